@@ -0,0 +1,216 @@
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "action_state.h"
+#include "action_table.h"
+#include "benchmark.h"
+#include "bench_session.h"
+
+// xrSyncActions and the xrGetActionState* family on the benchmark session, on valid handles and on the error paths applications hit
+namespace XRGameBridge {
+    namespace {
+        constexpr uint32_t action_set_count = 3;
+        constexpr uint32_t actions_per_set = 8;
+
+        struct GB_ActionSetup {
+            XrSession session = GetBenchmarkSession();
+            std::array<XrActiveActionSet, action_set_count> active_sets{};
+            // Attached to another session
+            std::array<XrActiveActionSet, action_set_count> foreign_sets{};
+            std::array<XrAction, action_set_count * actions_per_set> actions{};
+            std::array<XrActionType, action_set_count * actions_per_set> types{};
+            // Destroyed right after creation, its slot holds a newer action
+            XrAction destroyed_action = XR_NULL_HANDLE;
+        };
+
+        // Action sets attached to a session with actions of every input type, like an engine's default input mapping
+        const GB_ActionSetup& GetActionSetup() {
+            static const GB_ActionSetup setup = [] {
+                const std::array<XrActionType, 4> types{ XR_ACTION_TYPE_BOOLEAN_INPUT, XR_ACTION_TYPE_FLOAT_INPUT, XR_ACTION_TYPE_VECTOR2F_INPUT, XR_ACTION_TYPE_POSE_INPUT };
+
+                GB_ActionSetup setup;
+                for (uint32_t set = 0; set < action_set_count; set++) {
+                    GB_ActionSet action_set{ XR_NULL_HANDLE, setup.session, set, "set" + std::to_string(set), "Set " + std::to_string(set) };
+                    XrActionSet handle = g_action_sets.Create(std::move(action_set));
+                    setup.active_sets[set] = { handle, XR_NULL_PATH };
+
+                    for (uint32_t action = 0; action < actions_per_set; action++) {
+                        GB_Action new_action{ handle, types[action % types.size()], {}, "action" + std::to_string(action), "Action " + std::to_string(action) };
+                        setup.actions[set * actions_per_set + action] = g_actions.Create(std::move(new_action));
+                        setup.types[set * actions_per_set + action] = types[action % types.size()];
+                    }
+                }
+
+                const XrSession other_session = reinterpret_cast<XrSession>(uint64_t(2));
+                for (uint32_t set = 0; set < action_set_count; set++) {
+                    XrActionSet handle = g_action_sets.Create(GB_ActionSet{ XR_NULL_HANDLE, other_session, set, "foreign" + std::to_string(set), "Foreign " + std::to_string(set) });
+                    setup.foreign_sets[set] = { handle, XR_NULL_PATH };
+                }
+
+                setup.destroyed_action = g_actions.Create(GB_Action{ setup.active_sets[0].actionSet, XR_ACTION_TYPE_BOOLEAN_INPUT, {}, "destroyed", "Destroyed" });
+                g_actions.Destroy(setup.destroyed_action);
+                return setup;
+            }();
+            return setup;
+        }
+
+        void BM_SyncActions(GB_BenchmarkState& state) {
+            const GB_ActionSetup& setup = GetActionSetup();
+            XrActionsSyncInfo sync_info{ XR_TYPE_ACTIONS_SYNC_INFO };
+            sync_info.countActiveActionSets = action_set_count;
+            sync_info.activeActionSets = setup.active_sets.data();
+
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = SyncActions(GetBenchmarkSessions(), setup.session, &sync_info);
+                DoNotOptimize(result);
+            }
+            if (result != XR_SUCCESS) {
+                state.SkipWithError("xrSyncActions failed");
+            }
+        }
+        GB_BENCHMARK(BM_SyncActions);
+
+        // Action sets attached to another session, fails on the first set
+        void BM_SyncActions_NotAttached(GB_BenchmarkState& state) {
+            const GB_ActionSetup& setup = GetActionSetup();
+            XrActionsSyncInfo sync_info{ XR_TYPE_ACTIONS_SYNC_INFO };
+            sync_info.countActiveActionSets = action_set_count;
+            sync_info.activeActionSets = setup.foreign_sets.data();
+
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = SyncActions(GetBenchmarkSessions(), setup.session, &sync_info);
+                DoNotOptimize(result);
+            }
+            if (result != XR_ERROR_ACTIONSET_NOT_ATTACHED) {
+                state.SkipWithError("Action sets of another session passed validation");
+            }
+        }
+        GB_BENCHMARK(BM_SyncActions_NotAttached);
+
+        // Every action of every set once per iteration through the function of its type, what a frame of input polling costs
+        void BM_GetActionState_AllActions(GB_BenchmarkState& state) {
+            const GB_ActionSetup& setup = GetActionSetup();
+            XrActionStateBoolean boolean_state{ XR_TYPE_ACTION_STATE_BOOLEAN };
+            XrActionStateFloat float_state{ XR_TYPE_ACTION_STATE_FLOAT };
+            XrActionStateVector2f vector_state{ XR_TYPE_ACTION_STATE_VECTOR2F };
+            XrActionStatePose pose_state{ XR_TYPE_ACTION_STATE_POSE };
+
+            bool valid = true;
+            for (auto _ : state) {
+                for (uint32_t i = 0; i < setup.actions.size(); i++) {
+                    XrActionStateGetInfo get_info{ XR_TYPE_ACTION_STATE_GET_INFO };
+                    get_info.action = setup.actions[i];
+
+                    XrResult result = XR_ERROR_ACTION_TYPE_MISMATCH;
+                    switch (setup.types[i]) {
+                    case XR_ACTION_TYPE_BOOLEAN_INPUT:
+                        result = GetActionStateBoolean(GetBenchmarkSessions(), setup.session, &get_info, &boolean_state);
+                        break;
+                    case XR_ACTION_TYPE_FLOAT_INPUT:
+                        result = GetActionStateFloat(GetBenchmarkSessions(), setup.session, &get_info, &float_state);
+                        break;
+                    case XR_ACTION_TYPE_VECTOR2F_INPUT:
+                        result = GetActionStateVector2f(GetBenchmarkSessions(), setup.session, &get_info, &vector_state);
+                        break;
+                    case XR_ACTION_TYPE_POSE_INPUT:
+                        result = GetActionStatePose(GetBenchmarkSessions(), setup.session, &get_info, &pose_state);
+                        break;
+                    default:
+                        break;
+                    }
+                    valid = result == XR_SUCCESS && valid;
+                }
+                DoNotOptimize(boolean_state);
+                DoNotOptimize(float_state);
+                DoNotOptimize(vector_state);
+                DoNotOptimize(pose_state);
+            }
+            if (!valid) {
+                state.SkipWithError("xrGetActionState* failed on a valid action");
+            }
+        }
+        GB_BENCHMARK(BM_GetActionState_AllActions);
+
+        void BM_GetActionStateBoolean(GB_BenchmarkState& state) {
+            const GB_ActionSetup& setup = GetActionSetup();
+            XrActionStateGetInfo get_info{ XR_TYPE_ACTION_STATE_GET_INFO };
+            get_info.action = setup.actions[0];
+            XrActionStateBoolean action_state{ XR_TYPE_ACTION_STATE_BOOLEAN };
+
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = GetActionStateBoolean(GetBenchmarkSessions(), setup.session, &get_info, &action_state);
+                DoNotOptimize(result);
+                DoNotOptimize(action_state);
+            }
+            if (result != XR_SUCCESS) {
+                state.SkipWithError("xrGetActionStateBoolean failed");
+            }
+        }
+        GB_BENCHMARK(BM_GetActionStateBoolean);
+
+        // Applications that query a float action as a boolean get an error back every frame
+        void BM_GetActionState_TypeMismatch(GB_BenchmarkState& state) {
+            const GB_ActionSetup& setup = GetActionSetup();
+            XrActionStateGetInfo get_info{ XR_TYPE_ACTION_STATE_GET_INFO };
+            get_info.action = setup.actions[1];
+            XrActionStateBoolean action_state{ XR_TYPE_ACTION_STATE_BOOLEAN };
+
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = GetActionStateBoolean(GetBenchmarkSessions(), setup.session, &get_info, &action_state);
+                DoNotOptimize(result);
+            }
+            if (result != XR_ERROR_ACTION_TYPE_MISMATCH) {
+                state.SkipWithError("A float action passed as a boolean");
+            }
+        }
+        GB_BENCHMARK(BM_GetActionState_TypeMismatch);
+
+        // A stale action handle, an application polling an action it destroyed
+        void BM_GetActionState_InvalidHandle(GB_BenchmarkState& state) {
+            const GB_ActionSetup& setup = GetActionSetup();
+            XrActionStateGetInfo get_info{ XR_TYPE_ACTION_STATE_GET_INFO };
+            get_info.action = setup.destroyed_action;
+            XrActionStateBoolean action_state{ XR_TYPE_ACTION_STATE_BOOLEAN };
+
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = GetActionStateBoolean(GetBenchmarkSessions(), setup.session, &get_info, &action_state);
+                DoNotOptimize(result);
+            }
+            if (result != XR_ERROR_HANDLE_INVALID) {
+                state.SkipWithError("A destroyed action passed validation");
+            }
+        }
+        GB_BENCHMARK(BM_GetActionState_InvalidHandle);
+
+        // The same stale handle looked up the way the entry points did before GB_Expected, map.at() inside try/catch
+        void BM_GetActionState_InvalidHandle_Exception(GB_BenchmarkState& state) {
+            const GB_ActionSetup& setup = GetActionSetup();
+            std::unordered_map<XrAction, XrActionType> actions;
+            for (uint32_t i = 0; i < setup.actions.size(); i++) {
+                actions.emplace(setup.actions[i], setup.types[i]);
+            }
+
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                try {
+                    result = actions.at(setup.destroyed_action) == XR_ACTION_TYPE_BOOLEAN_INPUT ? XR_SUCCESS : XR_ERROR_ACTION_TYPE_MISMATCH;
+                }
+                catch (const std::out_of_range&) {
+                    result = XR_ERROR_HANDLE_INVALID;
+                }
+                DoNotOptimize(result);
+            }
+            if (result != XR_ERROR_HANDLE_INVALID) {
+                state.SkipWithError("A destroyed action was found");
+            }
+        }
+        GB_BENCHMARK(BM_GetActionState_InvalidHandle_Exception);
+    }
+}
@@ -0,0 +1,31 @@
+#include "benchmark.h"
+#include "events.h"
+
+// xrPollEvent, most calls find the queue empty
+namespace XRGameBridge {
+    namespace {
+        void BM_PollEvent_Empty(GB_BenchmarkState& state) {
+            GB_EventQueue queue;
+            XrEventDataBuffer event{ XR_TYPE_EVENT_DATA_BUFFER };
+            for (auto _ : state) {
+                XrResult result = queue.Poll(&event);
+                DoNotOptimize(result);
+            }
+        }
+        GB_BENCHMARK(BM_PollEvent_Empty);
+
+        // A session state change pushed and polled
+        void BM_PollEvent_SessionStateChanged(GB_BenchmarkState& state) {
+            GB_EventQueue queue;
+            XrEventDataBuffer event{ XR_TYPE_EVENT_DATA_BUFFER };
+            XrTime time = 0;
+            for (auto _ : state) {
+                PushSessionStateChanged(queue, XR_NULL_HANDLE, XR_SESSION_STATE_FOCUSED, time++);
+                XrResult result = queue.Poll(&event);
+                DoNotOptimize(result);
+                DoNotOptimize(event);
+            }
+        }
+        GB_BENCHMARK(BM_PollEvent_SessionStateChanged);
+    }
+}
@@ -0,0 +1,125 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "benchmark.h"
+#include "fence_waiter.h"
+
+// Waiting on GPU completion through the fence waiter, with a simulated timeline in place of a D3D12 fence
+namespace XRGameBridge {
+    namespace {
+        // xrWaitSwapchainImage on an image the GPU is done with, doesn't involve the waiter thread
+        void BM_FenceWaiter_Completed(GB_BenchmarkState& state) {
+            GB_SystemWaitBackend backend;
+            GB_FenceWaiter waiter(backend);
+            GB_SimulatedTimeline timeline;
+            timeline.Complete(1);
+
+            bool failed = false;
+            for (auto _ : state) {
+                failed |= !waiter.Wait(timeline, 1);
+            }
+
+            if (failed) {
+                state.SkipWithError("Completed value wasn't reported");
+            }
+        }
+        GB_BENCHMARK(BM_FenceWaiter_Completed);
+
+        // The application waits on every frame while another thread plays the GPU and completes it, the round trip of a wake
+        void BM_FenceWaiter_GpuCompletion(GB_BenchmarkState& state) {
+            GB_SystemWaitBackend backend;
+            GB_FenceWaiter waiter(backend);
+            GB_SimulatedTimeline timeline;
+            std::atomic<bool> running = true;
+            std::atomic<uint64_t> submitted = 0;
+
+            std::thread gpu_thread([&]() {
+                uint64_t completed = 0;
+                while (running.load(std::memory_order_relaxed)) {
+                    const uint64_t value = submitted.load(std::memory_order_acquire);
+                    if (value == completed) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    timeline.Complete(value);
+                    completed = value;
+                }
+            });
+
+            uint64_t value = 0;
+            bool failed = false;
+            for (auto _ : state) {
+                submitted.store(++value, std::memory_order_release);
+                failed |= !waiter.Wait(timeline, value);
+            }
+
+            running.store(false);
+            gpu_thread.join();
+
+            if (failed || timeline.GetCompletedValue() != value) {
+                state.SkipWithError("A wait didn't complete");
+            }
+        }
+        GB_BENCHMARK(BM_FenceWaiter_GpuCompletion);
+
+        // A 200 microsecond timeout on a frame the GPU never finishes. Millisecond timers round it to nothing or to a full
+        // millisecond, the waiter has to give up after the timeout and not before.
+        void BM_FenceWaiter_SubMillisecondTimeout(GB_BenchmarkState& state) {
+            GB_SystemWaitBackend backend;
+            GB_FenceWaiter waiter(backend);
+            GB_SimulatedTimeline timeline;
+            constexpr XrDuration timeout = 200'000;
+
+            bool failed = false;
+            bool early = false;
+            for (auto _ : state) {
+                const int64_t start = backend.Now();
+                failed |= waiter.Wait(timeline, 1, timeout);
+                early |= backend.Now() - start < timeout;
+            }
+
+            if (failed || early) {
+                state.SkipWithError("Timed out wait returned early or succeeded");
+            }
+        }
+        GB_BENCHMARK(BM_FenceWaiter_SubMillisecondTimeout);
+
+        // xrDestroyInstance with a frame still waiting on the GPU, Stop has to release the wait and join the thread.
+        // The wait after it starts the thread again, like the next instance does.
+        void BM_FenceWaiter_StopWhileWaiting(GB_BenchmarkState& state) {
+            GB_SystemWaitBackend backend;
+            GB_FenceWaiter waiter(backend);
+            GB_SimulatedTimeline timeline;
+
+            uint64_t value = 0;
+            bool failed = false;
+            for (auto _ : state) {
+                // Past the value completed for the restart
+                value += 2;
+                std::atomic<bool> released = false;
+                std::atomic<bool> completed = true;
+                std::thread application_thread([&]() {
+                    completed.store(waiter.Wait(timeline, value));
+                    released.store(true);
+                });
+
+                // Stop only releases waits the thread already knows about, until then it has nothing to join
+                while (!released.load()) {
+                    waiter.Stop();
+                    std::this_thread::yield();
+                }
+                application_thread.join();
+                failed |= completed.load();
+
+                timeline.Complete(value + 1);
+                failed |= !waiter.Wait(timeline, value + 1, 1'000'000);
+            }
+
+            if (failed) {
+                state.SkipWithError("Stop didn't time out the pending wait or the waiter didn't restart");
+            }
+        }
+        GB_BENCHMARK(BM_FenceWaiter_StopWhileWaiting);
+    }
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "benchmark.h"
+#include "frame_pacer.h"
+#include "frame_timer.h"
+
+// xrWaitFrame blocking on the frame pacer: what a blocked application thread costs and how quickly xrBeginFrame wakes it
+namespace XRGameBridge {
+    namespace {
+        int64_t GetThreadCpuTime() {
+#ifdef _WIN32
+            FILETIME creation, exit, kernel, user;
+            GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+            const uint64_t kernel_time = (uint64_t(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+            const uint64_t user_time = (uint64_t(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+            return static_cast<int64_t>((kernel_time + user_time) * 100);
+#else
+            timespec time;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+            return int64_t(time.tv_sec) * 1'000'000'000 + time.tv_nsec;
+#endif
+        }
+
+        struct BlockedWaits {
+            std::vector<int64_t> wake_latencies;
+            int64_t blocked_time = 0;
+            int64_t blocked_cpu_time = 0;
+        };
+
+        // A frame loop split over two threads. The application thread blocks in WaitFrame, the other thread gives it time to fall
+        // asleep and then begins the frame it claimed. Every wake up is timed from just before BeginFrame on the session clock.
+        BlockedWaits RunBlockedWaits(GB_BenchmarkState& state, std::chrono::nanoseconds block_time) {
+            GB_FramePacer pacer;
+            GB_SessionClock clock;
+            std::atomic<int64_t> begin_time = 0;
+            std::atomic<uint64_t> frames_claimed = 0;
+
+            BlockedWaits result;
+            result.wake_latencies.reserve(state.GetIterations());
+
+            std::thread application_thread([&]() {
+                // The first frame is free, every frame after it waits for the previous one to begin
+                pacer.WaitFrame();
+                frames_claimed.store(1, std::memory_order_release);
+                for (uint64_t frame = 1;; frame++) {
+                    const int64_t cpu_start = GetThreadCpuTime();
+                    const int64_t start = clock.Now();
+                    if (pacer.WaitFrame() != GB_FramePacer::WaitResult::Success) {
+                        break;
+                    }
+                    const int64_t woken = clock.Now();
+                    result.blocked_cpu_time += GetThreadCpuTime() - cpu_start;
+                    result.blocked_time += woken - start;
+                    result.wake_latencies.push_back(woken - begin_time.load(std::memory_order_acquire));
+                    frames_claimed.store(frame + 1, std::memory_order_release);
+                }
+            });
+
+            uint64_t frame = 1;
+            for (auto _ : state) {
+                while (frames_claimed.load(std::memory_order_acquire) < frame) {
+                    std::this_thread::yield();
+                }
+                std::this_thread::sleep_for(block_time);
+                begin_time.store(clock.Now(), std::memory_order_release);
+                pacer.BeginFrame();
+                pacer.EndFrame();
+                frame++;
+            }
+
+            while (frames_claimed.load(std::memory_order_acquire) < frame) {
+                std::this_thread::yield();
+            }
+            pacer.Release();
+            application_thread.join();
+            return result;
+        }
+
+        int64_t Percentile(std::vector<int64_t>& values, double percentile) {
+            const size_t index = std::min(values.size() - 1, static_cast<size_t>(percentile * values.size()));
+            std::nth_element(values.begin(), values.begin() + index, values.end());
+            return values[index];
+        }
+
+        void BM_FramePacer_WakeLatency(GB_BenchmarkState& state) {
+            BlockedWaits waits = RunBlockedWaits(state, std::chrono::microseconds(200));
+
+            char label[96];
+            std::snprintf(label, sizeof(label), "wake p50 %.1f us, p99 %.1f us, max %.1f us", Percentile(waits.wake_latencies, 0.5) / 1e3,
+                Percentile(waits.wake_latencies, 0.99) / 1e3, *std::max_element(waits.wake_latencies.begin(), waits.wake_latencies.end()) / 1e3);
+            state.SetLabel(label);
+        }
+        GB_BENCHMARK(BM_FramePacer_WakeLatency);
+
+        // A spinning wait would use the whole time it blocks, a sleeping one only the wake up
+        void BM_FramePacer_BlockedCpuTime(GB_BenchmarkState& state) {
+            const BlockedWaits waits = RunBlockedWaits(state, std::chrono::milliseconds(2));
+
+            const double cpu_share = waits.blocked_time > 0 ? double(waits.blocked_cpu_time) / double(waits.blocked_time) : 0.0;
+            char label[64];
+            std::snprintf(label, sizeof(label), "cpu %.2f%% of the blocked time", cpu_share * 100.0);
+            state.SetLabel(label);
+            if (cpu_share > 0.1) {
+                state.SkipWithError(std::string("The thread blocked in WaitFrame used ") + label);
+            }
+        }
+        GB_BENCHMARK(BM_FramePacer_BlockedCpuTime);
+    }
+}
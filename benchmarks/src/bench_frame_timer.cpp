@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "frame_timer.h"
+#include "trace.h"
+
+// Display time prediction of xrWaitFrame against synthetic vblanks on a replay clock, where the true refresh grid is known.
+// Every iteration adds the vblank xrEndFrame would report and predicts the next frame like xrWaitFrame does.
+namespace XRGameBridge {
+    namespace {
+        struct VblankSource {
+            // The display, a little off the refresh rate it reports like most panels
+            double nominal_refresh_rate;
+            int64_t true_period;
+            // Standard deviation of the timestamp noise
+            int64_t jitter;
+            // Chances per vblank
+            double missed = 0.0;
+            double late = 0.0;
+            double repeated = 0.0;
+        };
+
+        // Largest errors of the estimated period and of the next vblank predicted halfway through every frame, after the history filled
+        struct PredictionErrors {
+            int64_t period = 0;
+            std::vector<int64_t> next_vblank;
+        };
+
+        PredictionErrors RunVblanks(GB_BenchmarkState& state, const VblankSource& source) {
+            constexpr int64_t phase = 3'000'000;
+            constexpr uint64_t warmup = 32;
+
+            GB_ReplayClock clock;
+            GB_FrameTimer timer(clock, source.nominal_refresh_rate);
+            std::mt19937 random(7);
+            std::normal_distribution<double> noise(0.0, double(source.jitter));
+            std::uniform_real_distribution<double> chance(0.0, 1.0);
+            std::uniform_int_distribution<int64_t> lateness(source.true_period / 8, source.true_period / 2);
+
+            PredictionErrors errors;
+            errors.next_vblank.reserve(state.GetIterations());
+
+            uint64_t frame = 0;
+            int64_t last_reported = 0;
+            for (auto _ : state) {
+                const int64_t vblank = phase + int64_t(frame) * source.true_period;
+                clock.Set(vblank + source.true_period / 2);
+
+                const double roll = chance(random);
+                if (roll < source.missed) {
+                    // Nothing reported for this one
+                }
+                else if (roll < source.missed + source.repeated && last_reported != 0) {
+                    timer.AddVblank(last_reported);
+                }
+                else if (roll < source.missed + source.repeated + source.late) {
+                    // A stalled thread reading the statistics late
+                    timer.AddVblank(last_reported = vblank + lateness(random));
+                }
+                else {
+                    timer.AddVblank(last_reported = vblank + std::llround(noise(random)));
+                }
+
+                const GB_FramePrediction prediction = timer.PredictFrame();
+                DoNotOptimize(prediction);
+
+                if (frame >= warmup) {
+                    const int64_t next_vblank = vblank + source.true_period;
+                    errors.next_vblank.push_back(std::abs(timer.GetNextVblank(clock.Now()) - next_vblank));
+                    errors.period = std::max(errors.period, std::abs(timer.GetPeriod() - source.true_period));
+                }
+                frame++;
+            }
+            return errors;
+        }
+
+        // The prediction has to stay close to the right vblank: the period within 1%, the next vblank within 5% of a period on 99% of the
+        // frames and within a quarter period on every frame
+        void ReportErrors(GB_BenchmarkState& state, PredictionErrors& errors, int64_t period) {
+            if (errors.next_vblank.empty()) {
+                return;
+            }
+
+            const size_t p99_index = std::min(errors.next_vblank.size() - 1, errors.next_vblank.size() * 99 / 100);
+            std::nth_element(errors.next_vblank.begin(), errors.next_vblank.begin() + p99_index, errors.next_vblank.end());
+            const int64_t p99 = errors.next_vblank[p99_index];
+            const int64_t max = *std::max_element(errors.next_vblank.begin(), errors.next_vblank.end());
+
+            char label[96];
+            std::snprintf(label, sizeof(label), "period error %.1f us, next vblank p99 %.1f us, max %.1f us", errors.period / 1e3, p99 / 1e3, max / 1e3);
+            state.SetLabel(label);
+            if (errors.period > period / 100 || p99 > period / 20 || max > period / 4) {
+                state.SkipWithError(std::string("Prediction off the vblank grid, ") + label);
+            }
+        }
+
+        void BM_FrameTimer_JitteredVblanks(GB_BenchmarkState& state) {
+            const VblankSource source{ 60.0, 16'683'333, 300'000 };
+            PredictionErrors errors = RunVblanks(state, source);
+            ReportErrors(state, errors, source.true_period);
+        }
+        GB_BENCHMARK(BM_FrameTimer_JitteredVblanks);
+
+        // Missed vblanks, the same vblank reported twice and stalls reporting one late, on a 120 Hz panel
+        void BM_FrameTimer_VblanksWithOutliers(GB_BenchmarkState& state) {
+            const VblankSource source{ 120.0, 8'340'000, 100'000, 0.05, 0.05, 0.05 };
+            PredictionErrors errors = RunVblanks(state, source);
+            ReportErrors(state, errors, source.true_period);
+        }
+        GB_BENCHMARK(BM_FrameTimer_VblanksWithOutliers);
+    }
+}
@@ -0,0 +1,197 @@
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark.h"
+#include "handle_table.h"
+
+// Handle lookups as every entry point does them, against the unordered_map they replaced.
+// Then handle tables under contention: creating and destroying from several threads while others look up, like sessions and swapchains
+// being recreated on the application's threads while the render thread runs. Run under GB_SANITIZER=thread to check the lock free reads.
+namespace XRGameBridge {
+    namespace {
+        struct TaggedObject {
+            uint64_t tag;
+        };
+
+        using StressTable = GB_HandleTable<XrSwapchain, TaggedObject, 16, 64>;
+
+        // Swapchains, spaces and sessions of a running application
+        constexpr uint32_t lookup_handles = 16;
+
+        // The lookup xrAcquireSwapchainImage and the other entry points did before the handle tables: a hashed find in a map keyed by
+        // handles from a creation counter
+        void BM_HandleLookup_UnorderedMap(GB_BenchmarkState& state) {
+            std::unordered_map<XrSwapchain, TaggedObject> map;
+            std::array<XrSwapchain, lookup_handles> handles;
+            for (uint32_t i = 0; i < lookup_handles; i++) {
+                handles[i] = reinterpret_cast<XrSwapchain>(uint64_t(i + 1));
+                map.emplace(handles[i], TaggedObject{ i });
+            }
+
+            uint32_t i = 0;
+            for (auto _ : state) {
+                auto found = map.find(handles[i++ % lookup_handles]);
+                const TaggedObject* object = found != map.end() ? &found->second : nullptr;
+                DoNotOptimize(object);
+            }
+        }
+        GB_BENCHMARK(BM_HandleLookup_UnorderedMap);
+
+        void BM_HandleLookup_HandleTable(GB_BenchmarkState& state) {
+            StressTable table(HANDLE_TYPE_NULL_SWAPCHAIN);
+            std::array<XrSwapchain, lookup_handles> handles;
+            for (uint32_t i = 0; i < lookup_handles; i++) {
+                handles[i] = table.Create(TaggedObject{ i });
+            }
+
+            uint32_t i = 0;
+            for (auto _ : state) {
+                const TaggedObject* object = table.Get(handles[i++ % lookup_handles]);
+                DoNotOptimize(object);
+            }
+        }
+        GB_BENCHMARK(BM_HandleLookup_HandleTable);
+
+        // Handles of destroyed objects whose slots were reused, the generation check has to turn them all away
+        void BM_HandleLookup_HandleTable_Stale(GB_BenchmarkState& state) {
+            StressTable table(HANDLE_TYPE_NULL_SWAPCHAIN);
+            std::array<XrSwapchain, lookup_handles> handles;
+            for (uint32_t i = 0; i < lookup_handles; i++) {
+                handles[i] = table.Create(TaggedObject{ i });
+            }
+            for (uint32_t i = 0; i < lookup_handles; i++) {
+                table.Destroy(handles[i]);
+                table.Create(TaggedObject{ i });
+            }
+
+            bool valid = true;
+            uint32_t i = 0;
+            for (auto _ : state) {
+                const TaggedObject* object = table.Get(handles[i++ % lookup_handles]);
+                valid = valid && object == nullptr;
+                DoNotOptimize(object);
+            }
+            if (!valid) {
+                state.SkipWithError("A stale handle found the object now in its slot");
+            }
+        }
+        GB_BENCHMARK(BM_HandleLookup_HandleTable_Stale);
+
+        constexpr uint32_t churn_threads = 3;
+        constexpr uint32_t published_handles = 64;
+
+        // Creates, checks and destroys objects of its own while looking up handles other threads published, which may be stale.
+        // An object that doesn't carry the tag it was created with means two live handles share a slot.
+        class ChurnThreads {
+            StressTable& table;
+            std::array<std::atomic<XrSwapchain>, published_handles> published{};
+            std::atomic<bool> running = true;
+            std::atomic<bool> failed = false;
+            std::vector<std::thread> threads;
+
+        public:
+            explicit ChurnThreads(StressTable& table) : table(table) {
+                for (uint32_t t = 0; t < churn_threads; t++) {
+                    threads.emplace_back([this, t]() {
+                        uint64_t count = 0;
+                        while (running.load(std::memory_order_relaxed)) {
+                            const uint64_t tag = (uint64_t(t + 1) << 48) | count;
+                            if (!Cycle(tag)) {
+                                failed.store(true);
+                            }
+                            count++;
+                        }
+                    });
+                }
+            }
+
+            ~ChurnThreads() {
+                Stop();
+            }
+
+            // One create, lookup and destroy, with a lookup of a published handle in between
+            bool Cycle(uint64_t tag) {
+                const XrSwapchain handle = table.Create(TaggedObject{ tag });
+                if (handle == XR_NULL_HANDLE) {
+                    // Full, only possible while every other thread holds one too
+                    std::this_thread::yield();
+                    return true;
+                }
+
+                bool valid = table.Get(handle) != nullptr && table.Get(handle)->tag == tag;
+                std::atomic<XrSwapchain>& slot = published[tag % published_handles];
+                slot.store(handle, std::memory_order_relaxed);
+
+                // The object may be gone by now, only the lookup itself is checked
+                DoNotOptimize(table.Get(published[(tag * 7) % published_handles].load(std::memory_order_relaxed)));
+
+                valid = valid && table.Get(handle)->tag == tag;
+                valid = table.Destroy(handle) && valid;
+                return valid && table.Get(handle) == nullptr && !table.Destroy(handle);
+            }
+
+            void Stop() {
+                running.store(false);
+                for (std::thread& thread : threads) {
+                    thread.join();
+                }
+                threads.clear();
+            }
+
+            bool Failed() const {
+                return failed.load();
+            }
+        };
+
+        // Every iteration is a whole create, lookup and destroy cycle racing the churn threads for the write lock and the slots
+        void BM_HandleTable_ConcurrentCreateDestroy(GB_BenchmarkState& state) {
+            StressTable table(HANDLE_TYPE_NULL_SWAPCHAIN);
+            ChurnThreads churn(table);
+
+            bool valid = true;
+            uint64_t count = 0;
+            for (auto _ : state) {
+                valid = churn.Cycle(count++) && valid;
+            }
+            churn.Stop();
+
+            if (!valid || churn.Failed() || table.Size() != 0) {
+                state.SkipWithError("Handle table lost or aliased an object");
+            }
+        }
+        GB_BENCHMARK(BM_HandleTable_ConcurrentCreateDestroy);
+
+        // Lookups of long lived objects while other threads create and destroy around them, the frame path next to a swapchain recreate.
+        // The lookups must never block on the write lock and never see another object.
+        void BM_HandleTable_GetWhileChurning(GB_BenchmarkState& state) {
+            StressTable table(HANDLE_TYPE_NULL_SWAPCHAIN);
+            std::array<XrSwapchain, 8> handles;
+            for (uint32_t i = 0; i < handles.size(); i++) {
+                handles[i] = table.Create(TaggedObject{ i });
+            }
+            ChurnThreads churn(table);
+
+            bool valid = true;
+            uint32_t i = 0;
+            for (auto _ : state) {
+                const TaggedObject* object = table.Get(handles[i % handles.size()]);
+                valid = valid && object != nullptr && object->tag == i % handles.size();
+                DoNotOptimize(object);
+                i++;
+            }
+            churn.Stop();
+
+            for (const XrSwapchain handle : handles) {
+                valid = table.Destroy(handle) && valid;
+            }
+            if (!valid || churn.Failed() || table.Size() != 0) {
+                state.SkipWithError("Lookup returned the wrong object");
+            }
+        }
+        GB_BENCHMARK(BM_HandleTable_GetWhileChurning);
+    }
+}
@@ -0,0 +1,112 @@
+#include <array>
+#include <cstdint>
+
+#include "benchmark.h"
+#include "heap_allocator.h"
+
+// Placing swapchain images in pooled heaps, against a device that only counts the heaps it hands out
+namespace XRGameBridge {
+    namespace {
+        class GB_MockHeapDevice : public GB_HeapDevice {
+            uint64_t next_id = 1;
+
+        public:
+            uint64_t capacity = UINT64_MAX;
+            uint64_t allocated = 0;
+            uint32_t heaps = 0;
+
+            uint64_t CreateHeap(uint64_t size, uint64_t alignment) override {
+                if (allocated + size > capacity) {
+                    return 0;
+                }
+                allocated += size;
+                heaps++;
+                // Ids only have to be unique, the size is kept in the low bits to check destroys
+                return (next_id++ << 40) | (size >> 16);
+            }
+
+            void DestroyHeap(uint64_t heap) override {
+                allocated -= (heap & ((1ull << 40) - 1)) << 16;
+                heaps--;
+            }
+        };
+
+        constexpr uint64_t placement_alignment = 64 * 1024;
+
+        // RGBA8 with the 64KB placement granularity of D3D12
+        uint64_t GetImageSize(uint32_t width, uint32_t height) {
+            const uint64_t size = uint64_t(width) * height * 4;
+            return (size + placement_alignment - 1) / placement_alignment * placement_alignment;
+        }
+
+        // Destroying and creating a swapchain at the same size, what UEVR does when it restarts a session.
+        // After the first iteration every image comes from the free list.
+        void BM_HeapAllocator_RecreateSwapchain(GB_BenchmarkState& state) {
+            GB_MockHeapDevice device;
+            GB_HeapAllocator allocator(device, {});
+            std::array<GB_HeapAllocation, 3> images;
+
+            uint64_t fence_value = 0;
+            for (auto _ : state) {
+                for (auto& image : images) {
+                    image = allocator.Allocate(GetImageSize(1920, 1080), placement_alignment);
+                }
+                fence_value++;
+                for (auto& image : images) {
+                    allocator.Free(image, fence_value);
+                }
+                allocator.Reclaim(fence_value);
+            }
+
+            const GB_HeapAllocatorStats stats = allocator.GetStats();
+            if (stats.heaps_created != 1 || stats.allocations - stats.reused_allocations != images.size()) {
+                state.SkipWithError("Images weren't reused");
+            }
+        }
+        GB_BENCHMARK(BM_HeapAllocator_RecreateSwapchain);
+
+        // Two eye swapchains and a quad swapchain recreated at a new render scale every iteration while the GPU runs two
+        // frames behind, like dynamic resolution in UEVR. The pool has to settle instead of growing with every change.
+        void BM_HeapAllocator_ResolutionChanges(GB_BenchmarkState& state) {
+            GB_MockHeapDevice device;
+            device.capacity = 1024ull * 1024 * 1024;
+            GB_HeapAllocator allocator(device, {});
+
+            constexpr std::array<float, 6> scales{ 1.0f, 0.8f, 1.2f, 0.6f, 1.4f, 0.9f };
+            constexpr uint32_t images_per_swapchain = 3;
+            std::array<GB_HeapAllocation, 3 * images_per_swapchain> images{};
+
+            uint64_t fence_value = 0;
+            uint64_t iteration = 0;
+            bool failed = false;
+            for (auto _ : state) {
+                const float scale = scales[iteration++ % scales.size()];
+                const uint32_t width = static_cast<uint32_t>(2560 * scale);
+                const uint32_t height = static_cast<uint32_t>(1440 * scale);
+
+                fence_value++;
+                for (auto& image : images) {
+                    allocator.Free(image, fence_value);
+                }
+                if (fence_value > 2) {
+                    allocator.Reclaim(fence_value - 2);
+                }
+
+                for (uint32_t i = 0; i < images.size(); i++) {
+                    const bool quad = i >= 2 * images_per_swapchain;
+                    images[i] = allocator.Allocate(quad ? GetImageSize(1280, 720) : GetImageSize(width, height), placement_alignment);
+                    failed |= !images[i].IsValid();
+                }
+            }
+
+            const GB_HeapAllocatorStats stats = allocator.GetStats();
+            if (failed || stats.GetInternalFragmentation() > 0.25) {
+                state.SkipWithError("Allocation failed or wasted more than a quarter");
+            }
+            if (device.heaps != stats.heap_count || device.allocated != stats.heap_bytes) {
+                state.SkipWithError("Heap accounting is off");
+            }
+        }
+        GB_BENCHMARK(BM_HeapAllocator_ResolutionChanges);
+    }
+}
@@ -0,0 +1,37 @@
+#include <easylogging++.h>
+
+#include "benchmark.h"
+#include "logging.h"
+
+// Cost of a log call to the thread that logs, the log thread writes the records out in the background
+namespace XRGameBridge {
+    namespace {
+        // A hot path warning. The ring is drained outside the timing after every batch, so every call encodes a record instead of
+        // finding the ring full and only counting a dropped one.
+        void BM_Log_Async(GB_BenchmarkState& state) {
+            constexpr uint64_t batch_size = GB_LogRing::capacity / 2;
+
+            FlushLog();
+            uint64_t frame = 0;
+            for (auto _ : state) {
+                GB_LOG(Warning, "Frame {} missed its deadline by {} ns", frame++, 1250);
+                if (frame % batch_size == 0) {
+                    state.PauseTiming();
+                    FlushLog();
+                    state.ResumeTiming();
+                }
+            }
+            FlushLog();
+        }
+        GB_BENCHMARK(BM_Log_Async);
+
+        // The same line through easylogging++ on the calling thread
+        void BM_Log_Easylogging(GB_BenchmarkState& state) {
+            uint64_t frame = 0;
+            for (auto _ : state) {
+                LOG(WARNING) << "Frame " << frame++ << " missed its deadline by " << 1250 << " ns";
+            }
+        }
+        GB_BENCHMARK(BM_Log_Easylogging);
+    }
+}
@@ -0,0 +1,124 @@
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "path_table.h"
+
+// xrStringToPath and xrPathToString
+namespace XRGameBridge {
+    namespace {
+        // Paths of a typical action setup, every interaction profile with the inputs of both hands
+        std::vector<std::string> MakePaths() {
+            const std::array<const char*, 4> profiles{ "/interaction_profiles/khr/simple_controller", "/interaction_profiles/oculus/touch_controller", "/interaction_profiles/valve/index_controller", "/interaction_profiles/htc/vive_controller" };
+            const std::array<const char*, 2> hands{ "/user/hand/left", "/user/hand/right" };
+            const std::array<const char*, 8> inputs{ "/input/select/click", "/input/menu/click", "/input/grip/pose", "/input/aim/pose", "/input/trigger/value", "/input/squeeze/value", "/input/thumbstick", "/output/haptic" };
+
+            std::vector<std::string> paths(profiles.begin(), profiles.end());
+            for (const char* hand : hands) {
+                paths.emplace_back(hand);
+                for (const char* input : inputs) {
+                    paths.push_back(std::string(hand) + input);
+                }
+            }
+            return paths;
+        }
+
+        // Every path in the order an engine registers them while suggesting bindings: each profile and then the binding paths of both
+        // hands for it. Most binding paths repeat between profiles, so after the first profile the calls mostly find existing paths.
+        std::vector<std::string> MakeBindingSetupPaths() {
+            struct Profile {
+                const char* path;
+                std::vector<const char*> inputs;
+            };
+            const std::array<Profile, 8> profiles{ {
+                { "/interaction_profiles/khr/simple_controller", { "/input/select/click", "/input/menu/click", "/input/grip/pose", "/input/aim/pose", "/output/haptic" } },
+                { "/interaction_profiles/oculus/touch_controller", { "/input/squeeze/value", "/input/trigger/value", "/input/trigger/touch", "/input/thumbstick", "/input/thumbstick/x", "/input/thumbstick/y", "/input/thumbstick/click", "/input/thumbstick/touch", "/input/thumbrest/touch", "/input/grip/pose", "/input/aim/pose", "/output/haptic" } },
+                { "/interaction_profiles/valve/index_controller", { "/input/system/click", "/input/a/click", "/input/a/touch", "/input/b/click", "/input/b/touch", "/input/squeeze/value", "/input/squeeze/force", "/input/trigger/click", "/input/trigger/value", "/input/trigger/touch", "/input/thumbstick", "/input/thumbstick/click", "/input/thumbstick/touch", "/input/trackpad", "/input/trackpad/force", "/input/trackpad/touch", "/input/grip/pose", "/input/aim/pose", "/output/haptic" } },
+                { "/interaction_profiles/htc/vive_controller", { "/input/system/click", "/input/squeeze/click", "/input/menu/click", "/input/trigger/click", "/input/trigger/value", "/input/trackpad", "/input/trackpad/click", "/input/trackpad/touch", "/input/grip/pose", "/input/aim/pose", "/output/haptic" } },
+                { "/interaction_profiles/microsoft/motion_controller", { "/input/menu/click", "/input/squeeze/click", "/input/trigger/value", "/input/thumbstick", "/input/thumbstick/click", "/input/trackpad", "/input/trackpad/click", "/input/trackpad/touch", "/input/grip/pose", "/input/aim/pose", "/output/haptic" } },
+                { "/interaction_profiles/hp/mixed_reality_controller", { "/input/menu/click", "/input/squeeze/value", "/input/trigger/value", "/input/thumbstick", "/input/thumbstick/click", "/input/grip/pose", "/input/aim/pose", "/output/haptic" } },
+                { "/interaction_profiles/htc/vive_cosmos_controller", { "/input/menu/click", "/input/shoulder/click", "/input/squeeze/click", "/input/trigger/click", "/input/trigger/value", "/input/thumbstick", "/input/thumbstick/click", "/input/thumbstick/touch", "/input/grip/pose", "/input/aim/pose", "/output/haptic" } },
+                { "/interaction_profiles/bytedance/pico4_controller", { "/input/menu/click", "/input/squeeze/click", "/input/squeeze/value", "/input/trigger/click", "/input/trigger/value", "/input/trigger/touch", "/input/thumbstick", "/input/thumbstick/click", "/input/thumbstick/touch", "/input/grip/pose", "/input/aim/pose", "/output/haptic" } },
+            } };
+            const std::array<const char*, 2> hands{ "/user/hand/left", "/user/hand/right" };
+
+            std::vector<std::string> paths;
+            for (const Profile& profile : profiles) {
+                paths.emplace_back(profile.path);
+                for (const char* hand : hands) {
+                    for (const char* input : profile.inputs) {
+                        paths.push_back(std::string(hand) + input);
+                    }
+                }
+            }
+            return paths;
+        }
+
+        void BM_StringToPath_Existing(GB_BenchmarkState& state) {
+            GB_PathTable table;
+            const std::vector<std::string> paths = MakePaths();
+            for (const std::string& path : paths) {
+                XrPath id;
+                StringToPath(table, path.c_str(), &id);
+            }
+
+            size_t next = 0;
+            XrPath path = XR_NULL_PATH;
+            for (auto _ : state) {
+                XrResult result = StringToPath(table, paths[next].c_str(), &path);
+                next = next + 1 == paths.size() ? 0 : next + 1;
+                DoNotOptimize(result);
+                DoNotOptimize(path);
+            }
+        }
+        GB_BENCHMARK(BM_StringToPath_Existing);
+
+        // The whole binding setup of an engine registered into an empty table every iteration, table creation included
+        void BM_StringToPath_BulkRegistration(GB_BenchmarkState& state) {
+            const std::vector<std::string> paths = MakeBindingSetupPaths();
+
+            bool valid = true;
+            for (auto _ : state) {
+                GB_PathTable table;
+                for (const std::string& path : paths) {
+                    XrPath id;
+                    valid = StringToPath(table, path.c_str(), &id) == XR_SUCCESS && valid;
+                    DoNotOptimize(id);
+                }
+            }
+
+            if (!valid) {
+                state.SkipWithError("xrStringToPath rejected a binding path");
+                return;
+            }
+            char label[64];
+            std::snprintf(label, sizeof(label), "%zu calls per iteration", paths.size());
+            state.SetLabel(label);
+        }
+        GB_BENCHMARK(BM_StringToPath_BulkRegistration);
+
+        // Both calls of the two call idiom
+        void BM_PathToString(GB_BenchmarkState& state) {
+            GB_PathTable table;
+            std::vector<XrPath> ids;
+            for (const std::string& path : MakePaths()) {
+                ids.push_back(table.Intern(path));
+            }
+
+            std::array<char, XR_MAX_PATH_LENGTH> buffer;
+            size_t next = 0;
+            for (auto _ : state) {
+                uint32_t count = 0;
+                for (uint32_t capacity : { 0u, uint32_t(buffer.size()) }) {
+                    XrResult result = PathToString(table, ids[next], capacity, &count, buffer.data());
+                    DoNotOptimize(result);
+                }
+                next = next + 1 == ids.size() ? 0 : next + 1;
+                DoNotOptimize(buffer);
+            }
+        }
+        GB_BENCHMARK(BM_PathToString);
+    }
+}
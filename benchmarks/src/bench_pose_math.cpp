@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <string>
+
+#include "benchmark.h"
+#include "pose_math.h"
+
+// Vectorized pose math against the scalar reference in pose_math_scalar.h, for correctness and speed.
+// Built with GB_POSE_MATH_SCALAR both sides are the scalar path, so the checks always pass and the timings match.
+namespace XRGameBridge {
+    namespace {
+        constexpr uint32_t batch_size = 64;
+        // pose_math.h promises agreement within 8 float epsilon, see ErrorUlps for the scale
+        constexpr float max_error_ulps = 8.0f;
+
+        struct PoseMathInputs {
+            std::array<XrPosef, batch_size> poses;
+            std::array<XrQuaternionf, batch_size> targets;
+            std::array<float, batch_size> factors;
+        };
+
+        XrQuaternionf RandomOrientation(std::mt19937& random) {
+            std::normal_distribution<float> normal;
+            XrQuaternionf q{ normal(random), normal(random), normal(random), normal(random) };
+            const float length = std::sqrt(QuatDot(q, q));
+            return { q.x / length, q.y / length, q.z / length, q.w / length };
+        }
+
+        // Orientations cover the whole sphere, positions a room. Every fourth slerp target is close to its source to hit the linear fallback.
+        PoseMathInputs MakeInputs(uint32_t seed) {
+            std::mt19937 random(seed);
+            std::uniform_real_distribution<float> position(-5.0f, 5.0f);
+            std::uniform_real_distribution<float> factor(0.0f, 1.0f);
+
+            PoseMathInputs inputs;
+            for (uint32_t i = 0; i < batch_size; i++) {
+                inputs.poses[i] = { RandomOrientation(random), { position(random), position(random), position(random) } };
+                inputs.targets[i] = RandomOrientation(random);
+                if (i % 4 == 0) {
+                    const XrQuaternionf& source = inputs.poses[i].orientation;
+                    const XrQuaternionf nudged{ source.x + 0.001f, source.y, source.z, source.w };
+                    const float length = std::sqrt(QuatDot(nudged, nudged));
+                    inputs.targets[i] = { nudged.x / length, nudged.y / length, nudged.z / length, nudged.w / length };
+                }
+                inputs.factors[i] = factor(random);
+            }
+            return inputs;
+        }
+
+        float Length(const XrVector3f& v) {
+            return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        }
+
+        // Largest component difference in float epsilons of the operands' length, which is 1 for unit quaternions and the length of the
+        // positions that went in for vectors. Per component ULPs would blow up on components near zero and on positions that cancel out.
+        float ErrorUlps(const XrQuaternionf& result, const XrQuaternionf& reference) {
+            const float error = std::max({ std::abs(result.x - reference.x), std::abs(result.y - reference.y), std::abs(result.z - reference.z), std::abs(result.w - reference.w) });
+            return error / FLT_EPSILON;
+        }
+
+        float ErrorUlps(const XrVector3f& result, const XrVector3f& reference, float scale) {
+            const float error = std::max({ std::abs(result.x - reference.x), std::abs(result.y - reference.y), std::abs(result.z - reference.z) });
+            return error / (FLT_EPSILON * std::max(scale, 1.0f));
+        }
+
+        float ErrorUlps(const XrPosef& result, const XrPosef& reference, float scale) {
+            return std::max(ErrorUlps(result.orientation, reference.orientation), ErrorUlps(result.position, reference.position, scale));
+        }
+
+        struct WorstError {
+            const char* function = "";
+            float ulps = 0.0f;
+
+            void Add(const char* name, float error) {
+                if (error > ulps) {
+                    function = name;
+                    ulps = error;
+                }
+            }
+        };
+
+        // Every function and its batch version on new random inputs every iteration
+        void BM_PoseMath_MatchesScalar(GB_BenchmarkState& state) {
+            WorstError worst;
+            std::array<XrPosef, batch_size> poses;
+            std::array<XrPosef, batch_size> reference_poses;
+            std::array<XrQuaternionf, batch_size> quats;
+            std::array<XrQuaternionf, batch_size> reference_quats;
+
+            uint32_t seed = 0;
+            for (auto _ : state) {
+                const PoseMathInputs inputs = MakeInputs(seed++);
+                const XrPosef& a = inputs.poses[0];
+                for (uint32_t i = 0; i < batch_size; i++) {
+                    const XrPosef& b = inputs.poses[i];
+                    worst.Add("QuatMultiply", ErrorUlps(QuatMultiply(a.orientation, b.orientation), QuatMultiplyScalar(a.orientation, b.orientation)));
+                    worst.Add("QuatRotate", ErrorUlps(QuatRotate(b.orientation, a.position), QuatRotateScalar(b.orientation, a.position), Length(a.position)));
+                    worst.Add("PoseMultiply", ErrorUlps(PoseMultiply(a, b), PoseMultiplyScalar(a, b), Length(a.position) + Length(b.position)));
+                    worst.Add("PoseInverse", ErrorUlps(PoseInverse(b), PoseInverseScalar(b), Length(b.position)));
+                    worst.Add("QuatSlerp", ErrorUlps(QuatSlerp(b.orientation, inputs.targets[i], inputs.factors[i]), QuatSlerpScalar(b.orientation, inputs.targets[i], inputs.factors[i])));
+                }
+
+                PoseMultiplyBatch(a, inputs.poses.data(), poses.data(), batch_size);
+                PoseMultiplyBatchScalar(a, inputs.poses.data(), reference_poses.data(), batch_size);
+                for (uint32_t i = 0; i < batch_size; i++) {
+                    worst.Add("PoseMultiplyBatch", ErrorUlps(poses[i], reference_poses[i], Length(a.position) + Length(inputs.poses[i].position)));
+                }
+
+                PoseInverseBatch(inputs.poses.data(), poses.data(), batch_size);
+                PoseInverseBatchScalar(inputs.poses.data(), reference_poses.data(), batch_size);
+                for (uint32_t i = 0; i < batch_size; i++) {
+                    worst.Add("PoseInverseBatch", ErrorUlps(poses[i], reference_poses[i], Length(inputs.poses[i].position)));
+                }
+
+                std::array<XrQuaternionf, batch_size> sources;
+                std::transform(inputs.poses.begin(), inputs.poses.end(), sources.begin(), [](const XrPosef& pose) { return pose.orientation; });
+                QuatSlerpBatch(sources.data(), inputs.targets.data(), inputs.factors[0], quats.data(), batch_size);
+                QuatSlerpBatchScalar(sources.data(), inputs.targets.data(), inputs.factors[0], reference_quats.data(), batch_size);
+                for (uint32_t i = 0; i < batch_size; i++) {
+                    worst.Add("QuatSlerpBatch", ErrorUlps(quats[i], reference_quats[i]));
+                }
+            }
+
+            if (worst.ulps > max_error_ulps) {
+                state.SkipWithError(std::string(worst.function) + " is " + std::to_string(worst.ulps) + " epsilon off the scalar reference");
+            }
+        }
+        GB_BENCHMARK(BM_PoseMath_MatchesScalar);
+
+        // The transforms the space graph and the view solver run per locate, vector path first and the scalar reference after it
+        void BM_PoseMath_PoseMultiply(GB_BenchmarkState& state) {
+            const PoseMathInputs inputs = MakeInputs(1);
+            XrPosef pose = inputs.poses[0];
+            uint32_t i = 0;
+            for (auto _ : state) {
+                pose = PoseMultiply(inputs.poses[i++ % batch_size], pose);
+                DoNotOptimize(pose);
+            }
+        }
+        GB_BENCHMARK(BM_PoseMath_PoseMultiply);
+
+        void BM_PoseMath_PoseMultiplyScalar(GB_BenchmarkState& state) {
+            const PoseMathInputs inputs = MakeInputs(1);
+            XrPosef pose = inputs.poses[0];
+            uint32_t i = 0;
+            for (auto _ : state) {
+                pose = PoseMultiplyScalar(inputs.poses[i++ % batch_size], pose);
+                DoNotOptimize(pose);
+            }
+        }
+        GB_BENCHMARK(BM_PoseMath_PoseMultiplyScalar);
+
+        void BM_PoseMath_PoseInverse(GB_BenchmarkState& state) {
+            const PoseMathInputs inputs = MakeInputs(2);
+            uint32_t i = 0;
+            for (auto _ : state) {
+                XrPosef pose = PoseInverse(inputs.poses[i++ % batch_size]);
+                DoNotOptimize(pose);
+            }
+        }
+        GB_BENCHMARK(BM_PoseMath_PoseInverse);
+
+        void BM_PoseMath_PoseInverseScalar(GB_BenchmarkState& state) {
+            const PoseMathInputs inputs = MakeInputs(2);
+            uint32_t i = 0;
+            for (auto _ : state) {
+                XrPosef pose = PoseInverseScalar(inputs.poses[i++ % batch_size]);
+                DoNotOptimize(pose);
+            }
+        }
+        GB_BENCHMARK(BM_PoseMath_PoseInverseScalar);
+
+        void BM_PoseMath_QuatSlerp(GB_BenchmarkState& state) {
+            const PoseMathInputs inputs = MakeInputs(3);
+            uint32_t i = 0;
+            for (auto _ : state) {
+                const uint32_t index = i++ % batch_size;
+                XrQuaternionf q = QuatSlerp(inputs.poses[index].orientation, inputs.targets[index], inputs.factors[index]);
+                DoNotOptimize(q);
+            }
+        }
+        GB_BENCHMARK(BM_PoseMath_QuatSlerp);
+
+        void BM_PoseMath_QuatSlerpScalar(GB_BenchmarkState& state) {
+            const PoseMathInputs inputs = MakeInputs(3);
+            uint32_t i = 0;
+            for (auto _ : state) {
+                const uint32_t index = i++ % batch_size;
+                XrQuaternionf q = QuatSlerpScalar(inputs.poses[index].orientation, inputs.targets[index], inputs.factors[index]);
+                DoNotOptimize(q);
+            }
+        }
+        GB_BENCHMARK(BM_PoseMath_QuatSlerpScalar);
+
+        // A whole set of poses moved into another space, like the action spaces of a session
+        void BM_PoseMath_PoseMultiplyBatch(GB_BenchmarkState& state) {
+            const PoseMathInputs inputs = MakeInputs(4);
+            std::array<XrPosef, batch_size> poses;
+            for (auto _ : state) {
+                PoseMultiplyBatch(inputs.poses[0], inputs.poses.data(), poses.data(), batch_size);
+                DoNotOptimize(poses);
+            }
+        }
+        GB_BENCHMARK(BM_PoseMath_PoseMultiplyBatch);
+
+        void BM_PoseMath_PoseMultiplyBatchScalar(GB_BenchmarkState& state) {
+            const PoseMathInputs inputs = MakeInputs(4);
+            std::array<XrPosef, batch_size> poses;
+            for (auto _ : state) {
+                PoseMultiplyBatchScalar(inputs.poses[0], inputs.poses.data(), poses.data(), batch_size);
+                DoNotOptimize(poses);
+            }
+        }
+        GB_BENCHMARK(BM_PoseMath_PoseMultiplyBatchScalar);
+    }
+}
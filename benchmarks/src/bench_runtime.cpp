@@ -0,0 +1,63 @@
+#include <windows.h>
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_loader_negotiation.h>
+
+#include "benchmark.h"
+
+// xrGetInstanceProcAddr of the runtime DLL itself, resolved the way the loader does it
+namespace XRGameBridge {
+    namespace {
+        PFN_xrGetInstanceProcAddr LoadRuntime() {
+            static const PFN_xrGetInstanceProcAddr get_instance_proc_addr = []() -> PFN_xrGetInstanceProcAddr {
+                HMODULE runtime = LoadLibraryA(GB_BENCHMARK_RUNTIME_PATH);
+                if (runtime == nullptr) {
+                    return nullptr;
+                }
+                auto negotiate = reinterpret_cast<PFN_xrNegotiateLoaderRuntimeInterface>(GetProcAddress(runtime, "xrNegotiateLoaderRuntimeInterface"));
+                if (negotiate == nullptr) {
+                    return nullptr;
+                }
+
+                XrNegotiateLoaderInfo loader_info{ XR_LOADER_INTERFACE_STRUCT_LOADER_INFO, XR_LOADER_INFO_STRUCT_VERSION, sizeof(XrNegotiateLoaderInfo) };
+                loader_info.minInterfaceVersion = 1;
+                loader_info.maxInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+                loader_info.minApiVersion = XR_MAKE_VERSION(1, 0, 0);
+                loader_info.maxApiVersion = XR_CURRENT_API_VERSION;
+
+                XrNegotiateRuntimeRequest runtime_request{ XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST, XR_RUNTIME_INFO_STRUCT_VERSION, sizeof(XrNegotiateRuntimeRequest) };
+                if (XR_FAILED(negotiate(&loader_info, &runtime_request))) {
+                    return nullptr;
+                }
+                return runtime_request.getInstanceProcAddr;
+            }();
+            return get_instance_proc_addr;
+        }
+
+        void GetInstanceProcAddr(GB_BenchmarkState& state, const char* name) {
+            PFN_xrGetInstanceProcAddr get_instance_proc_addr = LoadRuntime();
+            if (get_instance_proc_addr == nullptr) {
+                state.SkipWithError("Can't load " GB_BENCHMARK_RUNTIME_PATH);
+                return;
+            }
+
+            PFN_xrVoidFunction function = nullptr;
+            for (auto _ : state) {
+                XrResult result = get_instance_proc_addr(XR_NULL_HANDLE, name, &function);
+                DoNotOptimize(result);
+                DoNotOptimize(function);
+            }
+        }
+
+        void BM_GetInstanceProcAddr_Core(GB_BenchmarkState& state) {
+            GetInstanceProcAddr(state, "xrLocateViews");
+        }
+        GB_BENCHMARK(BM_GetInstanceProcAddr_Core);
+
+        // Extension functions engines probe for but the runtime doesn't implement
+        void BM_GetInstanceProcAddr_Unsupported(GB_BenchmarkState& state) {
+            GetInstanceProcAddr(state, "xrGetVulkanGraphicsDeviceKHR");
+        }
+        GB_BENCHMARK(BM_GetInstanceProcAddr_Unsupported);
+    }
+}
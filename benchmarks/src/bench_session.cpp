@@ -0,0 +1,35 @@
+#include "bench_session.h"
+
+#include "spaces.h"
+
+namespace XRGameBridge {
+    namespace {
+        XrSpace CreateReferenceSpace(XrSession session, XrReferenceSpaceType type, const XrPosef& pose = { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } }) {
+            XrSpace space = g_reference_spaces.Create(GB_ReferenceSpace{ session, XR_NULL_HANDLE, type, pose });
+            g_reference_spaces.Get(space)->handle = space;
+            return space;
+        }
+    }
+
+    GB_HandleTable<XrSession, GB_BenchmarkSession>& GetBenchmarkSessions() {
+        static GB_HandleTable<XrSession, GB_BenchmarkSession> sessions{ HANDLE_TYPE_SESSION };
+        return sessions;
+    }
+
+    XrSession GetBenchmarkSession() {
+        static const XrSession session = [] {
+            XrSession handle = GetBenchmarkSessions().Create();
+            GB_BenchmarkSession& session = *GetBenchmarkSessions().Get(handle);
+
+            GB_SyntheticPoseSource::Fill(session.pose_history, g_benchmark_start_time, g_benchmark_sample_interval, GB_PoseHistory::capacity);
+            // A 15.6" screen
+            session.view_solver.SetScreenSize({ 0.344f, 0.194f });
+
+            session.local_space = CreateReferenceSpace(handle, XR_REFERENCE_SPACE_TYPE_LOCAL);
+            session.offset_local_space = CreateReferenceSpace(handle, XR_REFERENCE_SPACE_TYPE_LOCAL, { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, -0.3f, -1.0f } });
+            session.view_space = CreateReferenceSpace(handle, XR_REFERENCE_SPACE_TYPE_VIEW);
+            return handle;
+        }();
+        return session;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include "eye_predictor.h"
+#include "handle_table.h"
+#include "pose_history.h"
+#include "space_graph.h"
+#include "view_solver.h"
+
+namespace XRGameBridge {
+    // The tracking part of GB_Session, fed with synthetic eye samples instead of the eye tracker
+    struct GB_BenchmarkSession {
+        GB_PoseHistory pose_history;
+        GB_EyePredictor eye_predictor{ pose_history };
+        GB_SpaceGraph space_graph{ eye_predictor };
+        GB_ViewSolver view_solver{ eye_predictor, space_graph };
+
+        XrSpace local_space = XR_NULL_HANDLE;
+        // Local space with an offset, like the play area an engine places in front of the screen
+        XrSpace offset_local_space = XR_NULL_HANDLE;
+        XrSpace view_space = XR_NULL_HANDLE;
+    };
+
+    // Display times inside the synthetic samples
+    constexpr XrTime g_benchmark_start_time = 1'000'000'000;
+    constexpr XrDuration g_benchmark_sample_interval = 1'000'000'000 / 90;
+
+    // Created on first use with a full pose history and a space of every supported reference space type
+    XrSession GetBenchmarkSession();
+    GB_HandleTable<XrSession, GB_BenchmarkSession>& GetBenchmarkSessions();
+}
@@ -0,0 +1,170 @@
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "bench_session.h"
+#include "locate.h"
+#include "spaces.h"
+
+// xrLocateSpace and xrLocateViews on the benchmark session: session lookup, then the space graph or the view solver
+namespace XRGameBridge {
+    namespace {
+        // Display times of consecutive frames inside the pose history, wraps so it never runs past the samples
+        XrTime GetFrameTime(uint64_t frame) {
+            return g_benchmark_start_time + 64 * g_benchmark_sample_interval + XrTime(frame % 128) * g_benchmark_sample_interval;
+        }
+
+        // Two spaces fixed to the display, nothing to predict
+        void BM_LocateSpace_OffsetLocalInLocal(GB_BenchmarkState& state) {
+            GB_BenchmarkSession& session = *GetBenchmarkSessions().Get(GetBenchmarkSession());
+            XrSpaceLocation location{ XR_TYPE_SPACE_LOCATION };
+            uint64_t frame = 0;
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = LocateSpace(GetBenchmarkSessions(), session.offset_local_space, session.local_space, GetFrameTime(frame++), &location);
+                DoNotOptimize(result);
+                DoNotOptimize(location);
+            }
+            if (result != XR_SUCCESS) {
+                state.SkipWithError("xrLocateSpace failed");
+            }
+        }
+        GB_BENCHMARK(BM_LocateSpace_OffsetLocalInLocal);
+
+        // Every call of a frame after the first is served from the cache
+        void BM_LocateSpace_ViewInLocal_SameFrame(GB_BenchmarkState& state) {
+            GB_BenchmarkSession& session = *GetBenchmarkSessions().Get(GetBenchmarkSession());
+            XrSpaceLocation location{ XR_TYPE_SPACE_LOCATION };
+            const XrTime time = GetFrameTime(0);
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = LocateSpace(GetBenchmarkSessions(), session.view_space, session.local_space, time, &location);
+                DoNotOptimize(result);
+                DoNotOptimize(location);
+            }
+            if (result != XR_SUCCESS) {
+                state.SkipWithError("xrLocateSpace failed");
+            }
+        }
+        GB_BENCHMARK(BM_LocateSpace_ViewInLocal_SameFrame);
+
+        // A new display time every call, runs the eye prediction every time
+        void BM_LocateSpace_ViewInLocal_NewFrame(GB_BenchmarkState& state) {
+            GB_BenchmarkSession& session = *GetBenchmarkSessions().Get(GetBenchmarkSession());
+            XrSpaceLocation location{ XR_TYPE_SPACE_LOCATION };
+            uint64_t frame = 0;
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = LocateSpace(GetBenchmarkSessions(), session.view_space, session.local_space, GetFrameTime(frame++), &location);
+                DoNotOptimize(result);
+                DoNotOptimize(location);
+            }
+            if (result != XR_SUCCESS) {
+                state.SkipWithError("xrLocateSpace failed");
+            }
+        }
+        GB_BENCHMARK(BM_LocateSpace_ViewInLocal_NewFrame);
+
+        // Cache hits while other threads fill the cache with other pairs and frames, like an engine locating from its game and render threads.
+        // Every hit has to be exactly the location a single thread computes, a torn cache entry would show up as a different pose.
+        void BM_LocateSpace_ConcurrentThreads(GB_BenchmarkState& state) {
+            GB_BenchmarkSession& session = *GetBenchmarkSessions().Get(GetBenchmarkSession());
+            const XrTime time = GetFrameTime(0);
+            XrSpaceLocation expected{ XR_TYPE_SPACE_LOCATION };
+            if (LocateSpace(GetBenchmarkSessions(), session.view_space, session.local_space, time, &expected) != XR_SUCCESS) {
+                state.SkipWithError("xrLocateSpace failed");
+                return;
+            }
+
+            std::atomic<bool> running = true;
+            std::vector<std::thread> threads;
+            for (uint32_t t = 0; t < 3; t++) {
+                threads.emplace_back([&, t]() {
+                    const XrSpace pairs[][2]{ { session.view_space, session.local_space }, { session.local_space, session.view_space }, { session.offset_local_space, session.view_space } };
+                    XrSpaceLocation location{ XR_TYPE_SPACE_LOCATION };
+                    uint64_t frame = t;
+                    while (running.load(std::memory_order_relaxed)) {
+                        const XrSpace* pair = pairs[frame % 3];
+                        LocateSpace(GetBenchmarkSessions(), pair[0], pair[1], GetFrameTime(frame), &location);
+                        frame += 7;
+                    }
+                });
+            }
+
+            bool valid = true;
+            XrSpaceLocation location{ XR_TYPE_SPACE_LOCATION };
+            for (auto _ : state) {
+                const XrResult result = LocateSpace(GetBenchmarkSessions(), session.view_space, session.local_space, time, &location);
+                valid = valid && result == XR_SUCCESS && location.locationFlags == expected.locationFlags && memcmp(&location.pose, &expected.pose, sizeof(XrPosef)) == 0;
+                DoNotOptimize(location);
+            }
+
+            running.store(false);
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            if (!valid) {
+                state.SkipWithError("A concurrent locate returned a different location");
+            }
+        }
+        GB_BENCHMARK(BM_LocateSpace_ConcurrentThreads);
+
+        // A base space of another session has to be rejected before anything is composed
+        void BM_LocateSpace_OtherSession(GB_BenchmarkState& state) {
+            GB_BenchmarkSession& session = *GetBenchmarkSessions().Get(GetBenchmarkSession());
+            static const XrSpace other_space = g_reference_spaces.Create(GB_ReferenceSpace{ reinterpret_cast<XrSession>(uint64_t(1)), XR_NULL_HANDLE, XR_REFERENCE_SPACE_TYPE_LOCAL, { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } } });
+
+            XrSpaceLocation location{ XR_TYPE_SPACE_LOCATION };
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = LocateSpace(GetBenchmarkSessions(), session.view_space, other_space, GetFrameTime(0), &location);
+                DoNotOptimize(result);
+            }
+            if (result != XR_ERROR_VALIDATION_FAILURE) {
+                state.SkipWithError("A base space of another session was located");
+            }
+        }
+        GB_BENCHMARK(BM_LocateSpace_OtherSession);
+
+        // Engines locate the views more than once per frame, UEVR does so from several threads
+        void BM_LocateViews_SameFrame(GB_BenchmarkState& state) {
+            const XrSession session = GetBenchmarkSession();
+            XrViewLocateInfo locate_info{ XR_TYPE_VIEW_LOCATE_INFO, nullptr, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, GetFrameTime(0), GetBenchmarkSessions().Get(session)->local_space };
+            XrViewState view_state{ XR_TYPE_VIEW_STATE };
+            XrView views[2]{ { XR_TYPE_VIEW }, { XR_TYPE_VIEW } };
+            uint32_t view_count = 0;
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                result = LocateViews(GetBenchmarkSessions(), session, &locate_info, &view_state, 2, &view_count, views);
+                DoNotOptimize(result);
+                DoNotOptimize(views);
+            }
+            if (result != XR_SUCCESS || view_count != 2) {
+                state.SkipWithError("xrLocateViews failed");
+            }
+        }
+        GB_BENCHMARK(BM_LocateViews_SameFrame);
+
+        void BM_LocateViews_NewFrame(GB_BenchmarkState& state) {
+            const XrSession session = GetBenchmarkSession();
+            XrViewLocateInfo locate_info{ XR_TYPE_VIEW_LOCATE_INFO, nullptr, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, 0, GetBenchmarkSessions().Get(session)->local_space };
+            XrViewState view_state{ XR_TYPE_VIEW_STATE };
+            XrView views[2]{ { XR_TYPE_VIEW }, { XR_TYPE_VIEW } };
+            uint32_t view_count = 0;
+            uint64_t frame = 0;
+            XrResult result = XR_SUCCESS;
+            for (auto _ : state) {
+                locate_info.displayTime = GetFrameTime(frame++);
+                result = LocateViews(GetBenchmarkSessions(), session, &locate_info, &view_state, 2, &view_count, views);
+                DoNotOptimize(result);
+                DoNotOptimize(views);
+            }
+            if (result != XR_SUCCESS || view_count != 2) {
+                state.SkipWithError("xrLocateViews failed");
+            }
+        }
+        GB_BENCHMARK(BM_LocateViews_NewFrame);
+    }
+}
@@ -0,0 +1,263 @@
+#include <array>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "bench_session.h"
+#include "image_ring.h"
+#include "null_backend.h"
+
+// xrAcquireSwapchainImage, xrWaitSwapchainImage and xrReleaseSwapchainImage on the null backend, plus the layer validation of xrEndFrame
+namespace XRGameBridge {
+    namespace {
+        XrSwapchain CreateSwapchain(uint32_t width, uint32_t height, uint32_t array_size) {
+            XrSwapchainCreateInfo create_info{ XR_TYPE_SWAPCHAIN_CREATE_INFO };
+            create_info.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+            create_info.sampleCount = 1;
+            create_info.width = width;
+            create_info.height = height;
+            create_info.faceCount = 1;
+            create_info.arraySize = array_size;
+            create_info.mipCount = 1;
+            return g_null_swapchains.Create(create_info, 3u);
+        }
+
+        // Each call looks the swapchain up like the entry points do
+        XrResult CycleImage(XrSwapchain swapchain) {
+            uint32_t index;
+            auto acquire = g_null_swapchains.Find(swapchain);
+            if (!acquire) {
+                return acquire.error();
+            }
+            XrResult result = acquire->AcquireNextImage(index);
+
+            auto wait = g_null_swapchains.Find(swapchain);
+            if (!wait) {
+                return wait.error();
+            }
+            result = XR_SUCCEEDED(result) ? wait->WaitForImage(XR_INFINITE_DURATION) : result;
+
+            auto release = g_null_swapchains.Find(swapchain);
+            if (!release) {
+                return release.error();
+            }
+            return XR_SUCCEEDED(result) ? release->ReleaseImage() : result;
+        }
+
+        void BM_SwapchainAcquireWaitRelease(GB_BenchmarkState& state) {
+            const XrSwapchain swapchain = CreateSwapchain(64, 64, 1);
+            for (auto _ : state) {
+                XrResult result = CycleImage(swapchain);
+                DoNotOptimize(result);
+            }
+            g_null_swapchains.Destroy(swapchain);
+        }
+        GB_BENCHMARK(BM_SwapchainAcquireWaitRelease);
+
+        // A render thread acquiring and waiting while another thread releases, like engines that submit from a separate thread.
+        // The releasing thread checks that images come back in acquire order, any call failing other than on a full or empty ring is an error.
+        void BM_ImageRing_CrossThreadRelease(GB_BenchmarkState& state) {
+            GB_ImageRing ring(3);
+            std::atomic<bool> running = true;
+            std::atomic<bool> failed = false;
+            std::atomic<uint64_t> released = 0;
+
+            std::thread release_thread([&]() {
+                uint64_t count = 0;
+                while (running.load(std::memory_order_relaxed)) {
+                    uint32_t index;
+                    if (ring.Release(index) != XR_SUCCESS) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    if (index != count % ring.GetImageCount()) {
+                        failed.store(true);
+                    }
+                    released.store(++count, std::memory_order_relaxed);
+                }
+            });
+
+            uint64_t acquired = 0;
+            for (auto _ : state) {
+                uint32_t index;
+                while (ring.Acquire(index) != XR_SUCCESS) {
+                    std::this_thread::yield();
+                }
+                if (index != acquired % ring.GetImageCount()) {
+                    failed.store(true);
+                }
+                acquired++;
+                // The previous image has to be released before the next one can be waited on
+                uint32_t waited;
+                while (ring.BeginWait(waited) != XR_SUCCESS) {
+                    std::this_thread::yield();
+                }
+                ring.EndWait(waited, true);
+            }
+
+            // Everything that was waited on gets released
+            while (released.load(std::memory_order_relaxed) < acquired) {
+                std::this_thread::yield();
+            }
+            running.store(false);
+            release_thread.join();
+
+            if (failed.load() || ring.GetAcquiredCount() != 0) {
+                state.SkipWithError("Images out of order");
+            }
+        }
+        GB_BENCHMARK(BM_ImageRing_CrossThreadRelease);
+
+        // Threads calling acquire, wait and release in any order, with waits timing out, like an application that doesn't synchronize them.
+        // Calls out of order fail, the ones that succeed have to keep the ring consistent.
+        class ImageRingStress {
+            GB_ImageRing& ring;
+            std::atomic<bool> failed = false;
+            std::atomic<uint64_t> acquires = 0;
+            std::atomic<uint64_t> releases = 0;
+            std::array<std::atomic<uint64_t>, GB_ImageRing::max_images> image_acquires{};
+
+            // Only touched between a successful BeginWait and its EndWait, which the ring allows one thread at a time
+            std::atomic<uint32_t> waits_in_progress = 0;
+            uint64_t completed_waits = 0;
+
+        public:
+            explicit ImageRingStress(GB_ImageRing& ring) : ring(ring) {
+            }
+
+            void Acquire() {
+                uint32_t index;
+                if (ring.Acquire(index) != XR_SUCCESS) {
+                    return;
+                }
+                if (index >= ring.GetImageCount()) {
+                    failed.store(true);
+                    return;
+                }
+                image_acquires[index].fetch_add(1, std::memory_order_relaxed);
+                acquires.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Only one image can be waited on at a time and images are waited on in ring order.
+            // A release of the wrong image would show up here, as the next wait getting an image out of order.
+            void Wait(bool ready) {
+                uint32_t index;
+                if (ring.BeginWait(index) != XR_SUCCESS) {
+                    return;
+                }
+                if (waits_in_progress.fetch_add(1, std::memory_order_acq_rel) != 0 || index != completed_waits % ring.GetImageCount()) {
+                    failed.store(true);
+                }
+                if (ready) {
+                    completed_waits++;
+                }
+                waits_in_progress.fetch_sub(1, std::memory_order_acq_rel);
+                ring.EndWait(index, ready);
+            }
+
+            void Release() {
+                uint32_t index;
+                if (ring.Release(index) != XR_SUCCESS) {
+                    return;
+                }
+                if (index >= ring.GetImageCount() || ring.GetReleasedIndex() >= ring.GetImageCount()) {
+                    failed.store(true);
+                }
+                releases.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void RandomCall(std::minstd_rand& random) {
+                switch (random() % 4) {
+                case 0: Acquire(); break;
+                case 1: Wait(true); break;
+                case 2: Wait(false); break;
+                default: Release(); break;
+                }
+            }
+
+            // No calls may be in progress. Images went round robin, so their acquire counts differ by one at most.
+            bool Check() const {
+                uint64_t least = UINT64_MAX;
+                uint64_t most = 0;
+                for (uint32_t i = 0; i < ring.GetImageCount(); i++) {
+                    least = std::min(least, image_acquires[i].load());
+                    most = std::max(most, image_acquires[i].load());
+                }
+                return !failed.load() && most - least <= 1 && acquires.load() - releases.load() == ring.GetAcquiredCount() && ring.GetAcquiredCount() <= ring.GetImageCount();
+            }
+        };
+
+        void BM_ImageRing_ConcurrentMixedCalls(GB_BenchmarkState& state) {
+            GB_ImageRing ring(3);
+            ImageRingStress stress(ring);
+            std::atomic<bool> running = true;
+
+            std::vector<std::thread> threads;
+            for (uint32_t t = 1; t <= 3; t++) {
+                threads.emplace_back([&, t]() {
+                    std::minstd_rand random(t);
+                    while (running.load(std::memory_order_relaxed)) {
+                        stress.RandomCall(random);
+                    }
+                });
+            }
+
+            std::minstd_rand random(0);
+            for (auto _ : state) {
+                stress.RandomCall(random);
+            }
+            running.store(false);
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+
+            if (!stress.Check()) {
+                state.SkipWithError("Image ring invariant broken");
+            }
+        }
+        GB_BENCHMARK(BM_ImageRing_ConcurrentMixedCalls);
+
+        // A stereo projection layer from one array swapchain and a quad layer, the usual UEVR submission
+        void BM_EndFrame_NullCompositor(GB_BenchmarkState& state) {
+            const XrSpace local_space = GetBenchmarkSessions().Get(GetBenchmarkSession())->local_space;
+            const XrSwapchain eyes = CreateSwapchain(64, 64, 2);
+            const XrSwapchain overlay = CreateSwapchain(32, 32, 1);
+            CycleImage(eyes);
+            CycleImage(overlay);
+
+            std::array<XrCompositionLayerProjectionView, 2> views{};
+            for (uint32_t i = 0; i < views.size(); i++) {
+                views[i] = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
+                views[i].subImage = { eyes, { { 0, 0 }, { 64, 64 } }, i };
+            }
+            XrCompositionLayerProjection projection{ XR_TYPE_COMPOSITION_LAYER_PROJECTION };
+            projection.space = local_space;
+            projection.viewCount = static_cast<uint32_t>(views.size());
+            projection.views = views.data();
+
+            XrCompositionLayerQuad quad{ XR_TYPE_COMPOSITION_LAYER_QUAD };
+            quad.space = local_space;
+            quad.subImage = { overlay, { { 0, 0 }, { 32, 32 } }, 0 };
+
+            const std::array<const XrCompositionLayerBaseHeader*, 2> layers{ reinterpret_cast<const XrCompositionLayerBaseHeader*>(&projection), reinterpret_cast<const XrCompositionLayerBaseHeader*>(&quad) };
+            XrFrameEndInfo frame_end_info{ XR_TYPE_FRAME_END_INFO };
+            frame_end_info.layerCount = static_cast<uint32_t>(layers.size());
+            frame_end_info.layers = layers.data();
+
+            GB_NullCompositor compositor;
+            for (auto _ : state) {
+                XrResult result = compositor.ComposeFrame(&frame_end_info);
+                DoNotOptimize(result);
+            }
+            if (compositor.GetStats().frames != state.GetIterations()) {
+                state.SkipWithError("Frames were rejected");
+            }
+
+            g_null_swapchains.Destroy(eyes);
+            g_null_swapchains.Destroy(overlay);
+        }
+        GB_BENCHMARK(BM_EndFrame_NullCompositor);
+    }
+}
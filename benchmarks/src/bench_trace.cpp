@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "frame_timer.h"
+#include "pose_history.h"
+#include "trace.h"
+
+// Trace recording while the session closes the trace underneath the frame functions, and frame by frame replay of a recorded trace
+namespace XRGameBridge {
+    namespace {
+        std::string GetTracePath(const char* name) {
+            return (std::filesystem::temp_directory_path() / name).string();
+        }
+
+        // A record that shows whether it was torn or written after the mapping went away
+        struct CheckedPayload {
+            uint64_t value;
+            uint64_t inverse;
+        };
+
+        // Checks every record of a closed trace, returns how many there were or -1 for a broken one
+        int64_t CountCheckedRecords(const std::string& path) {
+            GB_TraceReader reader;
+            if (!reader.Open(path)) {
+                return -1;
+            }
+            int64_t count = 0;
+            GB_TraceRecord record;
+            while (reader.Next(record)) {
+                CheckedPayload payload;
+                if (record.type != TRACE_RECORD_API_CALL || !GB_TraceReader::GetPayload(record, payload) || payload.inverse != ~payload.value) {
+                    return -1;
+                }
+                count++;
+            }
+            return count;
+        }
+
+        // Three threads write records like xrWaitFrame, xrBeginFrame and xrEndFrame while the measured thread writes too and closes and
+        // reopens the trace every few thousand records, like xrEndSession and the next xrBeginSession.
+        // All the traces together have to hold exactly the records whose write succeeded, every one of them intact.
+        void BM_TraceWriter_CloseWhileWriting(GB_BenchmarkState& state) {
+            constexpr uint64_t records_per_trace = 4096;
+            constexpr uint64_t capacity = 1024 * 1024;
+            const std::string path = GetTracePath("gb_bench_trace_close.gbtrace");
+
+            GB_TraceWriter writer;
+            if (!writer.Open(path, capacity)) {
+                state.SkipWithError("Can't create " + path);
+                return;
+            }
+
+            std::atomic<bool> running = true;
+            std::atomic<int64_t> written = 0;
+            std::vector<std::thread> threads;
+            for (uint64_t t = 1; t <= 3; t++) {
+                threads.emplace_back([&, t]() {
+                    for (uint64_t value = t << 48; running.load(std::memory_order_relaxed); value++) {
+                        const CheckedPayload payload{ value, ~value };
+                        if (writer.Write(TRACE_RECORD_API_CALL, 0, &payload, sizeof(payload))) {
+                            written.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                });
+            }
+
+            bool valid = true;
+            int64_t records_read = 0;
+            auto close_and_count = [&]() {
+                // Writes counted before the close are in this trace or an earlier one
+                const int64_t written_before = written.load();
+                writer.Close();
+                const int64_t count = CountCheckedRecords(path);
+                records_read += count;
+                valid = valid && count >= 0 && records_read >= written_before;
+            };
+
+            uint64_t value = 0;
+            for (auto _ : state) {
+                const CheckedPayload payload{ value, ~value };
+                if (writer.Write(TRACE_RECORD_API_CALL, 0, &payload, sizeof(payload))) {
+                    written.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                if (++value % records_per_trace == 0) {
+                    close_and_count();
+                    valid = writer.Open(path, capacity) && valid;
+                }
+            }
+
+            running.store(false);
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            close_and_count();
+            std::filesystem::remove(path);
+
+            // Every write is counted by now, none may be missing and none may have been torn
+            if (!valid || records_read != written.load()) {
+                state.SkipWithError("A closed trace lost or tore records");
+            }
+        }
+        GB_BENCHMARK(BM_TraceWriter_CloseWhileWriting);
+
+        // A recorded session of 60 Hz frames: 90 Hz eye samples on the synthetic path, jittered vblanks and an xrWaitFrame halfway
+        // through every frame that holds the vblank the frame was really shown on
+        struct RecordedSession {
+            static constexpr int64_t phase = 3'000'000;
+            static constexpr int64_t period = 16'683'333;
+            static constexpr int64_t eye_interval = 1'000'000'000 / 90;
+            static constexpr uint64_t frames = 2048;
+        };
+
+        bool RecordSession(const std::string& path) {
+            GB_TraceWriter writer;
+            if (!writer.Open(path, 4 * 1024 * 1024)) {
+                return false;
+            }
+
+            std::mt19937 random(11);
+            std::normal_distribution<double> jitter(0.0, 300'000.0);
+            int64_t eye_time = 0;
+            auto write_eye_samples = [&](int64_t until) {
+                for (; eye_time < until; eye_time += RecordedSession::eye_interval) {
+                    writer.WriteEyeSample(GB_SyntheticPoseSource::Generate(eye_time));
+                }
+            };
+
+            for (uint64_t frame = 0; frame < RecordedSession::frames; frame++) {
+                const int64_t vblank = RecordedSession::phase + int64_t(frame) * RecordedSession::period;
+                write_eye_samples(vblank);
+                writer.WriteVblank(vblank + std::llround(jitter(random)));
+
+                const int64_t wait_time = vblank + RecordedSession::period / 2;
+                write_eye_samples(wait_time);
+                const GB_TraceFrameTiming timing{ frame, vblank + RecordedSession::period, RecordedSession::period, 0, 0 };
+                writer.WriteFrame(TRACE_RECORD_WAIT_FRAME, wait_time, timing);
+            }
+            const bool complete = writer.GetDroppedRecords() == 0;
+            writer.Close();
+            return complete;
+        }
+
+        // Steps through a recorded session one xrWaitFrame at a time, like a regression run without the display. The replayed vblanks
+        // drive the frame timer and the replayed eye samples the pose history, both are checked against what the trace recorded:
+        // the next vblank within 5% of a period and the eye center at the predicted display time within 2 mm of the path.
+        void BM_TraceReplay_WaitFrames(GB_BenchmarkState& state) {
+            constexpr uint64_t warmup = 32;
+            const std::string path = GetTracePath("gb_bench_trace_replay.gbtrace");
+            if (!RecordSession(path)) {
+                state.SkipWithError("Can't record " + path);
+                return;
+            }
+
+            GB_TraceReader reader;
+            if (!reader.Open(path)) {
+                state.SkipWithError("Can't open " + path);
+                return;
+            }
+
+            // Every pass over the trace starts from an empty history and frame timer
+            std::unique_ptr<GB_TraceReplay> replay;
+            std::unique_ptr<GB_PoseHistory> history;
+            std::unique_ptr<GB_FrameTimer> frame_timer;
+            auto restart = [&]() {
+                reader.Rewind();
+                replay = std::make_unique<GB_TraceReplay>(reader);
+                history = std::make_unique<GB_PoseHistory>();
+                frame_timer = std::make_unique<GB_FrameTimer>(replay->GetClock(), 60.0);
+            };
+            restart();
+
+            bool valid = true;
+            int64_t vblank_error = 0;
+            float eye_error = 0.0f;
+            for (auto _ : state) {
+                GB_TraceRecord record;
+                if (!replay->AdvanceToNext(TRACE_RECORD_WAIT_FRAME, record, history.get(), frame_timer.get())) {
+                    restart();
+                    valid = replay->AdvanceToNext(TRACE_RECORD_WAIT_FRAME, record, history.get(), frame_timer.get()) && valid;
+                }
+
+                GB_TraceFrameTiming timing;
+                valid = GB_TraceReader::GetPayload(record, timing) && valid;
+                const GB_FramePrediction prediction = frame_timer->PredictFrame();
+                GB_PoseSample sample;
+                valid = history->Sample(prediction.display_time, sample) && valid;
+
+                if (timing.frame_index >= warmup) {
+                    const int64_t next_vblank = frame_timer->GetNextVblank(replay->GetClock().Now());
+                    vblank_error = std::max(vblank_error, std::abs(next_vblank - timing.display_time));
+
+                    const XrVector3f center = GetEyeCenter(sample);
+                    const XrVector3f expected = GetEyeCenter(GB_SyntheticPoseSource::Generate(prediction.display_time));
+                    eye_error = std::max(eye_error, std::sqrt((center.x - expected.x) * (center.x - expected.x) + (center.y - expected.y) * (center.y - expected.y) + (center.z - expected.z) * (center.z - expected.z)));
+                }
+                DoNotOptimize(prediction);
+            }
+            reader.Close();
+            std::filesystem::remove(path);
+
+            if (!valid) {
+                state.SkipWithError("The replay lost frames or eye samples");
+                return;
+            }
+            char label[96];
+            std::snprintf(label, sizeof(label), "next vblank max error %.1f us, eye max error %.2f mm", vblank_error / 1e3, eye_error * 1e3f);
+            state.SetLabel(label);
+            if (vblank_error > RecordedSession::period / 20 || eye_error > 0.002f) {
+                state.SkipWithError(std::string("Replayed predictions off the recorded session, ") + label);
+            }
+        }
+        GB_BENCHMARK(BM_TraceReplay_WaitFrames);
+    }
+}
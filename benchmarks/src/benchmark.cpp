@@ -0,0 +1,253 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string_view>
+#include <vector>
+
+namespace {
+    std::atomic<uint64_t> g_allocations = 0;
+
+    void* Allocate(std::size_t size) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void* pointer = std::malloc(size != 0 ? size : 1)) {
+            return pointer;
+        }
+        throw std::bad_alloc();
+    }
+
+    void* AllocateAligned(std::size_t size, std::align_val_t alignment) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+        void* pointer = _aligned_malloc(size != 0 ? size : 1, align);
+#else
+        // aligned_alloc wants a multiple of the alignment
+        void* pointer = std::aligned_alloc(align, std::max(align, (size + align - 1) / align * align));
+#endif
+        if (pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void FreeAligned(void* pointer) {
+#ifdef _WIN32
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+
+    uint64_t Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    struct Benchmark {
+        const char* name;
+        XRGameBridge::GB_BenchmarkFunction function;
+    };
+
+    std::vector<Benchmark>& GetBenchmarks() {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    struct Options {
+        std::string_view filter;
+        double min_time = 0.5;
+        std::string_view csv_path;
+        std::string_view label;
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            const std::string_view argument(argv[i]);
+            auto value = [&](std::string_view name, std::string_view& out) {
+                if (argument.substr(0, name.size()) != name) {
+                    return false;
+                }
+                out = argument.substr(name.size());
+                return true;
+            };
+
+            std::string_view min_time;
+            if (value("--filter=", options.filter) || value("--csv=", options.csv_path) || value("--label=", options.label)) {
+                continue;
+            }
+            if (value("--min_time=", min_time)) {
+                options.min_time = std::atof(std::string(min_time).c_str());
+                continue;
+            }
+
+            std::cerr << "Usage: " << argv[0] << " [--filter=<substring>] [--min_time=<seconds>] [--csv=<file> [--label=<commit>]]\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+// Counts every heap allocation of the process, the array and nothrow forms end up here too
+void* operator new(std::size_t size) {
+    return Allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    FreeAligned(pointer);
+}
+
+namespace XRGameBridge {
+    void UseCharPointer(const volatile char*) {
+    }
+
+    GB_BenchmarkState::GB_BenchmarkState(uint64_t iterations) : iterations(iterations) {
+    }
+
+    void GB_BenchmarkState::StartTimer() {
+        paused_time = 0;
+        paused_allocations = 0;
+        start_allocations = g_allocations.load(std::memory_order_relaxed);
+        start_time = Now();
+    }
+
+    void GB_BenchmarkState::StopTimer() {
+        end_time = Now();
+        end_allocations = g_allocations.load(std::memory_order_relaxed);
+    }
+
+    GB_BenchmarkState::Iterator GB_BenchmarkState::begin() {
+        StartTimer();
+        return { this, error.empty() ? iterations : 0 };
+    }
+
+    GB_BenchmarkState::Iterator GB_BenchmarkState::end() {
+        return { this, 0 };
+    }
+
+    void GB_BenchmarkState::PauseTiming() {
+        pause_time = Now();
+        pause_allocations = g_allocations.load(std::memory_order_relaxed);
+    }
+
+    void GB_BenchmarkState::ResumeTiming() {
+        paused_allocations += g_allocations.load(std::memory_order_relaxed) - pause_allocations;
+        paused_time += Now() - pause_time;
+    }
+
+    void GB_BenchmarkState::SkipWithError(std::string message) {
+        error = std::move(message);
+    }
+
+    void GB_BenchmarkState::SetLabel(std::string text) {
+        label = std::move(text);
+    }
+
+    uint64_t GB_BenchmarkState::GetIterations() const {
+        return iterations;
+    }
+
+    uint64_t GB_BenchmarkState::GetElapsed() const {
+        return end_time - start_time - paused_time;
+    }
+
+    uint64_t GB_BenchmarkState::GetAllocations() const {
+        return end_allocations - start_allocations - paused_allocations;
+    }
+
+    const std::string& GB_BenchmarkState::GetError() const {
+        return error;
+    }
+
+    const std::string& GB_BenchmarkState::GetLabel() const {
+        return label;
+    }
+
+    bool RegisterBenchmark(const char* name, GB_BenchmarkFunction function) {
+        GetBenchmarks().push_back({ name, function });
+        return true;
+    }
+
+    int RunBenchmarks(int argc, char** argv) {
+        Options options;
+        if (!ParseOptions(argc, argv, options)) {
+            return 1;
+        }
+
+        std::ofstream csv;
+        if (!options.csv_path.empty()) {
+            const bool exists = std::ifstream(std::string(options.csv_path)).good();
+            csv.open(std::string(options.csv_path), std::ios::app);
+            if (!csv) {
+                std::cerr << "Can't open " << options.csv_path << "\n";
+                return 1;
+            }
+            if (!exists) {
+                csv << "label,benchmark,ns_per_call,allocs_per_call,iterations\n";
+            }
+        }
+
+        std::vector<Benchmark> benchmarks = GetBenchmarks();
+        std::sort(benchmarks.begin(), benchmarks.end(), [](const Benchmark& a, const Benchmark& b) { return std::string_view(a.name) < std::string_view(b.name); });
+
+        std::printf("%-48s %12s %12s %14s\n", "Benchmark", "Time (ns)", "Allocs", "Iterations");
+        std::printf("%s\n", std::string(89, '-').c_str());
+
+        const uint64_t min_time = static_cast<uint64_t>(options.min_time * 1e9);
+        for (const Benchmark& benchmark : benchmarks) {
+            if (std::string_view(benchmark.name).find(options.filter) == std::string_view::npos) {
+                continue;
+            }
+
+            // Grow the iteration count until a run takes long enough to time, the last run is the result
+            uint64_t iterations = 1;
+            while (true) {
+                GB_BenchmarkState state(iterations);
+                benchmark.function(state);
+                if (!state.GetError().empty()) {
+                    std::printf("%-48s SKIPPED: %s\n", benchmark.name, state.GetError().c_str());
+                    break;
+                }
+
+                const uint64_t elapsed = std::max<uint64_t>(state.GetElapsed(), 1);
+                if (elapsed < min_time && iterations < 1'000'000'000) {
+                    // Aim a little past the minimum time, but never grow more than 10x per step
+                    const double scale = std::min(10.0, std::max(1.5, 1.4 * double(min_time) / double(elapsed)));
+                    iterations = static_cast<uint64_t>(double(iterations) * scale) + 1;
+                    continue;
+                }
+
+                const double ns_per_call = double(elapsed) / double(iterations);
+                const double allocs_per_call = double(state.GetAllocations()) / double(iterations);
+                std::printf("%-48s %12.1f %12.2f %14llu%s%s\n", benchmark.name, ns_per_call, allocs_per_call, static_cast<unsigned long long>(iterations),
+                    state.GetLabel().empty() ? "" : "  ", state.GetLabel().c_str());
+                if (csv) {
+                    csv << options.label << "," << benchmark.name << "," << ns_per_call << "," << allocs_per_call << "," << iterations << "\n";
+                }
+                break;
+            }
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace XRGameBridge {
+    // Small benchmark harness in the style of Google Benchmark, without the dependency.
+    //
+    //     void BM_Something(GB_BenchmarkState& state) {
+    //         // Setup
+    //         for (auto _ : state) {
+    //             // Measured
+    //         }
+    //     }
+    //     GB_BENCHMARK(BM_Something);
+    //
+    // Every benchmark reports the time and the heap allocations per iteration.
+    class GB_BenchmarkState {
+        uint64_t iterations;
+        uint64_t start_time = 0;
+        uint64_t end_time = 0;
+        uint64_t start_allocations = 0;
+        uint64_t end_allocations = 0;
+        uint64_t pause_time = 0;
+        uint64_t pause_allocations = 0;
+        uint64_t paused_time = 0;
+        uint64_t paused_allocations = 0;
+        std::string error;
+        std::string label;
+
+        void StartTimer();
+        void StopTimer();
+
+    public:
+        explicit GB_BenchmarkState(uint64_t iterations);
+
+        struct Iterator {
+            GB_BenchmarkState* state;
+            uint64_t remaining;
+
+            bool operator!=(const Iterator&) const {
+                if (remaining != 0) {
+                    return true;
+                }
+                state->StopTimer();
+                return false;
+            }
+
+            void operator++() {
+                remaining--;
+            }
+
+            // The loop variable is never used, a class type keeps compilers from warning about it
+            struct Value {
+                ~Value() {
+                }
+            };
+
+            Value operator*() const {
+                return {};
+            }
+        };
+
+        Iterator begin();
+        Iterator end();
+
+        // Leaves work inside the loop out of the time and the allocations, like draining a queue the measured code fills
+        void PauseTiming();
+        void ResumeTiming();
+
+        // Stops the benchmark without a result, for setups that can't run on this machine
+        void SkipWithError(std::string message);
+        // Printed next to the result, for what the time per iteration doesn't show
+        void SetLabel(std::string text);
+
+        uint64_t GetIterations() const;
+        uint64_t GetElapsed() const;
+        uint64_t GetAllocations() const;
+        const std::string& GetError() const;
+        const std::string& GetLabel() const;
+    };
+
+    using GB_BenchmarkFunction = void(*)(GB_BenchmarkState& state);
+
+    bool RegisterBenchmark(const char* name, GB_BenchmarkFunction function);
+    int RunBenchmarks(int argc, char** argv);
+
+    // Defined out of line so the compiler can't see that it does nothing
+    void UseCharPointer(const volatile char* pointer);
+
+    // Keeps the compiler from optimizing away a result
+    template <typename T>
+    inline void DoNotOptimize(const T& value) {
+#if defined(_MSC_VER)
+        UseCharPointer(&reinterpret_cast<const volatile char&>(value));
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    inline void ClobberMemory() {
+#if defined(_MSC_VER)
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : : "memory");
+#endif
+    }
+}
+
+#define GB_BENCHMARK(function) static const bool function##_registered = XRGameBridge::RegisterBenchmark(#function, function)
@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <easylogging++.h>
+
+#include "eye_predictor.h"
+#include "logging.h"
+#include "trace.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+// Replays the eye samples of a recorded trace through every prediction filter and prints the prediction error per latency,
+// to pick the filter and its parameters for a tracker without running the runtime.
+namespace XRGameBridge {
+    namespace {
+        struct Options {
+            std::string trace_path;
+            double tracker_latency_ms = 0.0;
+            double max_latency_ms = 100.0;
+            double step_ms = 10.0;
+        };
+
+        struct Filter {
+            GB_PredictionFilterType type;
+            const char* name;
+        };
+
+        constexpr Filter filters[] = {
+            { PREDICTION_FILTER_NONE, "None" },
+            { PREDICTION_FILTER_ONE_EURO, "One Euro" },
+            { PREDICTION_FILTER_KALMAN, "Kalman" },
+        };
+
+        bool ParseOptions(int argc, char** argv, Options& options) {
+            for (int i = 1; i < argc; i++) {
+                const std::string_view argument(argv[i]);
+                auto value = [&](std::string_view name, double& out) {
+                    if (argument.substr(0, name.size()) != name) {
+                        return false;
+                    }
+                    out = std::atof(argv[i] + name.size());
+                    return true;
+                };
+
+                if (value("--tracker_latency_ms=", options.tracker_latency_ms) || value("--max_latency_ms=", options.max_latency_ms) || value("--step_ms=", options.step_ms)) {
+                    continue;
+                }
+                if (argument.substr(0, 2) != "--" && options.trace_path.empty()) {
+                    options.trace_path = argument;
+                    continue;
+                }
+                options.trace_path.clear();
+                break;
+            }
+
+            if (options.trace_path.empty() || options.step_ms <= 0.0) {
+                std::fprintf(stderr, "Usage: %s <trace> [--tracker_latency_ms=<ms>] [--max_latency_ms=<ms>] [--step_ms=<ms>]\n", argv[0]);
+                return false;
+            }
+            return true;
+        }
+
+        std::vector<GB_PoseSample> LoadEyeSamples(GB_TraceReader& reader) {
+            std::vector<GB_PoseSample> samples;
+            GB_TraceRecord record;
+            while (reader.Next(record)) {
+                GB_PoseSample sample;
+                if (record.type == TRACE_RECORD_EYE_SAMPLE && GB_TraceReader::GetPayload(record, sample)) {
+                    samples.push_back(sample);
+                }
+            }
+            return samples;
+        }
+
+        XrDuration ToDuration(double milliseconds) {
+            return static_cast<XrDuration>(milliseconds * 1e6);
+        }
+
+        int Run(const Options& options) {
+            GB_TraceReader reader;
+            if (!reader.Open(options.trace_path)) {
+                std::fprintf(stderr, "Can't open %s\n", options.trace_path.c_str());
+                return 1;
+            }
+            const std::vector<GB_PoseSample> samples = LoadEyeSamples(reader);
+            if (samples.size() < 2) {
+                std::fprintf(stderr, "%s has no eye samples to predict\n", options.trace_path.c_str());
+                return 1;
+            }
+
+            std::printf("%zu eye samples over %.1f s, tracker latency %.1f ms. Errors in mm, mean / rms / max.\n", samples.size(),
+                (samples.back().time - samples.front().time) / 1e9, options.tracker_latency_ms);
+            std::printf("%-14s", "Latency (ms)");
+            for (const Filter& filter : filters) {
+                std::printf(" %24s", filter.name);
+            }
+            std::printf("\n%s\n", std::string(14 + 25 * std::size(filters), '-').c_str());
+
+            for (double latency_ms = 0.0; latency_ms <= options.max_latency_ms + 1e-9; latency_ms += options.step_ms) {
+                std::printf("%-14.1f", latency_ms);
+                for (const Filter& filter : filters) {
+                    GB_PredictionParameters parameters;
+                    parameters.filter = filter.type;
+                    parameters.tracker_latency = ToDuration(options.tracker_latency_ms);
+
+                    const GB_PredictionError error = GB_EyePredictor::Evaluate(samples.data(), static_cast<uint32_t>(samples.size()), parameters, ToDuration(latency_ms));
+                    if (error.predictions == 0) {
+                        std::printf(" %24s", "-");
+                        continue;
+                    }
+                    std::printf(" %6.2f / %6.2f / %6.2f", error.mean * 1e3f, error.rms * 1e3f, error.max * 1e3f);
+                }
+                std::printf("\n");
+            }
+            return 0;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToStandardOutput, "false");
+
+    XRGameBridge::Options options;
+    const int result = XRGameBridge::ParseOptions(argc, argv, options) ? XRGameBridge::Run(options) : 1;
+    XRGameBridge::ShutdownLog();
+    return result;
+}
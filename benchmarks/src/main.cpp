@@ -0,0 +1,17 @@
+#include <easylogging++.h>
+
+#include "benchmark.h"
+#include "logging.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+int main(int argc, char** argv) {
+    // Whatever the runtime logs while being measured shouldn't end up between the results
+    el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToStandardOutput, "false");
+    // The logging benchmarks write millions of lines
+    el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToFile, "false");
+
+    const int result = XRGameBridge::RunBenchmarks(argc, argv);
+    XRGameBridge::ShutdownLog();
+    return result;
+}
@@ -10,15 +10,16 @@ struct temp
     int is_opaque;
     int multiply_alpha;
     float convert_to_linear;
+    uint array_index;
 };
 
-Texture2D g_texture : register(t0);
+Texture2DArray g_texture : register(t0);
 SamplerState g_sampler : register(s0);
 ConstantBuffer<temp> settings : register(b0, space0);
 
 float4 main(PSInput input) : SV_TARGET
 {
-    float4 layer_color = g_texture.Sample(g_sampler, input.uv.xy);
+    float4 layer_color = g_texture.Sample(g_sampler, float3(input.uv.xy, settings.array_index));
     layer_color.a = 0.5f;
 
     // Determine whether we need gamma correction
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include "action_table.h"
+#include "handle_table.h"
+#include "logging.h"
+
+namespace XRGameBridge {
+    // The bodies of xrSyncActions and the xrGetActionState* functions on a table of sessions.
+    // The entry points pass g_sessions, the benchmarks a table of sessions without graphics.
+    template <typename Session>
+    XrResult SyncActions(const GB_HandleTable<XrSession, Session>& sessions, XrSession session, const XrActionsSyncInfo* sync_info) {
+        auto session_lookup = sessions.Find(session);
+        if (!session_lookup) {
+            return session_lookup.error();
+        }
+
+        XrResult result = ValidateActiveActionSets(session, sync_info);
+        if (result != XR_SUCCESS) {
+            return result;
+        }
+
+        GB_LOG(Trace, "Called {}", "xrSyncActions");
+        return XR_SUCCESS;
+    }
+
+    // Validation shared by the xrGetActionState* functions
+    template <typename Session>
+    XrResult ValidateActionStateGetInfo(const GB_HandleTable<XrSession, Session>& sessions, XrSession session, const XrActionStateGetInfo* get_info, XrActionType action_type) {
+        auto session_lookup = sessions.Find(session);
+        if (!session_lookup) {
+            return session_lookup.error();
+        }
+
+        return ValidateActionState(session, get_info->action, action_type);
+    }
+
+    template <typename Session>
+    XrResult GetActionStateBoolean(const GB_HandleTable<XrSession, Session>& sessions, XrSession session, const XrActionStateGetInfo* get_info, XrActionStateBoolean* state) {
+        XrResult result = ValidateActionStateGetInfo(sessions, session, get_info, XR_ACTION_TYPE_BOOLEAN_INPUT);
+        if (result != XR_SUCCESS) {
+            return result;
+        }
+
+        state->isActive = false;
+        state->currentState = false;
+        state->changedSinceLastSync = false;
+        state->lastChangeTime = 0;
+        GB_LOG(Trace, "Called {}", "xrGetActionStateBoolean");
+        return XR_SUCCESS;
+    }
+
+    template <typename Session>
+    XrResult GetActionStateFloat(const GB_HandleTable<XrSession, Session>& sessions, XrSession session, const XrActionStateGetInfo* get_info, XrActionStateFloat* state) {
+        XrResult result = ValidateActionStateGetInfo(sessions, session, get_info, XR_ACTION_TYPE_FLOAT_INPUT);
+        if (result != XR_SUCCESS) {
+            return result;
+        }
+
+        state->isActive = false;
+        state->currentState = 0.f;
+        state->changedSinceLastSync = false;
+        state->lastChangeTime = 0;
+
+        GB_LOG(Trace, "Called {}", "xrGetActionStateFloat");
+        return XR_SUCCESS;
+    }
+
+    template <typename Session>
+    XrResult GetActionStateVector2f(const GB_HandleTable<XrSession, Session>& sessions, XrSession session, const XrActionStateGetInfo* get_info, XrActionStateVector2f* state) {
+        XrResult result = ValidateActionStateGetInfo(sessions, session, get_info, XR_ACTION_TYPE_VECTOR2F_INPUT);
+        if (result != XR_SUCCESS) {
+            return result;
+        }
+
+        state->isActive = false;
+        state->currentState = {0.f};
+        state->changedSinceLastSync = false;
+        state->lastChangeTime = 0;
+
+        GB_LOG(Trace, "Called {}", "xrGetActionStateVector2f");
+        return XR_SUCCESS;
+    }
+
+    template <typename Session>
+    XrResult GetActionStatePose(const GB_HandleTable<XrSession, Session>& sessions, XrSession session, const XrActionStateGetInfo* get_info, XrActionStatePose* state) {
+        XrResult result = ValidateActionStateGetInfo(sessions, session, get_info, XR_ACTION_TYPE_POSE_INPUT);
+        if (result != XR_SUCCESS) {
+            return result;
+        }
+
+        state->isActive = false;
+
+        GB_LOG(Trace, "Called {}", "xrGetActionStatePose");
+        return XR_SUCCESS;
+    }
+}
@@ -0,0 +1,34 @@
+#include "action_table.h"
+
+namespace XRGameBridge {
+    XrResult ValidateActiveActionSets(XrSession session, const XrActionsSyncInfo* sync_info) {
+        for (uint32_t i = 0; i < sync_info->countActiveActionSets; i++) {
+            auto gb_action_set = g_action_sets.Find(sync_info->activeActionSets[i].actionSet);
+            if (!gb_action_set) {
+                return gb_action_set.error();
+            }
+            // Check if it is attached to the passed session parameter
+            if (gb_action_set->session != session) {
+                return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+            }
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult ValidateActionState(XrSession session, XrAction action, XrActionType action_type) {
+        auto action_lookup = g_actions.Find(action);
+        if (!action_lookup) {
+            return action_lookup.error();
+        }
+        if (action_lookup->type != action_type) {
+            return XR_ERROR_ACTION_TYPE_MISMATCH;
+        }
+
+        auto action_set_lookup = g_action_sets.Find(action_lookup->action_set);
+        if (!action_set_lookup || action_set_lookup->session != session) {
+            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+        }
+
+        return XR_SUCCESS;
+    }
+}
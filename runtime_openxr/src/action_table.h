@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <openxr/openxr.h>
+
+#include "handle_table.h"
+
+namespace XRGameBridge {
+    struct GB_ActionSet {
+        XrInstance instance;
+        XrSession session = XR_NULL_HANDLE;
+        uint32_t priority;
+        std::string name;
+        std::string localized_name;
+    };
+
+    struct GB_Action {
+        // TODO list of action sets so multiple action sets can register the same action? Not sure if the specification wants that.
+        XrActionSet action_set;
+        XrActionType type;
+        std::vector<XrPath> sub_action_paths;
+        std::string name;
+        std::string localized_name;
+    };
+
+    // OpenXR makes a distinction between active and inactive action sets, only active ones have to be updated.
+    // Since we don't plan on handling VR actions I left this distinction out, but it might be good to have later.
+    inline GB_HandleTable<XrActionSet, GB_ActionSet> g_action_sets{ HANDLE_TYPE_ACTION_SET };
+    inline GB_HandleTable<XrAction, GB_Action> g_actions{ HANDLE_TYPE_ACTION };
+
+    // Every active action set has to exist and be attached to the session
+    XrResult ValidateActiveActionSets(XrSession session, const XrActionsSyncInfo* sync_info);
+    // The action has to exist, be of the requested type and belong to an action set attached to the session
+    XrResult ValidateActionState(XrSession session, XrAction action, XrActionType action_type);
+}
@@ -0,0 +1,179 @@
+#include "api_capture.h"
+
+#include <functional>
+#include <thread>
+
+namespace XRGameBridge {
+    namespace {
+        uint32_t AlignArgumentSize(uint32_t size) {
+            return (size + 7u) & ~7u;
+        }
+    }
+
+    GB_TraceApiArgument* GB_ApiCallBuilder::Reserve(GB_TraceArgumentKind kind, uint32_t data_size) {
+        const uint32_t argument_size = AlignArgumentSize(sizeof(GB_TraceApiArgument) + data_size);
+        if (size + argument_size > capacity) {
+            truncated = true;
+            return nullptr;
+        }
+
+        GB_TraceApiArgument* argument = reinterpret_cast<GB_TraceApiArgument*>(data.data() + size);
+        *argument = { kind, 0, 0, 0, 0 };
+        size += argument_size;
+        argument_count++;
+        return argument;
+    }
+
+    void GB_ApiCallBuilder::AppendValue(GB_TraceArgumentKind kind, uint64_t value) {
+        GB_TraceApiArgument* argument = Reserve(kind, sizeof(value));
+        if (argument == nullptr) {
+            return;
+        }
+        argument->element_size = sizeof(value);
+        argument->element_count = 1;
+        memcpy(argument + 1, &value, sizeof(value));
+    }
+
+    void GB_ApiCallBuilder::AppendString(const char* string, uint32_t max_length) {
+        const uint32_t length = string != nullptr ? static_cast<uint32_t>(strnlen(string, max_length)) : 0;
+        GB_TraceApiArgument* argument = Reserve(TRACE_ARGUMENT_STRING, length);
+        if (argument == nullptr) {
+            return;
+        }
+        argument->element_size = 1;
+        argument->element_count = length;
+        if (length > 0) {
+            memcpy(argument + 1, string, length);
+        }
+    }
+
+    GB_TraceApiArgument* GB_ApiCallBuilder::AppendArray(const void* elements, uint32_t element_size, uint32_t element_count) {
+        // Keep whole elements of arrays that don't fit
+        const uint32_t available = capacity - std::min(capacity, size + static_cast<uint32_t>(sizeof(GB_TraceApiArgument)));
+        const uint32_t count = std::min(element_count, available / element_size);
+        truncated |= count < element_count;
+
+        GB_TraceApiArgument* argument = Reserve(TRACE_ARGUMENT_ARRAY, element_size * count);
+        if (argument == nullptr) {
+            return nullptr;
+        }
+        argument->element_size = element_size;
+        argument->element_count = count;
+        if (count > 0) {
+            memcpy(argument + 1, elements, element_size * count);
+        }
+        return argument;
+    }
+
+    void GB_ApiCallBuilder::AppendChain(GB_TraceApiArgument* argument, const void* next) {
+        std::array<XrStructureType, max_chain_length> types;
+        uint32_t length = 0;
+        for (auto* structure = static_cast<const XrBaseInStructure*>(next); structure != nullptr && length < max_chain_length; structure = structure->next) {
+            types[length++] = structure->type;
+        }
+        // The types are written as extra data and then reclassified, the chain comes before any other extra data
+        AppendExtra(argument, types.data(), length * sizeof(XrStructureType));
+        if (argument->extra_size > 0) {
+            argument->chain_length = static_cast<uint16_t>(length);
+            argument->extra_size = 0;
+        }
+    }
+
+    void GB_ApiCallBuilder::AppendExtra(GB_TraceApiArgument* argument, const void* extra, uint32_t extra_size) {
+        // Only the last argument can grow
+        uint8_t* argument_data = reinterpret_cast<uint8_t*>(argument + 1);
+        const uint32_t used = argument->element_size * argument->element_count + argument->chain_length * sizeof(XrStructureType) + argument->extra_size;
+        const uint32_t begin = static_cast<uint32_t>(argument_data - data.data());
+        const uint32_t new_size = AlignArgumentSize(begin + used + extra_size);
+        if (extra_size == 0 || new_size > capacity) {
+            truncated |= extra_size > 0;
+            return;
+        }
+
+        memcpy(argument_data + used, extra, extra_size);
+        argument->extra_size += extra_size;
+        size = new_size;
+    }
+
+    void GB_ApiCallBuilder::AppendStructExtra(GB_TraceApiArgument* argument, const XrFrameEndInfo& info) {
+        for (uint32_t i = 0; i < info.layerCount; i++) {
+            const XrCompositionLayerBaseHeader* layer = info.layers[i];
+            GB_TraceApiLayer header{ layer->type, 0, 0, 0 };
+            if (layer->type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+                const auto* projection = reinterpret_cast<const XrCompositionLayerProjection*>(layer);
+                header.size = sizeof(XrCompositionLayerProjection);
+                header.view_count = projection->viewCount;
+                AppendExtra(argument, &header, sizeof(header));
+                AppendExtra(argument, projection, sizeof(XrCompositionLayerProjection));
+                AppendExtra(argument, projection->views, projection->viewCount * sizeof(XrCompositionLayerProjectionView));
+            }
+            else if (layer->type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
+                header.size = sizeof(XrCompositionLayerQuad);
+                AppendExtra(argument, &header, sizeof(header));
+                AppendExtra(argument, layer, sizeof(XrCompositionLayerQuad));
+            }
+            else {
+                AppendExtra(argument, &header, sizeof(header));
+            }
+        }
+    }
+
+    void GB_ApiCallBuilder::AppendStructExtra(GB_TraceApiArgument* argument, const XrActionsSyncInfo& info) {
+        AppendExtra(argument, info.activeActionSets, info.countActiveActionSets * sizeof(XrActiveActionSet));
+    }
+
+    void GB_ApiCallBuilder::AppendStructExtra(GB_TraceApiArgument* argument, const XrSessionActionSetsAttachInfo& info) {
+        AppendExtra(argument, info.actionSets, info.countActionSets * sizeof(XrActionSet));
+    }
+
+    void GB_ApiCallBuilder::AppendStructExtra(GB_TraceApiArgument* argument, const XrInteractionProfileSuggestedBinding& info) {
+        AppendExtra(argument, info.suggestedBindings, info.countSuggestedBindings * sizeof(XrActionSuggestedBinding));
+    }
+
+    void GB_ApiCallBuilder::AppendStructExtra(GB_TraceApiArgument* argument, const XrActionCreateInfo& info) {
+        AppendExtra(argument, info.subactionPaths, info.countSubactionPaths * sizeof(XrPath));
+    }
+
+    uint32_t GB_ApiCallBuilder::Finish(uint16_t function, XrResult result, XrTime end_time) {
+        GB_TraceApiCall call{ function, argument_count, result, end_time, GetCaptureThreadId(), truncated ? g_trace_api_call_truncated : uint16_t(0), 0 };
+        memcpy(data.data(), &call, sizeof(call));
+        return size;
+    }
+
+    const uint8_t* GB_ApiCallBuilder::GetData() const {
+        return data.data();
+    }
+
+    bool GB_ApiCapture::Open(const std::string& path, const std::string_view* function_names, uint32_t function_count, uint64_t capacity) {
+        if (!writer.Open(path, capacity)) {
+            return false;
+        }
+        clock.SetEpoch(std::chrono::high_resolution_clock::now());
+
+        for (uint32_t i = 0; i < function_count; i++) {
+            const GB_TraceApiFunction function{ static_cast<uint16_t>(i), static_cast<uint16_t>(function_names[i].size()), 0 };
+            writer.Write(TRACE_RECORD_API_FUNCTION, 0, &function, sizeof(function), function_names[i].data(), function.name_length);
+        }
+
+        enabled.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void GB_ApiCapture::Close() {
+        enabled.store(false, std::memory_order_release);
+        writer.Close();
+    }
+
+    void GB_ApiCapture::Write(XrTime start, const GB_ApiCallBuilder& builder, uint32_t size) {
+        writer.Write(TRACE_RECORD_API_CALL, start, builder.GetData(), size);
+    }
+
+    uint64_t GB_ApiCapture::GetDroppedCalls() const {
+        return writer.GetDroppedRecords();
+    }
+
+    uint32_t GetCaptureThreadId() {
+        thread_local const uint32_t id = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        return id;
+    }
+}
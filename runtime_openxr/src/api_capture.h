@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <openxr/openxr.h>
+
+#include "frame_timer.h"
+#include "trace.h"
+
+namespace XRGameBridge {
+    // Capture of every OpenXR call the runtime receives, for replaying an application session offline.
+    // Calls are written to a trace (trace.h). The capture starts with a TRACE_RECORD_API_FUNCTION record per function
+    // in the function table, followed by a TRACE_RECORD_API_CALL record per call. The record time is the time the call was made.
+    //
+    // Arguments are captured after the call so outputs hold what the runtime returned. Capture is shallow with a few exceptions:
+    // pointers to structs copy the struct and the structure types of its next chain, arrays are only followed when the
+    // two call idiom gives their length and struct members that point to arrays the runtime reads are appended as extra data.
+    enum GB_TraceArgumentKind : uint16_t {
+        // 8 bytes, integers, enums, atoms and floats
+        TRACE_ARGUMENT_VALUE,
+        // 8 bytes, a handle passed to the call
+        TRACE_ARGUMENT_HANDLE,
+        // 8 bytes, a handle the call created, 0 if it failed
+        TRACE_ARGUMENT_HANDLE_OUTPUT,
+        // Characters without terminator
+        TRACE_ARGUMENT_STRING,
+        // element_count elements of element_size bytes, then chain_length structure types of the first element's next chain, then extra_size bytes
+        TRACE_ARGUMENT_ARRAY,
+        // 8 bytes, address of something that isn't captured
+        TRACE_ARGUMENT_POINTER,
+    };
+
+    constexpr uint16_t g_trace_api_call_truncated = 1;
+
+    // Stride of the image structs of xrEnumerateSwapchainImages, the base header in the signature doesn't tell.
+    // Every graphics API's image struct is the header followed by one handle, openxr_functions.h checks the ones the runtime implements.
+    constexpr uint32_t g_trace_swapchain_image_size = sizeof(XrSwapchainImageBaseHeader) + sizeof(uint64_t);
+
+    struct GB_TraceApiFunction {
+        uint16_t function;
+        uint16_t name_length;
+        uint32_t reserved;
+    };
+
+    // Followed by argument_count GB_TraceApiArgument, each followed by its data
+    struct GB_TraceApiCall {
+        uint16_t function;
+        uint16_t argument_count;
+        XrResult result;
+        XrTime end_time;
+        uint32_t thread;
+        uint16_t flags;
+        uint16_t reserved;
+    };
+
+    struct GB_TraceApiArgument {
+        GB_TraceArgumentKind kind;
+        uint16_t chain_length;
+        uint32_t element_size;
+        uint32_t element_count;
+        uint32_t extra_size;
+    };
+
+    // Extra data of XrFrameEndInfo, one per layer followed by the layer struct and view_count projection views
+    struct GB_TraceApiLayer {
+        XrStructureType type;
+        uint32_t size;
+        uint32_t view_count;
+        uint32_t reserved;
+    };
+
+    template <typename T>
+    constexpr bool IsHandle = std::is_same_v<T, XrInstance> || std::is_same_v<T, XrSession> || std::is_same_v<T, XrSpace> ||
+        std::is_same_v<T, XrSwapchain> || std::is_same_v<T, XrActionSet> || std::is_same_v<T, XrAction>;
+
+    // Serializes the arguments of one call, on the stack of the calling thread
+    class GB_ApiCallBuilder {
+    public:
+        static constexpr uint32_t capacity = 8192;
+        static constexpr uint32_t max_chain_length = 8;
+        static constexpr uint32_t max_string_length = 256;
+
+    private:
+        alignas(8) std::array<uint8_t, capacity> data;
+        uint32_t size = sizeof(GB_TraceApiCall);
+        uint16_t argument_count = 0;
+        bool truncated = false;
+
+        // Two call idiom, a capacity followed by a count output gives the length of the array after them
+        uint32_t last_capacity = 0;
+        uint32_t array_length = 1;
+
+        uint32_t TakeArrayLength() {
+            const uint32_t length = array_length;
+            array_length = 1;
+            return length;
+        }
+
+        GB_TraceApiArgument* Reserve(GB_TraceArgumentKind kind, uint32_t data_size);
+        void AppendValue(GB_TraceArgumentKind kind, uint64_t value);
+        void AppendString(const char* string, uint32_t max_length);
+        GB_TraceApiArgument* AppendArray(const void* elements, uint32_t element_size, uint32_t element_count);
+        void AppendChain(GB_TraceApiArgument* argument, const void* next);
+        void AppendExtra(GB_TraceApiArgument* argument, const void* extra, uint32_t extra_size);
+
+        // Struct members that point to arrays the runtime reads
+        void AppendStructExtra(GB_TraceApiArgument* argument, const XrFrameEndInfo& info);
+        void AppendStructExtra(GB_TraceApiArgument* argument, const XrActionsSyncInfo& info);
+        void AppendStructExtra(GB_TraceApiArgument* argument, const XrSessionActionSetsAttachInfo& info);
+        void AppendStructExtra(GB_TraceApiArgument* argument, const XrInteractionProfileSuggestedBinding& info);
+        void AppendStructExtra(GB_TraceApiArgument* argument, const XrActionCreateInfo& info);
+        template <typename T>
+        void AppendStructExtra(GB_TraceApiArgument*, const T&) {
+        }
+
+    public:
+        template <typename T>
+        void Append(T argument) {
+            if constexpr (IsHandle<T>) {
+                AppendValue(TRACE_ARGUMENT_HANDLE, reinterpret_cast<uint64_t>(argument));
+            }
+            else if constexpr (std::is_same_v<T, const char*>) {
+                AppendString(argument, max_string_length);
+            }
+            else if constexpr (std::is_pointer_v<T>) {
+                using Pointee = std::remove_cv_t<std::remove_pointer_t<T>>;
+                if constexpr (IsHandle<Pointee>) {
+                    AppendValue(TRACE_ARGUMENT_HANDLE_OUTPUT, argument != nullptr ? reinterpret_cast<uint64_t>(*argument) : 0);
+                }
+                else if constexpr (std::is_same_v<Pointee, uint32_t> && !std::is_const_v<std::remove_pointer_t<T>>) {
+                    AppendArray(argument, sizeof(uint32_t), argument != nullptr ? 1 : 0);
+                    array_length = argument != nullptr ? std::min(last_capacity, *argument) : 0;
+                }
+                else if constexpr (std::is_same_v<Pointee, char>) {
+                    // Output buffer, only valid up to the returned length
+                    AppendString(argument, std::min(TakeArrayLength(), max_string_length));
+                }
+                else if constexpr (std::is_same_v<Pointee, XrSwapchainImageBaseHeader>) {
+                    const uint32_t length = TakeArrayLength();
+                    AppendArray(argument, g_trace_swapchain_image_size, argument != nullptr ? length : 0);
+                }
+                else if constexpr (std::is_class_v<Pointee> || std::is_arithmetic_v<Pointee> || std::is_enum_v<Pointee>) {
+                    const uint32_t length = TakeArrayLength();
+                    GB_TraceApiArgument* captured = AppendArray(argument, sizeof(Pointee), argument != nullptr ? length : 0);
+                    if constexpr (requires(const Pointee& value) { value.next; }) {
+                        if (captured != nullptr && argument != nullptr && length > 0) {
+                            AppendChain(captured, argument->next);
+                            AppendStructExtra(captured, *argument);
+                        }
+                    }
+                }
+                else {
+                    AppendValue(TRACE_ARGUMENT_POINTER, reinterpret_cast<uint64_t>(argument));
+                }
+            }
+            else {
+                uint64_t bits = 0;
+                static_assert(sizeof(T) <= sizeof(bits));
+                memcpy(&bits, &argument, sizeof(T));
+                if constexpr (std::is_same_v<T, uint32_t>) {
+                    last_capacity = argument;
+                }
+                AppendValue(TRACE_ARGUMENT_VALUE, bits);
+            }
+        }
+
+        // Fills in the call header, returns the record payload size
+        uint32_t Finish(uint16_t function, XrResult result, XrTime end_time);
+        const uint8_t* GetData() const;
+    };
+
+    // XR_GAME_BRIDGE_API_CAPTURE=<file> opens it before the loader resolves the first function.
+    // Every call costs two clock reads, the serialization and one atomic add while capturing, nothing otherwise.
+    class GB_ApiCapture {
+        GB_TraceWriter writer;
+        GB_SessionClock clock;
+        std::atomic<bool> enabled = false;
+
+    public:
+        static constexpr uint64_t default_capacity = 512ull * 1024 * 1024;
+
+        bool Open(const std::string& path, const std::string_view* function_names, uint32_t function_count, uint64_t capacity = default_capacity);
+        // No calls may be in progress
+        void Close();
+
+        bool IsEnabled() const {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        XrTime Now() const {
+            return clock.Now();
+        }
+
+        void Write(XrTime start, const GB_ApiCallBuilder& builder, uint32_t size);
+        uint64_t GetDroppedCalls() const;
+    } inline g_api_capture;
+
+    uint32_t GetCaptureThreadId();
+
+    // Wraps a runtime function, forwards the call and records it
+    template <auto Function>
+    struct GB_CaptureThunk;
+
+    template <typename... Args, XrResult(XRAPI_PTR* Function)(Args...)>
+    struct GB_CaptureThunk<Function> {
+        // Index of the function in the function table, set when the thunk is resolved
+        static inline std::atomic<uint16_t> function = 0;
+
+        static XrResult XRAPI_CALL Call(Args... args) {
+            const XrTime start = g_api_capture.Now();
+            const XrResult result = Function(args...);
+            const XrTime end = g_api_capture.Now();
+
+            GB_ApiCallBuilder builder;
+            (builder.Append(args), ...);
+            g_api_capture.Write(start, builder, builder.Finish(function.load(std::memory_order_relaxed), result, end));
+            return result;
+        }
+    };
+}
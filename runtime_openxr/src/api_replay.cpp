@@ -0,0 +1,357 @@
+#include "api_replay.h"
+
+#include <format>
+#include <thread>
+
+#include "openxr_functions.h"
+
+namespace XRGameBridge {
+    namespace {
+        template <typename T>
+        T* CopyExtra(GB_ApiReplayContext& context, const GB_ApiArgumentView& argument, uint32_t offset, uint32_t count) {
+            if (count == 0 || offset + count * sizeof(T) > argument.header.extra_size) {
+                return nullptr;
+            }
+            T* elements = static_cast<T*>(context.Allocate(count * sizeof(T)));
+            memcpy(static_cast<void*>(elements), argument.extra + offset, count * sizeof(T));
+            return elements;
+        }
+
+        template <typename Handle>
+        void RemapHandles(GB_ApiReplayContext& context, Handle* handles, uint32_t count) {
+            for (uint32_t i = 0; handles != nullptr && i < count; i++) {
+                handles[i] = context.Remap(handles[i]);
+            }
+        }
+
+        std::vector<GB_ApiFunctionStats> MakeStats(std::unordered_map<std::string, std::vector<XrDuration>>& durations, const std::unordered_map<std::string, uint64_t>& mismatches) {
+            std::vector<GB_ApiFunctionStats> stats;
+            for (auto& [name, times] : durations) {
+                std::sort(times.begin(), times.end());
+                GB_ApiFunctionStats function;
+                function.name = name;
+                function.calls = times.size();
+                for (XrDuration time : times) {
+                    function.total += time;
+                }
+                function.median = times[times.size() / 2];
+                function.p99 = times[std::min(times.size() - 1, times.size() * 99 / 100)];
+                function.max = times.back();
+                if (auto it = mismatches.find(name); it != mismatches.end()) {
+                    function.mismatches = it->second;
+                }
+                stats.push_back(std::move(function));
+            }
+
+            // Most expensive first
+            std::sort(stats.begin(), stats.end(), [](const GB_ApiFunctionStats& a, const GB_ApiFunctionStats& b) { return a.total > b.total; });
+            return stats;
+        }
+    }
+
+    bool DecodeApiCall(const GB_TraceRecord& record, GB_ApiCallView& call) {
+        if (record.type != TRACE_RECORD_API_CALL || !GB_TraceReader::GetPayload(record, call.call)) {
+            return false;
+        }
+        if (call.call.argument_count > GB_ApiCallView::max_arguments) {
+            return false;
+        }
+        call.time = record.time;
+
+        uint32_t offset = sizeof(GB_TraceApiCall);
+        for (uint32_t i = 0; i < call.call.argument_count; i++) {
+            GB_ApiArgumentView& argument = call.arguments[i];
+            if (!GB_TraceReader::GetPayload(record, argument.header, offset)) {
+                return false;
+            }
+            const uint64_t elements_size = static_cast<uint64_t>(argument.header.element_size) * argument.header.element_count;
+            const uint64_t chain_size = argument.header.chain_length * sizeof(XrStructureType);
+            const uint64_t data_size = elements_size + chain_size + argument.header.extra_size;
+            const uint64_t begin = offset + sizeof(GB_TraceApiArgument);
+            if (begin + data_size > record.payload_size) {
+                return false;
+            }
+
+            argument.elements = record.payload + begin;
+            argument.chain = argument.elements + elements_size;
+            argument.extra = argument.chain + chain_size;
+            offset = static_cast<uint32_t>((begin + data_size + 7) & ~7ull);
+        }
+        return true;
+    }
+
+    GB_ApiReplayContext::GB_ApiReplayContext(const GB_ApiReplayConfig& config) : config(config) {
+    }
+
+    void GB_ApiReplayContext::MapHandle(uint64_t captured, uint64_t replayed) {
+        handles[captured] = replayed;
+    }
+
+    uint64_t GB_ApiReplayContext::RemapHandle(uint64_t captured) const {
+        auto it = handles.find(captured);
+        return it != handles.end() ? it->second : captured;
+    }
+
+    void* GB_ApiReplayContext::Allocate(uint64_t size) {
+        if (storage_used == storage.size()) {
+            storage.emplace_back();
+        }
+        std::vector<uint64_t>& block = storage[storage_used++];
+        block.assign((size + sizeof(uint64_t) - 1) / sizeof(uint64_t) + 1, 0);
+        return block.data();
+    }
+
+    void GB_ApiReplayContext::BeginCall() {
+        storage_used = 0;
+        last_capacity = 0;
+    }
+
+    XrSwapchainImageBaseHeader* DecodeSwapchainImages(GB_ApiReplayContext& context, const GB_ApiArgumentView& argument) {
+        const uint32_t captured_count = argument.header.kind == TRACE_ARGUMENT_ARRAY ? argument.header.element_count : 0;
+        const uint32_t count = std::max(captured_count, std::exchange(context.last_capacity, 0));
+        if (count == 0) {
+            return nullptr;
+        }
+
+        auto* images = static_cast<uint8_t*>(context.Allocate(uint64_t(count) * g_trace_swapchain_image_size));
+        const bool captured = captured_count > 0 && argument.header.element_size == g_trace_swapchain_image_size;
+        for (uint32_t i = 0; i < count; i++) {
+            XrSwapchainImageBaseHeader header{};
+            // The structure type of the slots the application didn't get back is the same as the first
+            if (captured) {
+                memcpy(&header, argument.elements + uint64_t(std::min(i, captured_count - 1)) * g_trace_swapchain_image_size, sizeof(header));
+            }
+            header.next = nullptr;
+            memcpy(images + uint64_t(i) * g_trace_swapchain_image_size, &header, sizeof(header));
+        }
+        return reinterpret_cast<XrSwapchainImageBaseHeader*>(images);
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrInstanceCreateInfo& info, const GB_ApiArgumentView& argument) {
+        info.enabledApiLayerCount = 0;
+        info.enabledApiLayerNames = nullptr;
+        info.enabledExtensionCount = static_cast<uint32_t>(context.config.extensions.size());
+        info.enabledExtensionNames = context.config.extensions.data();
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrSessionCreateInfo& info, const GB_ApiArgumentView& argument) {
+        info.next = context.config.graphics_binding;
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrFrameEndInfo& info, const GB_ApiArgumentView& argument) {
+        auto** layers = static_cast<const XrCompositionLayerBaseHeader**>(context.Allocate(info.layerCount * sizeof(void*)));
+        uint32_t layer_count = 0;
+
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < info.layerCount; i++) {
+            GB_TraceApiLayer header;
+            if (offset + sizeof(header) > argument.header.extra_size) {
+                break;
+            }
+            memcpy(&header, argument.extra + offset, sizeof(header));
+            offset += sizeof(header);
+
+            if (header.type == XR_TYPE_COMPOSITION_LAYER_PROJECTION && header.size == sizeof(XrCompositionLayerProjection)) {
+                auto* projection = CopyExtra<XrCompositionLayerProjection>(context, argument, offset, 1);
+                auto* views = CopyExtra<XrCompositionLayerProjectionView>(context, argument, offset + header.size, header.view_count);
+                if (projection == nullptr || views == nullptr) {
+                    break;
+                }
+                offset += header.size + header.view_count * sizeof(XrCompositionLayerProjectionView);
+
+                projection->next = nullptr;
+                projection->space = context.Remap(projection->space);
+                projection->views = views;
+                for (uint32_t view = 0; view < header.view_count; view++) {
+                    views[view].next = nullptr;
+                    views[view].subImage.swapchain = context.Remap(views[view].subImage.swapchain);
+                }
+                layers[layer_count++] = reinterpret_cast<const XrCompositionLayerBaseHeader*>(projection);
+            }
+            else if (header.type == XR_TYPE_COMPOSITION_LAYER_QUAD && header.size == sizeof(XrCompositionLayerQuad)) {
+                auto* quad = CopyExtra<XrCompositionLayerQuad>(context, argument, offset, 1);
+                if (quad == nullptr) {
+                    break;
+                }
+                offset += header.size;
+
+                quad->next = nullptr;
+                quad->space = context.Remap(quad->space);
+                quad->subImage.swapchain = context.Remap(quad->subImage.swapchain);
+                layers[layer_count++] = reinterpret_cast<const XrCompositionLayerBaseHeader*>(quad);
+            }
+            // Layer types that weren't captured are left out
+        }
+
+        info.layerCount = layer_count;
+        info.layers = layers;
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrActionsSyncInfo& info, const GB_ApiArgumentView& argument) {
+        auto* sets = CopyExtra<XrActiveActionSet>(context, argument, 0, info.countActiveActionSets);
+        for (uint32_t i = 0; sets != nullptr && i < info.countActiveActionSets; i++) {
+            sets[i].actionSet = context.Remap(sets[i].actionSet);
+        }
+        info.countActiveActionSets = sets != nullptr ? info.countActiveActionSets : 0;
+        info.activeActionSets = sets;
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrSessionActionSetsAttachInfo& info, const GB_ApiArgumentView& argument) {
+        auto* sets = CopyExtra<XrActionSet>(context, argument, 0, info.countActionSets);
+        RemapHandles(context, sets, info.countActionSets);
+        info.countActionSets = sets != nullptr ? info.countActionSets : 0;
+        info.actionSets = sets;
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrInteractionProfileSuggestedBinding& info, const GB_ApiArgumentView& argument) {
+        auto* bindings = CopyExtra<XrActionSuggestedBinding>(context, argument, 0, info.countSuggestedBindings);
+        for (uint32_t i = 0; bindings != nullptr && i < info.countSuggestedBindings; i++) {
+            bindings[i].action = context.Remap(bindings[i].action);
+        }
+        info.countSuggestedBindings = bindings != nullptr ? info.countSuggestedBindings : 0;
+        info.suggestedBindings = bindings;
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrActionCreateInfo& info, const GB_ApiArgumentView& argument) {
+        auto* paths = CopyExtra<XrPath>(context, argument, 0, info.countSubactionPaths);
+        info.countSubactionPaths = paths != nullptr ? info.countSubactionPaths : 0;
+        info.subactionPaths = paths;
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrActionSpaceCreateInfo& info, const GB_ApiArgumentView& argument) {
+        info.action = context.Remap(info.action);
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrActionStateGetInfo& info, const GB_ApiArgumentView& argument) {
+        info.action = context.Remap(info.action);
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrHapticActionInfo& info, const GB_ApiArgumentView& argument) {
+        info.action = context.Remap(info.action);
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrBoundSourcesForActionEnumerateInfo& info, const GB_ApiArgumentView& argument) {
+        info.action = context.Remap(info.action);
+    }
+
+    void FixupInput(GB_ApiReplayContext& context, XrViewLocateInfo& info, const GB_ApiArgumentView& argument) {
+        info.space = context.Remap(info.space);
+    }
+
+    bool GB_ApiReplay::Open(const std::string& path) {
+        return reader.Open(path);
+    }
+
+    std::vector<std::string> GB_ApiReplay::ReadFunctionNames() {
+        std::vector<std::string> names;
+        reader.Rewind();
+
+        GB_TraceRecord record;
+        while (reader.Next(record)) {
+            GB_TraceApiFunction function;
+            if (record.type != TRACE_RECORD_API_FUNCTION || !GB_TraceReader::GetPayload(record, function)) {
+                continue;
+            }
+            if (sizeof(function) + function.name_length > record.payload_size) {
+                continue;
+            }
+            if (names.size() <= function.function) {
+                names.resize(function.function + 1);
+            }
+            names[function.function].assign(reinterpret_cast<const char*>(record.payload + sizeof(function)), function.name_length);
+        }
+
+        reader.Rewind();
+        return names;
+    }
+
+    std::vector<GB_ApiFunctionStats> GB_ApiReplay::Run(const GB_ApiReplayConfig& config) {
+        const std::vector<std::string> names = ReadFunctionNames();
+
+        // Resolve once, the replay loop only indexes
+        std::vector<const GB_FunctionEntry*> entries(names.size(), nullptr);
+        for (size_t i = 0; i < names.size(); i++) {
+            entries[i] = FindFunctionEntry(names[i]);
+        }
+
+        GB_ApiReplayContext context(config);
+        std::unordered_map<std::string, std::vector<XrDuration>> durations;
+        std::unordered_map<std::string, uint64_t> mismatches;
+        skipped_calls = 0;
+
+        const auto replay_start = std::chrono::high_resolution_clock::now();
+        XrTime first_call = -1;
+
+        GB_TraceRecord record;
+        GB_ApiCallView call;
+        while (reader.Next(record)) {
+            if (!DecodeApiCall(record, call)) {
+                continue;
+            }
+            const uint16_t function = call.call.function;
+            if (function >= entries.size() || entries[function] == nullptr) {
+                skipped_calls++;
+                continue;
+            }
+
+            if (config.real_time) {
+                first_call = first_call < 0 ? call.time : first_call;
+                std::this_thread::sleep_until(replay_start + std::chrono::nanoseconds(call.time - first_call));
+            }
+
+            XrResult result;
+            XrDuration duration;
+            if (!entries[function]->replay(context, call, result, duration)) {
+                skipped_calls++;
+                continue;
+            }
+
+            durations[names[function]].push_back(duration);
+            if (result != call.call.result) {
+                mismatches[names[function]]++;
+            }
+        }
+
+        return MakeStats(durations, mismatches);
+    }
+
+    std::vector<GB_ApiFunctionStats> GB_ApiReplay::Summarize() {
+        const std::vector<std::string> names = ReadFunctionNames();
+
+        std::unordered_map<std::string, std::vector<XrDuration>> durations;
+        std::unordered_map<std::string, uint64_t> failures;
+
+        GB_TraceRecord record;
+        GB_ApiCallView call;
+        while (reader.Next(record)) {
+            if (!DecodeApiCall(record, call) || call.call.function >= names.size()) {
+                continue;
+            }
+            const std::string& name = names[call.call.function];
+            durations[name].push_back(call.call.end_time - call.time);
+            if (XR_FAILED(call.call.result)) {
+                failures[name]++;
+            }
+        }
+
+        return MakeStats(durations, failures);
+    }
+
+    uint64_t GB_ApiReplay::GetSkippedCalls() const {
+        return skipped_calls;
+    }
+
+    void GB_ApiReplay::Compare(const std::vector<GB_ApiFunctionStats>& baseline, const std::vector<GB_ApiFunctionStats>& current, std::ostream& out) {
+        out << std::format("{:<45} {:>10} {:>12} {:>12} {:>12} {:>12} {:>8}\n", "function", "calls", "base median", "median", "base p99", "p99", "change");
+
+        for (const GB_ApiFunctionStats& function : current) {
+            auto it = std::find_if(baseline.begin(), baseline.end(), [&](const GB_ApiFunctionStats& b) { return b.name == function.name; });
+            if (it == baseline.end()) {
+                out << std::format("{:<45} {:>10} {:>12} {:>12} {:>12} {:>12} {:>8}\n", function.name, function.calls, "-", function.median, "-", function.p99, "new");
+                continue;
+            }
+            const double change = it->median > 0 ? (static_cast<double>(function.median) / static_cast<double>(it->median) - 1.0) * 100.0 : 0.0;
+            out << std::format("{:<45} {:>10} {:>12} {:>12} {:>12} {:>12} {:>+7.1f}%\n", function.name, function.calls, it->median, function.median, it->p99, function.p99, change);
+        }
+    }
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <openxr/openxr.h>
+
+#include "api_capture.h"
+#include "trace.h"
+
+namespace XRGameBridge {
+    struct GB_ApiArgumentView {
+        GB_TraceApiArgument header{};
+        const uint8_t* elements = nullptr;
+        const uint8_t* chain = nullptr;
+        const uint8_t* extra = nullptr;
+
+        uint64_t GetValue() const {
+            uint64_t value = 0;
+            if (header.element_size == sizeof(value) && header.element_count == 1) {
+                memcpy(&value, elements, sizeof(value));
+            }
+            return value;
+        }
+    };
+
+    struct GB_ApiCallView {
+        static constexpr uint32_t max_arguments = 16;
+
+        XrTime time = 0;
+        GB_TraceApiCall call{};
+        std::array<GB_ApiArgumentView, max_arguments> arguments;
+    };
+
+    // False for records that aren't calls or are malformed
+    bool DecodeApiCall(const GB_TraceRecord& record, GB_ApiCallView& call);
+
+    struct GB_ApiReplayConfig {
+        // Enabled on the replay's instance in place of the application's extensions, the graphics extension has to match the binding
+        std::vector<const char*> extensions;
+        // Chained to XrSessionCreateInfo in place of the application's graphics binding
+        const void* graphics_binding = nullptr;
+        // Wait for the captured call times instead of replaying back to back
+        bool real_time = false;
+    };
+
+    // Time spent inside the runtime per entry point
+    struct GB_ApiFunctionStats {
+        std::string name;
+        uint64_t calls = 0;
+        // Captured, calls that failed. Replayed, calls whose result differs from the capture.
+        uint64_t mismatches = 0;
+        XrDuration total = 0;
+        XrDuration median = 0;
+        XrDuration p99 = 0;
+        XrDuration max = 0;
+    };
+
+    // Handles and argument memory of a replay.
+    // Handles are remapped from the values in the capture to the ones the runtime hands out during the replay. Paths and system ids
+    // aren't, the runtime assigns them in call order so the replay gets the same values as long as it replays from the start.
+    class GB_ApiReplayContext {
+        std::unordered_map<uint64_t, uint64_t> handles;
+        // Reused for every call, so a replay stops allocating once the largest call has been seen
+        std::vector<std::vector<uint64_t>> storage;
+        uint32_t storage_used = 0;
+
+    public:
+        const GB_ApiReplayConfig& config;
+        // Capacity of the last two call idiom seen while decoding, output arrays are allocated at that size
+        uint32_t last_capacity = 0;
+
+        explicit GB_ApiReplayContext(const GB_ApiReplayConfig& config);
+
+        void MapHandle(uint64_t captured, uint64_t replayed);
+        // Unknown handles are passed on as captured, the runtime rejects them like it would in the application
+        uint64_t RemapHandle(uint64_t captured) const;
+
+        template <typename Handle>
+        Handle Remap(Handle handle) const {
+            return reinterpret_cast<Handle>(RemapHandle(reinterpret_cast<uint64_t>(handle)));
+        }
+
+        // Zeroed and 8 byte aligned, lives until the next call
+        void* Allocate(uint64_t size);
+        void BeginCall();
+    };
+
+    // Image structs of xrEnumerateSwapchainImages at the captured stride, with room for as many as the capacity says
+    XrSwapchainImageBaseHeader* DecodeSwapchainImages(GB_ApiReplayContext& context, const GB_ApiArgumentView& argument);
+
+    // Captured structs point into the application, these rebuild what the runtime reads and remap the handles in them
+    void FixupInput(GB_ApiReplayContext& context, XrInstanceCreateInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrSessionCreateInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrFrameEndInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrActionsSyncInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrSessionActionSetsAttachInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrInteractionProfileSuggestedBinding& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrActionCreateInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrActionSpaceCreateInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrActionStateGetInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrHapticActionInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrBoundSourcesForActionEnumerateInfo& info, const GB_ApiArgumentView& argument);
+    void FixupInput(GB_ApiReplayContext& context, XrViewLocateInfo& info, const GB_ApiArgumentView& argument);
+    template <typename T>
+    void FixupInput(GB_ApiReplayContext&, T&, const GB_ApiArgumentView&) {
+    }
+
+    template <typename T>
+    T DecodeArgument(GB_ApiReplayContext& context, const GB_ApiArgumentView& argument) {
+        if constexpr (IsHandle<T>) {
+            return context.Remap(reinterpret_cast<T>(argument.GetValue()));
+        }
+        else if constexpr (std::is_same_v<T, const char*>) {
+            char* string = static_cast<char*>(context.Allocate(argument.header.element_count + 1));
+            memcpy(string, argument.elements, argument.header.element_count);
+            return string;
+        }
+        else if constexpr (std::is_same_v<T, XrSwapchainImageBaseHeader*>) {
+            return DecodeSwapchainImages(context, argument);
+        }
+        else if constexpr (std::is_pointer_v<T>) {
+            using Pointee = std::remove_cv_t<std::remove_pointer_t<T>>;
+            using Element = std::conditional_t<std::is_void_v<Pointee>, uint64_t, Pointee>;
+            constexpr uint64_t element_size = sizeof(Element);
+            constexpr bool is_output = !std::is_const_v<std::remove_pointer_t<T>>;
+            constexpr bool is_count = is_output && std::is_same_v<Pointee, uint32_t>;
+
+            if (argument.header.kind == TRACE_ARGUMENT_POINTER || argument.header.kind == TRACE_ARGUMENT_HANDLE_OUTPUT) {
+                // Nothing was captured, outputs get zeroed memory to write to
+                if (argument.header.kind == TRACE_ARGUMENT_POINTER && argument.GetValue() == 0) {
+                    return nullptr;
+                }
+                return static_cast<T>(context.Allocate(element_size));
+            }
+
+            // Output buffers have to hold what the runtime may write, which can be more than the application got back
+            const uint32_t captured_count = argument.header.element_count;
+            const uint32_t count = is_output && !is_count ? std::max(captured_count, std::exchange(context.last_capacity, 0)) : captured_count;
+            if (count == 0) {
+                return nullptr;
+            }
+
+            auto* elements = static_cast<Element*>(context.Allocate(count * element_size));
+            if constexpr (!std::is_void_v<Pointee>) {
+                if (argument.header.element_size == element_size && captured_count > 0) {
+                    memcpy(static_cast<void*>(elements), argument.elements, captured_count * element_size);
+                    // Structure types of the slots the application didn't get back
+                    for (uint32_t i = captured_count; i < count; i++) {
+                        memcpy(static_cast<void*>(&elements[i]), argument.elements, element_size);
+                    }
+                }
+                if constexpr (requires(Pointee & value) { value.next = nullptr; }) {
+                    for (uint32_t i = 0; i < count; i++) {
+                        elements[i].next = nullptr;
+                    }
+                }
+                if constexpr (!is_output) {
+                    FixupInput(context, elements[0], argument);
+                }
+            }
+            return reinterpret_cast<T>(elements);
+        }
+        else {
+            const uint64_t bits = argument.GetValue();
+            T value;
+            memcpy(&value, &bits, sizeof(T));
+            if constexpr (std::is_same_v<T, uint32_t>) {
+                context.last_capacity = value;
+            }
+            return value;
+        }
+    }
+
+    // Handles the call created are remapped from then on
+    template <typename T>
+    void MapOutput(GB_ApiReplayContext& context, T argument, const GB_ApiArgumentView& captured) {
+        if constexpr (std::is_pointer_v<T>) {
+            if constexpr (IsHandle<std::remove_cv_t<std::remove_pointer_t<T>>>) {
+                if (captured.header.kind == TRACE_ARGUMENT_HANDLE_OUTPUT && captured.GetValue() != 0 && argument != nullptr) {
+                    context.MapHandle(captured.GetValue(), reinterpret_cast<uint64_t>(*argument));
+                }
+            }
+        }
+    }
+
+    // Calls a runtime function with the arguments of a captured call, false if the call can't be rebuilt
+    using GB_ReplayFunction = bool(*)(GB_ApiReplayContext& context, const GB_ApiCallView& call, XrResult& result, XrDuration& duration);
+
+    template <auto Function>
+    struct GB_ReplayThunk;
+
+    template <typename... Args, XrResult(XRAPI_PTR* Function)(Args...)>
+    struct GB_ReplayThunk<Function> {
+        template <size_t... Index>
+        static void Invoke(GB_ApiReplayContext& context, const GB_ApiCallView& call, XrResult& result, XrDuration& duration, std::index_sequence<Index...>) {
+            // Braced initialization decodes the arguments in order, the two call idiom depends on it
+            std::tuple<Args...> arguments{ DecodeArgument<Args>(context, call.arguments[Index])... };
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            result = std::apply(Function, arguments);
+            duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            if (XR_SUCCEEDED(result)) {
+                (MapOutput(context, std::get<Index>(arguments), call.arguments[Index]), ...);
+            }
+        }
+
+        static bool Call(GB_ApiReplayContext& context, const GB_ApiCallView& call, XrResult& result, XrDuration& duration) {
+            if (call.call.argument_count != sizeof...(Args) || (call.call.flags & g_trace_api_call_truncated) != 0) {
+                return false;
+            }
+            context.BeginCall();
+            Invoke(context, call, result, duration, std::index_sequence_for<Args...>());
+            return true;
+        }
+    };
+
+    // Drives the runtime with a captured session, on the calling thread in capture order.
+    // Calls the application made from several threads are serialized, their relative order is kept.
+    class GB_ApiReplay {
+        GB_TraceReader reader;
+        uint64_t skipped_calls = 0;
+
+        // Function names by capture index, the function table may differ between the capturing and the replaying build
+        std::vector<std::string> ReadFunctionNames();
+
+    public:
+        bool Open(const std::string& path);
+
+        std::vector<GB_ApiFunctionStats> Run(const GB_ApiReplayConfig& config);
+        // Cost of every entry point as captured, what the application saw
+        std::vector<GB_ApiFunctionStats> Summarize();
+        // Calls of the last run that couldn't be rebuilt
+        uint64_t GetSkippedCalls() const;
+
+        // Per entry point table of two runs, for comparing builds
+        static void Compare(const std::vector<GB_ApiFunctionStats>& baseline, const std::vector<GB_ApiFunctionStats>& current, std::ostream& out);
+    };
+}
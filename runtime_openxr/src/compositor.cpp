@@ -40,7 +40,7 @@ namespace XRGameBridge {
         return buffer;
     }
 
-    void GB_Compositor::Initialize(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue, uint32_t back_buffer_count) {
+    void GB_Compositor::Initialize(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue) {
 
         d3d12_device = device;
         command_queue = queue;
@@ -64,7 +64,7 @@ namespace XRGameBridge {
             CD3DX12_ROOT_PARAMETER1 root_parameters[3];
             root_parameters[0].InitAsDescriptorTable(1, &ranges[0], D3D12_SHADER_VISIBILITY_PIXEL);
             root_parameters[1].InitAsDescriptorTable(1, &ranges[1], D3D12_SHADER_VISIBILITY_PIXEL);
-            root_parameters[2].InitAsConstants(3, 0, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+            root_parameters[2].InitAsConstants(4, 0, 0, D3D12_SHADER_VISIBILITY_PIXEL);
 
 
 
@@ -147,19 +147,6 @@ namespace XRGameBridge {
         samplerDesc.MaxAnisotropy = 1;
         samplerDesc.ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
         device->CreateSampler(&samplerDesc, sampler_heap->GetCPUDescriptorHandleForHeapStart());
-
-        command_allocators.resize(back_buffer_count);
-        command_lists.resize(back_buffer_count);
-        for (uint32_t i = 0; i < back_buffer_count; i++) {
-            // Create present command allocator and command list resources
-            ThrowIfFailed(d3d12_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&command_allocators[i])));
-            // TODO use initial pipeline state here later. First check if it works without.
-            ThrowIfFailed(d3d12_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, command_allocators[i].Get(), pipeline_state.Get(), IID_PPV_ARGS(&command_lists[i])));
-
-            std::wstring name = std::format(L"Compositor Command List {}", i);
-            command_lists[i]->SetName(name.c_str());
-            command_lists[i]->Close();
-        }
     }
 
     void GB_Compositor::ComposeImage(const XrFrameEndInfo* frameEndInfo, ID3D12GraphicsCommandList* cmd_list) {
@@ -170,10 +157,12 @@ namespace XRGameBridge {
             // TODO clear the screen when no layers are present
         }
 
+        composed_image_count = 0;
+
         for (uint32_t layer_num = 0; layer_num < frameEndInfo->layerCount; layer_num++) {
             if (frameEndInfo->layers[layer_num]->type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
                 auto layer = reinterpret_cast<const XrCompositionLayerProjection*>(frameEndInfo->layers[layer_num]);
-                auto& ref_space = g_reference_spaces[layer->space]; // pose in spaces of the view over time
+                GB_ReferenceSpace* ref_space = g_reference_spaces.Get(layer->space); // pose in spaces of the view over time
 
                 // Render every view to the resource
                 for (int32_t view_num = 0; view_num < layer->viewCount; view_num++) {
@@ -182,8 +171,26 @@ namespace XRGameBridge {
                     // TODO do something with rectangles
                     auto& rect = view.subImage.imageRect;
 
-                    auto& gb_swapchain = g_proxy_swapchains[view.subImage.swapchain];
-                    auto proxy_resource = gb_swapchain.GetBuffers()[view.subImage.imageArrayIndex];
+                    GB_ProxySwapchain* gb_swapchain_ptr = g_proxy_swapchains.Get(view.subImage.swapchain);
+                    if (gb_swapchain_ptr == nullptr) {
+                        continue;
+                    }
+                    auto& gb_swapchain = *gb_swapchain_ptr;
+                    // The application may have acquired the next images already, the released one holds the frame
+                    const uint32_t image_index = gb_swapchain.GetReleasedIndex();
+                    if (image_index == UINT32_MAX) {
+                        continue;
+                    }
+                    auto proxy_resource = gb_swapchain.GetBuffers()[image_index];
+                    // One array swapchain can hold both eyes, every view reads its own slice
+                    const uint32_t array_index = view.subImage.imageArrayIndex;
+                    if (array_index >= gb_swapchain.GetArraySize()) {
+                        continue;
+                    }
+                    // The image has to stay unavailable to the application until the frame that reads it completed
+                    if (!AddComposedImage(gb_swapchain_ptr, image_index)) {
+                        continue;
+                    }
 
                     // Viewport settings
                     const float width = static_cast<float>(rect.extent.width);
@@ -194,8 +201,21 @@ namespace XRGameBridge {
                     cmd_list->RSSetScissorRects(1, &scissor_rect);
 
                     // TODO Maybe transition all buffers at once, maybe with split barriers, so we transition barriers at the same time?
-                    // Transition proxy swapchain resource to pixel shader resource
-                    TransitionImage(cmd_list, proxy_resource.Get(),gb_swapchain.resource_usage, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+                    if (gb_swapchain.IsMultisampled()) {
+                        // Views sharing a slice, like side by side rectangles in one image, are resolved once
+                        bool resolved = false;
+                        for (uint32_t other = 0; other < static_cast<uint32_t>(view_num); other++) {
+                            const auto& other_image = layer->views[other].subImage;
+                            resolved |= other_image.swapchain == view.subImage.swapchain && other_image.imageArrayIndex == array_index;
+                        }
+                        if (!resolved) {
+                            ResolveImage(cmd_list, gb_swapchain, image_index, array_index);
+                        }
+                    }
+                    else {
+                        // Transition proxy swapchain resource to pixel shader resource
+                        TransitionImage(cmd_list, proxy_resource.Get(), gb_swapchain.resource_usage, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+                    }
 
                     std::array heaps = { gb_swapchain.GetSrvHeap().Get(), sampler_heap.Get() };
                     cmd_list->SetDescriptorHeaps(heaps.size(), heaps.data());
@@ -204,24 +224,29 @@ namespace XRGameBridge {
                         uint32_t is_opaque;
                         uint32_t multiply_alpha;
                         float convert_to_linear;
+                        uint32_t array_index;
                     } layering_constants;
                     // Make opaque if XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT is not set
                     layering_constants.is_opaque = (layer->layerFlags& XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT) != XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
                     // Multiply alpha if XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT is set
                     layering_constants.multiply_alpha = (layer->layerFlags & XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT) == XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT;
                     layering_constants.convert_to_linear = 0;
+                    layering_constants.array_index = array_index;
                     cmd_list->SetGraphicsRootSignature(root_signature.Get());
                     cmd_list->SetPipelineState(pipeline_state.Get());
-                    cmd_list->SetGraphicsRoot32BitConstants(2, 3, &layering_constants, 0);
+                    cmd_list->SetGraphicsRoot32BitConstants(2, 4, &layering_constants, 0);
 
                     // Setting descriptor tables is optional if there is only a single texture. For multiple sets of textures, you want to move this index.
-                    cmd_list->SetGraphicsRootDescriptorTable(0, gb_swapchain.GetSrvHeap()->GetGPUDescriptorHandleForHeapStart()); // Set offset in the heap for the shader (descriptor tables)
+                    CD3DX12_GPU_DESCRIPTOR_HANDLE srv_handle(gb_swapchain.GetSrvHeap()->GetGPUDescriptorHandleForHeapStart(), gb_swapchain.GetSrvIndex(image_index), gb_swapchain.cbc_srv_uav_descriptor_size);
+                    cmd_list->SetGraphicsRootDescriptorTable(0, srv_handle); // Set offset in the heap for the shader (descriptor tables)
                     cmd_list->SetGraphicsRootDescriptorTable(1, sampler_heap->GetGPUDescriptorHandleForHeapStart());
 
                     cmd_list->DrawInstanced(3, 1, 0, 0);
 
-                    // Transition proxy swapchain resource back to render target
-                    TransitionImage(cmd_list, proxy_resource.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, gb_swapchain.resource_usage);
+                    // Transition proxy swapchain resource back to render target, resolved copies stay readable
+                    if (!gb_swapchain.IsMultisampled()) {
+                        TransitionImage(cmd_list, proxy_resource.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, gb_swapchain.resource_usage);
+                    }
                 }
             }
             else if (frameEndInfo->layers[layer_num]->type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
@@ -231,40 +256,56 @@ namespace XRGameBridge {
         }
     }
 
-    void GB_Compositor::ExecuteCommandLists(ID3D12GraphicsCommandList* cmd_list, const XrFrameEndInfo* frameEndInfo) {
+    void GB_Compositor::ExecuteCommandLists(ID3D12GraphicsCommandList* cmd_list, uint64_t timeline_value) {
         ID3D12CommandList* lists[]{ cmd_list };
         command_queue->ExecuteCommandLists(1, lists);
 
-        // Go over every layer to signal all proxy swapchain fences
-        for (uint32_t layer_num = 0; layer_num < frameEndInfo->layerCount; layer_num++) {
-            if (frameEndInfo->layers[layer_num]->type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
-                auto layer = reinterpret_cast<const XrCompositionLayerProjection*>(frameEndInfo->layers[layer_num]);
-                    // In every layer get every view
-                for (uint32_t view_num = 0; view_num < layer->viewCount; view_num++) {
-                    // Get the swapchain from the view and signal its fence
-                    auto& view = layer->views[view_num];
-                    auto& gb_swapchain = g_proxy_swapchains[view.subImage.swapchain];
-                    command_queue->Signal(gb_swapchain.fence.Get(), gb_swapchain.fence_values[gb_swapchain.current_frame_index]);
-                }
+        // The frame signals the timeline once, every image it read depends on that value
+        for (uint32_t i = 0; i < composed_image_count; i++) {
+            composed_images[i].swapchain->SetImageTimelineValue(composed_images[i].image_index, timeline_value);
+        }
+        composed_image_count = 0;
+    }
+
+    bool GB_Compositor::AddComposedImage(GB_ProxySwapchain* swapchain, uint32_t image_index) {
+        // Both eyes usually read the same image
+        for (uint32_t i = 0; i < composed_image_count; i++) {
+            if (composed_images[i].swapchain == swapchain && composed_images[i].image_index == image_index) {
+                return true;
             }
         }
+        if (composed_image_count == max_composed_images) {
+            return false;
+        }
+        composed_images[composed_image_count++] = { swapchain, image_index };
+        return true;
     }
 
-    void GB_Compositor::TransitionImage(ID3D12GraphicsCommandList* cmd_list, ID3D12Resource* resource, D3D12_RESOURCE_STATES state_before, D3D12_RESOURCE_STATES state_after) {
+    void GB_Compositor::TransitionImage(ID3D12GraphicsCommandList* cmd_list, ID3D12Resource* resource, D3D12_RESOURCE_STATES state_before, D3D12_RESOURCE_STATES state_after, uint32_t subresource) {
         if (state_before == state_after) {
             return;
         }
 
-        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(resource, state_before, state_after);
+        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(resource, state_before, state_after, subresource);
         cmd_list->ResourceBarrier(1, &barrier);
     }
 
-    ComPtr<ID3D12GraphicsCommandList>& GB_Compositor::GetCommandList(uint32_t index) {
-        return command_lists[index];
-    }
+    void GB_Compositor::ResolveImage(ID3D12GraphicsCommandList* cmd_list, GB_ProxySwapchain& swapchain, uint32_t image_index, uint32_t array_index) {
+        ID3D12Resource* source = swapchain.GetBuffers()[image_index].Get();
+        ID3D12Resource* destination = swapchain.resolve_images[image_index].Get();
+        if (destination == nullptr) {
+            return;
+        }
+
+        // Both images have a single mip, only the slice of the view changes state
+        const uint32_t subresource = D3D12CalcSubresource(0, array_index, 0, 1, swapchain.GetArraySize());
+        TransitionImage(cmd_list, source, swapchain.resource_usage, D3D12_RESOURCE_STATE_RESOLVE_SOURCE, subresource);
+        TransitionImage(cmd_list, destination, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RESOLVE_DEST, subresource);
+
+        cmd_list->ResolveSubresource(destination, subresource, source, subresource, swapchain.image_desc.Format);
 
-    ComPtr<ID3D12CommandAllocator>& GB_Compositor::GetCommandAllocator(uint32_t index) {
-        return command_allocators[index];
+        TransitionImage(cmd_list, source, D3D12_RESOURCE_STATE_RESOLVE_SOURCE, swapchain.resource_usage, subresource);
+        TransitionImage(cmd_list, destination, D3D12_RESOURCE_STATE_RESOLVE_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, subresource);
     }
 
     ComPtr<ID3D12PipelineState>& GB_Compositor::GetPipelineState()
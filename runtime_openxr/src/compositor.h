@@ -1,8 +1,29 @@
 #pragma once
+#include <array>
+
 #include "openxr_includes.h"
 
 namespace XRGameBridge {
+    class GB_ProxySwapchain;
+
     class GB_Compositor {
+    public:
+        // Distinct swapchain images one frame can read, further views are not drawn
+        static constexpr uint32_t max_composed_images = 32;
+
+    private:
+        struct GB_ComposedImage {
+            GB_ProxySwapchain* swapchain;
+            uint32_t image_index;
+        };
+
+        // Images read by the frame being composed, the application can release newer ones before the frame is submitted
+        std::array<GB_ComposedImage, max_composed_images> composed_images;
+        uint32_t composed_image_count = 0;
+
+        // False when the image can't be tracked anymore
+        bool AddComposedImage(GB_ProxySwapchain* swapchain, uint32_t image_index);
+
         ComPtr<ID3D12RootSignature> root_signature;
         ComPtr<ID3D12PipelineState> pipeline_state;
 
@@ -13,24 +34,22 @@ namespace XRGameBridge {
         ComPtr<ID3D12Device> d3d12_device;
         ComPtr<ID3D12CommandQueue> command_queue;
 
-        std::vector<ComPtr<ID3D12CommandAllocator>> command_allocators;
-        std::vector<ComPtr<ID3D12GraphicsCommandList>> command_lists;
-
     public:
-        void Initialize(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue, uint32_t back_buffer_count);
+        void Initialize(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue);
         //void InitShaders(const ComPtr<ID3D12Device>& device);
         void ComposeImage(const XrFrameEndInfo* frameEndInfo, ID3D12GraphicsCommandList* cmd_list);
-        void ExecuteCommandLists(ID3D12GraphicsCommandList* cmd_list, const XrFrameEndInfo* frameEndInfo);
+        // Submits the frame, the swapchain images ComposeImage read are free once the session timeline completed timeline_value
+        void ExecuteCommandLists(ID3D12GraphicsCommandList* cmd_list, uint64_t timeline_value);
 
-        void TransitionImage(ID3D12GraphicsCommandList* cmd_list, ID3D12Resource* resource, D3D12_RESOURCE_STATES state_before, D3D12_RESOURCE_STATES state_after);
+        void TransitionImage(ID3D12GraphicsCommandList* cmd_list, ID3D12Resource* resource, D3D12_RESOURCE_STATES state_before, D3D12_RESOURCE_STATES state_after, uint32_t subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+        // Resolves one slice of a multisampled image into the copy the compositor samples
+        void ResolveImage(ID3D12GraphicsCommandList* cmd_list, GB_ProxySwapchain& swapchain, uint32_t image_index, uint32_t array_index);
 
         void AddResource();
         void RemoveResource();
         void AddSwapchainResources();
         void RemoveSwapchainResources();
 
-        ComPtr<ID3D12GraphicsCommandList>& GetCommandList(uint32_t index);
-        ComPtr<ID3D12CommandAllocator>& GetCommandAllocator(uint32_t index);
         ComPtr<ID3D12PipelineState>& GetPipelineState();
     };
 }
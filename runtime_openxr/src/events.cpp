@@ -1 +1,51 @@
 #include "events.h"
+
+namespace XRGameBridge {
+    void GB_EventQueue::PushBuffer(const void* event, uint32_t size) {
+        std::lock_guard lock(mutex);
+        if (count == capacity) {
+            head = (head + 1) % capacity;
+            count--;
+            lost_events++;
+        }
+
+        XrEventDataBuffer& buffer = events[(head + count) % capacity];
+        memcpy(&buffer, event, size);
+        memset(reinterpret_cast<uint8_t*>(&buffer) + size, 0, sizeof(buffer) - size);
+        count++;
+    }
+
+    XrResult GB_EventQueue::Poll(XrEventDataBuffer* event) {
+        std::lock_guard lock(mutex);
+        // The loss is reported where the dropped events would have been
+        if (lost_events > 0) {
+            XrEventDataEventsLost events_lost{ XR_TYPE_EVENT_DATA_EVENTS_LOST };
+            events_lost.lostEventCount = lost_events;
+            memcpy(event, &events_lost, sizeof(events_lost));
+            lost_events = 0;
+            return XR_SUCCESS;
+        }
+
+        if (count == 0) {
+            return XR_EVENT_UNAVAILABLE;
+        }
+
+        memcpy(event, &events[head], sizeof(XrEventDataBuffer));
+        head = (head + 1) % capacity;
+        count--;
+        return XR_SUCCESS;
+    }
+
+    uint32_t GB_EventQueue::Size() {
+        std::lock_guard lock(mutex);
+        return count;
+    }
+
+    void PushSessionStateChanged(GB_EventQueue& queue, XrSession session, XrSessionState state, XrTime time) {
+        XrEventDataSessionStateChanged state_change{ XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED };
+        state_change.session = session;
+        state_change.state = state;
+        state_change.time = time;
+        queue.Push(state_change);
+    }
+}
@@ -1,2 +1,39 @@
 #pragma once
-#include "openxr_includes.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#include <openxr/openxr.h>
+
+namespace XRGameBridge {
+    // Events waiting for xrPollEvent, oldest first.
+    // Pushed from any thread. When the queue is full the oldest event is dropped and xrPollEvent reports the loss with XrEventDataEventsLost.
+    class GB_EventQueue {
+    public:
+        static constexpr uint32_t capacity = 64;
+
+    private:
+        std::mutex mutex;
+        std::array<XrEventDataBuffer, capacity> events;
+        uint32_t head = 0;
+        uint32_t count = 0;
+        uint32_t lost_events = 0;
+
+        void PushBuffer(const void* event, uint32_t size);
+
+    public:
+        template <typename Event>
+        void Push(const Event& event) {
+            static_assert(sizeof(Event) <= sizeof(XrEventDataBuffer), "Events have to fit in XrEventDataBuffer");
+            PushBuffer(&event, sizeof(Event));
+        }
+
+        // XR_EVENT_UNAVAILABLE when the queue is empty
+        XrResult Poll(XrEventDataBuffer* event);
+        uint32_t Size();
+    };
+
+    void PushSessionStateChanged(GB_EventQueue& queue, XrSession session, XrSessionState state, XrTime time);
+}
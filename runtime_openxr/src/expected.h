@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cassert>
+#include <utility>
+
+#include <openxr/openxr.h>
+
+namespace XRGameBridge {
+    // Result of a lookup, holds either the object or the XrResult the entry point should return.
+    // Replaces map.at() inside try/catch, an invalid handle is an ordinary return value instead of a C++ exception.
+    //
+    // auto session_lookup = g_sessions.Find(session);
+    // if (!session_lookup) {
+    //     return session_lookup.error();
+    // }
+    // GB_Session& gb_session = *session_lookup;
+    template <typename T, typename E = XrResult>
+    class GB_Expected {
+        T value_storage;
+        E error_value;
+        bool valid;
+
+    public:
+        GB_Expected(T value) : value_storage(std::move(value)), error_value{}, valid(true) {
+        }
+
+        static GB_Expected Error(E error) {
+            GB_Expected result{ T{} };
+            result.error_value = error;
+            result.valid = false;
+            return result;
+        }
+
+        bool has_value() const { return valid; }
+        explicit operator bool() const { return valid; }
+
+        T& value() { assert(valid); return value_storage; }
+        const T& value() const { assert(valid); return value_storage; }
+        T& operator*() { return value(); }
+        const T& operator*() const { return value(); }
+        T* operator->() { return &value(); }
+        const T* operator->() const { return &value(); }
+
+        E error() const { assert(!valid); return error_value; }
+    };
+
+    // Reference specialization, the common case for handle lookups
+    template <typename T, typename E>
+    class GB_Expected<T&, E> {
+        T* pointer;
+        E error_value;
+
+        GB_Expected(T* pointer, E error) : pointer(pointer), error_value(error) {
+        }
+
+    public:
+        GB_Expected(T& value) : pointer(&value), error_value{} {
+        }
+
+        static GB_Expected Error(E error) {
+            return GB_Expected(nullptr, error);
+        }
+
+        bool has_value() const { return pointer != nullptr; }
+        explicit operator bool() const { return pointer != nullptr; }
+
+        T& value() const { assert(pointer != nullptr); return *pointer; }
+        T& operator*() const { return value(); }
+        T* operator->() const { return &value(); }
+
+        E error() const { assert(pointer == nullptr); return error_value; }
+    };
+}
@@ -0,0 +1,248 @@
+#include "eye_predictor.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+
+namespace XRGameBridge {
+    namespace {
+        constexpr uint32_t axis_count = 6;
+
+        // Left eye xyz followed by right eye xyz
+        std::array<float, axis_count> GetAxes(const GB_PoseSample& sample) {
+            return { sample.left_eye.x, sample.left_eye.y, sample.left_eye.z, sample.right_eye.x, sample.right_eye.y, sample.right_eye.z };
+        }
+
+        void SetAxes(GB_PoseSample& sample, const std::array<float, axis_count>& axes) {
+            sample.left_eye = { axes[0], axes[1], axes[2] };
+            sample.right_eye = { axes[3], axes[4], axes[5] };
+        }
+
+        float Distance(const XrVector3f& a, const XrVector3f& b) {
+            const float x = a.x - b.x;
+            const float y = a.y - b.y;
+            const float z = a.z - b.z;
+            return std::sqrt(x * x + y * y + z * z);
+        }
+
+        // Filtered position and velocity of one axis at the last sample
+        struct AxisEstimate {
+            float position = 0.0f;
+            float velocity = 0.0f;
+        };
+
+        class OneEuroFilter {
+            const GB_PredictionParameters& parameters;
+            AxisEstimate estimate;
+            bool initialized = false;
+
+            static float Alpha(float cutoff, float dt) {
+                constexpr float two_pi = 6.2831853f;
+                const float tau = 1.0f / (two_pi * cutoff);
+                return 1.0f / (1.0f + tau / dt);
+            }
+
+        public:
+            explicit OneEuroFilter(const GB_PredictionParameters& parameters) : parameters(parameters) {
+            }
+
+            void Update(float value, float dt) {
+                if (!initialized || dt <= 0.0f) {
+                    estimate.position = initialized ? estimate.position : value;
+                    initialized = true;
+                    return;
+                }
+
+                const float raw_velocity = (value - estimate.position) / dt;
+                estimate.velocity += Alpha(parameters.derivative_cutoff, dt) * (raw_velocity - estimate.velocity);
+                const float cutoff = parameters.min_cutoff + parameters.beta * std::abs(estimate.velocity);
+                estimate.position += Alpha(cutoff, dt) * (value - estimate.position);
+            }
+
+            AxisEstimate GetEstimate() const {
+                return estimate;
+            }
+        };
+
+        class KalmanFilter {
+            const GB_PredictionParameters& parameters;
+            AxisEstimate estimate;
+            // Symmetric covariance of position and velocity
+            float p00 = 0.0f;
+            float p01 = 0.0f;
+            float p11 = 0.0f;
+            bool initialized = false;
+
+        public:
+            explicit KalmanFilter(const GB_PredictionParameters& parameters) : parameters(parameters) {
+            }
+
+            void Update(float value, float dt) {
+                const float r = parameters.measurement_noise;
+                if (!initialized) {
+                    estimate = { value, 0.0f };
+                    // The velocity is unknown, the first few samples pin it down
+                    p00 = r;
+                    p01 = 0.0f;
+                    p11 = 1.0f;
+                    initialized = true;
+                    return;
+                }
+
+                // Predict with white noise acceleration
+                const float q = parameters.process_noise;
+                const float dt2 = dt * dt;
+                estimate.position += estimate.velocity * dt;
+                p00 += 2.0f * dt * p01 + dt2 * p11 + q * dt2 * dt2 / 4.0f;
+                p01 += dt * p11 + q * dt2 * dt / 2.0f;
+                p11 += q * dt2;
+
+                // Correct with the measured position
+                const float innovation = value - estimate.position;
+                const float s = p00 + r;
+                const float k0 = p00 / s;
+                const float k1 = p01 / s;
+                estimate.position += k0 * innovation;
+                estimate.velocity += k1 * innovation;
+                p11 -= k1 * p01;
+                p01 *= 1.0f - k0;
+                p00 *= 1.0f - k0;
+            }
+
+            AxisEstimate GetEstimate() const {
+                return estimate;
+            }
+        };
+
+        template <typename Filter>
+        void RunFilter(const GB_PredictionParameters& parameters, const GB_PoseSample* samples, uint32_t count, XrDuration prediction, GB_PoseSample& result) {
+            std::array<Filter, axis_count> filters{ Filter(parameters), Filter(parameters), Filter(parameters), Filter(parameters), Filter(parameters), Filter(parameters) };
+
+            for (uint32_t i = 0; i < count; i++) {
+                const float dt = i == 0 ? 0.0f : static_cast<float>(static_cast<double>(samples[i].time - samples[i - 1].time) * 1e-9);
+                const std::array<float, axis_count> axes = GetAxes(samples[i]);
+                for (uint32_t axis = 0; axis < axis_count; axis++) {
+                    filters[axis].Update(axes[axis], dt);
+                }
+            }
+
+            const float seconds = static_cast<float>(static_cast<double>(prediction) * 1e-9);
+            std::array<float, axis_count> predicted;
+            for (uint32_t axis = 0; axis < axis_count; axis++) {
+                const AxisEstimate estimate = filters[axis].GetEstimate();
+                predicted[axis] = estimate.position + estimate.velocity * seconds;
+            }
+            SetAxes(result, predicted);
+        }
+
+        // Linear interpolation of the trace, the reference the predictions are measured against
+        bool SampleTrace(const GB_PoseSample* trace, uint32_t count, XrTime time, GB_PoseSample& sample) {
+            const GB_PoseSample* end = trace + count;
+            const GB_PoseSample* high = std::lower_bound(trace, end, time, [](const GB_PoseSample& s, XrTime t) { return s.time < t; });
+            if (high == trace || high == end) {
+                return false;
+            }
+            const GB_PoseSample* low = high - 1;
+            const float t = static_cast<float>(static_cast<double>(time - low->time) / static_cast<double>(high->time - low->time));
+
+            std::array<float, axis_count> a = GetAxes(*low);
+            const std::array<float, axis_count> b = GetAxes(*high);
+            for (uint32_t axis = 0; axis < axis_count; axis++) {
+                a[axis] += (b[axis] - a[axis]) * t;
+            }
+            sample.time = time;
+            SetAxes(sample, a);
+            return true;
+        }
+    }
+
+    GB_EyePredictor::GB_EyePredictor(const GB_PoseHistory& pose_history) : pose_history(pose_history) {
+    }
+
+    void GB_EyePredictor::SetParameters(const GB_PredictionParameters& parameters) {
+        std::scoped_lock lock(parameter_mutex);
+        this->parameters = parameters;
+        parameter_changes.fetch_add(1, std::memory_order_release);
+    }
+
+    GB_PredictionParameters GB_EyePredictor::GetParameters() const {
+        std::scoped_lock lock(parameter_mutex);
+        return parameters;
+    }
+
+    bool GB_EyePredictor::Predict(XrTime time, GB_PoseSample& sample) const {
+        return Predict(pose_history, GetParameters(), time, sample);
+    }
+
+    bool GB_EyePredictor::Predict(const GB_PoseHistory& history, const GB_PredictionParameters& parameters, XrTime time, GB_PoseSample& sample) {
+        // A sample stamped at t holds the eyes as they were at t - tracker_latency, look that much further ahead
+        const XrTime sample_time = time + parameters.tracker_latency;
+
+        // The head orientation isn't filtered
+        if (!history.Sample(sample_time, sample)) {
+            return false;
+        }
+        sample.time = time;
+        if (parameters.filter == PREDICTION_FILTER_NONE) {
+            return true;
+        }
+
+        std::array<GB_PoseSample, window> samples;
+        const uint32_t count = history.GetRecent(samples.data(), window);
+
+        // Times the history covers already have real samples around them, only the future is predicted
+        if (count == 0 || sample_time <= samples[count - 1].time) {
+            return true;
+        }
+
+        const XrDuration prediction = std::min(sample_time - samples[count - 1].time, parameters.max_prediction);
+        if (parameters.filter == PREDICTION_FILTER_ONE_EURO) {
+            RunFilter<OneEuroFilter>(parameters, samples.data(), count, prediction, sample);
+        }
+        else {
+            RunFilter<KalmanFilter>(parameters, samples.data(), count, prediction, sample);
+        }
+        return true;
+    }
+
+    uint64_t GB_EyePredictor::GetGeneration() const {
+        // Both only ever grow, so the sum changes whenever either does
+        return pose_history.GetGeneration() + parameter_changes.load(std::memory_order_acquire);
+    }
+
+    GB_PredictionError GB_EyePredictor::Evaluate(const GB_PoseSample* trace, uint32_t count, const GB_PredictionParameters& parameters, XrDuration latency) {
+        auto history = std::make_unique<GB_PoseHistory>();
+
+        GB_PredictionError error;
+        double sum = 0.0;
+        double squared_sum = 0.0;
+        for (uint32_t i = 0; i < count; i++) {
+            // The sample arrives after the tracker latency and the frame is shown latency after that
+            GB_PoseSample arrived = trace[i];
+            arrived.time += parameters.tracker_latency;
+            history->AddSample(arrived);
+
+            const XrTime display_time = arrived.time + latency;
+            GB_PoseSample truth;
+            if (!SampleTrace(trace, count, display_time, truth)) {
+                continue;
+            }
+
+            GB_PoseSample predicted;
+            Predict(*history, parameters, display_time, predicted);
+
+            const float eye_error = (Distance(predicted.left_eye, truth.left_eye) + Distance(predicted.right_eye, truth.right_eye)) / 2.0f;
+            sum += eye_error;
+            squared_sum += static_cast<double>(eye_error) * eye_error;
+            error.max = std::max(error.max, eye_error);
+            error.predictions++;
+        }
+
+        if (error.predictions > 0) {
+            error.mean = static_cast<float>(sum / error.predictions);
+            error.rms = static_cast<float>(std::sqrt(squared_sum / error.predictions));
+        }
+        return error;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include <openxr/openxr.h>
+
+#include "pose_history.h"
+
+namespace XRGameBridge {
+    enum GB_PredictionFilterType {
+        // Interpolate the raw samples, extrapolate from the last two
+        PREDICTION_FILTER_NONE,
+        // Adaptive low pass, smooths hard while the eyes are still and follows quickly when they move
+        PREDICTION_FILTER_ONE_EURO,
+        // Constant velocity Kalman filter per axis
+        PREDICTION_FILTER_KALMAN,
+    };
+
+    struct GB_PredictionParameters {
+        GB_PredictionFilterType filter = PREDICTION_FILTER_KALMAN;
+        // Time between the eyes being captured and the sample arriving, samples are stamped on arrival
+        XrDuration tracker_latency = 0;
+        // Predicting further than this mostly amplifies noise, the prediction stops there
+        XrDuration max_prediction = 100'000'000;
+
+        // One Euro, cutoffs in Hz and beta in Hz per m/s
+        float min_cutoff = 1.0f;
+        float beta = 300.0f;
+        float derivative_cutoff = 1.0f;
+
+        // Kalman, variance of the acceleration in m^2/s^4 and of the measurements in m^2
+        float process_noise = 10.0f;
+        float measurement_noise = 1e-6f;
+    };
+
+    // Prediction error in meters, averaged over both eyes
+    struct GB_PredictionError {
+        uint32_t predictions = 0;
+        float mean = 0.0f;
+        float rms = 0.0f;
+        float max = 0.0f;
+    };
+
+    // Predicts where the eyes are at a display time from the samples in the pose history.
+    // Every query runs the selected filter over the newest samples, so there is no filter state to share between threads and
+    // results only depend on the samples and the parameters. Parameters can be changed at any time.
+    class GB_EyePredictor {
+    public:
+        // Samples the filter runs over, enough for the filters to settle
+        static constexpr uint32_t window = 32;
+
+    private:
+        const GB_PoseHistory& pose_history;
+
+        mutable std::mutex parameter_mutex;
+        GB_PredictionParameters parameters;
+        std::atomic<uint64_t> parameter_changes = 0;
+
+    public:
+        explicit GB_EyePredictor(const GB_PoseHistory& pose_history);
+
+        void SetParameters(const GB_PredictionParameters& parameters);
+        GB_PredictionParameters GetParameters() const;
+
+        // Eye positions at the time, false if there are no samples yet
+        bool Predict(XrTime time, GB_PoseSample& sample) const;
+        static bool Predict(const GB_PoseHistory& history, const GB_PredictionParameters& parameters, XrTime time, GB_PoseSample& sample);
+
+        // Changes whenever a prediction could change, on new samples and new parameters
+        uint64_t GetGeneration() const;
+
+        // Replays a recorded trace sample by sample and predicts latency ahead of every sample that arrives.
+        // Trace times are capture times, samples arrive tracker_latency later. Predictions are compared with the trace itself.
+        static GB_PredictionError Evaluate(const GB_PoseSample* trace, uint32_t count, const GB_PredictionParameters& parameters, XrDuration latency);
+    };
+}
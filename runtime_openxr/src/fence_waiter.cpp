@@ -0,0 +1,252 @@
+#include "fence_waiter.h"
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace XRGameBridge {
+    namespace {
+        int64_t GetDeadline(int64_t now, XrDuration timeout) {
+            if (timeout == XR_INFINITE_DURATION || timeout > INT64_MAX - now) {
+                return INT64_MAX;
+            }
+            return now + timeout;
+        }
+    }
+
+#ifdef _WIN32
+    GB_SystemWaitBackend::GB_SystemWaitBackend() {
+        wake_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        // High resolution timers need Windows 10 1803, older versions get the regular timer resolution
+        timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (timer == nullptr) {
+            timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+    }
+
+    GB_SystemWaitBackend::~GB_SystemWaitBackend() {
+        CloseHandle(timer);
+        CloseHandle(wake_event);
+    }
+
+    void GB_SystemWaitBackend::Sleep(int64_t deadline) {
+        if (deadline == INT64_MAX) {
+            WaitForSingleObject(wake_event, INFINITE);
+            return;
+        }
+
+        const int64_t remaining = deadline - Now();
+        if (remaining <= 0) {
+            return;
+        }
+        // Negative due times are relative, in 100 nanosecond units
+        LARGE_INTEGER due_time;
+        due_time.QuadPart = -std::max<int64_t>(remaining / 100, 1);
+        SetWaitableTimerEx(timer, &due_time, 0, nullptr, nullptr, nullptr, 0);
+
+        const HANDLE handles[] = { wake_event, timer };
+        WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+    }
+
+    void GB_SystemWaitBackend::Wake() {
+        SetEvent(wake_event);
+    }
+
+    void* GB_SystemWaitBackend::GetNativeEvent() {
+        return wake_event;
+    }
+#else
+    GB_SystemWaitBackend::GB_SystemWaitBackend() = default;
+    GB_SystemWaitBackend::~GB_SystemWaitBackend() = default;
+
+    void GB_SystemWaitBackend::Sleep(int64_t deadline) {
+        std::unique_lock lock(mutex);
+        if (deadline == INT64_MAX) {
+            condition.wait(lock, [&] { return woken; });
+        }
+        else {
+            const std::chrono::steady_clock::time_point time{ std::chrono::nanoseconds(deadline) };
+            condition.wait_until(lock, time, [&] { return woken; });
+        }
+        woken = false;
+    }
+
+    void GB_SystemWaitBackend::Wake() {
+        std::lock_guard lock(mutex);
+        woken = true;
+        condition.notify_one();
+    }
+
+    void* GB_SystemWaitBackend::GetNativeEvent() {
+        return nullptr;
+    }
+#endif
+
+    int64_t GB_SystemWaitBackend::Now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    uint64_t GB_SimulatedTimeline::GetCompletedValue() const {
+        return completed_value.load(std::memory_order_acquire);
+    }
+
+    void GB_SimulatedTimeline::WakeOnCompletion(uint64_t value, GB_WaitBackend& backend) const {
+        {
+            std::lock_guard lock(mutex);
+            if (GetCompletedValue() < value) {
+                notifications.push_back({ value, &backend });
+                return;
+            }
+        }
+        backend.Wake();
+    }
+
+    void GB_SimulatedTimeline::Complete(uint64_t value) {
+        std::lock_guard lock(mutex);
+        completed_value.store(value, std::memory_order_release);
+        std::erase_if(notifications, [&](const Notification& notification) {
+            if (notification.value > value) {
+                return false;
+            }
+            notification.backend->Wake();
+            return true;
+        });
+    }
+
+    GB_FenceWaiter::GB_FenceWaiter(GB_WaitBackend& backend) : backend(backend) {}
+
+    GB_FenceWaiter::~GB_FenceWaiter() {
+        Stop();
+    }
+
+    void GB_FenceWaiter::Stop() {
+        std::thread stopped;
+        {
+            std::lock_guard lock(mutex);
+            if (!thread.joinable()) {
+                return;
+            }
+            running.store(false, std::memory_order_release);
+            stopping = true;
+            stopped = std::move(thread);
+        }
+        backend.Wake();
+        stopped.join();
+
+        std::lock_guard lock(mutex);
+        for (auto& slot : pending) {
+            slot->state.store(WAIT_RESULT_TIMED_OUT, std::memory_order_release);
+            slot->state.notify_one();
+        }
+        pending.clear();
+        stopping = false;
+    }
+
+    void GB_FenceWaiter::Run() {
+        std::vector<std::shared_ptr<Slot>> finished;
+        std::vector<uint32_t> results;
+
+        while (running.load(std::memory_order_acquire)) {
+            int64_t now;
+            int64_t earliest_deadline = INT64_MAX;
+            bool waiting;
+            {
+                std::lock_guard lock(mutex);
+                now = backend.Now();
+
+                std::erase_if(pending, [&](std::shared_ptr<Slot>& slot) {
+                    uint32_t result = WAIT_RESULT_PENDING;
+                    if (slot->timeline->GetCompletedValue() >= slot->value) {
+                        result = WAIT_RESULT_COMPLETED;
+                    }
+                    else if (now >= slot->deadline) {
+                        result = WAIT_RESULT_TIMED_OUT;
+                    }
+                    else {
+                        if (!slot->armed) {
+                            slot->timeline->WakeOnCompletion(slot->value, backend);
+                            slot->armed = true;
+                        }
+                        earliest_deadline = std::min(earliest_deadline, slot->deadline);
+                        return false;
+                    }
+                    finished.push_back(std::move(slot));
+                    results.push_back(result);
+                    return true;
+                });
+                waiting = !pending.empty();
+            }
+
+            // The waiting threads own the slots again after the store, the shared pointers keep them alive for the notify
+            for (size_t i = 0; i < finished.size(); i++) {
+                finished[i]->state.store(results[i], std::memory_order_release);
+                finished[i]->state.notify_one();
+            }
+            finished.clear();
+            results.clear();
+
+            if (!waiting) {
+                backend.Sleep(INT64_MAX);
+            }
+            else if (earliest_deadline - now <= spin_threshold) {
+                std::this_thread::yield();
+            }
+            else {
+                backend.Sleep(earliest_deadline == INT64_MAX ? INT64_MAX : earliest_deadline - spin_threshold);
+            }
+        }
+    }
+
+    bool GB_FenceWaiter::Wait(const GB_WaitTimeline& timeline, uint64_t value, XrDuration timeout) {
+        if (timeline.GetCompletedValue() >= value) {
+            return true;
+        }
+        if (timeout <= 0) {
+            return false;
+        }
+
+        thread_local std::shared_ptr<Slot> slot = std::make_shared<Slot>();
+        slot->state.store(WAIT_RESULT_PENDING, std::memory_order_relaxed);
+        slot->timeline = &timeline;
+        slot->value = value;
+        slot->deadline = GetDeadline(backend.Now(), timeout);
+        slot->armed = false;
+
+        {
+            std::lock_guard lock(mutex);
+            if (stopping) {
+                return false;
+            }
+            if (!running.load(std::memory_order_relaxed)) {
+                running.store(true, std::memory_order_relaxed);
+                thread = std::thread(&GB_FenceWaiter::Run, this);
+            }
+            pending.push_back(slot);
+        }
+        backend.Wake();
+
+        // Returns once the waiter thread stored a result, spurious wakes see the pending state and park again
+        slot->state.wait(WAIT_RESULT_PENDING, std::memory_order_acquire);
+        return slot->state.load(std::memory_order_acquire) == WAIT_RESULT_COMPLETED;
+    }
+
+    const GB_WaitBackend& GB_FenceWaiter::GetBackend() const {
+        return backend;
+    }
+
+    GB_FenceWaiter& GetFenceWaiter() {
+        static GB_SystemWaitBackend* backend = new GB_SystemWaitBackend();
+        static GB_FenceWaiter* waiter = new GB_FenceWaiter(*backend);
+        return *waiter;
+    }
+
+    void ShutdownFenceWaiter() {
+        GetFenceWaiter().Stop();
+    }
+}
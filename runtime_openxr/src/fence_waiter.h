@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <openxr/openxr.h>
+
+namespace XRGameBridge {
+    // How the fence waiter tells time and sleeps
+    class GB_WaitBackend {
+    public:
+        virtual ~GB_WaitBackend() = default;
+
+        // Monotonic nanoseconds
+        virtual int64_t Now() const = 0;
+        // Blocks until Wake was called or the deadline passed, INT64_MAX waits for a wake only. A wake before the call isn't lost.
+        virtual void Sleep(int64_t deadline) = 0;
+        virtual void Wake() = 0;
+        // Win32 event a GPU API can set to wake the waiter, nullptr where there is none
+        virtual void* GetNativeEvent() {
+            return nullptr;
+        }
+    };
+
+    // A GPU timeline the fence waiter can watch, a fence whose value only increases
+    class GB_WaitTimeline {
+    public:
+        virtual ~GB_WaitTimeline() = default;
+
+        virtual uint64_t GetCompletedValue() const = 0;
+        // Wakes the backend once the value completed, right away if it already did
+        virtual void WakeOnCompletion(uint64_t value, GB_WaitBackend& backend) const = 0;
+    };
+
+    // Sleeps on a high resolution waitable timer and an event on Windows, on a condition variable elsewhere
+    class GB_SystemWaitBackend : public GB_WaitBackend {
+#ifdef _WIN32
+        void* wake_event = nullptr;
+        void* timer = nullptr;
+#else
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool woken = false;
+#endif
+
+    public:
+        GB_SystemWaitBackend();
+        ~GB_SystemWaitBackend() override;
+
+        int64_t Now() const override;
+        void Sleep(int64_t deadline) override;
+        void Wake() override;
+        void* GetNativeEvent() override;
+    };
+
+    // Timeline completed by hand, stands in for a GPU fence in headless runs and benchmarks
+    class GB_SimulatedTimeline : public GB_WaitTimeline {
+        struct Notification {
+            uint64_t value;
+            GB_WaitBackend* backend;
+        };
+
+        std::atomic<uint64_t> completed_value = 0;
+        mutable std::mutex mutex;
+        mutable std::vector<Notification> notifications;
+
+    public:
+        uint64_t GetCompletedValue() const override;
+        void WakeOnCompletion(uint64_t value, GB_WaitBackend& backend) const override;
+
+        // What the GPU does when it reaches a signal
+        void Complete(uint64_t value);
+    };
+
+    // One thread that watches every pending GPU wait, so waiting doesn't need an event per swapchain or per fence.
+    // Waiting threads park on an atomic (a futex or WaitOnAddress) and the waiter thread wakes them when the timeline completed
+    // or the deadline passed. Deadlines are in nanoseconds, the thread sleeps on a high resolution timer until shortly before
+    // the earliest one and yields for the rest, so timeouts below a millisecond are kept instead of rounding to 0.
+    class GB_FenceWaiter {
+        enum WaitResult : uint32_t {
+            WAIT_RESULT_PENDING,
+            WAIT_RESULT_COMPLETED,
+            WAIT_RESULT_TIMED_OUT,
+        };
+
+        // Every thread has one slot it reuses for all its waits, shared so the waiter thread can still touch it after a wake
+        struct Slot {
+            std::atomic<uint32_t> state = WAIT_RESULT_PENDING;
+            const GB_WaitTimeline* timeline = nullptr;
+            uint64_t value = 0;
+            int64_t deadline = 0;
+            bool armed = false;
+        };
+
+        GB_WaitBackend& backend;
+
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Slot>> pending;
+
+        // Written with mutex held
+        std::atomic<bool> running = false;
+        bool stopping = false;
+        std::thread thread;
+
+        void Run();
+
+    public:
+        // Time before a deadline that is spent yielding instead of sleeping, covers the timer's wake up latency
+        static constexpr int64_t spin_threshold = 200'000;
+
+        // The thread starts with the first wait that has to block
+        explicit GB_FenceWaiter(GB_WaitBackend& backend);
+        ~GB_FenceWaiter();
+
+        GB_FenceWaiter(const GB_FenceWaiter&) = delete;
+        GB_FenceWaiter& operator=(const GB_FenceWaiter&) = delete;
+
+        // Blocks until the timeline completed the value, false when the timeout in nanoseconds expired first.
+        // Completed values return without involving the waiter thread, a timeout of 0 only polls.
+        bool Wait(const GB_WaitTimeline& timeline, uint64_t value, XrDuration timeout = XR_INFINITE_DURATION);
+
+        // Joins the thread, pending waits and waits started until it returns time out. The next wait starts the thread again.
+        void Stop();
+
+        const GB_WaitBackend& GetBackend() const;
+    };
+
+    // Waiter of the runtime on the system backend, never destroyed so it can be used until the runtime unloads
+    GB_FenceWaiter& GetFenceWaiter();
+    // Stops the thread of the runtime's waiter, for when the last instance is destroyed
+    void ShutdownFenceWaiter();
+}
@@ -0,0 +1,76 @@
+#include "frame_pacer.h"
+
+namespace XRGameBridge {
+    GB_FramePacer::WaitResult GB_FramePacer::WaitFrame(std::chrono::nanoseconds timeout) {
+        std::unique_lock lock(mutex);
+
+        auto frame_available = [&] {
+            return released || !frame_waited;
+        };
+
+        if (timeout == std::chrono::nanoseconds::max()) {
+            frame_condition.wait(lock, frame_available);
+        }
+        else if (!frame_condition.wait_for(lock, timeout, frame_available)) {
+            return WaitResult::Timeout;
+        }
+
+        if (released) {
+            return WaitResult::Released;
+        }
+
+        frame_waited = true;
+        return WaitResult::Success;
+    }
+
+    bool GB_FramePacer::BeginFrame() {
+        {
+            std::lock_guard guard(mutex);
+            if (!frame_waited) {
+                return false;
+            }
+            frame_waited = false;
+            frames_in_progress++;
+            frames_begun++;
+        }
+
+        // Notify everyone, a waiter that timed out at the same moment must not swallow the wake up of the others
+        frame_condition.notify_all();
+        return true;
+    }
+
+    bool GB_FramePacer::EndFrame() {
+        std::lock_guard guard(mutex);
+        if (frames_in_progress == 0) {
+            return false;
+        }
+        frames_in_progress--;
+        frames_ended++;
+        return true;
+    }
+
+    void GB_FramePacer::Release() {
+        {
+            std::lock_guard guard(mutex);
+            released = true;
+        }
+        frame_condition.notify_all();
+    }
+
+    void GB_FramePacer::Reset() {
+        std::lock_guard guard(mutex);
+        released = false;
+        frame_waited = false;
+        frames_in_progress = 0;
+    }
+
+    uint64_t GB_FramePacer::GetFramesBegun() {
+        std::lock_guard guard(mutex);
+        return frames_begun;
+    }
+
+    uint64_t GB_FramePacer::GetFramesEnded() {
+        std::lock_guard guard(mutex);
+        return frames_ended;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace XRGameBridge {
+    // Hands out frames to xrWaitFrame, xrBeginFrame and xrEndFrame in the order the OpenXR frame loop requires.
+    // WaitFrame sleeps on a condition variable until the previous frame was begun, so a blocked application thread uses no CPU
+    // and wakes up as soon as BeginFrame signals instead of after the next timer tick.
+    // Any number of threads may wait, each allowed frame is claimed by exactly one of them.
+    class GB_FramePacer {
+    public:
+        enum class WaitResult {
+            Success,
+            Timeout,
+            Released
+        };
+
+    private:
+        std::mutex mutex;
+        std::condition_variable frame_condition;
+
+        // True while a frame was claimed by WaitFrame and not begun yet
+        bool frame_waited = false;
+        // Number of frames begun and not ended yet, the spec allows a new frame to begin before the previous one ended
+        uint32_t frames_in_progress = 0;
+        bool released = false;
+
+        uint64_t frames_begun = 0;
+        uint64_t frames_ended = 0;
+
+    public:
+        // Blocks until a new frame may start and claims it for the caller.
+        // Returns Timeout if no frame became available in time and Released once Release was called.
+        WaitResult WaitFrame(std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max());
+
+        // Returns false if there is no frame claimed by WaitFrame. Wakes up the next waiter.
+        bool BeginFrame();
+
+        // Returns false if there is no frame begun
+        bool EndFrame();
+
+        // Wakes up every waiter with Released, used when the session stops so the application isn't stuck in xrWaitFrame
+        void Release();
+
+        // Allows frames again after Release
+        void Reset();
+
+        uint64_t GetFramesBegun();
+        uint64_t GetFramesEnded();
+    };
+}
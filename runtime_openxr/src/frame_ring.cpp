@@ -0,0 +1,76 @@
+#include "frame_ring.h"
+
+#include <algorithm>
+#include <format>
+
+namespace XRGameBridge {
+    bool GB_FrameRing::Initialize(const ComPtr<ID3D12Device>& device, uint32_t frames_in_flight, const ComPtr<ID3D12PipelineState>& pipeline_state) {
+        this->frames_in_flight = std::clamp(frames_in_flight, 1u, g_max_frames_in_flight);
+
+        if (!timeline.Initialize(device)) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < this->frames_in_flight; i++) {
+            GB_FrameContext& frame = frames[i];
+            if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&frame.command_allocator)))) {
+                LOG(ERROR) << "Failed to create command allocator for frame " << i;
+                return false;
+            }
+            if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, frame.command_allocator.Get(), pipeline_state.Get(), IID_PPV_ARGS(&frame.command_list)))) {
+                LOG(ERROR) << "Failed to create command list for frame " << i;
+                return false;
+            }
+
+            std::wstring name = std::format(L"Compositor Command List {}", i);
+            frame.command_list->SetName(name.c_str());
+            frame.command_list->Close();
+        }
+
+        LOG(INFO) << "Frames in flight: " << this->frames_in_flight;
+        return true;
+    }
+
+    void GB_FrameRing::WaitForValue(uint64_t value) const {
+        if (!timeline.Wait(value)) {
+            // The GPU may still be using the frame's allocator, a device that was removed won't touch it anymore
+            timeline.WaitBlocking(value);
+        }
+    }
+
+    uint32_t GB_FrameRing::GetFramesInFlight() const {
+        return frames_in_flight;
+    }
+
+    void GB_FrameRing::WaitForFreeFrame() {
+        // Wait for the oldest frame in flight, the frame that uses its context next can then start
+        const uint64_t submitted = timeline.GetSignaledValue();
+        if (submitted >= frames_in_flight) {
+            WaitForValue(submitted - frames_in_flight + 1);
+        }
+    }
+
+    GB_FrameContext& GB_FrameRing::BeginFrame(const ComPtr<ID3D12PipelineState>& pipeline_state) {
+        const uint64_t submitted = timeline.GetSignaledValue();
+        GB_FrameContext& frame = frames[submitted % frames_in_flight];
+
+        // xrWaitFrame normally waited for this already, but resetting an allocator the GPU still reads from is never allowed
+        WaitForValue(frame.fence_value);
+
+        frame.command_allocator->Reset();
+        frame.command_list->Reset(frame.command_allocator.Get(), pipeline_state.Get());
+        return frame;
+    }
+
+    void GB_FrameRing::EndFrame(const ComPtr<ID3D12CommandQueue>& queue, GB_FrameContext& frame) {
+        frame.fence_value = timeline.Signal(queue);
+    }
+
+    void GB_FrameRing::WaitForIdle() {
+        WaitForValue(timeline.GetSignaledValue());
+    }
+
+    const GB_Timeline& GB_FrameRing::GetTimeline() const {
+        return timeline;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+
+#include "openxr_includes.h"
+#include "timeline.h"
+
+namespace XRGameBridge {
+    constexpr uint32_t g_max_frames_in_flight = 3;
+
+    // Everything the compositor records a single frame with
+    struct GB_FrameContext {
+        ComPtr<ID3D12CommandAllocator> command_allocator;
+        ComPtr<ID3D12GraphicsCommandList> command_list;
+        // Timeline value signaled once the GPU is done with the frame, 0 if the context was never submitted
+        uint64_t fence_value = 0;
+        XrTime display_time = 0;
+    };
+
+    // Ring of frame contexts, one per frame the GPU may be working on at the same time.
+    // More frames in flight let the CPU run ahead of the GPU for throughput, fewer keep the latency down.
+    // Every submitted frame signals the session timeline once, its value counts the submitted frames.
+    class GB_FrameRing {
+        std::array<GB_FrameContext, g_max_frames_in_flight> frames;
+        uint32_t frames_in_flight = 2;
+
+        GB_Timeline timeline;
+
+        // Waits through the fence waiter and falls back to blocking on the fence when the waiter timed the wait out on a stop
+        void WaitForValue(uint64_t value) const;
+
+    public:
+        // frames_in_flight is clamped to [1, g_max_frames_in_flight]
+        bool Initialize(const ComPtr<ID3D12Device>& device, uint32_t frames_in_flight, const ComPtr<ID3D12PipelineState>& pipeline_state);
+
+        uint32_t GetFramesInFlight() const;
+
+        // Blocks until the GPU is working on fewer than frames_in_flight frames, called from xrWaitFrame to throttle the application
+        void WaitForFreeFrame();
+
+        // Returns the context for the next frame with its allocator and command list reset
+        GB_FrameContext& BeginFrame(const ComPtr<ID3D12PipelineState>& pipeline_state);
+
+        // Signals the timeline for the frame after its command lists were submitted to the queue
+        void EndFrame(const ComPtr<ID3D12CommandQueue>& queue, GB_FrameContext& frame);
+
+        // Blocks until the GPU finished every submitted frame
+        void WaitForIdle();
+
+        const GB_Timeline& GetTimeline() const;
+    };
+}
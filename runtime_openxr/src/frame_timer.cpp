@@ -0,0 +1,232 @@
+#include "frame_timer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace XRGameBridge {
+    namespace {
+        int64_t PeriodFromRefreshRate(double refresh_rate) {
+            return static_cast<int64_t>(std::llround(1'000'000'000.0 / refresh_rate));
+        }
+
+        // Number of whole periods in duration, rounded to the nearest
+        int64_t RoundPeriods(int64_t duration, int64_t period) {
+            return duration >= 0 ? (duration + period / 2) / period : -((-duration + period / 2) / period);
+        }
+
+        template <size_t Size>
+        int64_t Median(std::array<int64_t, Size>& values, uint32_t count) {
+            auto middle = values.begin() + count / 2;
+            std::nth_element(values.begin(), middle, values.begin() + count);
+            return *middle;
+        }
+    }
+
+    GB_FrameTimer::GB_FrameTimer(const GB_Clock& clock, double refresh_rate) : clock(clock) {
+        nominal_period = PeriodFromRefreshRate(refresh_rate);
+        period = nominal_period;
+        // Until it is measured assume the application takes a whole frame to render, same as the old fixed prediction
+        render_latency = nominal_period;
+    }
+
+    void GB_FrameTimer::SetNominalRefreshRate(double refresh_rate) {
+        if (refresh_rate <= 0.0) {
+            return;
+        }
+
+        std::lock_guard guard(mutex);
+        nominal_period = PeriodFromRefreshRate(refresh_rate);
+        period = nominal_period;
+        UpdateEstimates();
+    }
+
+    void GB_FrameTimer::AddVblank(int64_t time) {
+        std::lock_guard guard(mutex);
+
+        // Drop samples that go back in time or repeat the last vblank, frame statistics report the same vblank until the next one happened
+        if (vblank_count > 0) {
+            const int64_t last = vblanks[(vblank_count - 1) % history_size];
+            if (time - last < period / 2) {
+                return;
+            }
+        }
+
+        vblanks[vblank_count % history_size] = time;
+        vblank_count++;
+        UpdateEstimates();
+    }
+
+    int64_t GB_FrameTimer::GetSample(uint32_t index) const {
+        const uint32_t count = std::min(vblank_count, history_size);
+        return vblanks[(vblank_count - count + index) % history_size];
+    }
+
+    bool GB_FrameTimer::EstimatePeriod(uint32_t span) {
+        const uint32_t count = std::min(vblank_count, history_size);
+
+        // Intervals between samples span apart, divided by the number of vblanks they cover so missed samples still count
+        std::array<int64_t, history_size> candidates;
+        uint32_t candidate_count = 0;
+        for (uint32_t i = 0; i + span < count; i++) {
+            const int64_t interval = GetSample(i + span) - GetSample(i);
+            const int64_t periods = RoundPeriods(interval, period);
+            if (periods < 1) {
+                continue;
+            }
+            const int64_t candidate = interval / periods;
+            // Ignore intervals that don't fit the display at all, for example after the window was moved or the machine stalled
+            if (candidate < nominal_period * 3 / 4 || candidate > nominal_period * 5 / 4) {
+                continue;
+            }
+            candidates[candidate_count++] = candidate;
+        }
+
+        if (candidate_count < 3) {
+            return false;
+        }
+        period = Median(candidates, candidate_count);
+        return true;
+    }
+
+    void GB_FrameTimer::UpdateEstimates() {
+        const uint32_t count = std::min(vblank_count, history_size);
+        if (count == 0) {
+            return;
+        }
+
+        // Coarse estimate from neighbouring samples first, it is needed to count the periods between samples further apart.
+        // Then refine with samples half the history apart, their jitter is divided by the number of periods in between.
+        if (EstimatePeriod(1)) {
+            EstimatePeriod(count / 2);
+        }
+
+        // Phase: where the samples sit within a period on average, next to the newest vblank. Averaged as angles, so samples just
+        // before and just after a period boundary don't cancel out and the newest one being an outlier doesn't move the grid.
+        constexpr double two_pi = 6.283185307179586;
+        const int64_t newest = GetSample(count - 1);
+        double sum_sin = 0.0;
+        double sum_cos = 0.0;
+        for (uint32_t i = 0; i < count; i++) {
+            const int64_t offset = GetSample(i) - newest;
+            const double angle = two_pi * static_cast<double>(offset - RoundPeriods(offset, period) * period) / static_cast<double>(period);
+            sum_sin += std::sin(angle);
+            sum_cos += std::cos(angle);
+        }
+        phase = newest + std::llround(std::atan2(sum_sin, sum_cos) / two_pi * static_cast<double>(period));
+
+        RefitInliers(count);
+    }
+
+    void GB_FrameTimer::RefitInliers(uint32_t count) {
+        // Samples further off the grid than a few times the typical deviation are outliers, like a vblank read late after a stall
+        std::array<int64_t, history_size> periods;
+        std::array<int64_t, history_size> deviations;
+        for (uint32_t i = 0; i < count; i++) {
+            const int64_t offset = GetSample(i) - phase;
+            periods[i] = RoundPeriods(offset, period);
+            deviations[i] = std::abs(offset - periods[i] * period);
+        }
+        std::array<int64_t, history_size> sorted_deviations = deviations;
+        const int64_t tolerance = std::max(Median(sorted_deviations, count) * 4, period / 100);
+
+        double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+        uint32_t inliers = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            if (deviations[i] > tolerance) {
+                continue;
+            }
+            const double x = static_cast<double>(periods[i]);
+            const double y = static_cast<double>(GetSample(i) - phase);
+            sum_x += x;
+            sum_y += y;
+            sum_xx += x * x;
+            sum_xy += x * y;
+            inliers++;
+        }
+        if (inliers < 8) {
+            return;
+        }
+
+        const double spread = inliers * sum_xx - sum_x * sum_x;
+        if (spread <= 0.0) {
+            return;
+        }
+        const double slope = (inliers * sum_xy - sum_x * sum_y) / spread;
+        const int64_t fitted_period = std::llround(slope);
+        if (fitted_period < nominal_period * 3 / 4 || fitted_period > nominal_period * 5 / 4) {
+            return;
+        }
+        period = fitted_period;
+        phase += std::llround((sum_y - slope * sum_x) / inliers);
+    }
+
+    void GB_FrameTimer::AddRenderLatency(int64_t duration) {
+        std::lock_guard guard(mutex);
+        render_latency += (std::max<int64_t>(duration, 0) - render_latency) / latency_smoothing;
+    }
+
+    void GB_FrameTimer::AddCompositorLatency(int64_t duration) {
+        std::lock_guard guard(mutex);
+        compositor_latency += (std::max<int64_t>(duration, 0) - compositor_latency) / latency_smoothing;
+    }
+
+    void GB_FrameTimer::StartFrame() {
+        const int64_t now = clock.Now();
+
+        std::lock_guard guard(mutex);
+        // Forget the oldest frame if the application never ended it
+        if (frames_started - frames_ended == max_started_frames) {
+            frames_ended++;
+        }
+        frame_start_times[frames_started % max_started_frames] = now;
+        frames_started++;
+    }
+
+    void GB_FrameTimer::EndFrame() {
+        const int64_t now = clock.Now();
+
+        int64_t start;
+        {
+            std::lock_guard guard(mutex);
+            if (frames_started == frames_ended) {
+                return;
+            }
+            start = frame_start_times[frames_ended % max_started_frames];
+            frames_ended++;
+        }
+        AddRenderLatency(now - start);
+    }
+
+    GB_FramePrediction GB_FrameTimer::PredictFrame() const {
+        const int64_t now = clock.Now();
+
+        std::lock_guard guard(mutex);
+        GB_FramePrediction prediction;
+        prediction.display_period = period;
+
+        // The frame can't be shown before the application rendered it and the compositor weaved it
+        prediction.display_time = NextVblankLocked(now + render_latency + compositor_latency);
+        return prediction;
+    }
+
+    int64_t GB_FrameTimer::GetNextVblank(int64_t time) const {
+        std::lock_guard guard(mutex);
+        return NextVblankLocked(time);
+    }
+
+    int64_t GB_FrameTimer::NextVblankLocked(int64_t time) const {
+        const int64_t offset = time - phase;
+        const int64_t periods = offset >= 0 ? (offset + period - 1) / period : -((-offset) / period);
+        return phase + periods * period;
+    }
+
+    int64_t GB_FrameTimer::GetPeriod() const {
+        std::lock_guard guard(mutex);
+        return period;
+    }
+
+    int64_t GB_FrameTimer::GetPhase() const {
+        std::lock_guard guard(mutex);
+        return phase;
+    }
+}
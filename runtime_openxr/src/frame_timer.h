@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace XRGameBridge {
+    // Time source of the frame timer, returns nanoseconds on the same timebase as XrTime.
+    // Injected so the predictor can run against a simulated clock.
+    class GB_Clock {
+    public:
+        virtual ~GB_Clock() = default;
+        virtual int64_t Now() const = 0;
+    };
+
+    // XrTime of a session, nanoseconds since the session epoch
+    class GB_SessionClock : public GB_Clock {
+        std::chrono::high_resolution_clock::time_point epoch = std::chrono::high_resolution_clock::now();
+
+    public:
+        void SetEpoch(std::chrono::high_resolution_clock::time_point session_epoch) {
+            epoch = session_epoch;
+        }
+
+        int64_t Now() const override {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - epoch).count();
+        }
+    };
+
+    struct GB_FramePrediction {
+        int64_t display_time;
+        int64_t display_period;
+    };
+
+    // Predicts when the frame that is being started will be shown on the display.
+    // Keeps a history of vblank timestamps and estimates the refresh period and phase from it.
+    // A median period and the average position of the samples within a period give a first estimate that missed vblanks, doubled frames
+    // and scheduling hiccups don't pull far off. A least squares fit through the samples close to that grid then refines it.
+    // The display time is the first vblank after the application and the compositor are expected to be done with the frame.
+    //
+    // Threading: xrWaitFrame predicts while xrEndFrame adds samples, possibly from another thread, so every call takes a mutex.
+    class GB_FrameTimer {
+        static constexpr uint32_t history_size = 32;
+        // Latency estimates are exponential moving averages, 1/8 weight for each new sample
+        static constexpr int64_t latency_smoothing = 8;
+
+        const GB_Clock& clock;
+        mutable std::mutex mutex;
+
+        std::array<int64_t, history_size> vblanks{};
+        uint32_t vblank_count = 0; // Total number of samples, the newest is at (vblank_count - 1) % history_size
+
+        int64_t nominal_period;
+        int64_t period;
+        int64_t phase = 0; // Time of a vblank, every other vblank is a whole number of periods away from it
+
+        int64_t render_latency;
+        int64_t compositor_latency = 0;
+
+        // Start times of frames handed out and not ended yet, the application may wait for the next frame before ending the current one
+        static constexpr uint32_t max_started_frames = 4;
+        std::array<int64_t, max_started_frames> frame_start_times{};
+        uint32_t frames_started = 0;
+        uint32_t frames_ended = 0;
+
+        // Must be called with the mutex held
+        void UpdateEstimates();
+        // Returns false if there were not enough usable samples
+        bool EstimatePeriod(uint32_t span);
+        void RefitInliers(uint32_t count);
+        // Oldest sample is 0
+        int64_t GetSample(uint32_t index) const;
+        int64_t NextVblankLocked(int64_t time) const;
+
+    public:
+        explicit GB_FrameTimer(const GB_Clock& clock, double refresh_rate = 60.0);
+
+        GB_FrameTimer(const GB_FrameTimer& other) = delete;
+        GB_FrameTimer& operator=(const GB_FrameTimer& other) = delete;
+
+        // Refresh rate reported by the display, used until there are enough vblanks to measure it.
+        // Also bounds the measured period so a stalled display can't make the estimate drift far away.
+        void SetNominalRefreshRate(double refresh_rate);
+
+        // Time a vblank happened, in clock time
+        void AddVblank(int64_t time);
+
+        // Time from the frame being handed to the application in xrWaitFrame until xrEndFrame
+        void AddRenderLatency(int64_t duration);
+
+        // Time from xrEndFrame until the frame was handed to the display
+        void AddCompositorLatency(int64_t duration);
+
+        // Remembers when xrWaitFrame handed out a frame, measures the render latency when EndFrame is called
+        void StartFrame();
+        void EndFrame();
+
+        GB_FramePrediction PredictFrame() const;
+
+        // Display time of the first vblank at or after time
+        int64_t GetNextVblank(int64_t time) const;
+
+        int64_t GetPeriod() const;
+        int64_t GetPhase() const;
+    };
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include <openxr/openxr.h>
+
+namespace XRGameBridge {
+    // What the swapchain functions need from a graphics API, images are handed out in order and waited and released oldest first
+    class GB_SwapchainBackend {
+    public:
+        virtual ~GB_SwapchainBackend() = default;
+
+        virtual uint32_t GetBufferCount() const = 0;
+
+        // Returns the oldest image index
+        virtual XrResult AcquireNextImage(uint32_t& index) = 0;
+
+        // Waits until the oldest acquired image can be rendered to
+        virtual XrResult WaitForImage(const XrDuration& timeout) = 0;
+
+        // Make the image available for composition
+        virtual XrResult ReleaseImage() = 0;
+    };
+
+    // Turns the layers of a frame into the output image
+    class GB_CompositorBackend {
+    public:
+        virtual ~GB_CompositorBackend() = default;
+
+        virtual XrResult ComposeFrame(const XrFrameEndInfo* frame_end_info) = 0;
+    };
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "expected.h"
+
+namespace XRGameBridge {
+    // Tags stored in the upper bits of every handle so handles of different object types never alias each other.
+    // Spaces use two tags so xrLocateSpace and xrDestroySpace can tell reference spaces and action spaces apart without probing,
+    // swapchains use two so the swapchain functions can tell D3D12 and null backend swapchains apart the same way.
+    enum HandleType : uint8_t {
+        HANDLE_TYPE_NONE = 0,
+        HANDLE_TYPE_SESSION,
+        HANDLE_TYPE_SWAPCHAIN,
+        HANDLE_TYPE_REFERENCE_SPACE,
+        HANDLE_TYPE_ACTION_SPACE,
+        HANDLE_TYPE_ACTION_SET,
+        HANDLE_TYPE_ACTION,
+        HANDLE_TYPE_NULL_SWAPCHAIN,
+    };
+
+    // Handle layout: [8 bit type][24 bit generation][32 bit slot index]
+    // Live slots always have an odd generation, so a valid handle is never XR_NULL_HANDLE.
+    constexpr uint64_t g_handle_index_mask = 0xFFFFFFFFull;
+    constexpr uint32_t g_handle_generation_mask = 0xFFFFFF;
+    constexpr uint32_t g_handle_generation_shift = 32;
+    constexpr uint32_t g_handle_type_shift = 56;
+
+    inline HandleType GetHandleType(uint64_t handle) {
+        return static_cast<HandleType>(handle >> g_handle_type_shift);
+    }
+
+    template <typename Handle>
+    HandleType GetHandleType(Handle handle) {
+        return GetHandleType(reinterpret_cast<uint64_t>(handle));
+    }
+
+    // Generational slot map that owns the runtime objects behind OpenXR handles.
+    // Lookups index straight into the slot and compare the generation, so there is no hashing and stale or foreign handles are rejected.
+    //
+    // Threading: Get and ForEach never lock, they are safe to call from any thread while other threads create or destroy objects.
+    // Create and Destroy are serialized by a mutex per table, they only happen at setup so the frame path never touches it.
+    // Pages are allocated once and only freed with the table, so a reader can never see a page disappear underneath it.
+    // Destroying an object that another thread is still using is an application error, the OpenXR spec requires external synchronization for that.
+    template <typename Handle, typename T, uint32_t PageSize = 64, uint32_t MaxPages = 256>
+    class GB_HandleTable {
+        struct Slot {
+            std::optional<T> value;
+            // Odd while the slot holds an object, even while it is free
+            std::atomic<uint32_t> generation = 0;
+        };
+        using Page = std::array<Slot, PageSize>;
+
+        HandleType type;
+        std::array<std::atomic<Page*>, MaxPages> pages{};
+        std::atomic<uint32_t> slot_count = 0;
+        std::atomic<uint32_t> live_count = 0;
+
+        std::mutex write_mutex;
+        std::vector<uint32_t> free_slots;
+
+        Slot* GetSlot(uint32_t index) const {
+            if (index >= slot_count.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            Page* page = pages[index / PageSize].load(std::memory_order_acquire);
+            if (page == nullptr) {
+                return nullptr;
+            }
+            return &(*page)[index % PageSize];
+        }
+
+        Handle MakeHandle(uint32_t index, uint32_t generation) const {
+            uint64_t value = (static_cast<uint64_t>(type) << g_handle_type_shift) |
+                (static_cast<uint64_t>(generation & g_handle_generation_mask) << g_handle_generation_shift) |
+                index;
+            return reinterpret_cast<Handle>(value);
+        }
+
+        // Must be called with write_mutex held, returns nullptr when the table is full
+        Slot* AllocateSlot(uint32_t& index) {
+            if (!free_slots.empty()) {
+                index = free_slots.back();
+                free_slots.pop_back();
+                return GetSlot(index);
+            }
+
+            index = slot_count.load(std::memory_order_relaxed);
+            const uint32_t page_index = index / PageSize;
+            if (page_index >= MaxPages) {
+                return nullptr;
+            }
+            if (pages[page_index].load(std::memory_order_relaxed) == nullptr) {
+                pages[page_index].store(new Page(), std::memory_order_release);
+            }
+            slot_count.store(index + 1, std::memory_order_release);
+            return GetSlot(index);
+        }
+
+        // Must be called with write_mutex held
+        template <typename... Args>
+        Handle EmplaceLocked(Args&&... args) {
+            uint32_t index;
+            Slot* slot = AllocateSlot(index);
+            if (slot == nullptr) {
+                return Handle{};
+            }
+
+            slot->value.emplace(std::forward<Args>(args)...);
+            // Publish the object, readers that see the new generation also see the constructed value
+            const uint32_t generation = (slot->generation.load(std::memory_order_relaxed) + 1) & g_handle_generation_mask;
+            slot->generation.store(generation, std::memory_order_release);
+            live_count.fetch_add(1, std::memory_order_relaxed);
+            return MakeHandle(index, generation);
+        }
+
+    public:
+        explicit GB_HandleTable(HandleType type) : type(type) {
+        }
+
+        ~GB_HandleTable() {
+            for (auto& page : pages) {
+                delete page.load(std::memory_order_relaxed);
+            }
+        }
+
+        GB_HandleTable(const GB_HandleTable& other) = delete;
+        GB_HandleTable& operator=(const GB_HandleTable& other) = delete;
+
+        // Constructs a new object in place and returns its handle, returns XR_NULL_HANDLE when the table is full
+        template <typename... Args>
+        Handle Create(Args&&... args) {
+            std::lock_guard guard(write_mutex);
+            return EmplaceLocked(std::forward<Args>(args)...);
+        }
+
+        // Same as Create, but returns XR_NULL_HANDLE without creating anything if is_duplicate(object) holds for a live object.
+        // The check and the insertion happen under the same lock, so two threads can't register the same name.
+        template <typename Predicate, typename... Args>
+        Handle CreateUnique(Predicate&& is_duplicate, Args&&... args) {
+            std::lock_guard guard(write_mutex);
+
+            bool duplicate = false;
+            ForEach([&](Handle, T& object) {
+                duplicate = duplicate || is_duplicate(object);
+            });
+            if (duplicate) {
+                return Handle{};
+            }
+
+            return EmplaceLocked(std::forward<Args>(args)...);
+        }
+
+        // Returns nullptr for XR_NULL_HANDLE, destroyed handles and handles of another type
+        T* Get(Handle handle) const {
+            const uint64_t value = reinterpret_cast<uint64_t>(handle);
+            if (GetHandleType(value) != type) {
+                return nullptr;
+            }
+
+            Slot* slot = GetSlot(static_cast<uint32_t>(value & g_handle_index_mask));
+            if (slot == nullptr) {
+                return nullptr;
+            }
+
+            const uint32_t generation = slot->generation.load(std::memory_order_acquire);
+            if ((generation & 1) == 0 || generation != ((value >> g_handle_generation_shift) & g_handle_generation_mask)) {
+                return nullptr;
+            }
+            // Only the address, the slot may be destroyed right after the generation check when the handle is stale
+            return &*slot->value;
+        }
+
+        // Same as Get, but carries the result the entry point should return for an invalid handle
+        GB_Expected<T&> Find(Handle handle) const {
+            T* object = Get(handle);
+            if (object == nullptr) {
+                return GB_Expected<T&>::Error(XR_ERROR_HANDLE_INVALID);
+            }
+            return *object;
+        }
+
+        bool Contains(Handle handle) const {
+            return Get(handle) != nullptr;
+        }
+
+        // Destroys the object, the handle and any copies of it become invalid
+        bool Destroy(Handle handle) {
+            std::lock_guard guard(write_mutex);
+            if (Get(handle) == nullptr) {
+                return false;
+            }
+
+            const uint32_t index = static_cast<uint32_t>(reinterpret_cast<uint64_t>(handle) & g_handle_index_mask);
+            Slot* slot = GetSlot(index);
+
+            // Retire the handle before destroying the object so new lookups fail first
+            const uint32_t generation = slot->generation.load(std::memory_order_relaxed);
+            slot->generation.store((generation + 1) & g_handle_generation_mask, std::memory_order_release);
+            slot->value.reset();
+
+            free_slots.push_back(index);
+            live_count.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Calls func(handle, object) for every live object
+        template <typename Func>
+        void ForEach(Func&& func) const {
+            const uint32_t count = slot_count.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < count; i++) {
+                Slot* slot = GetSlot(i);
+                const uint32_t generation = slot->generation.load(std::memory_order_acquire);
+                if ((generation & 1) != 0) {
+                    func(MakeHandle(i, generation), *slot->value);
+                }
+            }
+        }
+
+        uint32_t Size() const {
+            return live_count.load(std::memory_order_relaxed);
+        }
+    };
+}
@@ -0,0 +1,202 @@
+#include "heap_allocator.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace XRGameBridge {
+    namespace {
+        uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    GB_HeapAllocator::GB_HeapAllocator(GB_HeapDevice& device, const GB_HeapAllocatorConfig& config) : device(device), config(config) {
+        this->config.granularity = std::max<uint64_t>(config.granularity, 1);
+        this->config.heap_size = std::max(config.heap_size, this->config.granularity);
+    }
+
+    GB_HeapAllocator::~GB_HeapAllocator() {
+        for (const Heap& heap : heaps) {
+            device.DestroyHeap(heap.id);
+        }
+    }
+
+    uint32_t GB_HeapAllocator::GetSizeClass(uint64_t units) {
+        if (units <= 4) {
+            return static_cast<uint32_t>(std::max<uint64_t>(units, 1) - 1);
+        }
+
+        // Above 4 units a power of two is split into 4, 5, 6 and 7 quarters of it
+        uint32_t power = static_cast<uint32_t>(std::bit_width(units)) - 1;
+        const uint64_t step = 1ull << (power - 2);
+        uint64_t steps = (units + step - 1) / step;
+        if (steps == 8) {
+            power++;
+            steps = 4;
+        }
+        return 4 * (power - 1) + static_cast<uint32_t>(steps - 4) - 1;
+    }
+
+    uint64_t GB_HeapAllocator::GetClassUnits(uint32_t size_class) {
+        if (size_class < 4) {
+            return size_class + 1;
+        }
+        const uint32_t position = size_class + 1;
+        return (position % 4 + 4ull) << (position / 4 - 1);
+    }
+
+    GB_HeapAllocator::Heap* GB_HeapAllocator::FindHeap(uint64_t id) {
+        for (Heap& heap : heaps) {
+            if (heap.id == id) {
+                return &heap;
+            }
+        }
+        return nullptr;
+    }
+
+    bool GB_HeapAllocator::PopFreeBlock(uint32_t size_class, uint64_t alignment, Block& block) {
+        if (size_class >= free_blocks.size()) {
+            return false;
+        }
+
+        // Most recently freed first, that memory is the most likely to still be resident
+        std::vector<Block>& blocks = free_blocks[size_class];
+        for (size_t i = blocks.size(); i-- > 0;) {
+            if (blocks[i].offset % alignment != 0 || FindHeap(blocks[i].heap)->alignment < alignment) {
+                continue;
+            }
+            block = blocks[i];
+            blocks.erase(blocks.begin() + i);
+            return true;
+        }
+        return false;
+    }
+
+    bool GB_HeapAllocator::CarveBlock(uint64_t size, uint64_t alignment, Block& block) {
+        const bool dedicated = size > config.heap_size / 2;
+        if (!dedicated) {
+            for (Heap& heap : heaps) {
+                if (heap.dedicated || heap.alignment < alignment) {
+                    continue;
+                }
+                const uint64_t offset = AlignUp(heap.top, alignment);
+                if (offset + size <= heap.size) {
+                    heap.top = offset + size;
+                    block = { heap.id, offset };
+                    return true;
+                }
+            }
+        }
+
+        const uint64_t heap_size = dedicated ? size : config.heap_size;
+        uint64_t id = device.CreateHeap(heap_size, alignment);
+        if (id == 0 && !heaps.empty()) {
+            // Memory held for other size classes may be what's missing
+            Trim();
+            id = device.CreateHeap(heap_size, alignment);
+        }
+        if (id == 0) {
+            return false;
+        }
+
+        heaps.push_back({ id, heap_size, alignment, size, 0, dedicated });
+        stats.heap_count++;
+        stats.heap_bytes += heap_size;
+        stats.heaps_created++;
+        block = { id, 0 };
+        return true;
+    }
+
+    GB_HeapAllocation GB_HeapAllocator::Allocate(uint64_t size, uint64_t alignment) {
+        GB_HeapAllocation allocation;
+        if (size == 0) {
+            return allocation;
+        }
+        alignment = std::max<uint64_t>(alignment, 1);
+
+        const uint32_t size_class = GetSizeClass((size + config.granularity - 1) / config.granularity);
+        const uint64_t block_size = GetClassUnits(size_class) * config.granularity;
+
+        Block block;
+        if (PopFreeBlock(size_class, alignment, block)) {
+            stats.free_bytes -= block_size;
+            stats.reused_allocations++;
+        }
+        else if (!CarveBlock(block_size, alignment, block)) {
+            return allocation;
+        }
+
+        FindHeap(block.heap)->used_blocks++;
+        stats.allocations++;
+        stats.used_bytes += block_size;
+        stats.requested_bytes += size;
+
+        allocation.heap = block.heap;
+        allocation.offset = block.offset;
+        allocation.size = block_size;
+        allocation.requested_size = size;
+        return allocation;
+    }
+
+    void GB_HeapAllocator::Free(const GB_HeapAllocation& allocation, uint64_t fence_value) {
+        if (!allocation.IsValid()) {
+            return;
+        }
+        retired_blocks.push_back({ allocation, fence_value });
+    }
+
+    void GB_HeapAllocator::Reclaim(uint64_t completed_fence_value) {
+        auto completed = [&](const RetiredBlock& retired) {
+            if (retired.fence_value > completed_fence_value) {
+                return false;
+            }
+
+            const GB_HeapAllocation& allocation = retired.allocation;
+            const uint32_t size_class = GetSizeClass(allocation.size / config.granularity);
+            if (size_class >= free_blocks.size()) {
+                free_blocks.resize(size_class + 1);
+            }
+            free_blocks[size_class].push_back({ allocation.heap, allocation.offset });
+
+            FindHeap(allocation.heap)->used_blocks--;
+            stats.used_bytes -= allocation.size;
+            stats.requested_bytes -= allocation.requested_size;
+            stats.free_bytes += allocation.size;
+            return true;
+        };
+        retired_blocks.erase(std::remove_if(retired_blocks.begin(), retired_blocks.end(), completed), retired_blocks.end());
+    }
+
+    void GB_HeapAllocator::Trim() {
+        auto unused = [&](const Heap& heap) {
+            if (heap.used_blocks > 0) {
+                return false;
+            }
+
+            for (std::vector<Block>& blocks : free_blocks) {
+                auto in_heap = [&](const Block& block) {
+                    return block.heap == heap.id;
+                };
+                blocks.erase(std::remove_if(blocks.begin(), blocks.end(), in_heap), blocks.end());
+            }
+            device.DestroyHeap(heap.id);
+
+            stats.heap_count--;
+            stats.heap_bytes -= heap.size;
+            return true;
+        };
+        heaps.erase(std::remove_if(heaps.begin(), heaps.end(), unused), heaps.end());
+
+        // Only blocks of the remaining heaps are left
+        stats.free_bytes = 0;
+        for (uint32_t size_class = 0; size_class < free_blocks.size(); size_class++) {
+            stats.free_bytes += free_blocks[size_class].size() * GetClassUnits(size_class) * config.granularity;
+        }
+    }
+
+    GB_HeapAllocatorStats GB_HeapAllocator::GetStats() const {
+        GB_HeapAllocatorStats result = stats;
+        result.unused_bytes = stats.heap_bytes - stats.used_bytes - stats.free_bytes;
+        return result;
+    }
+}
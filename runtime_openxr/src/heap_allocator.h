@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace XRGameBridge {
+    // What the heap allocator needs from a graphics device, so the allocation policy can run against a mock without a GPU.
+    // Sizes and offsets are in whatever unit the device uses, bytes for memory heaps and descriptors for descriptor heaps.
+    class GB_HeapDevice {
+    public:
+        virtual ~GB_HeapDevice() = default;
+
+        // Returns an id other than 0, or 0 when the device is out of memory
+        virtual uint64_t CreateHeap(uint64_t size, uint64_t alignment) = 0;
+        virtual void DestroyHeap(uint64_t heap) = 0;
+    };
+
+    struct GB_HeapAllocation {
+        // 0 when the allocation failed
+        uint64_t heap = 0;
+        uint64_t offset = 0;
+        // Size of the block, the requested size rounded up to its size class
+        uint64_t size = 0;
+        uint64_t requested_size = 0;
+
+        bool IsValid() const {
+            return heap != 0;
+        }
+    };
+
+    struct GB_HeapAllocatorConfig {
+        // Blocks are placed in heaps of this size, blocks larger than half of it get a heap of their own
+        uint64_t heap_size = 64ull * 1024 * 1024;
+        // Smallest block, every block size is a multiple of it
+        uint64_t granularity = 64 * 1024;
+    };
+
+    struct GB_HeapAllocatorStats {
+        uint32_t heap_count = 0;
+        // Held from the device
+        uint64_t heap_bytes = 0;
+        // Blocks in use, including freed blocks the GPU may still read
+        uint64_t used_bytes = 0;
+        // What the blocks in use were requested with, the rest of used_bytes is lost to size class rounding
+        uint64_t requested_bytes = 0;
+        // Blocks in the free lists, only allocations of the same size class can reuse them
+        uint64_t free_bytes = 0;
+        // Heap space never handed out, including alignment padding
+        uint64_t unused_bytes = 0;
+
+        uint64_t allocations = 0;
+        // Allocations served from a free list
+        uint64_t reused_allocations = 0;
+        uint64_t heaps_created = 0;
+
+        // Fraction of the used bytes lost to rounding
+        double GetInternalFragmentation() const {
+            return used_bytes > 0 ? static_cast<double>(used_bytes - requested_bytes) / used_bytes : 0.0;
+        }
+
+        // Fraction of the held memory that isn't in use
+        double GetExternalFragmentation() const {
+            return heap_bytes > 0 ? static_cast<double>(free_bytes + unused_bytes) / heap_bytes : 0.0;
+        }
+    };
+
+    // Sub-allocates blocks from large heaps, for placing swapchain images and descriptors without a device allocation per object.
+    //
+    // Requests are rounded up to size classes, four per power of two, so a block wastes less than a quarter of its size.
+    // Blocks are carved from the heaps front to back and never split or merged. Freed blocks go to the free list of their class and
+    // are handed out again first, swapchains being recreated at the same size reuse their old memory without touching the device.
+    //
+    // Freed blocks may still be read by the GPU, Free takes the fence value after which that is no longer the case and Reclaim
+    // moves the blocks whose value completed to the free lists. Not thread safe, the owner serializes calls.
+    class GB_HeapAllocator {
+        struct Heap {
+            uint64_t id;
+            uint64_t size;
+            uint64_t alignment;
+            // Front of the space not handed out yet
+            uint64_t top;
+            // Blocks in use or waiting for the GPU
+            uint32_t used_blocks;
+            // Holds a single block too large to share a heap
+            bool dedicated;
+        };
+
+        struct Block {
+            uint64_t heap;
+            uint64_t offset;
+        };
+
+        struct RetiredBlock {
+            GB_HeapAllocation allocation;
+            uint64_t fence_value;
+        };
+
+        GB_HeapDevice& device;
+        GB_HeapAllocatorConfig config;
+
+        std::vector<Heap> heaps;
+        // Indexed by size class
+        std::vector<std::vector<Block>> free_blocks;
+        std::vector<RetiredBlock> retired_blocks;
+
+        GB_HeapAllocatorStats stats;
+
+        Heap* FindHeap(uint64_t id);
+        bool PopFreeBlock(uint32_t size_class, uint64_t alignment, Block& block);
+        bool CarveBlock(uint64_t size, uint64_t alignment, Block& block);
+
+    public:
+        GB_HeapAllocator(GB_HeapDevice& device, const GB_HeapAllocatorConfig& config);
+        // Destroys every heap, blocks still in use become invalid
+        ~GB_HeapAllocator();
+
+        GB_HeapAllocator(const GB_HeapAllocator&) = delete;
+        GB_HeapAllocator& operator=(const GB_HeapAllocator&) = delete;
+
+        // Size class of a request in granularity units, and the units the class holds
+        static uint32_t GetSizeClass(uint64_t units);
+        static uint64_t GetClassUnits(uint32_t size_class);
+
+        // Offsets are multiples of the alignment. Invalid allocation when the device is out of memory.
+        GB_HeapAllocation Allocate(uint64_t size, uint64_t alignment);
+        // The block can be reused once Reclaim is called with fence_value or later
+        void Free(const GB_HeapAllocation& allocation, uint64_t fence_value);
+        void Reclaim(uint64_t completed_fence_value);
+        // Destroys heaps without blocks in use, their free blocks are dropped
+        void Trim();
+
+        GB_HeapAllocatorStats GetStats() const;
+    };
+}
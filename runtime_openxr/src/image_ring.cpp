@@ -0,0 +1,95 @@
+#include "image_ring.h"
+
+#include <algorithm>
+
+namespace XRGameBridge {
+    GB_ImageRing::GB_ImageRing(uint32_t image_count) {
+        Reset(image_count);
+    }
+
+    void GB_ImageRing::Reset(uint32_t count) {
+        image_count = std::min(count, max_images);
+        for (auto& image : images) {
+            image.store(MakeWord(0, IMAGE_STATE_RELEASED), std::memory_order_relaxed);
+        }
+        acquire_position.store(0, std::memory_order_relaxed);
+        release_position.store(0, std::memory_order_relaxed);
+        released_index.store(UINT32_MAX, std::memory_order_release);
+    }
+
+    uint32_t GB_ImageRing::GetImageCount() const {
+        return image_count;
+    }
+
+    XrResult GB_ImageRing::Acquire(uint32_t& index) {
+        if (image_count == 0) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+
+        uint64_t position = acquire_position.load(std::memory_order_relaxed);
+        for (;;) {
+            // The image is free once the release of the previous lap moved it into this lap
+            const uint32_t image = static_cast<uint32_t>(position % image_count);
+            if (images[image].load(std::memory_order_acquire) != MakeWord(GetLap(position), IMAGE_STATE_RELEASED)) {
+                return XR_ERROR_CALL_ORDER_INVALID;
+            }
+            // Only the thread that advances the position may touch the image
+            if (acquire_position.compare_exchange_weak(position, position + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                images[image].store(MakeWord(GetLap(position), IMAGE_STATE_ACQUIRED), std::memory_order_release);
+                index = image;
+                return XR_SUCCESS;
+            }
+        }
+    }
+
+    XrResult GB_ImageRing::BeginWait(uint32_t& index) {
+        if (image_count == 0) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+
+        // Released images are skipped, so the oldest acquired image is at the release position.
+        // It being waited on or waited already means the previous wait wasn't released yet.
+        const uint64_t position = release_position.load(std::memory_order_acquire);
+        const uint32_t image = static_cast<uint32_t>(position % image_count);
+        uint64_t expected = MakeWord(GetLap(position), IMAGE_STATE_ACQUIRED);
+        if (!images[image].compare_exchange_strong(expected, MakeWord(GetLap(position), IMAGE_STATE_WAITING), std::memory_order_acq_rel)) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+        index = image;
+        return XR_SUCCESS;
+    }
+
+    void GB_ImageRing::EndWait(uint32_t index, bool ready) {
+        // The image is owned by the waiting thread, nothing else changes its word
+        const uint64_t lap = images[index].load(std::memory_order_relaxed) >> lap_shift;
+        images[index].store(MakeWord(lap, ready ? IMAGE_STATE_WAITED : IMAGE_STATE_ACQUIRED), std::memory_order_release);
+    }
+
+    XrResult GB_ImageRing::Release(uint32_t& index) {
+        if (image_count == 0) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+
+        const uint64_t position = release_position.load(std::memory_order_acquire);
+        const uint32_t image = static_cast<uint32_t>(position % image_count);
+        const uint64_t lap = GetLap(position);
+        uint64_t expected = MakeWord(lap, IMAGE_STATE_WAITED);
+        // Moving the image into the next lap makes it acquirable again
+        if (!images[image].compare_exchange_strong(expected, MakeWord(lap + 1, IMAGE_STATE_RELEASED), std::memory_order_acq_rel)) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+        released_index.store(image, std::memory_order_release);
+        release_position.store(position + 1, std::memory_order_release);
+        index = image;
+        return XR_SUCCESS;
+    }
+
+    uint32_t GB_ImageRing::GetReleasedIndex() const {
+        return released_index.load(std::memory_order_acquire);
+    }
+
+    uint32_t GB_ImageRing::GetAcquiredCount() const {
+        const uint64_t released = release_position.load(std::memory_order_acquire);
+        return static_cast<uint32_t>(acquire_position.load(std::memory_order_acquire) - released);
+    }
+}
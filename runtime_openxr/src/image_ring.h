@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include <openxr/openxr.h>
+
+namespace XRGameBridge {
+    // Image lifecycle of a swapchain in the order the specification requires, without locks.
+    // Images are acquired round robin, up to the image count at once. The oldest acquired image is waited on and then released,
+    // only one image can be waited on until it is released. Every call may come from a different thread.
+    //
+    // Each image has a state word holding its state and the lap of the ring it is in, the image at ring position p is in lap p / image count.
+    // Acquire claims a position by advancing the acquire position, wait and release move the image at the release position along.
+    // Transitions are compare exchanges on the state word, so a call racing another call on the same image fails with
+    // XR_ERROR_CALL_ORDER_INVALID instead of corrupting the ring. Calls that are ordered by the application never fail spuriously.
+    class GB_ImageRing {
+    public:
+        static constexpr uint32_t max_images = 8;
+
+    private:
+        enum ImageState : uint64_t {
+            IMAGE_STATE_RELEASED = 0,
+            IMAGE_STATE_ACQUIRED = 1,
+            // Claimed by a wait that hasn't finished yet
+            IMAGE_STATE_WAITING = 2,
+            IMAGE_STATE_WAITED = 3,
+        };
+        static constexpr uint64_t state_mask = 3;
+        static constexpr uint32_t lap_shift = 2;
+
+        static uint64_t MakeWord(uint64_t lap, ImageState state) {
+            return (lap << lap_shift) | state;
+        }
+
+        uint32_t image_count = 0;
+        std::array<std::atomic<uint64_t>, max_images> images;
+
+        // Acquire and release usually happen on different threads
+        alignas(64) std::atomic<uint64_t> acquire_position = 0;
+        alignas(64) std::atomic<uint64_t> release_position = 0;
+        std::atomic<uint32_t> released_index = UINT32_MAX;
+
+        uint64_t GetLap(uint64_t position) const {
+            return position / image_count;
+        }
+
+    public:
+        explicit GB_ImageRing(uint32_t image_count = 0);
+
+        // Every image released, no calls may be in progress
+        void Reset(uint32_t count);
+        uint32_t GetImageCount() const;
+
+        // XR_ERROR_CALL_ORDER_INVALID when every image is acquired
+        XrResult Acquire(uint32_t& index);
+
+        // Claims the oldest acquired image for waiting, the caller waits for the GPU and then calls EndWait
+        XrResult BeginWait(uint32_t& index);
+        // Makes the image renderable, or returns it to acquired after a timeout so the wait can be repeated
+        void EndWait(uint32_t index, bool ready);
+
+        // Releases the waited image
+        XrResult Release(uint32_t& index);
+
+        // Most recently released image, what the compositor reads. UINT32_MAX until the first release.
+        uint32_t GetReleasedIndex() const;
+        // Images acquired and not released yet, only exact while no calls are in progress
+        uint32_t GetAcquiredCount() const;
+    };
+}
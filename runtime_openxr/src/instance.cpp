@@ -1,13 +1,15 @@
 #include "instance.h"
 
-#include <stdexcept>
 #include <vector>
 #include <set>
 
 #include <easylogging++.h>
 
 #include "actions.h"
+#include "fence_waiter.h"
+#include "logging.h"
 #include "openxr_functions.h"
+#include "settings.h"
 #include "swapchain.h"
 #include "game_bridge_structs.h"
 #include "system.h"
@@ -26,19 +28,19 @@
 using namespace XRGameBridge;
 
 XrResult xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
-    try {
-        *function = openxr_functions.at(name);
-    }
-    catch (std::out_of_range& e) {
-        LOG(WARNING) << "FUNCTION UNSUPPORTED: " << name << " Error: " << e.what();
-        return XR_ERROR_FUNCTION_UNSUPPORTED;
-    }
-    catch (std::exception& e) {
-        return XR_ERROR_RUNTIME_FAILURE; // Generic error
+    const GB_FunctionEntry* entry = FindFunctionEntry(name);
+    if (entry != nullptr) {
+        *function = g_api_capture.IsEnabled() ? entry->resolve_capture(static_cast<uint16_t>(entry - openxr_functions.data())) : entry->resolve();
+        return XR_SUCCESS;
     }
 
-    LOG(INFO) << "Address retrieved: " << name;
-    return XR_SUCCESS;
+    *function = nullptr;
+
+    // Known extension functions are probed by most engines, only warn about names we have never heard of
+    if (!IsExtensionStubFunction(name)) {
+        GB_LOG(Warning, "FUNCTION UNSUPPORTED: {}", name);
+    }
+    return XR_ERROR_FUNCTION_UNSUPPORTED;
 }
 
 XrResult xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderInfo, XrNegotiateRuntimeRequest* runtimeRequest) {
@@ -50,6 +52,18 @@ XrResult xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderIn
     runtimeRequest->runtimeInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
     runtimeRequest->getInstanceProcAddr = &xrGetInstanceProcAddr;
 
+    // The loader resolves everything through getInstanceProcAddr after this, so the capture has to be running now
+    if (!g_runtime_settings.api_capture_path.empty() && !g_api_capture.IsEnabled()) {
+        std::array<std::string_view, openxr_functions.size()> function_names;
+        std::transform(openxr_functions.begin(), openxr_functions.end(), function_names.begin(), [](const GB_FunctionEntry& entry) { return entry.name; });
+        if (g_api_capture.Open(g_runtime_settings.api_capture_path, function_names.data(), static_cast<uint32_t>(function_names.size()))) {
+            LOG(INFO) << "Capturing OpenXR calls to " << g_runtime_settings.api_capture_path;
+        }
+        else {
+            LOG(WARNING) << "Failed to open OpenXR call capture " << g_runtime_settings.api_capture_path;
+        }
+    }
+
     LOG(INFO) << "\truntimeApiVersion %i", runtimeRequest->runtimeApiVersion;
     LOG(INFO) << "\truntimeInterfaceVersion %i", runtimeRequest->runtimeInterfaceVersion;
 
@@ -122,6 +136,7 @@ XrResult xrCreateInstance(const XrInstanceCreateInfo* createInfo, XrInstance* in
     for (uint32_t i = 0; i < createInfo->enabledExtensionCount; i++) {
         application_extensions.insert(application_extensions.end(), api_extensions[i]);
     }
+    const bool headless = application_extensions.contains(XR_MND_HEADLESS_EXTENSION_NAME);
     // Remove our extensions from application extensions
     for (auto extension : supported_extensions) {
         application_extensions.erase(extension.extensionName);
@@ -135,8 +150,12 @@ XrResult xrCreateInstance(const XrInstanceCreateInfo* createInfo, XrInstance* in
         return XR_ERROR_EXTENSION_NOT_PRESENT;
     }
 
+    // The log thread was stopped when a previous instance was destroyed
+    StartLog();
+
     // Create new instance
     g_gbinstance = new GB_Instance();
+    g_gbinstance->headless = headless;
     *instance = reinterpret_cast<XrInstance>(g_gbinstance);
 
     InitializeGameBridge();
@@ -172,6 +191,13 @@ XrResult xrDestroyInstance(XrInstance instance) {
 
     XRGameBridge::g_gbinstance = nullptr;
 
+    // Only one instance exists at a time, no session is left to wait on the GPU
+    ShutdownFenceWaiter();
+
+    // Make sure everything logged from the frame loop ends up in the log file and no thread is left running when the loader unloads the runtime.
+    // Not done on DLL_PROCESS_DETACH, joining a thread under the loader lock deadlocks.
+    ShutdownLog();
+
     // TODO Destroy game bridge instance perhaps with all its components
     g_game_bridge_instance = nullptr;
 
@@ -190,27 +216,23 @@ XrResult xrGetD3D11GraphicsRequirementsKHR(XrInstance instance, XrSystemId syste
         return XR_ERROR_SYSTEM_INVALID;
     }
 
-    try {
-        GB_System& system = g_systems.at(systemId);
+    auto system_lookup = FindSystem(systemId);
+    if (!system_lookup) {
+        return system_lookup.error();
+    }
+    GB_System& system = *system_lookup;
 
-        if (system.instance != instance) {
-            LOG(ERROR) << "Instance not bound to this system";
-            return XR_ERROR_HANDLE_INVALID;
-        }
+    if (system.instance != instance) {
+        LOG(ERROR) << "Instance not bound to this system";
+        return XR_ERROR_HANDLE_INVALID;
+    }
 
-        system.feature_level = D3D_FEATURE_LEVEL_11_0;
-        system.features_enumerated = true;
+    system.feature_level = D3D_FEATURE_LEVEL_11_0;
+    system.features_enumerated = true;
 
-        //GB_Instance gb_instance = instances.at(instance);
-        g_gbinstance->active_graphics_backend = GraphicsBackend::D3D11;
-        system.active_graphics_backend = GraphicsBackend::D3D11;
-    }
-    catch (std::out_of_range& e) {
-        return XR_ERROR_SYSTEM_INVALID;
-    }
-    catch (std::exception& e) {
-        return XR_ERROR_RUNTIME_FAILURE;
-    }
+    //GB_Instance gb_instance = instances.at(instance);
+    g_gbinstance->active_graphics_backend = GraphicsBackend::D3D11;
+    system.active_graphics_backend = GraphicsBackend::D3D11;
 
     // Give graphics requirements to the connected application
     DXGI_ADAPTER_DESC1 desc;
@@ -232,29 +254,25 @@ XrResult xrGetD3D12GraphicsRequirementsKHR(XrInstance instance, XrSystemId syste
         return XR_ERROR_SYSTEM_INVALID;
     }
 
-    try {
-        GB_System& system = g_systems.at(systemId);
+    auto system_lookup = FindSystem(systemId);
+    if (!system_lookup) {
+        return system_lookup.error();
+    }
+    GB_System& system = *system_lookup;
 
-        if (system.instance != instance) {
-            LOG(ERROR) << "Instance not bound to this system";
-            return XR_ERROR_HANDLE_INVALID;
-        }
+    if (system.instance != instance) {
+        LOG(ERROR) << "Instance not bound to this system";
+        return XR_ERROR_HANDLE_INVALID;
+    }
 
-        system.feature_level = D3D_FEATURE_LEVEL_11_0;
-        system.features_enumerated = true;
+    system.feature_level = D3D_FEATURE_LEVEL_11_0;
+    system.features_enumerated = true;
 
-        //GB_Instance gb_instance = instances.at(instance);
-        //TODO Do I need this in both? Maybe only in system sincen that the device that renders in the end
-        g_gbinstance->active_graphics_backend = GraphicsBackend::D3D12;
-        system.active_graphics_backend = GraphicsBackend::D3D12;
-        LOG(INFO) << "";
-    }
-    catch (std::out_of_range& e) {
-        return XR_ERROR_SYSTEM_INVALID;
-    }
-    catch (std::exception& e) {
-        return XR_ERROR_RUNTIME_FAILURE;
-    }
+    //GB_Instance gb_instance = instances.at(instance);
+    //TODO Do I need this in both? Maybe only in system sincen that the device that renders in the end
+    g_gbinstance->active_graphics_backend = GraphicsBackend::D3D12;
+    system.active_graphics_backend = GraphicsBackend::D3D12;
+    LOG(INFO) << "";
 
     // Give graphics requirements to the connected application
     DXGI_ADAPTER_DESC1 desc;
@@ -275,40 +293,11 @@ XrResult xrGetD3D12GraphicsRequirementsKHR(XrInstance instance, XrSystemId syste
 }
 
 XrResult xrStringToPath(XrInstance instance, const char* pathString, XrPath* path) {
-    XrPath xr_path = string_hasher(pathString);
-    *path = xr_path;
-
-    // Don't overwrite the path if it already exists
-    if (!g_xrpath_storage[xr_path].empty()) {
-        return XR_SUCCESS;
-    }
-
-    g_xrpath_storage[xr_path] = std::string(pathString);
-    *path = xr_path;
-
-    return XR_SUCCESS;
+    return XRGameBridge::StringToPath(g_path_table, pathString, path);
 }
 
 XrResult xrPathToString(XrInstance instance, XrPath path, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer) {
-    std::string string_path = g_xrpath_storage[path];
-
-    if (string_path.empty()) {
-        return XR_ERROR_PATH_INVALID;
-    }
-
-    uint32_t path_size = static_cast<uint32_t>(string_path.size());
-    *bufferCountOutput = path_size;
-
-    if (bufferCapacityInput == 0) {
-        return XR_SUCCESS;
-    }
-    if (bufferCapacityInput < path_size) {
-        return XR_ERROR_SIZE_INSUFFICIENT;
-    }
-
-    strcpy_s(buffer, path_size, string_path.data());
-
-    return XR_SUCCESS;
+    return XRGameBridge::PathToString(g_path_table, path, bufferCapacityInput, bufferCountOutput, buffer);
 }
 
 XrResult xrCreateActionSet(XrInstance instance, const XrActionSetCreateInfo* createInfo, XrActionSet* actionSet) {
@@ -321,124 +310,108 @@ XrResult xrCreateActionSet(XrInstance instance, const XrActionSetCreateInfo* cre
         return XR_ERROR_LOCALIZED_NAME_INVALID;
     }
 
-    XrActionSet handle = reinterpret_cast<XrActionSet>(string_hasher(action_set_name));
-
     GB_ActionSet new_action_set;
     new_action_set.instance = instance;
     new_action_set.priority = createInfo->priority;
+    new_action_set.name = action_set_name;
     new_action_set.localized_name = localized_action_set_name;
 
-    auto pair = g_action_sets.insert({ handle,  new_action_set });
-    if (pair.second) {
-        *actionSet = handle;
-    }
-    else {
-        // Iterator to the pair element
+    XrActionSet handle = g_action_sets.CreateUnique([&](const GB_ActionSet& existing) {
+        return existing.name == action_set_name;
+    }, std::move(new_action_set));
+
+    if (handle == XR_NULL_HANDLE) {
         LOG(WARNING) << "Action set already exists: " << localized_action_set_name;
         return XR_ERROR_NAME_DUPLICATED;
     }
 
+    *actionSet = handle;
     return XR_SUCCESS;
 }
 
 XrResult xrDestroyActionSet(XrActionSet actionSet) {
-    try {
-        GB_ActionSet& to_delete = g_action_sets.at(actionSet);
-
-        LOG(INFO) << "Unregistered action: " << to_delete.localized_name;
-        g_action_sets.erase(actionSet);
-    }
-    catch (std::out_of_range& e) {
+    auto to_delete = g_action_sets.Find(actionSet);
+    if (!to_delete) {
         LOG(ERROR) << "Action set not found";
-        return XR_ERROR_HANDLE_INVALID;
-    }
-    catch (std::exception& e) {
-        LOG(ERROR) << "Exception occurred: " << e.what();
-        return XR_ERROR_RUNTIME_FAILURE;
+        return to_delete.error();
     }
 
+    LOG(INFO) << "Unregistered action: " << to_delete->localized_name;
+    g_action_sets.Destroy(actionSet);
+
     // Remove g_actions linked to the action set
-    std::erase_if(g_actions, [&](const auto& item)-> bool {
-        auto const& [key, value] = item;
-        if (value.action_set == actionSet) {
-            return true;
+    std::vector<XrAction> linked_actions;
+    g_actions.ForEach([&](XrAction handle, const GB_Action& action) {
+        if (action.action_set == actionSet) {
+            linked_actions.push_back(handle);
         }
-        return false;
-        }
-    );
+    });
+    for (XrAction action : linked_actions) {
+        g_actions.Destroy(action);
+    }
 
     return XR_SUCCESS;
 }
 
 XrResult xrCreateAction(XrActionSet actionSet, const XrActionCreateInfo* createInfo, XrAction* action) {
-    try {
-        GB_ActionSet& gb_action_set = g_action_sets.at(actionSet);
-    }
-    catch (std::out_of_range& e) {
+    auto action_set_lookup = g_action_sets.Find(actionSet);
+    if (!action_set_lookup) {
         LOG(ERROR) << "Action set does not exist";
-        return XR_ERROR_HANDLE_INVALID;
-    }
-    catch (std::exception& e) {
-        LOG(ERROR) << "Exception occurred: " << e.what();
-        return XR_ERROR_RUNTIME_FAILURE;
+        return action_set_lookup.error();
     }
 
     GB_Action new_action{};
     new_action.action_set = actionSet;
     new_action.type = createInfo->actionType;
     new_action.sub_action_paths.insert(new_action.sub_action_paths.begin(), createInfo->subactionPaths, createInfo->subactionPaths + createInfo->countSubactionPaths);
+    new_action.name = createInfo->actionName;
     new_action.localized_name = createInfo->localizedActionName;
 
-    XrAction handle = reinterpret_cast<XrAction>(string_hasher(createInfo->actionName));
+    // Action names only have to be unique within their action set
+    const std::string action_name(createInfo->actionName);
+    XrAction handle = g_actions.CreateUnique([&](const GB_Action& existing) {
+        return existing.action_set == actionSet && existing.name == action_name;
+    }, std::move(new_action));
 
-    // TODO Can only register unique action names. I cannot register the same action handles to different g_actions sets. Is this a problem?
-    auto pair = g_actions.insert({ handle, new_action });
-    if (pair.second) {
-        *action = handle;
-    }
-    else {
-        LOG(WARNING) << "Action already exists: " << new_action.localized_name << "";
+    if (handle == XR_NULL_HANDLE) {
+        LOG(WARNING) << "Action already exists: " << createInfo->localizedActionName << "";
         return XR_ERROR_NAME_DUPLICATED;
     }
 
+    *action = handle;
     return XR_SUCCESS;
 }
 
 XrResult xrDestroyAction(XrAction action) {
-    try {
-        GB_Action& to_delete = g_actions.at(action);
-
-        LOG(INFO) << "Unregistered action: " << to_delete.localized_name;
-        g_actions.erase(action);
-    }
-    catch (std::out_of_range& e) {
+    auto to_delete = g_actions.Find(action);
+    if (!to_delete) {
         LOG(ERROR) << "Action does not exist";
-        return XR_ERROR_HANDLE_INVALID;
-    }
-    catch (std::exception& e) {
-        LOG(ERROR) << "Exception occurred: " << e.what();
-        return XR_ERROR_RUNTIME_FAILURE;
+        return to_delete.error();
     }
 
+    LOG(INFO) << "Unregistered action: " << to_delete->localized_name;
+    g_actions.Destroy(action);
+
     return XR_SUCCESS;
 }
 
 XrResult xrAttachSessionActionSets(XrSession session, const XrSessionActionSetsAttachInfo* attachInfo) {
-    try {
-        const std::vector<XrActionSet> attach_info_sets(attachInfo->actionSets, attachInfo->actionSets + attachInfo->countActionSets);
+    auto session_lookup = g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
+    }
 
-        for (uint32_t i = 0; i < attach_info_sets.size(); i++) {
-            GB_ActionSet& gb_action_set = g_action_sets.at(attach_info_sets[i]);
-            gb_action_set.session = session;
+    // Validate every handle first so a bad handle doesn't leave the sets half attached
+    for (uint32_t i = 0; i < attachInfo->countActionSets; i++) {
+        auto action_set_lookup = g_action_sets.Find(attachInfo->actionSets[i]);
+        if (!action_set_lookup) {
+            LOG(ERROR) << "Action set does not exist";
+            return action_set_lookup.error();
         }
     }
-    catch (std::out_of_range& e) {
-        LOG(ERROR) << "Action does not exist";
-        return XR_ERROR_HANDLE_INVALID;
-    }
-    catch (std::exception& e) {
-        LOG(ERROR) << "Exception occurred: " << e.what();
-        return XR_ERROR_RUNTIME_FAILURE;
+
+    for (uint32_t i = 0; i < attachInfo->countActionSets; i++) {
+        g_action_sets.Find(attachInfo->actionSets[i])->session = session;
     }
 
     return XR_SUCCESS;
@@ -454,7 +427,10 @@ XrResult xrSuggestInteractionProfileBindings(XrInstance instance, const XrIntera
 }
 
 XrResult xrGetCurrentInteractionProfile(XrSession session, XrPath topLevelUserPath, XrInteractionProfileState* interactionProfile) {
-    std::string string_path = g_xrpath_storage[topLevelUserPath];
+    const std::string_view string_path = g_path_table.ToString(topLevelUserPath);
+    if (string_path.empty()) {
+        return XR_ERROR_PATH_INVALID;
+    }
     if(std::find(XRGameBridge::g_supported_paths.begin(), XRGameBridge::g_supported_paths.end(), string_path) == XRGameBridge::g_supported_paths.end())
     {
         return XR_ERROR_PATH_UNSUPPORTED;
@@ -464,40 +440,12 @@ XrResult xrGetCurrentInteractionProfile(XrSession session, XrPath topLevelUserPa
 }
 
 XrResult xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData) {
-    auto& event_manager = g_game_bridge_instance->GetEventManager();
-
-    uint32_t event_type;
-    void* data = g_openxr_event_stream_reader->GetNextEvent(event_type);
-    if (event_type == GB_EVENT_NULL) {
-        return XR_EVENT_UNAVAILABLE;
-    }
-
-    if (event_type == XR_SESSION_STATE_READY) {
-        XrEventDataSessionStateChanged* state_change = reinterpret_cast<XrEventDataSessionStateChanged*>(data);
-        XrEventDataBuffer* state_change_B = reinterpret_cast<XrEventDataBuffer*>(data);
-        uint32_t objsize = sizeof(XrEventDataSessionStateChanged);
-        eventData->type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
-        memcpy_s(eventData, XR_MAX_EVENT_DATA_SIZE, data, objsize);
-    }
-    else if (event_type == XR_SESSION_STATE_FOCUSED) {
-        XrEventDataSessionStateChanged* state_change = reinterpret_cast<XrEventDataSessionStateChanged*>(data);
-        XrEventDataBuffer* state_change_B = reinterpret_cast<XrEventDataBuffer*>(data);
-        uint32_t objsize = sizeof(XrEventDataSessionStateChanged);
-        eventData->type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
-        memcpy_s(eventData, XR_MAX_EVENT_DATA_SIZE, data, objsize);
-    }
-    return XR_SUCCESS;
+    return g_event_queue.Poll(eventData);
 }
 
 void XRGameBridge::InitializeGameBridge() {
     if (g_game_bridge_instance == nullptr) {
         g_game_bridge_instance = new GameBridge(EventManager());
-        auto& event_manager = g_game_bridge_instance->GetEventManager();
-        g_openxr_event_stream_writer = event_manager.CreateEventStream(GB_EVENT_STREAM_TYPE_XR_GAME_BRIDGE, 300, XR_MAX_EVENT_DATA_SIZE);
-        g_openxr_event_stream_reader = event_manager.GetEventStreamReader(GB_EVENT_STREAM_TYPE_XR_GAME_BRIDGE);
-
-
-        //g_openxr_event_stream_writer->SubmitEvent(XR_TYPE_EVENT_DATA_EVENTS_LOST, 200, nullptr);
     }
 }
 
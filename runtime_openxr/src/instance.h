@@ -2,8 +2,12 @@
 #include <string>
 #include <unordered_map>
 
+#include "action_table.h"
 #include "dll.h"
+#include "events.h"
+#include "handle_table.h"
 #include "openxr_includes.h"
+#include "path_table.h"
 #include "session.h"
 #include "swapchain.h"
 #include "system.h"
@@ -48,7 +52,7 @@ XrResult xrSuggestInteractionProfileBindings(XrInstance instance, const XrIntera
 XrResult xrGetCurrentInteractionProfile(XrSession session, XrPath topLevelUserPath, XrInteractionProfileState* interactionProfile);
 
 // Events
-inline XrResult xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData);
+XrResult xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData);
 
 namespace XRGameBridge {
     //// Handle functions
@@ -70,55 +74,42 @@ namespace XRGameBridge {
         const uint64_t runtime_version = XR_MAKE_VERSION(RUNTIME_VERSION_MAYOR, RUNTIME_VERSION_MINOR, RUNTIME_VERSION_PATCH);
         GraphicsBackend active_graphics_backend;
         SR::SRContext* sr_context;
+        // XR_MND_headless is enabled, sessions created without a graphics binding render to the null backend
+        bool headless = false;
 
         // Currently not being used
         XrInteractionProfileSuggestedBinding suggested_bindings;
     };
 
-    struct GB_ActionSet {
-        XrInstance instance;
-        XrSession session;
-        uint32_t priority;
-        std::string localized_name;
-    };
-
-    struct GB_Action {
-        // TODO list of action sets so multiple action sets can register the same action? Not sure if the specification wants that.
-        XrActionSet action_set;
-        XrActionType type;
-        std::vector<XrPath> sub_action_paths;
-        std::string localized_name;
-    };
-
     ///! \brief Initialize Game Bridge
     void InitializeGameBridge();
 
     ///! \brief Initialize XR Systems
     void InitializeSystems(XrInstance instance);
 
-    // Hash class
-    inline std::hash<std::string> string_hasher;
-
     inline GB_Instance* g_gbinstance = nullptr;
     inline GameBridge* g_game_bridge_instance = nullptr;
-    inline std::shared_ptr<EventStreamWriter> g_openxr_event_stream_writer;
-    inline std::shared_ptr<EventStreamReader> g_openxr_event_stream_reader;
 
     inline PlatformManager* g_platform_manager = nullptr;
 
     // Data
-    // The key is the string hash of an action set path. The same hash is being used for action set handles
-    inline std::unordered_map<XrPath, std::string> g_xrpath_storage;
+    inline GB_PathTable g_path_table;
+    inline GB_EventQueue g_event_queue;
 
     // TODO a list of instances in the future?
     //inline std::unordered_map<XrInstance, GB_Instance> instances;
-    inline std::unordered_map<XrSession, GB_Session> g_sessions;
+    // Handle tables can be read from any thread without locking, see GB_HandleTable
+    inline GB_HandleTable<XrSession, GB_Session> g_sessions{ HANDLE_TYPE_SESSION };
+    // Only written while creating the instance, read only afterwards
     inline std::unordered_map<XrSystemId, GB_System> g_systems;
-    // OpenXR makes a distinction between active and inactive action sets, only active ones have to be updated.
-    // Since we don't plan on handling VR actions I left this distinction out, but it might be good to have later.
-    inline std::unordered_map<XrActionSet, GB_ActionSet> g_action_sets;
-    inline std::unordered_map<XrAction, GB_Action> g_actions;
-    inline std::unordered_map<XrSpace, GB_ReferenceSpace> g_reference_spaces;
-    inline std::unordered_map<XrSpace, GB_ActionSpace> g_action_spaces;
     inline std::unordered_map<XrSpace, GB_Display> g_displays;
+
+    // Returns XR_ERROR_SYSTEM_INVALID for ids that xrGetSystem never handed out
+    inline GB_Expected<GB_System&> FindSystem(XrSystemId system_id) {
+        auto it = g_systems.find(system_id);
+        if (it == g_systems.end()) {
+            return GB_Expected<GB_System&>::Error(XR_ERROR_SYSTEM_INVALID);
+        }
+        return it->second;
+    }
 }
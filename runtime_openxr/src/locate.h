@@ -0,0 +1,101 @@
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include "handle_table.h"
+#include "logging.h"
+#include "space_graph.h"
+#include "view_solver.h"
+
+namespace XRGameBridge {
+    // The bodies of xrLocateSpace and xrLocateViews on a table of sessions that own a space_graph and a view_solver.
+    // The entry points pass g_sessions, the benchmarks a table of sessions without graphics.
+    template <typename Session>
+    XrResult LocateSpace(const GB_HandleTable<XrSession, Session>& sessions, XrSpace space, XrSpace base_space, XrTime time, XrSpaceLocation* location) {
+        // TODO Application may ask for a velocity of the tracked object
+        if (location->next != nullptr) {
+            XrSpaceVelocity* velocity = static_cast<XrSpaceVelocity*>(location->next);
+            velocity->velocityFlags = 0;
+        }
+
+        auto node_lookup = GB_SpaceGraph::GetNode(space);
+        if (!node_lookup) {
+            GB_LOG(Warning, "Space does not exist: {}", space);
+            return node_lookup.error();
+        }
+        auto session_lookup = sessions.Find(node_lookup->session);
+        if (!session_lookup) {
+            return session_lookup.error();
+        }
+
+        // Repeated locates of the same pair within a frame are served from the graph's cache
+        auto located = session_lookup->space_graph.Locate(space, base_space, time);
+        if (!located) {
+            return located.error();
+        }
+
+        location->pose = located->pose;
+        location->locationFlags = located->flags;
+        return XR_SUCCESS;
+    }
+
+    template <typename Session>
+    XrResult LocateViews(const GB_HandleTable<XrSession, Session>& sessions, XrSession session, const XrViewLocateInfo* view_locate_info, XrViewState* view_state, uint32_t view_capacity, uint32_t* view_count_output, XrView* views) {
+        auto session_lookup = sessions.Find(session);
+        if (!session_lookup) {
+            return session_lookup.error();
+        }
+        // Views can only be located in a space of the same session
+        auto base_node = GB_SpaceGraph::GetNode(view_locate_info->space);
+        if (base_node && base_node->session != session) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        //TODO Don't understand this, for some reason it wants a single view for stereo output.
+        // Should change this later
+        uint32_t view_count = 0;
+        if (view_locate_info->viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO) {
+            view_count = 1;
+        }
+        else if (view_locate_info->viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+            view_count = 2;
+        }
+
+        *view_count_output = view_count;
+
+        // Request for the view array or the view array itself
+        if (view_capacity == 0) {
+            return XR_SUCCESS;
+        }
+        // Passed array not large enough
+        if (view_capacity < view_count) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+
+        // Eye poses and frustums at the time the frame will be displayed, cached per tracking sample
+        auto solution = session_lookup->view_solver.Solve(view_locate_info->space, view_locate_info->displayTime);
+        if (!solution) {
+            return solution.error();
+        }
+
+        for (uint32_t i = 0; i < view_count; i++) {
+            views[i].type = XR_TYPE_VIEW;
+            views[i].next = nullptr;
+            views[i].pose = solution->poses[i]; // Orientation, Position
+            views[i].fov = solution->fovs[i]; // FOV angle left, right, up, down
+        }
+
+        // Views can't be located in action spaces
+        if ((solution->base_flags & XR_SPACE_LOCATION_POSITION_VALID_BIT) == 0) {
+            view_state->viewStateFlags = 0;
+        }
+        else {
+            view_state->viewStateFlags = XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_VALID_BIT;
+        }
+        if (view_state->viewStateFlags != 0 && solution->tracked) {
+            view_state->viewStateFlags |= XR_VIEW_STATE_POSITION_TRACKED_BIT | XR_VIEW_STATE_ORIENTATION_TRACKED_BIT;
+        }
+
+        return XR_SUCCESS;
+    }
+}
@@ -0,0 +1,302 @@
+#include "logging.h"
+
+#include <condition_variable>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "easylogging++.h"
+
+namespace XRGameBridge {
+    GB_LogRecord* GB_LogRing::Reserve() {
+        const uint64_t write = head.load(std::memory_order_relaxed);
+        if (write - tail.load(std::memory_order_acquire) >= capacity) {
+            return nullptr;
+        }
+        return &records[write % capacity];
+    }
+
+    void GB_LogRing::Commit() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    const GB_LogRecord* GB_LogRing::Peek() {
+        const uint64_t read = tail.load(std::memory_order_relaxed);
+        if (read == head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &records[read % capacity];
+    }
+
+    void GB_LogRing::Pop() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    namespace {
+        el::Level ToEasyloggingLevel(GB_LogLevel level) {
+            switch (level) {
+            case GB_LogLevel::Trace: return el::Level::Trace;
+            case GB_LogLevel::Debug: return el::Level::Debug;
+            case GB_LogLevel::Info: return el::Level::Info;
+            case GB_LogLevel::Warning: return el::Level::Warning;
+            case GB_LogLevel::Error: return el::Level::Error;
+            }
+            return el::Level::Info;
+        }
+
+        void AppendArgument(std::string& out, const GB_LogRecord& record, uint32_t index) {
+            const uint64_t value = record.values[index];
+            switch (record.types[index]) {
+            case GB_LogArgumentType::Signed:
+                out += std::to_string(static_cast<int64_t>(value));
+                break;
+            case GB_LogArgumentType::Unsigned:
+                out += std::to_string(value);
+                break;
+            case GB_LogArgumentType::Float:
+                out += std::to_string(std::bit_cast<double>(value));
+                break;
+            case GB_LogArgumentType::Pointer: {
+                char buffer[19];
+                snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(value));
+                out += buffer;
+                break;
+            }
+            case GB_LogArgumentType::String:
+                out.append(record.text.data() + (value >> 32), value & 0xFFFFFFFF);
+                break;
+            }
+        }
+
+        // Record being written by the log thread, its time replaces the time of writing in the log line
+        thread_local const GB_LogRecord* g_writing_record = nullptr;
+
+        // Wall clock time of a steady clock timestamp, measured once since the two clocks don't drift apart noticeably
+        std::chrono::system_clock::time_point ToSystemTime(uint64_t timestamp) {
+            static const auto steady_start = std::chrono::steady_clock::now();
+            static const auto system_start = std::chrono::system_clock::now();
+            const auto since_start = std::chrono::steady_clock::duration(timestamp) - steady_start.time_since_epoch();
+            return system_start + std::chrono::duration_cast<std::chrono::system_clock::duration>(since_start);
+        }
+
+        // %gbtime, the easylogging++ default date format with the time the record was logged at
+        std::string FormatLogTime(const el::LogMessage*) {
+            const auto time = g_writing_record != nullptr ? ToSystemTime(g_writing_record->timestamp) : std::chrono::system_clock::now();
+            const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+            const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &seconds);
+#else
+            localtime_r(&seconds, &local);
+#endif
+            char buffer[32];
+            const size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+            snprintf(buffer + length, sizeof(buffer) - length, ",%03d", static_cast<int>(milliseconds));
+            return buffer;
+        }
+
+        std::string FormatRecord(const GB_LogRecord& record) {
+            std::string out;
+            uint32_t argument = 0;
+            for (const char* c = record.format; *c != '\0'; c++) {
+                if (c[0] == '{' && c[1] == '}' && argument < record.argument_count) {
+                    AppendArgument(out, record, argument++);
+                    c++;
+                    continue;
+                }
+                out += *c;
+            }
+            return out;
+        }
+
+        // Owns the per thread rings and the thread that writes them out.
+        // Allocated once and never destroyed so threads can still log while the process shuts down, the thread is joined by ShutdownLog.
+        class GB_AsyncLogger {
+            std::mutex rings_mutex;
+            std::vector<std::shared_ptr<GB_LogRing>> rings;
+
+            // Rings have a single consumer, the log thread or a flush while it isn't running
+            std::mutex drain_mutex;
+
+            std::mutex flush_mutex;
+            std::condition_variable flush_condition;
+            uint64_t flush_requests = 0;
+            uint64_t flushes_done = 0;
+            bool stopping = false;
+            // Set by ShutdownLog, a new ring doesn't start the thread again until StartLog
+            bool shut_down = false;
+
+            // Started and joined with flush_mutex held
+            std::thread thread;
+
+            // Returns whether any record was written
+            bool Drain() {
+                std::lock_guard drain_guard(drain_mutex);
+
+                std::vector<std::shared_ptr<GB_LogRing>> snapshot;
+                {
+                    std::lock_guard guard(rings_mutex);
+                    snapshot = rings;
+                }
+
+                bool wrote = false;
+                for (auto& ring : snapshot) {
+                    const uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+                    if (dropped != 0) {
+                        LOG(WARNING) << "Log ring full, dropped " << dropped << " messages";
+                    }
+
+                    while (const GB_LogRecord* record = ring->Peek()) {
+                        g_writing_record = record;
+                        el::base::Writer(ToEasyloggingLevel(record->level), record->file, record->line, "", el::base::DispatchAction::NormalLog)
+                            .construct(1, el::base::consts::kDefaultLoggerId) << FormatRecord(*record);
+                        g_writing_record = nullptr;
+                        ring->Pop();
+                        wrote = true;
+                    }
+                }
+
+                // Forget rings of threads that exited once they are empty
+                std::lock_guard guard(rings_mutex);
+                std::erase_if(rings, [](const std::shared_ptr<GB_LogRing>& ring) {
+                    return ring->abandoned.load(std::memory_order_acquire) && ring->Peek() == nullptr;
+                });
+                return wrote;
+            }
+
+            void Run() {
+                while (true) {
+                    uint64_t requested;
+                    {
+                        std::lock_guard guard(flush_mutex);
+                        if (stopping) {
+                            break;
+                        }
+                        requested = flush_requests;
+                    }
+
+                    const bool wrote = Drain();
+
+                    {
+                        std::unique_lock lock(flush_mutex);
+                        flushes_done = requested;
+                        flush_condition.notify_all();
+
+                        // Producers never signal, poll at a low rate while idle
+                        if (!wrote) {
+                            flush_condition.wait_for(lock, std::chrono::milliseconds(5), [&] { return stopping || flush_requests != flushes_done; });
+                        }
+                    }
+                }
+
+                // Whatever was logged before the stop, which also covers flushes still waiting
+                std::unique_lock lock(flush_mutex);
+                const uint64_t requested = flush_requests;
+                lock.unlock();
+                Drain();
+                lock.lock();
+                flushes_done = requested;
+                flush_condition.notify_all();
+            }
+
+            // Must be called with flush_mutex held
+            void StartLocked() {
+                if (thread.joinable()) {
+                    return;
+                }
+                stopping = false;
+                thread = std::thread(&GB_AsyncLogger::Run, this);
+            }
+
+        public:
+            GB_AsyncLogger() {
+                // Every line shows when it was logged instead of when the log thread wrote it
+                el::Helpers::installCustomFormatSpecifier(el::CustomFormatSpecifier("%gbtime", &FormatLogTime));
+                el::Loggers::reconfigureAllLoggers(el::ConfigurationType::Format, "%gbtime %level [%logger] %msg");
+            }
+
+            void Register(const std::shared_ptr<GB_LogRing>& ring) {
+                {
+                    std::lock_guard guard(rings_mutex);
+                    rings.push_back(ring);
+                }
+                std::lock_guard guard(flush_mutex);
+                if (!shut_down) {
+                    StartLocked();
+                }
+            }
+
+            void Flush() {
+                std::unique_lock lock(flush_mutex);
+                if (!thread.joinable()) {
+                    lock.unlock();
+                    Drain();
+                    return;
+                }
+                const uint64_t request = ++flush_requests;
+                flush_condition.notify_all();
+                flush_condition.wait(lock, [&] { return flushes_done >= request; });
+            }
+
+            void Start() {
+                std::lock_guard guard(flush_mutex);
+                shut_down = false;
+                StartLocked();
+            }
+
+            void Shutdown() {
+                std::thread stopped;
+                {
+                    std::lock_guard guard(flush_mutex);
+                    shut_down = true;
+                    stopping = true;
+                    flush_condition.notify_all();
+                    stopped = std::move(thread);
+                }
+                // Drains once more before it exits
+                if (stopped.joinable()) {
+                    stopped.join();
+                }
+            }
+        };
+
+        GB_AsyncLogger& GetAsyncLogger() {
+            static GB_AsyncLogger* logger = new GB_AsyncLogger();
+            return *logger;
+        }
+
+        // Marks the ring as abandoned when its thread exits, the log thread still writes out what is left in it
+        struct GB_ThreadLogRing {
+            std::shared_ptr<GB_LogRing> ring;
+
+            GB_ThreadLogRing() : ring(std::make_shared<GB_LogRing>()) {
+                GetAsyncLogger().Register(ring);
+            }
+
+            ~GB_ThreadLogRing() {
+                ring->abandoned.store(true, std::memory_order_release);
+            }
+        };
+    }
+
+    GB_LogRing* GetThreadLogRing() {
+        thread_local GB_ThreadLogRing thread_ring;
+        return thread_ring.ring.get();
+    }
+
+    void FlushLog() {
+        GetAsyncLogger().Flush();
+    }
+
+    void StartLog() {
+        GetAsyncLogger().Start();
+    }
+
+    void ShutdownLog() {
+        GetAsyncLogger().Shutdown();
+    }
+}
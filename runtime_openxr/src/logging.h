@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Logging for code that runs every frame or on every lookup.
+// GB_LOG only copies the format string pointer and the binary arguments into a ring buffer owned by the calling thread.
+// A background thread formats the records and hands them to easylogging++, so the caller never formats, locks or touches the log file.
+// Everything below GB_LOG_MIN_LEVEL is removed at compile time. Keep using LOG() for setup code, this is for hot paths.
+//
+// Usage: GB_LOG(Warning, "Space does not exist: {}", space);
+// The format must be a string literal, {} is replaced by the next argument.
+
+namespace XRGameBridge {
+    enum class GB_LogLevel : uint8_t {
+        Trace = 0,
+        Debug = 1,
+        Info = 2,
+        Warning = 3,
+        Error = 4
+    };
+}
+
+#ifndef GB_LOG_MIN_LEVEL
+#define GB_LOG_MIN_LEVEL 2
+#endif
+
+#define GB_LOG(level, ...) \
+    do { \
+        if constexpr (static_cast<int>(XRGameBridge::GB_LogLevel::level) >= GB_LOG_MIN_LEVEL) { \
+            XRGameBridge::LogAsync(XRGameBridge::GB_LogLevel::level, __FILE__, __LINE__, __VA_ARGS__); \
+        } \
+    } while (false)
+
+namespace XRGameBridge {
+    enum class GB_LogArgumentType : uint8_t {
+        Signed,
+        Unsigned,
+        Float,
+        Pointer,
+        String
+    };
+
+    constexpr uint32_t g_log_max_arguments = 6;
+    constexpr uint32_t g_log_text_capacity = 80;
+
+    // Fixed size so the ring buffer is a plain array, strings are copied into text and truncated when they don't fit
+    struct GB_LogRecord {
+        const char* format;
+        const char* file;
+        uint64_t timestamp;
+        uint32_t line;
+        GB_LogLevel level;
+        uint8_t argument_count;
+        uint8_t text_used;
+        std::array<GB_LogArgumentType, g_log_max_arguments> types;
+        std::array<uint64_t, g_log_max_arguments> values;
+        std::array<char, g_log_text_capacity> text;
+    };
+
+    // Single producer single consumer ring, the producer is the owning thread and the consumer is the log thread
+    class GB_LogRing {
+    public:
+        static constexpr uint32_t capacity = 1024;
+
+    private:
+        std::array<GB_LogRecord, capacity> records;
+        alignas(64) std::atomic<uint64_t> head = 0; // Next record to write
+        alignas(64) std::atomic<uint64_t> tail = 0; // Next record to read
+
+    public:
+        std::atomic<uint64_t> dropped = 0;
+        std::atomic<bool> abandoned = false;
+
+        // Returns nullptr when the ring is full, the record is published by Commit
+        GB_LogRecord* Reserve();
+        void Commit();
+
+        // Consumer side
+        const GB_LogRecord* Peek();
+        void Pop();
+    };
+
+    // Returns the ring of the calling thread, registers it with the log thread on first use
+    GB_LogRing* GetThreadLogRing();
+
+    // Blocks until every record submitted before the call has been written
+    void FlushLog();
+    // Starts the log thread again after ShutdownLog, the first GB_LOG starts it otherwise
+    void StartLog();
+    // Writes out everything logged so far and joins the log thread, for when the runtime is about to be unloaded.
+    // Records logged afterwards wait in their ring until StartLog or FlushLog.
+    void ShutdownLog();
+
+    inline void EncodeLogArgument(GB_LogRecord& record, std::string_view value) {
+        const uint32_t offset = record.text_used;
+        const uint32_t length = static_cast<uint32_t>(std::min<size_t>(value.size(), g_log_text_capacity - offset));
+        memcpy(record.text.data() + offset, value.data(), length);
+        record.text_used = static_cast<uint8_t>(offset + length);
+
+        record.types[record.argument_count] = GB_LogArgumentType::String;
+        record.values[record.argument_count] = (static_cast<uint64_t>(offset) << 32) | length;
+    }
+
+    template <typename T>
+    void EncodeLogArgument(GB_LogRecord& record, const T& value) {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            EncodeLogArgument(record, std::string_view(value));
+        }
+        else if constexpr (std::is_enum_v<T>) {
+            record.types[record.argument_count] = GB_LogArgumentType::Signed;
+            record.values[record.argument_count] = static_cast<uint64_t>(static_cast<int64_t>(value));
+        }
+        else if constexpr (std::is_same_v<T, bool> || std::is_unsigned_v<T>) {
+            record.types[record.argument_count] = GB_LogArgumentType::Unsigned;
+            record.values[record.argument_count] = static_cast<uint64_t>(value);
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            record.types[record.argument_count] = GB_LogArgumentType::Signed;
+            record.values[record.argument_count] = static_cast<uint64_t>(static_cast<int64_t>(value));
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            record.types[record.argument_count] = GB_LogArgumentType::Float;
+            record.values[record.argument_count] = std::bit_cast<uint64_t>(static_cast<double>(value));
+        }
+        else if constexpr (std::is_pointer_v<T>) {
+            // OpenXR handles are pointers as well
+            record.types[record.argument_count] = GB_LogArgumentType::Pointer;
+            record.values[record.argument_count] = reinterpret_cast<uint64_t>(value);
+        }
+        else {
+            static_assert(std::is_pointer_v<T>, "Unsupported GB_LOG argument type");
+        }
+    }
+
+    template <size_t FormatSize, typename... Args>
+    void LogAsync(GB_LogLevel level, const char* file, uint32_t line, const char (&format)[FormatSize], const Args&... args) {
+        static_assert(sizeof...(Args) <= g_log_max_arguments, "Too many GB_LOG arguments");
+
+        GB_LogRing* ring = GetThreadLogRing();
+        GB_LogRecord* record = ring->Reserve();
+        if (record == nullptr) {
+            // Never block the caller, the log thread reports the dropped count
+            ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        record->format = format;
+        record->file = file;
+        record->line = line;
+        record->level = level;
+        record->timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        record->argument_count = 0;
+        record->text_used = 0;
+        ((EncodeLogArgument(*record, args), record->argument_count++), ...);
+
+        ring->Commit();
+    }
+}
@@ -1,9 +1,13 @@
 #include <string>
 #include <format>
+#include <iostream>
 
 #include <easylogging++.h>
 #include <openxr/openxr.h>
 
+#include "api_capture.h"
+#include "api_replay.h"
+#include "dll.h"
 #include "settings.h"
 
 INITIALIZE_EASYLOGGINGPP
@@ -20,6 +24,7 @@ BOOL WINAPI DllMain(HINSTANCE hInst, DWORD fdwReason, LPVOID) {
         runtime_path = std::string(module_path);
 
         FindPathEnv();
+        XRGameBridge::LoadEnvironmentSettings();
 
         LOG(INFO) << "DLL_PROCESS_ATTACH";
 
@@ -38,6 +43,7 @@ BOOL WINAPI DllMain(HINSTANCE hInst, DWORD fdwReason, LPVOID) {
         LOG(INFO) << "Support D3D12 " << (XRGameBridge::g_runtime_settings.support_d3d12 ? "TRUE" : "FALSE");
         LOG(INFO) << "Support GL " << (XRGameBridge::g_runtime_settings.support_gl ? "TRUE" : "FALSE");
         LOG(INFO) << "Support VK " << (XRGameBridge::g_runtime_settings.support_vk ? "TRUE" : "FALSE");
+        LOG(INFO) << "Frames in flight " << XRGameBridge::g_runtime_settings.frames_in_flight;
 
         //if (FClientSettings::ClientSettings.AllowVK)
         //{
@@ -54,6 +60,11 @@ BOOL WINAPI DllMain(HINSTANCE hInst, DWORD fdwReason, LPVOID) {
     {
         LOG(INFO) << "DLL_PROCESS_DETACH";
 
+        if (XRGameBridge::g_api_capture.IsEnabled()) {
+            LOG(INFO) << "OpenXR calls dropped from the capture: " << XRGameBridge::g_api_capture.GetDroppedCalls();
+            XRGameBridge::g_api_capture.Close();
+        }
+
         LOG(INFO) << "XR Game Bridge Unloaded";
         break;
     }
@@ -63,6 +74,25 @@ BOOL WINAPI DllMain(HINSTANCE hInst, DWORD fdwReason, LPVOID) {
     return TRUE;
 }
 
+// Replays a capture of XR_GAME_BRIDGE_API_CAPTURE on a headless session, so the swapchains and the compositor are the null backend.
+// Prints what every entry point cost the application next to what it costs this build.
+DllExport int GB_ReplayApiCapture(const char* capture_path) {
+    XRGameBridge::GB_ApiReplay replay;
+    if (capture_path == nullptr || !replay.Open(capture_path)) {
+        LOG(ERROR) << "Can't open the API capture " << (capture_path != nullptr ? capture_path : "");
+        return 1;
+    }
+
+    XRGameBridge::GB_ApiReplayConfig config;
+    config.extensions = { XR_MND_HEADLESS_EXTENSION_NAME };
+
+    const std::vector<XRGameBridge::GB_ApiFunctionStats> captured = replay.Summarize();
+    const std::vector<XRGameBridge::GB_ApiFunctionStats> replayed = replay.Run(config);
+    XRGameBridge::GB_ApiReplay::Compare(captured, replayed, std::cout);
+    std::cout << "Calls that couldn't be replayed: " << replay.GetSkippedCalls() << '\n';
+    return 0;
+}
+
 // Targets are delayed in CMake
 #include <delayimp.h>
 FARPROC WINAPI delayHook(unsigned dliNotify, PDelayLoadInfo pdli) {
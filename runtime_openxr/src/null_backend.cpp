@@ -0,0 +1,147 @@
+#include "null_backend.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "spaces.h"
+
+namespace XRGameBridge {
+    GB_NullSwapchain::GB_NullSwapchain(const XrSwapchainCreateInfo& create_info, uint32_t image_count) : create_info(create_info), image_count(std::min(image_count, GB_ImageRing::max_images)), image_ring(this->image_count) {
+        this->create_info.next = nullptr;
+        image_size = uint64_t(create_info.width) * create_info.height * create_info.arraySize * bytes_per_pixel;
+        images.resize(image_size * this->image_count);
+    }
+
+    XrResult GB_NullSwapchain::ValidateCreateInfo(const XrSwapchainCreateInfo& create_info) {
+        if (create_info.width == 0 || create_info.height == 0 || create_info.arraySize == 0 || create_info.mipCount == 0 || create_info.sampleCount == 0) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (create_info.faceCount != 1 && create_info.faceCount != 6) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        // D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+        if (create_info.arraySize > 2048 / create_info.faceCount) {
+            return XR_ERROR_FEATURE_UNSUPPORTED;
+        }
+        if (create_info.mipCount > static_cast<uint32_t>(std::bit_width(std::max(create_info.width, create_info.height)))) {
+            return XR_ERROR_FEATURE_UNSUPPORTED;
+        }
+        return XR_SUCCESS;
+    }
+
+    const XrSwapchainCreateInfo& GB_NullSwapchain::GetCreateInfo() const {
+        return create_info;
+    }
+
+    uint8_t* GB_NullSwapchain::GetImage(uint32_t index) {
+        return images.data() + image_size * index;
+    }
+
+    uint64_t GB_NullSwapchain::GetImageSize() const {
+        return image_size;
+    }
+
+    uint32_t GB_NullSwapchain::GetReleasedIndex() const {
+        return image_ring.GetReleasedIndex();
+    }
+
+    uint32_t GB_NullSwapchain::GetBufferCount() const {
+        return image_count;
+    }
+
+    XrResult GB_NullSwapchain::AcquireNextImage(uint32_t& index) {
+        return image_ring.Acquire(index);
+    }
+
+    XrResult GB_NullSwapchain::WaitForImage(const XrDuration& timeout) {
+        // Nothing renders from the images, they are ready right away
+        uint32_t index = 0;
+        XrResult result = image_ring.BeginWait(index);
+        if (result == XR_SUCCESS) {
+            image_ring.EndWait(index, true);
+        }
+        return result;
+    }
+
+    XrResult GB_NullSwapchain::ReleaseImage() {
+        uint32_t index = 0;
+        return image_ring.Release(index);
+    }
+
+    GB_NullCompositor::GB_NullCompositor(uint32_t view_count) : view_count(view_count) {
+    }
+
+    XrResult GB_NullCompositor::ValidateSubImage(const XrSwapchainSubImage& sub_image) const {
+        auto swapchain_lookup = g_null_swapchains.Find(sub_image.swapchain);
+        if (!swapchain_lookup) {
+            return swapchain_lookup.error();
+        }
+        const GB_NullSwapchain& swapchain = *swapchain_lookup;
+        const XrSwapchainCreateInfo& info = swapchain.GetCreateInfo();
+
+        // Layers can only use images that have been released at least once
+        if (swapchain.GetReleasedIndex() == UINT32_MAX) {
+            return XR_ERROR_LAYER_INVALID;
+        }
+
+        const XrRect2Di& rect = sub_image.imageRect;
+        if (rect.offset.x < 0 || rect.offset.y < 0 || rect.extent.width <= 0 || rect.extent.height <= 0 ||
+            uint64_t(rect.offset.x) + rect.extent.width > info.width || uint64_t(rect.offset.y) + rect.extent.height > info.height) {
+            return XR_ERROR_SWAPCHAIN_RECT_INVALID;
+        }
+        if (sub_image.imageArrayIndex >= info.arraySize) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        return XR_SUCCESS;
+    }
+
+    XrResult GB_NullCompositor::ComposeFrame(const XrFrameEndInfo* frame_end_info) {
+        if (frame_end_info->layerCount > max_layers) {
+            return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+        }
+
+        uint64_t views = 0;
+        for (uint32_t i = 0; i < frame_end_info->layerCount; i++) {
+            const XrCompositionLayerBaseHeader* layer = frame_end_info->layers[i];
+            if (layer == nullptr) {
+                return XR_ERROR_LAYER_INVALID;
+            }
+            if (!g_reference_spaces.Contains(layer->space) && !g_action_spaces.Contains(layer->space)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+
+            if (layer->type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+                const auto* projection = reinterpret_cast<const XrCompositionLayerProjection*>(layer);
+                if (projection->viewCount != view_count) {
+                    return XR_ERROR_VALIDATION_FAILURE;
+                }
+                for (uint32_t view = 0; view < projection->viewCount; view++) {
+                    XrResult result = ValidateSubImage(projection->views[view].subImage);
+                    if (result != XR_SUCCESS) {
+                        return result;
+                    }
+                }
+                views += projection->viewCount;
+            }
+            else if (layer->type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
+                XrResult result = ValidateSubImage(reinterpret_cast<const XrCompositionLayerQuad*>(layer)->subImage);
+                if (result != XR_SUCCESS) {
+                    return result;
+                }
+                views++;
+            }
+            else {
+                return XR_ERROR_LAYER_INVALID;
+            }
+        }
+
+        stats.frames++;
+        stats.layers += frame_end_info->layerCount;
+        stats.views += views;
+        return XR_SUCCESS;
+    }
+
+    const GB_NullCompositorStats& GB_NullCompositor::GetStats() const {
+        return stats;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <openxr/openxr.h>
+
+#include "graphics_backend.h"
+#include "handle_table.h"
+#include "image_ring.h"
+
+namespace XRGameBridge {
+    // Swapchain without a graphics API, the images are plain memory and are ready as soon as they are acquired.
+    // Follows the image order of the specification so it can stand in for GB_ProxySwapchain in headless runs.
+    class GB_NullSwapchain : public GB_SwapchainBackend {
+        XrSwapchainCreateInfo create_info;
+        uint32_t image_count;
+        uint64_t image_size;
+        std::vector<uint8_t> images;
+        GB_ImageRing image_ring;
+
+    public:
+        static constexpr uint32_t bytes_per_pixel = 4;
+
+        GB_NullSwapchain(const XrSwapchainCreateInfo& create_info, uint32_t image_count);
+
+        // The limits of the D3D12 swapchains it stands in for, without the format checks
+        static XrResult ValidateCreateInfo(const XrSwapchainCreateInfo& create_info);
+
+        const XrSwapchainCreateInfo& GetCreateInfo() const;
+        // width * height * arraySize pixels
+        uint8_t* GetImage(uint32_t index);
+        uint64_t GetImageSize() const;
+        // Most recently released image, what a compositor reads. UINT32_MAX until the first image is released.
+        uint32_t GetReleasedIndex() const;
+
+        uint32_t GetBufferCount() const override;
+        XrResult AcquireNextImage(uint32_t& index) override;
+        XrResult WaitForImage(const XrDuration& timeout) override;
+        XrResult ReleaseImage() override;
+    };
+
+    struct GB_NullCompositorStats {
+        uint64_t frames = 0;
+        uint64_t layers = 0;
+        uint64_t views = 0;
+    };
+
+    // Validates the submitted layers like the D3D12 compositor would and counts them instead of drawing
+    class GB_NullCompositor : public GB_CompositorBackend {
+        uint32_t view_count;
+        GB_NullCompositorStats stats;
+
+        XrResult ValidateSubImage(const XrSwapchainSubImage& sub_image) const;
+
+    public:
+        static constexpr uint32_t max_layers = 16;
+
+        explicit GB_NullCompositor(uint32_t view_count = 2);
+
+        XrResult ComposeFrame(const XrFrameEndInfo* frame_end_info) override;
+        const GB_NullCompositorStats& GetStats() const;
+    };
+
+    inline GB_HandleTable<XrSwapchain, GB_NullSwapchain> g_null_swapchains{ HANDLE_TYPE_NULL_SWAPCHAIN };
+}
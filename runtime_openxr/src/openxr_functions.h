@@ -1,9 +1,13 @@
 #pragma once
 
-#include <string>
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <vector>
 
 #include "openxr_includes.h"
+#include "api_capture.h"
+#include "api_replay.h"
 
 inline XrResult xrResultToString(XrInstance instance, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE]) { LOG(INFO) << "Called " << __func__;return XR_ERROR_RUNTIME_FAILURE;}
 inline XrResult xrStructureTypeToString(XrInstance instance, XrStructureType value, char buffer[XR_MAX_STRUCTURE_NAME_SIZE]) { LOG(INFO) << "Called " << __func__; return XR_ERROR_RUNTIME_FAILURE; }
@@ -39,76 +43,238 @@ XrResult xrGetD3D12GraphicsRequirementsKHR(XrInstance instance, XrSystemId syste
 //XrResult xrRequestDisplayRefreshRateFB(XrSession session, float displayRefreshRate);
 
 namespace XRGameBridge {
-    const std::unordered_map<std::string, PFN_xrVoidFunction> openxr_functions {
-        { "rGetInstanceProcAddr",                       reinterpret_cast<PFN_xrVoidFunction>(xrGetInstanceProcAddr)},
-        { "xrEnumerateInstanceExtensionProperties",     reinterpret_cast<PFN_xrVoidFunction>(xrEnumerateInstanceExtensionProperties) },
-        { "xrCreateInstance",                           reinterpret_cast<PFN_xrVoidFunction>(xrCreateInstance) },
-        { "xrDestroyInstance",                          reinterpret_cast<PFN_xrVoidFunction>(xrDestroyInstance) },
-        { "xrGetInstanceProperties",                    reinterpret_cast<PFN_xrVoidFunction>(xrGetInstanceProperties) },
-        { "xrPollEvent",                                reinterpret_cast<PFN_xrVoidFunction>(xrPollEvent) },
-        { "xrResultToString",                           reinterpret_cast<PFN_xrVoidFunction>(xrResultToString) },
-        { "xrStructureTypeToString",                    reinterpret_cast<PFN_xrVoidFunction>(xrStructureTypeToString) },
-        { "xrGetSystem",                                reinterpret_cast<PFN_xrVoidFunction>(xrGetSystem) },
-        { "xrGetSystemProperties",                      reinterpret_cast<PFN_xrVoidFunction>(xrGetSystemProperties) },
-        { "xrEnumerateEnvironmentBlendModes",           reinterpret_cast<PFN_xrVoidFunction>(xrEnumerateEnvironmentBlendModes) },
-        { "xrCreateSession",                            reinterpret_cast<PFN_xrVoidFunction>(xrCreateSession) },
-        { "xrDestroySession",                           reinterpret_cast<PFN_xrVoidFunction>(xrDestroySession) },
-        { "xrEnumerateReferenceSpaces",                 reinterpret_cast<PFN_xrVoidFunction>(xrEnumerateReferenceSpaces) },
-        { "xrCreateReferenceSpace",                     reinterpret_cast<PFN_xrVoidFunction>(xrCreateReferenceSpace) },
-        { "xrGetReferenceSpaceBoundsRect",              reinterpret_cast<PFN_xrVoidFunction>(xrGetReferenceSpaceBoundsRect) },
-        { "xrCreateActionSpace",                        reinterpret_cast<PFN_xrVoidFunction>(xrCreateActionSpace) },
-        { "xrLocateSpace",                              reinterpret_cast<PFN_xrVoidFunction>(xrLocateSpace) },
-        { "xrDestroySpace",                             reinterpret_cast<PFN_xrVoidFunction>(xrDestroySpace) },
-        { "xrEnumerateViewConfigurations",              reinterpret_cast<PFN_xrVoidFunction>(xrEnumerateViewConfigurations) },
-        { "xrGetViewConfigurationProperties",           reinterpret_cast<PFN_xrVoidFunction>(xrGetViewConfigurationProperties) },
-        { "xrEnumerateViewConfigurationViews",          reinterpret_cast<PFN_xrVoidFunction>(xrEnumerateViewConfigurationViews) },
-        { "xrEnumerateSwapchainFormats",                reinterpret_cast<PFN_xrVoidFunction>(xrEnumerateSwapchainFormats) },
-        { "xrCreateSwapchain",                          reinterpret_cast<PFN_xrVoidFunction>(xrCreateSwapchain) },
-        { "xrDestroySwapchain",                         reinterpret_cast<PFN_xrVoidFunction>(xrDestroySwapchain) },
-        { "xrEnumerateSwapchainImages",                 reinterpret_cast<PFN_xrVoidFunction>(xrEnumerateSwapchainImages) },
-        { "xrAcquireSwapchainImage",                    reinterpret_cast<PFN_xrVoidFunction>(xrAcquireSwapchainImage) },
-        { "xrWaitSwapchainImage",                       reinterpret_cast<PFN_xrVoidFunction>(xrWaitSwapchainImage) },
-        { "xrReleaseSwapchainImage",                    reinterpret_cast<PFN_xrVoidFunction>(xrReleaseSwapchainImage) },
-        { "xrBeginSession",                             reinterpret_cast<PFN_xrVoidFunction>(xrBeginSession) },
-        { "xrEndSession",                               reinterpret_cast<PFN_xrVoidFunction>(xrEndSession) },
-        { "xrRequestExitSession",                       reinterpret_cast<PFN_xrVoidFunction>(xrRequestExitSession) },
-        { "xrWaitFrame",                                reinterpret_cast<PFN_xrVoidFunction>(xrWaitFrame) },
-        { "xrBeginFrame",                               reinterpret_cast<PFN_xrVoidFunction>(xrBeginFrame) },
-        { "xrEndFrame",                                 reinterpret_cast<PFN_xrVoidFunction>(xrEndFrame) },
-        { "xrLocateViews",                              reinterpret_cast<PFN_xrVoidFunction>(xrLocateViews) },
-        { "xrStringToPath",                             reinterpret_cast<PFN_xrVoidFunction>(xrStringToPath) },
-        { "xrPathToString",                             reinterpret_cast<PFN_xrVoidFunction>(xrPathToString) },
-        { "xrCreateActionSet",                          reinterpret_cast<PFN_xrVoidFunction>(xrCreateActionSet) },
-        { "xrDestroyActionSet",                         reinterpret_cast<PFN_xrVoidFunction>(xrDestroyActionSet) },
-        { "xrCreateAction",                             reinterpret_cast<PFN_xrVoidFunction>(xrCreateAction) },
-        { "xrDestroyAction",                            reinterpret_cast<PFN_xrVoidFunction>(xrDestroyAction) },
-        { "xrSuggestInteractionProfileBindings",        reinterpret_cast<PFN_xrVoidFunction>(xrSuggestInteractionProfileBindings) },
-        { "xrAttachSessionActionSets",                  reinterpret_cast<PFN_xrVoidFunction>(xrAttachSessionActionSets) },
-        { "xrGetCurrentInteractionProfile",             reinterpret_cast<PFN_xrVoidFunction>(xrGetCurrentInteractionProfile) },
-        { "xrGetActionStateBoolean",                    reinterpret_cast<PFN_xrVoidFunction>(xrGetActionStateBoolean) },
-        { "xrGetActionStateFloat",                      reinterpret_cast<PFN_xrVoidFunction>(xrGetActionStateFloat) },
-        { "xrGetActionStateVector2f",                   reinterpret_cast<PFN_xrVoidFunction>(xrGetActionStateVector2f) },
-        { "xrGetActionStatePose",                       reinterpret_cast<PFN_xrVoidFunction>(xrGetActionStatePose) },
-        { "xrSyncActions",                              reinterpret_cast<PFN_xrVoidFunction>(xrSyncActions) },
-        { "xrEnumerateBoundSourcesForAction",           reinterpret_cast<PFN_xrVoidFunction>(xrEnumerateBoundSourcesForAction) },
-        { "xrGetInputSourceLocalizedName",              reinterpret_cast<PFN_xrVoidFunction>(xrGetInputSourceLocalizedName) },
-        { "xrApplyHapticFeedback",                      reinterpret_cast<PFN_xrVoidFunction>(xrApplyHapticFeedback) },
-        { "xrStopHapticFeedback",                       reinterpret_cast<PFN_xrVoidFunction>(xrStopHapticFeedback) },
+    struct GB_FunctionEntry {
+        std::string_view name;
+        // Function pointers can't be reinterpret_cast in a constant expression, so the table stores a resolver per function instead
+        PFN_xrVoidFunction(*resolve)();
+        // Resolves to a thunk that records every call, function is the index of the entry
+        PFN_xrVoidFunction(*resolve_capture)(uint16_t function);
+        GB_ReplayFunction replay;
+    };
+
+    template <auto Function>
+    PFN_xrVoidFunction ResolveFunction() {
+        return reinterpret_cast<PFN_xrVoidFunction>(Function);
+    }
+
+    template <auto Function>
+    PFN_xrVoidFunction ResolveCaptureThunk(uint16_t function) {
+        GB_CaptureThunk<Function>::function.store(function, std::memory_order_relaxed);
+        return reinterpret_cast<PFN_xrVoidFunction>(&GB_CaptureThunk<Function>::Call);
+    }
+
+    template <auto Function>
+    consteval GB_FunctionEntry MakeFunctionEntry(std::string_view name) {
+        return { name, &ResolveFunction<Function>, &ResolveCaptureThunk<Function>, &GB_ReplayThunk<Function>::Call };
+    }
+
+    template <size_t Size>
+    consteval std::array<GB_FunctionEntry, Size> SortFunctionTable(std::array<GB_FunctionEntry, Size> table) {
+        std::sort(table.begin(), table.end(), [](const GB_FunctionEntry& a, const GB_FunctionEntry& b) { return a.name < b.name; });
+        return table;
+    }
+
+    // Sorted by name at compile time, xrGetInstanceProcAddr binary searches it
+    constexpr auto openxr_functions = SortFunctionTable(std::array{
+        MakeFunctionEntry<xrGetInstanceProcAddr>("xrGetInstanceProcAddr"),
+        MakeFunctionEntry<xrEnumerateInstanceExtensionProperties>("xrEnumerateInstanceExtensionProperties"),
+        MakeFunctionEntry<xrCreateInstance>("xrCreateInstance"),
+        MakeFunctionEntry<xrDestroyInstance>("xrDestroyInstance"),
+        MakeFunctionEntry<xrGetInstanceProperties>("xrGetInstanceProperties"),
+        MakeFunctionEntry<xrPollEvent>("xrPollEvent"),
+        MakeFunctionEntry<xrResultToString>("xrResultToString"),
+        MakeFunctionEntry<xrStructureTypeToString>("xrStructureTypeToString"),
+        MakeFunctionEntry<xrGetSystem>("xrGetSystem"),
+        MakeFunctionEntry<xrGetSystemProperties>("xrGetSystemProperties"),
+        MakeFunctionEntry<xrEnumerateEnvironmentBlendModes>("xrEnumerateEnvironmentBlendModes"),
+        MakeFunctionEntry<xrCreateSession>("xrCreateSession"),
+        MakeFunctionEntry<xrDestroySession>("xrDestroySession"),
+        MakeFunctionEntry<xrEnumerateReferenceSpaces>("xrEnumerateReferenceSpaces"),
+        MakeFunctionEntry<xrCreateReferenceSpace>("xrCreateReferenceSpace"),
+        MakeFunctionEntry<xrGetReferenceSpaceBoundsRect>("xrGetReferenceSpaceBoundsRect"),
+        MakeFunctionEntry<xrCreateActionSpace>("xrCreateActionSpace"),
+        MakeFunctionEntry<xrLocateSpace>("xrLocateSpace"),
+        MakeFunctionEntry<xrDestroySpace>("xrDestroySpace"),
+        MakeFunctionEntry<xrEnumerateViewConfigurations>("xrEnumerateViewConfigurations"),
+        MakeFunctionEntry<xrGetViewConfigurationProperties>("xrGetViewConfigurationProperties"),
+        MakeFunctionEntry<xrEnumerateViewConfigurationViews>("xrEnumerateViewConfigurationViews"),
+        MakeFunctionEntry<xrEnumerateSwapchainFormats>("xrEnumerateSwapchainFormats"),
+        MakeFunctionEntry<xrCreateSwapchain>("xrCreateSwapchain"),
+        MakeFunctionEntry<xrDestroySwapchain>("xrDestroySwapchain"),
+        MakeFunctionEntry<xrEnumerateSwapchainImages>("xrEnumerateSwapchainImages"),
+        MakeFunctionEntry<xrAcquireSwapchainImage>("xrAcquireSwapchainImage"),
+        MakeFunctionEntry<xrWaitSwapchainImage>("xrWaitSwapchainImage"),
+        MakeFunctionEntry<xrReleaseSwapchainImage>("xrReleaseSwapchainImage"),
+        MakeFunctionEntry<xrBeginSession>("xrBeginSession"),
+        MakeFunctionEntry<xrEndSession>("xrEndSession"),
+        MakeFunctionEntry<xrRequestExitSession>("xrRequestExitSession"),
+        MakeFunctionEntry<xrWaitFrame>("xrWaitFrame"),
+        MakeFunctionEntry<xrBeginFrame>("xrBeginFrame"),
+        MakeFunctionEntry<xrEndFrame>("xrEndFrame"),
+        MakeFunctionEntry<xrLocateViews>("xrLocateViews"),
+        MakeFunctionEntry<xrStringToPath>("xrStringToPath"),
+        MakeFunctionEntry<xrPathToString>("xrPathToString"),
+        MakeFunctionEntry<xrCreateActionSet>("xrCreateActionSet"),
+        MakeFunctionEntry<xrDestroyActionSet>("xrDestroyActionSet"),
+        MakeFunctionEntry<xrCreateAction>("xrCreateAction"),
+        MakeFunctionEntry<xrDestroyAction>("xrDestroyAction"),
+        MakeFunctionEntry<xrSuggestInteractionProfileBindings>("xrSuggestInteractionProfileBindings"),
+        MakeFunctionEntry<xrAttachSessionActionSets>("xrAttachSessionActionSets"),
+        MakeFunctionEntry<xrGetCurrentInteractionProfile>("xrGetCurrentInteractionProfile"),
+        MakeFunctionEntry<xrGetActionStateBoolean>("xrGetActionStateBoolean"),
+        MakeFunctionEntry<xrGetActionStateFloat>("xrGetActionStateFloat"),
+        MakeFunctionEntry<xrGetActionStateVector2f>("xrGetActionStateVector2f"),
+        MakeFunctionEntry<xrGetActionStatePose>("xrGetActionStatePose"),
+        MakeFunctionEntry<xrSyncActions>("xrSyncActions"),
+        MakeFunctionEntry<xrEnumerateBoundSourcesForAction>("xrEnumerateBoundSourcesForAction"),
+        MakeFunctionEntry<xrGetInputSourceLocalizedName>("xrGetInputSourceLocalizedName"),
+        MakeFunctionEntry<xrApplyHapticFeedback>("xrApplyHapticFeedback"),
+        MakeFunctionEntry<xrStopHapticFeedback>("xrStopHapticFeedback"),
 
         // Graphics extensions
-        //{ "xrGetD3D11GraphicsRequirementsKHR",          reinterpret_cast<PFN_xrVoidFunction>(xrGetD3D11GraphicsRequirementsKHR) },
-        { "xrGetD3D12GraphicsRequirementsKHR",          reinterpret_cast<PFN_xrVoidFunction>(xrGetD3D12GraphicsRequirementsKHR) }
+        MakeFunctionEntry<xrGetD3D11GraphicsRequirementsKHR>("xrGetD3D11GraphicsRequirementsKHR"),
+        MakeFunctionEntry<xrGetD3D12GraphicsRequirementsKHR>("xrGetD3D12GraphicsRequirementsKHR"),
+    });
+
+    // Functions of extensions we know about but don't implement. Engines probe these while starting up,
+    // they are answered with XR_ERROR_FUNCTION_UNSUPPORTED without logging a warning.
+    constexpr auto extension_stub_functions = std::to_array<std::string_view>({
+        // XR_KHR_win32_convert_performance_counter_time
+        "xrConvertWin32PerformanceCounterToTimeKHR",
+        "xrConvertTimeToWin32PerformanceCounterKHR",
+
+        // XR_KHR_vulkan_enable and XR_KHR_vulkan_enable2
+        "xrGetVulkanInstanceExtensionsKHR",
+        "xrGetVulkanDeviceExtensionsKHR",
+        "xrGetVulkanGraphicsDeviceKHR",
+        "xrGetVulkanGraphicsRequirementsKHR",
+        "xrCreateVulkanInstanceKHR",
+        "xrCreateVulkanDeviceKHR",
+        "xrGetVulkanGraphicsDevice2KHR",
+        "xrGetVulkanGraphicsRequirements2KHR",
+
+        // XR_KHR_opengl_enable
+        "xrGetOpenGLGraphicsRequirementsKHR",
+
+        // XR_KHR_visibility_mask
+        "xrGetVisibilityMaskKHR",
+
+        // XR_EXT_hand_tracking
+        "xrCreateHandTrackerEXT",
+        "xrDestroyHandTrackerEXT",
+        "xrLocateHandJointsEXT",
+
+        // XR_FB_display_refresh_rate
+        "xrEnumerateDisplayRefreshRatesFB",
+        "xrGetDisplayRefreshRateFB",
+        "xrRequestDisplayRefreshRateFB",
+
+        // XR_EXT_debug_utils
+        "xrSetDebugUtilsObjectNameEXT",
+        "xrCreateDebugUtilsMessengerEXT",
+        "xrDestroyDebugUtilsMessengerEXT",
+        "xrSubmitDebugUtilsMessageEXT",
+        "xrSessionBeginDebugUtilsLabelRegionEXT",
+        "xrSessionEndDebugUtilsLabelRegionEXT",
+        "xrSessionInsertDebugUtilsLabelEXT",
+    });
+
+    constexpr const GB_FunctionEntry* FindFunctionEntry(std::string_view name) {
+        auto it = std::lower_bound(openxr_functions.begin(), openxr_functions.end(), name, [](const GB_FunctionEntry& entry, std::string_view value) {
+            return entry.name < value;
+        });
+        if (it == openxr_functions.end() || it->name != name) {
+            return nullptr;
+        }
+        return &*it;
+    }
+
+    constexpr bool IsExtensionStubFunction(std::string_view name) {
+        return std::find(extension_stub_functions.begin(), extension_stub_functions.end(), name) != extension_stub_functions.end();
+    }
+
+    // Every OpenXR 1.0 core function a runtime has to answer. xrEnumerateApiLayerProperties is left out, the loader implements it.
+    constexpr auto core_functions = std::to_array<std::string_view>({
+        "xrGetInstanceProcAddr", "xrEnumerateInstanceExtensionProperties", "xrCreateInstance", "xrDestroyInstance",
+        "xrGetInstanceProperties", "xrPollEvent", "xrResultToString", "xrStructureTypeToString",
+        "xrGetSystem", "xrGetSystemProperties", "xrEnumerateEnvironmentBlendModes",
+        "xrCreateSession", "xrDestroySession", "xrBeginSession", "xrEndSession", "xrRequestExitSession",
+        "xrEnumerateReferenceSpaces", "xrCreateReferenceSpace", "xrGetReferenceSpaceBoundsRect", "xrCreateActionSpace", "xrLocateSpace", "xrDestroySpace",
+        "xrEnumerateViewConfigurations", "xrGetViewConfigurationProperties", "xrEnumerateViewConfigurationViews",
+        "xrEnumerateSwapchainFormats", "xrCreateSwapchain", "xrDestroySwapchain", "xrEnumerateSwapchainImages",
+        "xrAcquireSwapchainImage", "xrWaitSwapchainImage", "xrReleaseSwapchainImage",
+        "xrWaitFrame", "xrBeginFrame", "xrEndFrame", "xrLocateViews",
+        "xrStringToPath", "xrPathToString",
+        "xrCreateActionSet", "xrDestroyActionSet", "xrCreateAction", "xrDestroyAction",
+        "xrSuggestInteractionProfileBindings", "xrAttachSessionActionSets", "xrGetCurrentInteractionProfile",
+        "xrGetActionStateBoolean", "xrGetActionStateFloat", "xrGetActionStateVector2f", "xrGetActionStatePose",
+        "xrSyncActions", "xrEnumerateBoundSourcesForAction", "xrGetInputSourceLocalizedName",
+        "xrApplyHapticFeedback", "xrStopHapticFeedback"
+    });
+
+    struct GB_ExtensionEntry {
+        std::string_view name;
+        uint32_t spec_version;
+        // Functions the extension adds, unused entries are nullptr
+        std::array<const char*, 2> functions;
     };
 
-    const std::vector<XrExtensionProperties> supported_extensions{
+    // Extensions xrEnumerateInstanceExtensionProperties reports. Every function they add has to be implemented, a stub doesn't count.
+    // XR_KHR_win32_convert_performance_counter_time is left out, XrTime counts from the session epoch so an instance can't convert it.
+    constexpr auto advertised_extensions = std::to_array<GB_ExtensionEntry>({
         // Microsoft Windows extensions
-        { XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_EXT_WIN32_APPCONTAINER_COMPATIBLE_EXTENSION_NAME, XR_EXT_win32_appcontainer_compatible_SPEC_VERSION },
-        { XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME, XR_KHR_win32_convert_performance_counter_time_SPEC_VERSION },
-        { XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME, XR_KHR_composition_layer_depth_SPEC_VERSION },
+        { XR_EXT_WIN32_APPCONTAINER_COMPATIBLE_EXTENSION_NAME, XR_EXT_win32_appcontainer_compatible_SPEC_VERSION, {} },
+        { XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME, XR_KHR_composition_layer_depth_SPEC_VERSION, {} },
+        // Sessions without a graphics binding, composed by the null backend
+        { XR_MND_HEADLESS_EXTENSION_NAME, XR_MND_headless_SPEC_VERSION, {} },
 
         // Graphics Extensions
-        { XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_KHR_D3D11_ENABLE_EXTENSION_NAME, XR_KHR_D3D11_enable_SPEC_VERSION },
-        { XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_KHR_D3D12_ENABLE_EXTENSION_NAME, XR_KHR_D3D12_enable_SPEC_VERSION },
-        //{ XR_TYPE_EXTENSION_PROPERTIES, nullptr, XR_KHR_VULKAN_ENABLE2_EXTENSION_NAME, XR_KHR_vulkan_enable2_SPEC_VERSION }
-    };
+        { XR_KHR_D3D11_ENABLE_EXTENSION_NAME, XR_KHR_D3D11_enable_SPEC_VERSION, { "xrGetD3D11GraphicsRequirementsKHR" } },
+        { XR_KHR_D3D12_ENABLE_EXTENSION_NAME, XR_KHR_D3D12_enable_SPEC_VERSION, { "xrGetD3D12GraphicsRequirementsKHR" } },
+        //{ XR_KHR_VULKAN_ENABLE2_EXTENSION_NAME, XR_KHR_vulkan_enable2_SPEC_VERSION, { ... } },
+    });
+
+    consteval bool HasUniqueNames() {
+        return std::adjacent_find(openxr_functions.begin(), openxr_functions.end(), [](const GB_FunctionEntry& a, const GB_FunctionEntry& b) {
+            return a.name == b.name;
+        }) == openxr_functions.end();
+    }
+
+    consteval bool AllCoreFunctionsResolve() {
+        return std::all_of(core_functions.begin(), core_functions.end(), [](std::string_view name) {
+            return FindFunctionEntry(name) != nullptr;
+        });
+    }
+
+    consteval bool AllExtensionFunctionsResolve() {
+        return std::all_of(advertised_extensions.begin(), advertised_extensions.end(), [](const GB_ExtensionEntry& extension) {
+            return std::all_of(extension.functions.begin(), extension.functions.end(), [](const char* name) {
+                return name == nullptr || FindFunctionEntry(name) != nullptr;
+            });
+        });
+    }
+
+    consteval bool ExtensionNamesFit() {
+        return std::all_of(advertised_extensions.begin(), advertised_extensions.end(), [](const GB_ExtensionEntry& extension) {
+            return extension.name.size() < XR_MAX_EXTENSION_NAME_SIZE;
+        });
+    }
+
+    static_assert(HasUniqueNames(), "openxr_functions contains a function twice");
+    static_assert(AllCoreFunctionsResolve(), "A core OpenXR function is missing from openxr_functions");
+    static_assert(AllExtensionFunctionsResolve(), "A function of an advertised extension is not implemented");
+    static_assert(ExtensionNamesFit(), "An extension name doesn't fit XrExtensionProperties");
+    static_assert(sizeof(XrSwapchainImageD3D12KHR) == g_trace_swapchain_image_size, "Captured swapchain images don't match the D3D12 image struct");
+
+    inline std::vector<XrExtensionProperties> MakeExtensionProperties() {
+        std::vector<XrExtensionProperties> properties;
+        for (const GB_ExtensionEntry& extension : advertised_extensions) {
+            XrExtensionProperties& property = properties.emplace_back(XrExtensionProperties{ XR_TYPE_EXTENSION_PROPERTIES });
+            extension.name.copy(property.extensionName, extension.name.size());
+            property.extensionVersion = extension.spec_version;
+        }
+        return properties;
+    }
+
+    const std::vector<XrExtensionProperties> supported_extensions = MakeExtensionProperties();
 }
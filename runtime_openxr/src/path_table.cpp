@@ -0,0 +1,162 @@
+#include "path_table.h"
+
+#include <cstring>
+#include <mutex>
+
+namespace XRGameBridge {
+    GB_PathTable::GB_PathTable() {
+        // Interaction profile setup registers a few hundred paths, start big enough to not rehash for those
+        buckets.resize(1024);
+        entries.reserve(512);
+    }
+
+    // FNV-1a
+    uint64_t GB_PathTable::Hash(std::string_view string) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : string) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    const GB_PathTable::Bucket& GB_PathTable::FindBucket(std::string_view string, uint64_t hash) const {
+        const size_t mask = buckets.size() - 1;
+        size_t index = hash & mask;
+
+        // Linear probing, the load factor is kept below 0.5 so there is always an empty bucket to stop at
+        while (true) {
+            const Bucket& bucket = buckets[index];
+            if (bucket.id == 0) {
+                return bucket;
+            }
+            if (bucket.hash == hash && entries[bucket.id - 1] == string) {
+                return bucket;
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    std::string_view GB_PathTable::CopyToArena(std::string_view string) {
+        // Keep the null terminator so the stored string can be handed out as a c string
+        const size_t size = string.size() + 1;
+
+        char* destination;
+        if (size > arena_block_size) {
+            // Oversized strings get their own block in front of the current one, so the current block keeps being filled
+            auto position = arena_blocks.empty() ? arena_blocks.end() : arena_blocks.end() - 1;
+            destination = arena_blocks.insert(position, std::make_unique<char[]>(size))->get();
+        }
+        else {
+            if (arena_block_used + size > arena_block_size) {
+                arena_blocks.emplace_back(std::make_unique<char[]>(arena_block_size));
+                arena_block_used = 0;
+            }
+            destination = arena_blocks.back().get() + arena_block_used;
+            arena_block_used += size;
+        }
+
+        memcpy(destination, string.data(), string.size());
+        destination[string.size()] = '\0';
+        return std::string_view(destination, string.size());
+    }
+
+    void GB_PathTable::Grow() {
+        std::vector<Bucket> old_buckets(buckets.size() * 2);
+        old_buckets.swap(buckets);
+
+        const size_t mask = buckets.size() - 1;
+        for (const Bucket& bucket : old_buckets) {
+            if (bucket.id == 0) {
+                continue;
+            }
+            size_t index = bucket.hash & mask;
+            while (buckets[index].id != 0) {
+                index = (index + 1) & mask;
+            }
+            buckets[index] = bucket;
+        }
+    }
+
+    XrPath GB_PathTable::Intern(std::string_view path) {
+        const uint64_t hash = Hash(path);
+
+        // Most calls register a path that already exists, try that under the shared lock first
+        {
+            std::shared_lock lock(mutex);
+            const Bucket& bucket = FindBucket(path, hash);
+            if (bucket.id != 0) {
+                return bucket.id;
+            }
+        }
+
+        std::unique_lock lock(mutex);
+
+        // Another thread may have registered the path in between the locks
+        Bucket* bucket = const_cast<Bucket*>(&FindBucket(path, hash));
+        if (bucket->id != 0) {
+            return bucket->id;
+        }
+
+        // Growing moves the buckets, the free one has to be found again
+        if ((entries.size() + 1) * 2 > buckets.size()) {
+            Grow();
+            bucket = const_cast<Bucket*>(&FindBucket(path, hash));
+        }
+
+        entries.push_back(CopyToArena(path));
+        bucket->hash = hash;
+        bucket->id = static_cast<uint32_t>(entries.size());
+        return bucket->id;
+    }
+
+    XrPath GB_PathTable::Find(std::string_view path) const {
+        std::shared_lock lock(mutex);
+        return FindBucket(path, Hash(path)).id;
+    }
+
+    std::string_view GB_PathTable::ToString(XrPath path) const {
+        std::shared_lock lock(mutex);
+        if (path == XR_NULL_PATH || path > entries.size()) {
+            return {};
+        }
+        return entries[path - 1];
+    }
+
+    uint32_t GB_PathTable::Size() const {
+        std::shared_lock lock(mutex);
+        return static_cast<uint32_t>(entries.size());
+    }
+
+    XrResult StringToPath(GB_PathTable& table, const char* path_string, XrPath* path) {
+        const std::string_view string(path_string);
+        if (string.empty() || string.size() >= XR_MAX_PATH_LENGTH) {
+            return XR_ERROR_PATH_FORMAT_INVALID;
+        }
+
+        *path = table.Intern(string);
+        return XR_SUCCESS;
+    }
+
+    XrResult PathToString(const GB_PathTable& table, XrPath path, uint32_t buffer_capacity, uint32_t* buffer_count, char* buffer) {
+        const std::string_view string = table.ToString(path);
+        if (string.empty()) {
+            return XR_ERROR_PATH_INVALID;
+        }
+
+        // The count includes the null terminator
+        const uint32_t size = static_cast<uint32_t>(string.size()) + 1;
+        *buffer_count = size;
+
+        if (buffer_capacity == 0) {
+            return XR_SUCCESS;
+        }
+        if (buffer_capacity < size) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+
+        // Strings in the path table are null terminated
+        memcpy(buffer, string.data(), size);
+        return XR_SUCCESS;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+#include <openxr/openxr.h>
+
+namespace XRGameBridge {
+    // Interns XrPath strings.
+    // Every string is stored once in a bump allocated arena and gets a dense, sequential id starting at 1 so XR_NULL_PATH stays invalid.
+    // String to id goes through an open addressing hash table that compares the full string, so different paths never share an id.
+    // Id to string is an index into the entry array.
+    // Paths are never removed, the spec keeps them valid for the lifetime of the instance.
+    class GB_PathTable {
+        struct Bucket {
+            uint64_t hash = 0;
+            uint32_t id = 0; // 0 marks an empty bucket
+        };
+
+        static constexpr size_t arena_block_size = 16 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> arena_blocks;
+        size_t arena_block_used = arena_block_size;
+
+        // Index is id - 1
+        std::vector<std::string_view> entries;
+        std::vector<Bucket> buckets;
+
+        mutable std::shared_mutex mutex;
+
+        static uint64_t Hash(std::string_view string);
+
+        // Must be called with the mutex held, returns the bucket holding the string or the empty bucket it should go into
+        const Bucket& FindBucket(std::string_view string, uint64_t hash) const;
+        std::string_view CopyToArena(std::string_view string);
+        void Grow();
+
+    public:
+        GB_PathTable();
+
+        // Returns the id of the path, registering it if it doesn't exist yet
+        XrPath Intern(std::string_view path);
+
+        // Returns XR_NULL_PATH if the path was never registered
+        XrPath Find(std::string_view path) const;
+
+        // Returns an empty view for XR_NULL_PATH and ids that were never handed out.
+        // The view stays valid for the lifetime of the table.
+        std::string_view ToString(XrPath path) const;
+
+        uint32_t Size() const;
+    };
+
+    // xrStringToPath and xrPathToString on a given table, the entry points pass g_path_table
+    XrResult StringToPath(GB_PathTable& table, const char* path_string, XrPath* path);
+    XrResult PathToString(const GB_PathTable& table, XrPath path, uint32_t buffer_capacity, uint32_t* buffer_count, char* buffer);
+}
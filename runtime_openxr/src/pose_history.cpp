@@ -0,0 +1,255 @@
+#include "pose_history.h"
+
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace XRGameBridge {
+    namespace {
+        XrVector3f Lerp(const XrVector3f& a, const XrVector3f& b, float t) {
+            return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t };
+        }
+
+        // Normalized linear interpolation along the shortest arc, close enough to slerp for the small steps between samples
+        XrQuaternionf Nlerp(const XrQuaternionf& a, XrQuaternionf b, float t) {
+            if (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f) {
+                b = { -b.x, -b.y, -b.z, -b.w };
+            }
+            XrQuaternionf result{ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t };
+            const float length = std::sqrt(result.x * result.x + result.y * result.y + result.z * result.z + result.w * result.w);
+            if (length <= 0.0f) {
+                return a;
+            }
+            return { result.x / length, result.y / length, result.z / length, result.w / length };
+        }
+
+        // t is allowed to go past 1 to extrapolate
+        GB_PoseSample Interpolate(const GB_PoseSample& a, const GB_PoseSample& b, XrTime time) {
+            const XrDuration interval = b.time - a.time;
+            const float t = interval > 0 ? static_cast<float>(static_cast<double>(time - a.time) / static_cast<double>(interval)) : 1.0f;
+
+            GB_PoseSample result;
+            result.time = time;
+            result.left_eye = Lerp(a.left_eye, b.left_eye, t);
+            result.right_eye = Lerp(a.right_eye, b.right_eye, t);
+            result.head_orientation = Nlerp(a.head_orientation, b.head_orientation, t);
+            return result;
+        }
+    }
+
+    void GB_PoseHistory::AddSample(const GB_PoseSample& sample) {
+        const uint64_t index = sample_count.load(std::memory_order_relaxed);
+        Slot& slot = slots[index % capacity];
+
+        std::array<uint64_t, sample_words> words{};
+        memcpy(words.data(), &sample, sizeof(GB_PoseSample));
+
+        // Mark the slot as being written before touching the data, readers that see the odd version retry
+        slot.version.store(2 * (index + 1) - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (uint32_t i = 0; i < sample_words; i++) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.version.store(2 * (index + 1), std::memory_order_release);
+
+        sample_count.store(index + 1, std::memory_order_release);
+        generation.fetch_add(1, std::memory_order_release);
+
+        if (GB_TraceWriter* writer = trace_writer.load(std::memory_order_acquire)) {
+            writer->WriteEyeSample(sample);
+        }
+    }
+
+    void GB_PoseHistory::SetTraceWriter(GB_TraceWriter* writer) {
+        trace_writer.store(writer, std::memory_order_release);
+    }
+
+    bool GB_PoseHistory::ReadSample(uint64_t index, GB_PoseSample& sample) const {
+        const Slot& slot = slots[index % capacity];
+        const uint64_t expected_version = 2 * (index + 1);
+
+        if (slot.version.load(std::memory_order_acquire) != expected_version) {
+            return false;
+        }
+
+        std::array<uint64_t, sample_words> words;
+        for (uint32_t i = 0; i < sample_words; i++) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+
+        // The data loads may not move past the second version check
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) != expected_version) {
+            return false;
+        }
+
+        memcpy(&sample, words.data(), sizeof(GB_PoseSample));
+        return true;
+    }
+
+    bool GB_PoseHistory::Sample(XrTime time, GB_PoseSample& sample) const {
+        // A read only fails when the writer lapped the reader, the next attempt searches the newer samples
+        for (uint32_t attempt = 0; attempt < 4; attempt++) {
+            const uint64_t count = sample_count.load(std::memory_order_acquire);
+            if (count == 0) {
+                return false;
+            }
+
+            // Stay away from the oldest slots, those are the next ones the writer overwrites
+            const uint64_t newest_index = count - 1;
+            const uint64_t oldest_index = count > capacity ? count - capacity + capacity / 8 : 0;
+
+            GB_PoseSample newest;
+            if (!ReadSample(newest_index, newest)) {
+                continue;
+            }
+
+            // Past the newest sample, extrapolate from the last two
+            if (time >= newest.time) {
+                GB_PoseSample previous;
+                if (newest_index == oldest_index || !ReadSample(newest_index - 1, previous)) {
+                    sample = newest;
+                    sample.time = time;
+                    return true;
+                }
+                sample = Interpolate(previous, newest, std::min(time, newest.time + max_extrapolation));
+                sample.time = time;
+                return true;
+            }
+
+            GB_PoseSample oldest;
+            if (!ReadSample(oldest_index, oldest)) {
+                continue;
+            }
+            if (time <= oldest.time) {
+                sample = oldest;
+                sample.time = time;
+                return true;
+            }
+
+            // Binary search for the two samples around the time, low.time <= time < high.time
+            uint64_t low = oldest_index;
+            uint64_t high = newest_index;
+            GB_PoseSample low_sample = oldest;
+            GB_PoseSample high_sample = newest;
+            bool lapped = false;
+            while (high - low > 1) {
+                const uint64_t middle = low + (high - low) / 2;
+                GB_PoseSample middle_sample;
+                if (!ReadSample(middle, middle_sample)) {
+                    lapped = true;
+                    break;
+                }
+                if (middle_sample.time <= time) {
+                    low = middle;
+                    low_sample = middle_sample;
+                }
+                else {
+                    high = middle;
+                    high_sample = middle_sample;
+                }
+            }
+            if (lapped) {
+                continue;
+            }
+
+            sample = Interpolate(low_sample, high_sample, time);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool GB_PoseHistory::GetNewest(GB_PoseSample& sample) const {
+        for (uint32_t attempt = 0; attempt < 4; attempt++) {
+            const uint64_t count = sample_count.load(std::memory_order_acquire);
+            if (count == 0) {
+                return false;
+            }
+            if (ReadSample(count - 1, sample)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t GB_PoseHistory::GetRecent(GB_PoseSample* samples, uint32_t count) const {
+        for (uint32_t attempt = 0; attempt < 4; attempt++) {
+            const uint64_t total = sample_count.load(std::memory_order_acquire);
+            // Stay away from the oldest slots like Sample does
+            const uint32_t copied = static_cast<uint32_t>(std::min<uint64_t>({ count, total, capacity - capacity / 8 }));
+
+            bool lapped = false;
+            for (uint32_t i = 0; i < copied && !lapped; i++) {
+                lapped = !ReadSample(total - copied + i, samples[i]);
+            }
+            if (!lapped) {
+                return copied;
+            }
+        }
+        return 0;
+    }
+
+    uint64_t GB_PoseHistory::GetSampleCount() const {
+        return sample_count.load(std::memory_order_acquire);
+    }
+
+    uint64_t GB_PoseHistory::GetGeneration() const {
+        return generation.load(std::memory_order_acquire);
+    }
+
+    GB_SyntheticPoseSource::GB_SyntheticPoseSource(const GB_Clock& clock, XrDuration sample_interval) : clock(clock), sample_interval(sample_interval) {
+    }
+
+    GB_SyntheticPoseSource::~GB_SyntheticPoseSource() {
+        Stop();
+    }
+
+    bool GB_SyntheticPoseSource::Start(GB_PoseHistory& history) {
+        if (running.exchange(true)) {
+            return false;
+        }
+
+        thread = std::thread([this, &history] {
+            while (running.load(std::memory_order_relaxed)) {
+                history.AddSample(Generate(clock.Now()));
+                std::this_thread::sleep_for(std::chrono::nanoseconds(sample_interval));
+            }
+        });
+        return true;
+    }
+
+    void GB_SyntheticPoseSource::Stop() {
+        running.store(false);
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    GB_PoseSample GB_SyntheticPoseSource::Generate(XrTime time) {
+        constexpr double two_pi = 6.283185307179586;
+        constexpr float half_ipd = 0.032f;
+        const double seconds = static_cast<double>(time) * 1e-9;
+
+        const float x = static_cast<float>(0.05 * std::sin(two_pi * 0.25 * seconds));
+        const float y = static_cast<float>(0.01 * std::sin(two_pi * 0.5 * seconds));
+        const float z = static_cast<float>(0.6 + 0.05 * std::sin(two_pi * 0.1 * seconds));
+        // Turning the head around the y axis moves the eyes around the center between them
+        const float yaw = static_cast<float>(0.1 * std::sin(two_pi * 0.2 * seconds));
+
+        GB_PoseSample sample;
+        sample.time = time;
+        sample.left_eye = { x - half_ipd * std::cos(yaw), y, z + half_ipd * std::sin(yaw) };
+        sample.right_eye = { x + half_ipd * std::cos(yaw), y, z - half_ipd * std::sin(yaw) };
+        sample.head_orientation = { 0.0f, std::sin(yaw / 2.0f), 0.0f, std::cos(yaw / 2.0f) };
+        return sample;
+    }
+
+    void GB_SyntheticPoseSource::Fill(GB_PoseHistory& history, XrTime start, XrDuration interval, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            history.AddSample(Generate(start + interval * i));
+        }
+    }
+}
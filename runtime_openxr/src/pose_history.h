@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include <openxr/openxr.h>
+
+#include "frame_timer.h"
+
+namespace XRGameBridge {
+    class GB_TraceWriter;
+
+    // Tracked eye positions at a point in time.
+    // Display space: meters, origin in the center of the screen, x to the right, y up and z towards the viewer.
+    struct GB_PoseSample {
+        XrTime time = 0;
+        XrVector3f left_eye{ -0.032f, 0.0f, 0.6f };
+        XrVector3f right_eye{ 0.032f, 0.0f, 0.6f };
+        XrQuaternionf head_orientation{ 0.0f, 0.0f, 0.0f, 1.0f };
+    };
+
+    // Point between the eyes, the origin of the view space
+    inline XrVector3f GetEyeCenter(const GB_PoseSample& sample) {
+        return { (sample.left_eye.x + sample.right_eye.x) / 2.0f, (sample.left_eye.y + sample.right_eye.y) / 2.0f, (sample.left_eye.z + sample.right_eye.z) / 2.0f };
+    }
+
+    // Ring of the most recent pose samples, written by one tracking thread and read by any number of threads without locks.
+    // Every slot is a seqlock, a reader that races the writer notices it and retries, so it never sees half a sample.
+    // Queries binary search the ring by time and interpolate between the two samples around it, or extrapolate past the newest.
+    class GB_PoseHistory {
+    public:
+        static constexpr uint32_t capacity = 256;
+        // Predicting further ahead than this mostly amplifies tracker noise, the pose is held instead
+        static constexpr XrDuration max_extrapolation = 50'000'000;
+
+    private:
+        static constexpr uint32_t sample_words = (sizeof(GB_PoseSample) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        struct Slot {
+            // 2 * (sample index + 1) once the sample is written, odd while it is being written
+            std::atomic<uint64_t> version = 0;
+            std::array<std::atomic<uint64_t>, sample_words> words{};
+        };
+
+        std::array<Slot, capacity> slots;
+        std::atomic<uint64_t> sample_count = 0;
+        // Incremented on every write, lets caches built from the history notice new samples
+        std::atomic<uint64_t> generation = 0;
+        // Records every added sample when set
+        std::atomic<GB_TraceWriter*> trace_writer = nullptr;
+
+        // Returns false if the sample was overwritten in the meantime
+        bool ReadSample(uint64_t index, GB_PoseSample& sample) const;
+
+    public:
+        // Only one thread may add samples, they have to be added in time order
+        void AddSample(const GB_PoseSample& sample);
+
+        // The writer has to outlive the history or be removed before it's closed
+        void SetTraceWriter(GB_TraceWriter* writer);
+
+        // Pose at the given time, false if there are no samples yet
+        bool Sample(XrTime time, GB_PoseSample& sample) const;
+
+        bool GetNewest(GB_PoseSample& sample) const;
+        // Copies up to count of the newest samples oldest first, returns how many were copied
+        uint32_t GetRecent(GB_PoseSample* samples, uint32_t count) const;
+        uint64_t GetSampleCount() const;
+        uint64_t GetGeneration() const;
+    };
+
+    // Produces pose samples for a history, for example from an eye tracker
+    class GB_PoseSource {
+    public:
+        virtual ~GB_PoseSource() = default;
+        virtual bool Start(GB_PoseHistory& history) = 0;
+        virtual void Stop() = 0;
+    };
+
+    // Moves the eyes on a deterministic path, used when there is no eye tracker and to test locating without hardware.
+    // The head sways left to right and moves towards and away from the screen.
+    class GB_SyntheticPoseSource : public GB_PoseSource {
+        const GB_Clock& clock;
+        XrDuration sample_interval;
+
+        std::thread thread;
+        std::atomic<bool> running = false;
+
+    public:
+        explicit GB_SyntheticPoseSource(const GB_Clock& clock, XrDuration sample_interval = 1'000'000'000 / 90);
+        ~GB_SyntheticPoseSource() override;
+
+        bool Start(GB_PoseHistory& history) override;
+        void Stop() override;
+
+        // The exact pose of the path at a time
+        static GB_PoseSample Generate(XrTime time);
+
+        // Adds count samples starting at start without a thread, for headless use
+        static void Fill(GB_PoseHistory& history, XrTime start, XrDuration interval, uint32_t count);
+    };
+}
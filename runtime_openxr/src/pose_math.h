@@ -0,0 +1,189 @@
+#pragma once
+#include "pose_math_scalar.h"
+
+// Vectorized pose math for the tracking path, SSE on x86 and NEON on ARM64.
+// Every function has a scalar reference in pose_math_scalar.h with the same name and a Scalar suffix. For unit quaternions the results agree
+// within 8 float epsilon of the operands' length, rotations take a different route than the reference so they don't agree to the bit.
+// BM_PoseMath_MatchesScalar checks it.
+// Define GB_POSE_MATH_SCALAR to build the runtime with the scalar path only.
+#if !defined(GB_POSE_MATH_SCALAR) && (defined(_M_X64) || defined(__SSE2__))
+#define GB_POSE_MATH_SSE
+#include <emmintrin.h>
+#elif !defined(GB_POSE_MATH_SCALAR) && (defined(_M_ARM64) || defined(__aarch64__))
+#define GB_POSE_MATH_NEON
+#include <arm_neon.h>
+#endif
+
+namespace XRGameBridge {
+#if defined(GB_POSE_MATH_SSE) || defined(GB_POSE_MATH_NEON)
+    // Four floats in a register, quaternions as (x, y, z, w) and vectors as (x, y, z, 0)
+    namespace pose_math_detail {
+#if defined(GB_POSE_MATH_SSE)
+        using GB_Vec4 = __m128;
+
+        inline GB_Vec4 VecSet(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+        inline GB_Vec4 VecLoad(const XrQuaternionf& q) { return _mm_loadu_ps(&q.x); }
+        // A 16 byte load would read past the end of the last vector in an array
+        inline GB_Vec4 VecLoad(const XrVector3f& v) { return _mm_movelh_ps(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&v.x))), _mm_load_ss(&v.z)); }
+        inline void VecStore(GB_Vec4 v, XrQuaternionf& q) { _mm_storeu_ps(&q.x, v); }
+        inline void VecStore(GB_Vec4 v, XrVector3f& out) {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&out.x), _mm_castps_si128(v));
+            _mm_store_ss(&out.z, _mm_movehl_ps(v, v));
+        }
+
+        inline GB_Vec4 VecAdd(GB_Vec4 a, GB_Vec4 b) { return _mm_add_ps(a, b); }
+        inline GB_Vec4 VecMul(GB_Vec4 a, GB_Vec4 b) { return _mm_mul_ps(a, b); }
+        inline GB_Vec4 VecMul(GB_Vec4 a, float b) { return _mm_mul_ps(a, _mm_set1_ps(b)); }
+        inline float VecDot(GB_Vec4 a, GB_Vec4 b) {
+            const GB_Vec4 m = _mm_mul_ps(a, b);
+            const GB_Vec4 s = _mm_add_ps(m, _mm_movehl_ps(m, m));
+            return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1))));
+        }
+
+        template <int lane>
+        GB_Vec4 VecSplat(GB_Vec4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(lane, lane, lane, lane)); }
+        inline GB_Vec4 VecWZYX(GB_Vec4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3)); }
+        inline GB_Vec4 VecZWXY(GB_Vec4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)); }
+        inline GB_Vec4 VecYXWZ(GB_Vec4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)); }
+#else
+        using GB_Vec4 = float32x4_t;
+
+        inline GB_Vec4 VecSet(float x, float y, float z, float w) {
+            const float values[4] = { x, y, z, w };
+            return vld1q_f32(values);
+        }
+        inline GB_Vec4 VecLoad(const XrQuaternionf& q) { return vld1q_f32(&q.x); }
+        // A 16 byte load would read past the end of the last vector in an array
+        inline GB_Vec4 VecLoad(const XrVector3f& v) { return vcombine_f32(vld1_f32(&v.x), vld1_lane_f32(&v.z, vdup_n_f32(0.0f), 0)); }
+        inline void VecStore(GB_Vec4 v, XrQuaternionf& q) { vst1q_f32(&q.x, v); }
+        inline void VecStore(GB_Vec4 v, XrVector3f& out) {
+            vst1_f32(&out.x, vget_low_f32(v));
+            vst1q_lane_f32(&out.z, v, 2);
+        }
+
+        inline GB_Vec4 VecAdd(GB_Vec4 a, GB_Vec4 b) { return vaddq_f32(a, b); }
+        inline GB_Vec4 VecMul(GB_Vec4 a, GB_Vec4 b) { return vmulq_f32(a, b); }
+        inline GB_Vec4 VecMul(GB_Vec4 a, float b) { return vmulq_n_f32(a, b); }
+        inline float VecDot(GB_Vec4 a, GB_Vec4 b) { return vaddvq_f32(vmulq_f32(a, b)); }
+
+        template <int lane>
+        GB_Vec4 VecSplat(GB_Vec4 v) { return vdupq_laneq_f32(v, lane); }
+        inline GB_Vec4 VecZWXY(GB_Vec4 v) { return vextq_f32(v, v, 2); }
+        inline GB_Vec4 VecYXWZ(GB_Vec4 v) { return vrev64q_f32(v); }
+        inline GB_Vec4 VecWZYX(GB_Vec4 v) { return vrev64q_f32(vextq_f32(v, v, 2)); }
+#endif
+
+        // a * b as a.w * b + a.x * (b.w, -b.z, b.y, -b.x) + a.y * (b.z, b.w, -b.x, -b.y) + a.z * (-b.y, b.x, b.w, -b.z)
+        inline GB_Vec4 VecQuatMultiply(GB_Vec4 a, GB_Vec4 b) {
+            const GB_Vec4 sign_x = VecSet(1.0f, -1.0f, 1.0f, -1.0f);
+            const GB_Vec4 sign_y = VecSet(1.0f, 1.0f, -1.0f, -1.0f);
+            const GB_Vec4 sign_z = VecSet(-1.0f, 1.0f, 1.0f, -1.0f);
+
+            GB_Vec4 result = VecMul(VecSplat<3>(a), b);
+            result = VecAdd(result, VecMul(VecSplat<0>(a), VecMul(VecWZYX(b), sign_x)));
+            result = VecAdd(result, VecMul(VecSplat<1>(a), VecMul(VecZWXY(b), sign_y)));
+            result = VecAdd(result, VecMul(VecSplat<2>(a), VecMul(VecYXWZ(b), sign_z)));
+            return result;
+        }
+
+        inline GB_Vec4 VecQuatConjugate(GB_Vec4 q) {
+            return VecMul(q, VecSet(-1.0f, -1.0f, -1.0f, 1.0f));
+        }
+
+        // q * v * q^-1, only uses the shuffles that are cheap on both instruction sets. The w lane of the result is garbage.
+        inline GB_Vec4 VecQuatRotate(GB_Vec4 q, GB_Vec4 q_conjugate, GB_Vec4 v) {
+            return VecQuatMultiply(VecQuatMultiply(q, v), q_conjugate);
+        }
+
+        inline GB_Vec4 VecQuatSlerp(GB_Vec4 a, GB_Vec4 b, float t) {
+            float weight_a, weight_b;
+            SlerpWeights(VecDot(a, b), t, weight_a, weight_b);
+            const GB_Vec4 result = VecAdd(VecMul(a, weight_a), VecMul(b, weight_b));
+            return VecMul(result, 1.0f / std::sqrt(VecDot(result, result)));
+        }
+    }
+
+    inline XrQuaternionf QuatMultiply(const XrQuaternionf& a, const XrQuaternionf& b) {
+        using namespace pose_math_detail;
+        XrQuaternionf result;
+        VecStore(VecQuatMultiply(VecLoad(a), VecLoad(b)), result);
+        return result;
+    }
+
+    inline XrVector3f QuatRotate(const XrQuaternionf& q, const XrVector3f& v) {
+        using namespace pose_math_detail;
+        const GB_Vec4 orientation = VecLoad(q);
+        XrVector3f result;
+        VecStore(VecQuatRotate(orientation, VecQuatConjugate(orientation), VecLoad(v)), result);
+        return result;
+    }
+
+    inline XrPosef PoseMultiply(const XrPosef& a, const XrPosef& b) {
+        using namespace pose_math_detail;
+        const GB_Vec4 orientation = VecLoad(a.orientation);
+        const GB_Vec4 rotated = VecQuatRotate(orientation, VecQuatConjugate(orientation), VecLoad(b.position));
+
+        XrPosef result;
+        VecStore(VecQuatMultiply(orientation, VecLoad(b.orientation)), result.orientation);
+        VecStore(VecAdd(VecLoad(a.position), rotated), result.position);
+        return result;
+    }
+
+    inline XrPosef PoseInverse(const XrPosef& pose) {
+        using namespace pose_math_detail;
+        const GB_Vec4 orientation = VecLoad(pose.orientation);
+        const GB_Vec4 inverse = VecQuatConjugate(orientation);
+        const GB_Vec4 position = VecQuatRotate(inverse, orientation, VecLoad(pose.position));
+
+        XrPosef result;
+        VecStore(inverse, result.orientation);
+        VecStore(VecMul(position, -1.0f), result.position);
+        return result;
+    }
+
+    inline XrQuaternionf QuatSlerp(const XrQuaternionf& a, const XrQuaternionf& b, float t) {
+        using namespace pose_math_detail;
+        XrQuaternionf result;
+        VecStore(VecQuatSlerp(VecLoad(a), VecLoad(b), t), result);
+        return result;
+    }
+
+    // result[i] = a * poses[i], for moving many poses into one space. result may alias poses.
+    inline void PoseMultiplyBatch(const XrPosef& a, const XrPosef* poses, XrPosef* result, uint32_t count) {
+        using namespace pose_math_detail;
+        const GB_Vec4 orientation = VecLoad(a.orientation);
+        const GB_Vec4 conjugate = VecQuatConjugate(orientation);
+        const GB_Vec4 position = VecLoad(a.position);
+
+        for (uint32_t i = 0; i < count; i++) {
+            const GB_Vec4 rotated = VecQuatRotate(orientation, conjugate, VecLoad(poses[i].position));
+            const GB_Vec4 composed = VecQuatMultiply(orientation, VecLoad(poses[i].orientation));
+            VecStore(composed, result[i].orientation);
+            VecStore(VecAdd(position, rotated), result[i].position);
+        }
+    }
+
+    // result may alias poses
+    inline void PoseInverseBatch(const XrPosef* poses, XrPosef* result, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            result[i] = PoseInverse(poses[i]);
+        }
+    }
+
+    inline void QuatSlerpBatch(const XrQuaternionf* a, const XrQuaternionf* b, float t, XrQuaternionf* result, uint32_t count) {
+        using namespace pose_math_detail;
+        for (uint32_t i = 0; i < count; i++) {
+            VecStore(VecQuatSlerp(VecLoad(a[i]), VecLoad(b[i]), t), result[i]);
+        }
+    }
+#else
+    inline XrQuaternionf QuatMultiply(const XrQuaternionf& a, const XrQuaternionf& b) { return QuatMultiplyScalar(a, b); }
+    inline XrVector3f QuatRotate(const XrQuaternionf& q, const XrVector3f& v) { return QuatRotateScalar(q, v); }
+    inline XrPosef PoseMultiply(const XrPosef& a, const XrPosef& b) { return PoseMultiplyScalar(a, b); }
+    inline XrPosef PoseInverse(const XrPosef& pose) { return PoseInverseScalar(pose); }
+    inline XrQuaternionf QuatSlerp(const XrQuaternionf& a, const XrQuaternionf& b, float t) { return QuatSlerpScalar(a, b, t); }
+    inline void PoseMultiplyBatch(const XrPosef& a, const XrPosef* poses, XrPosef* result, uint32_t count) { PoseMultiplyBatchScalar(a, poses, result, count); }
+    inline void PoseInverseBatch(const XrPosef* poses, XrPosef* result, uint32_t count) { PoseInverseBatchScalar(poses, result, count); }
+    inline void QuatSlerpBatch(const XrQuaternionf* a, const XrQuaternionf* b, float t, XrQuaternionf* result, uint32_t count) { QuatSlerpBatchScalar(a, b, t, result, count); }
+#endif
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+#include <openxr/openxr.h>
+
+namespace XRGameBridge {
+    // Scalar reference implementation of the pose math, pose_math.h vectorizes the same operations.
+    // Kept straightforward on purpose, the vector path is checked against it.
+    // PoseMultiply(a, b) applies b first and then a, so a pose of space B in A times a pose of C in B is the pose of C in A.
+
+    inline XrPosef PoseIdentity() {
+        return { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } };
+    }
+
+    inline XrQuaternionf QuatConjugate(const XrQuaternionf& q) {
+        return { -q.x, -q.y, -q.z, q.w };
+    }
+
+    inline float QuatDot(const XrQuaternionf& a, const XrQuaternionf& b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    }
+
+    inline XrQuaternionf QuatMultiplyScalar(const XrQuaternionf& a, const XrQuaternionf& b) {
+        return {
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+        };
+    }
+
+    // Rotates v by the unit quaternion q, v + 2w(u x v) + 2u x (u x v)
+    inline XrVector3f QuatRotateScalar(const XrQuaternionf& q, const XrVector3f& v) {
+        const XrVector3f t{ 2.0f * (q.y * v.z - q.z * v.y), 2.0f * (q.z * v.x - q.x * v.z), 2.0f * (q.x * v.y - q.y * v.x) };
+        return {
+            v.x + q.w * t.x + (q.y * t.z - q.z * t.y),
+            v.y + q.w * t.y + (q.z * t.x - q.x * t.z),
+            v.z + q.w * t.z + (q.x * t.y - q.y * t.x)
+        };
+    }
+
+    inline XrPosef PoseMultiplyScalar(const XrPosef& a, const XrPosef& b) {
+        const XrVector3f rotated = QuatRotateScalar(a.orientation, b.position);
+        return { QuatMultiplyScalar(a.orientation, b.orientation), { a.position.x + rotated.x, a.position.y + rotated.y, a.position.z + rotated.z } };
+    }
+
+    inline XrPosef PoseInverseScalar(const XrPosef& pose) {
+        const XrQuaternionf inverse = QuatConjugate(pose.orientation);
+        const XrVector3f position = QuatRotateScalar(inverse, pose.position);
+        return { inverse, { -position.x, -position.y, -position.z } };
+    }
+
+    // Interpolation weights of a slerp along the shortest arc, the second weight is negative when b has to be flipped
+    inline void SlerpWeights(float dot, float t, float& weight_a, float& weight_b) {
+        const float sign = dot < 0.0f ? -1.0f : 1.0f;
+        dot *= sign;
+
+        // Nearly parallel, sin(theta) goes to zero so fall back to a linear blend
+        if (dot > 0.9995f) {
+            weight_a = 1.0f - t;
+            weight_b = t * sign;
+            return;
+        }
+
+        const float theta = std::acos(dot);
+        const float inverse_sin = 1.0f / std::sin(theta);
+        weight_a = std::sin((1.0f - t) * theta) * inverse_sin;
+        weight_b = std::sin(t * theta) * inverse_sin * sign;
+    }
+
+    inline XrQuaternionf QuatSlerpScalar(const XrQuaternionf& a, const XrQuaternionf& b, float t) {
+        float weight_a, weight_b;
+        SlerpWeights(QuatDot(a, b), t, weight_a, weight_b);
+        XrQuaternionf result{ a.x * weight_a + b.x * weight_b, a.y * weight_a + b.y * weight_b, a.z * weight_a + b.z * weight_b, a.w * weight_a + b.w * weight_b };
+
+        // The linear fallback drifts off the unit sphere
+        const float length = std::sqrt(QuatDot(result, result));
+        return { result.x / length, result.y / length, result.z / length, result.w / length };
+    }
+
+    inline void PoseMultiplyBatchScalar(const XrPosef& a, const XrPosef* poses, XrPosef* result, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            result[i] = PoseMultiplyScalar(a, poses[i]);
+        }
+    }
+
+    inline void PoseInverseBatchScalar(const XrPosef* poses, XrPosef* result, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            result[i] = PoseInverseScalar(poses[i]);
+        }
+    }
+
+    inline void QuatSlerpBatchScalar(const XrQuaternionf* a, const XrQuaternionf* b, float t, XrQuaternionf* result, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            result[i] = QuatSlerpScalar(a[i], b[i], t);
+        }
+    }
+}
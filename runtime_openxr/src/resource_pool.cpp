@@ -0,0 +1,215 @@
+#include "resource_pool.h"
+
+#include <utility>
+
+namespace XRGameBridge {
+    namespace {
+        // Slot of a destroyed heap or a new one, ids are slot indices plus one
+        template <typename T>
+        uint64_t StoreHeap(std::vector<ComPtr<T>>& heaps, ComPtr<T> heap) {
+            for (size_t i = 0; i < heaps.size(); i++) {
+                if (heaps[i] == nullptr) {
+                    heaps[i] = std::move(heap);
+                    return i + 1;
+                }
+            }
+            heaps.push_back(std::move(heap));
+            return heaps.size();
+        }
+    }
+
+    void GB_D3D12HeapDevice::Initialize(const ComPtr<ID3D12Device>& device, D3D12_HEAP_FLAGS flags) {
+        this->device = device;
+        this->flags = flags;
+    }
+
+    uint64_t GB_D3D12HeapDevice::CreateHeap(uint64_t size, uint64_t alignment) {
+        // Heaps only come with the default or the MSAA placement alignment
+        const uint64_t heap_alignment = alignment > D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        CD3DX12_HEAP_DESC desc(size, D3D12_HEAP_TYPE_DEFAULT, heap_alignment, flags);
+
+        ComPtr<ID3D12Heap> heap;
+        if (FAILED(device->CreateHeap(&desc, IID_PPV_ARGS(&heap)))) {
+            LOG(WARNING) << "Failed to create a " << size << " byte image heap";
+            return 0;
+        }
+        heap->SetName(L"Swapchain Image Heap");
+        return StoreHeap(heaps, std::move(heap));
+    }
+
+    void GB_D3D12HeapDevice::DestroyHeap(uint64_t heap) {
+        heaps[heap - 1].Reset();
+    }
+
+    ID3D12Heap* GB_D3D12HeapDevice::GetHeap(uint64_t heap) const {
+        return heaps[heap - 1].Get();
+    }
+
+    void GB_DescriptorHeapDevice::Initialize(const ComPtr<ID3D12Device>& device, D3D12_DESCRIPTOR_HEAP_TYPE type, D3D12_DESCRIPTOR_HEAP_FLAGS flags) {
+        this->device = device;
+        this->type = type;
+        this->flags = flags;
+    }
+
+    uint64_t GB_DescriptorHeapDevice::CreateHeap(uint64_t size, uint64_t alignment) {
+        D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+        desc.NumDescriptors = static_cast<UINT>(size);
+        desc.Type = type;
+        desc.Flags = flags;
+
+        ComPtr<ID3D12DescriptorHeap> heap;
+        if (FAILED(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&heap)))) {
+            LOG(WARNING) << "Failed to create a descriptor heap with " << size << " descriptors";
+            return 0;
+        }
+        return StoreHeap(heaps, std::move(heap));
+    }
+
+    void GB_DescriptorHeapDevice::DestroyHeap(uint64_t heap) {
+        heaps[heap - 1].Reset();
+    }
+
+    const ComPtr<ID3D12DescriptorHeap>& GB_DescriptorHeapDevice::GetHeap(uint64_t heap) const {
+        return heaps[heap - 1];
+    }
+
+    bool GB_ResourcePool::Initialize(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue) {
+        this->device = device;
+        this->queue = queue;
+
+        // Render targets and depth stencils are the one category every resource heap tier can share a heap with
+        image_heaps.Initialize(device, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES);
+        rtv_heaps.Initialize(device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, D3D12_DESCRIPTOR_HEAP_FLAG_NONE);
+        srv_heaps.Initialize(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE);
+
+        if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)))) {
+            LOG(ERROR) << "Failed to create resource pool fence";
+            return false;
+        }
+        fence->SetName(L"Resource Pool Fence");
+
+        if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&command_allocator)))) {
+            LOG(ERROR) << "Failed to create resource pool command allocator";
+            return false;
+        }
+        if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, command_allocator.Get(), nullptr, IID_PPV_ARGS(&command_list)))) {
+            LOG(ERROR) << "Failed to create resource pool command list";
+            return false;
+        }
+        command_list->SetName(L"Resource Pool Command List");
+        command_list->Close();
+
+        return true;
+    }
+
+    void GB_ResourcePool::Reclaim() {
+        const uint64_t completed = fence->GetCompletedValue();
+        image_allocator.Reclaim(completed);
+        rtv_allocator.Reclaim(completed);
+        srv_allocator.Reclaim(completed);
+    }
+
+    void GB_ResourcePool::DiscardImages(const ComPtr<ID3D12Resource>* resources, uint32_t count, D3D12_RESOURCE_STATES states, bool depth_stencil) {
+        // The allocator is reused, the previous swapchain's discards are normally done long before
+        if (fence->GetCompletedValue() < command_list_fence_value) {
+            fence->SetEventOnCompletion(command_list_fence_value, nullptr);
+        }
+        command_allocator->Reset();
+        command_list->Reset(command_allocator.Get(), nullptr);
+
+        // Discarding needs the image in its writable state
+        const D3D12_RESOURCE_STATES discard_state = depth_stencil ? D3D12_RESOURCE_STATE_DEPTH_WRITE : D3D12_RESOURCE_STATE_RENDER_TARGET;
+        for (uint32_t i = 0; i < count; i++) {
+            if (states != discard_state) {
+                auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(resources[i].Get(), states, discard_state);
+                command_list->ResourceBarrier(1, &barrier);
+            }
+            command_list->DiscardResource(resources[i].Get(), nullptr);
+            if (states != discard_state) {
+                auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(resources[i].Get(), discard_state, states);
+                command_list->ResourceBarrier(1, &barrier);
+            }
+        }
+        command_list->Close();
+
+        // The application renders on the same queue, so its first use comes after the discard
+        ID3D12CommandList* lists[]{ command_list.Get() };
+        queue->ExecuteCommandLists(1, lists);
+        queue->Signal(fence.Get(), ++fence_value);
+        command_list_fence_value = fence_value;
+    }
+
+    bool GB_ResourcePool::CreateImages(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES states, const D3D12_CLEAR_VALUE* clear_value, uint32_t count, ComPtr<ID3D12Resource>* resources, GB_HeapAllocation* allocations) {
+        if ((desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) == 0) {
+            return false;
+        }
+        const D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &desc);
+        if (info.SizeInBytes == UINT64_MAX) {
+            return false;
+        }
+
+        std::lock_guard lock(mutex);
+        Reclaim();
+
+        for (uint32_t i = 0; i < count; i++) {
+            allocations[i] = image_allocator.Allocate(info.SizeInBytes, info.Alignment);
+            if (!allocations[i].IsValid() || FAILED(device->CreatePlacedResource(image_heaps.GetHeap(allocations[i].heap), allocations[i].offset, &desc, states, clear_value, IID_PPV_ARGS(&resources[i])))) {
+                // The GPU never saw these, the blocks can be reused right away
+                for (uint32_t j = 0; j <= i; j++) {
+                    resources[j].Reset();
+                    image_allocator.Free(allocations[j], 0);
+                    allocations[j] = {};
+                }
+                LOG(WARNING) << "Swapchain image pool exhausted, committing the images";
+                return false;
+            }
+        }
+
+        DiscardImages(resources, count, states, (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) != 0);
+        return true;
+    }
+
+    bool GB_ResourcePool::AllocateDescriptors(uint32_t count, GB_HeapAllocation& rtv, ComPtr<ID3D12DescriptorHeap>& rtv_heap, GB_HeapAllocation& srv, ComPtr<ID3D12DescriptorHeap>& srv_heap) {
+        std::lock_guard lock(mutex);
+        Reclaim();
+
+        rtv = rtv_allocator.Allocate(count, 1);
+        srv = srv_allocator.Allocate(count, 1);
+        if (!rtv.IsValid() || !srv.IsValid()) {
+            rtv_allocator.Free(rtv, 0);
+            srv_allocator.Free(srv, 0);
+            rtv = {};
+            srv = {};
+            return false;
+        }
+
+        rtv_heap = rtv_heaps.GetHeap(rtv.heap);
+        srv_heap = srv_heaps.GetHeap(srv.heap);
+        return true;
+    }
+
+    void GB_ResourcePool::Free(const GB_HeapAllocation* images, uint32_t count, const GB_HeapAllocation& rtv, const GB_HeapAllocation& srv) {
+        std::lock_guard lock(mutex);
+
+        // Everything that may use the resources was submitted to the queue before this
+        queue->Signal(fence.Get(), ++fence_value);
+        for (uint32_t i = 0; i < count; i++) {
+            image_allocator.Free(images[i], fence_value);
+        }
+        rtv_allocator.Free(rtv, fence_value);
+        srv_allocator.Free(srv, fence_value);
+    }
+
+    void GB_ResourcePool::Trim() {
+        std::lock_guard lock(mutex);
+        Reclaim();
+        image_allocator.Trim();
+        rtv_allocator.Trim();
+        srv_allocator.Trim();
+    }
+
+    GB_HeapAllocatorStats GB_ResourcePool::GetImageStats() {
+        std::lock_guard lock(mutex);
+        return image_allocator.GetStats();
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "heap_allocator.h"
+#include "openxr_includes.h"
+
+namespace XRGameBridge {
+    // ID3D12Heaps for the heap allocator, ids are slot indices plus one
+    class GB_D3D12HeapDevice : public GB_HeapDevice {
+        ComPtr<ID3D12Device> device;
+        D3D12_HEAP_FLAGS flags = D3D12_HEAP_FLAG_NONE;
+        std::vector<ComPtr<ID3D12Heap>> heaps;
+
+    public:
+        void Initialize(const ComPtr<ID3D12Device>& device, D3D12_HEAP_FLAGS flags);
+
+        uint64_t CreateHeap(uint64_t size, uint64_t alignment) override;
+        void DestroyHeap(uint64_t heap) override;
+
+        ID3D12Heap* GetHeap(uint64_t heap) const;
+    };
+
+    // Descriptor heaps for the heap allocator, sizes are in descriptors
+    class GB_DescriptorHeapDevice : public GB_HeapDevice {
+        ComPtr<ID3D12Device> device;
+        D3D12_DESCRIPTOR_HEAP_TYPE type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+        D3D12_DESCRIPTOR_HEAP_FLAGS flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+        std::vector<ComPtr<ID3D12DescriptorHeap>> heaps;
+
+    public:
+        void Initialize(const ComPtr<ID3D12Device>& device, D3D12_DESCRIPTOR_HEAP_TYPE type, D3D12_DESCRIPTOR_HEAP_FLAGS flags);
+
+        uint64_t CreateHeap(uint64_t size, uint64_t alignment) override;
+        void DestroyHeap(uint64_t heap) override;
+
+        const ComPtr<ID3D12DescriptorHeap>& GetHeap(uint64_t heap) const;
+    };
+
+    // Memory and descriptors of the proxy swapchains of a session.
+    // Images are placed in shared heaps and their RTVs and SRVs come from shared descriptor heaps, so creating a swapchain doesn't
+    // allocate from the device once the pool has grown to what the application uses. Only render target and depth stencil images are
+    // placed, they are the only ones all resource heap tiers can keep together. Anything the pool can't serve is committed as before.
+    //
+    // Memory of destroyed swapchains is reused after a fence signaled at destruction completed. Placed render targets have
+    // undefined contents, the pool discards every image it places before the application can use it.
+    class GB_ResourcePool {
+        ComPtr<ID3D12Device> device;
+        ComPtr<ID3D12CommandQueue> queue;
+
+        // Signaled when images are discarded and when resources are freed
+        ComPtr<ID3D12Fence> fence;
+        uint64_t fence_value = 0;
+        ComPtr<ID3D12CommandAllocator> command_allocator;
+        ComPtr<ID3D12GraphicsCommandList> command_list;
+        uint64_t command_list_fence_value = 0;
+
+        GB_D3D12HeapDevice image_heaps;
+        GB_DescriptorHeapDevice rtv_heaps;
+        GB_DescriptorHeapDevice srv_heaps;
+        GB_HeapAllocator image_allocator{ image_heaps, { image_heap_size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT } };
+        GB_HeapAllocator rtv_allocator{ rtv_heaps, { descriptor_heap_size, 1 } };
+        GB_HeapAllocator srv_allocator{ srv_heaps, { descriptor_heap_size, 1 } };
+
+        // Swapchains are created and destroyed from any thread
+        std::mutex mutex;
+
+        void Reclaim();
+        void DiscardImages(const ComPtr<ID3D12Resource>* resources, uint32_t count, D3D12_RESOURCE_STATES states, bool depth_stencil);
+
+    public:
+        static constexpr uint64_t image_heap_size = 64ull * 1024 * 1024;
+        static constexpr uint64_t descriptor_heap_size = 256;
+
+        bool Initialize(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue);
+
+        // Places count images with the same description, false when the pool can't, the caller commits them instead
+        bool CreateImages(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES states, const D3D12_CLEAR_VALUE* clear_value, uint32_t count, ComPtr<ID3D12Resource>* resources, GB_HeapAllocation* allocations);
+        // count consecutive descriptors in an RTV heap and a shader visible SRV heap, the offsets are in descriptors
+        bool AllocateDescriptors(uint32_t count, GB_HeapAllocation& rtv, ComPtr<ID3D12DescriptorHeap>& rtv_heap, GB_HeapAllocation& srv, ComPtr<ID3D12DescriptorHeap>& srv_heap);
+
+        // Invalid allocations are skipped, the resources must have been released already
+        void Free(const GB_HeapAllocation* images, uint32_t count, const GB_HeapAllocation& rtv, const GB_HeapAllocation& srv);
+        // Gives memory no swapchain uses back to the device
+        void Trim();
+
+        GB_HeapAllocatorStats GetImageStats();
+    };
+}
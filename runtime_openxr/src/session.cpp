@@ -1,6 +1,7 @@
 #include "session.h"
 
-#include <stdexcept>
+#include <algorithm>
+#include <array>
 #include <shellscalingapi.h>
 
 #include "easylogging++.h"
@@ -9,37 +10,110 @@
 #include "system.h"
 #include "settings.h"
 #include "compositor.h"
+#include "null_backend.h"
 #include "swapchain.h"
+#include "sr_pose_source.h"
 #include  "instance.h"
 
+namespace {
+    // What the application submitted, only projection layers have views
+    void RecordEndFrame(XRGameBridge::GB_Session& gb_session, const XrFrameEndInfo* frameEndInfo, XrTime time) {
+        std::array<XRGameBridge::GB_TraceLayer, 16> layers{};
+        const uint32_t layer_count = std::min<uint32_t>(frameEndInfo->layerCount, static_cast<uint32_t>(layers.size()));
+
+        for (uint32_t layer_num = 0; layer_num < layer_count; layer_num++) {
+            const XrCompositionLayerBaseHeader* layer = frameEndInfo->layers[layer_num];
+            XRGameBridge::GB_TraceLayer& traced = layers[layer_num];
+            traced.type = static_cast<uint32_t>(layer->type);
+            traced.flags = static_cast<uint32_t>(layer->layerFlags);
+
+            if (layer->type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+                auto projection = reinterpret_cast<const XrCompositionLayerProjection*>(layer);
+                traced.view_count = projection->viewCount;
+                if (projection->viewCount > 0) {
+                    const XrSwapchainSubImage& sub_image = projection->views[0].subImage;
+                    traced.array_index = sub_image.imageArrayIndex;
+                    traced.width = sub_image.imageRect.extent.width;
+                    traced.height = sub_image.imageRect.extent.height;
+                }
+            }
+        }
 
-XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) {
-    // TODO refactor local scope static variables
-    static uint64_t session_creation_count = 1;
+        const XRGameBridge::GB_TraceFrameTiming timing{ gb_session.frame_pacer.GetFramesBegun(), frameEndInfo->displayTime, 0, layer_count, 0 };
+        gb_session.trace_writer->WriteFrame(XRGameBridge::TRACE_RECORD_END_FRAME, time, timing, layers.data());
+    }
 
-    SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_SYSTEM_AWARE);
+    // Window, its swapchain, the intermediate image the compositor renders to and the weaver
+    void CreateWindowResources(XRGameBridge::GB_Session& gb_session, XRGameBridge::GB_System& gb_system) {
+        // Create debug window
+        auto native_resolution = XRGameBridge::GetNativeSystemResolution(gb_system);
+        gb_session.display.CreateApplicationWindow(XRGameBridge::g_runtime_settings.hInst, native_resolution.x, native_resolution.y, true, true);
+
+        // Create swapchain info
+        XrSwapchainCreateInfo swapchain_info;
+        swapchain_info.width = native_resolution.x;
+        swapchain_info.height = native_resolution.y;
+        swapchain_info.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        swapchain_info.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+
+        // The window needs a back buffer for every frame in flight plus the one on screen, and at least as many as the application has
+        // so a late weave doesn't block presenting. The intermediate resource is indexed with the back buffer index.
+        static_assert(XRGameBridge::g_max_frames_in_flight < XRGameBridge::g_max_swapchain_images);
+        const uint32_t window_image_count = std::max(XRGameBridge::g_runtime_settings.swapchain_images, gb_session.frame_ring.GetFramesInFlight() + 1);
+
+        // Create intermediate resources for weaving render target
+        const auto intermediate_desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, native_resolution.x, native_resolution.y, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+        gb_session.intermediate_resource.CreateResources(gb_session.d3d12_device, intermediate_desc, D3D12_RESOURCE_STATE_RENDER_TARGET, window_image_count);
+
+        // Create swapchain for debug window
+        gb_session.window_swapchain.CreateSwapChain(gb_session.d3d12_device, gb_session.command_queue ,&swapchain_info, gb_session.display.GetWindowHandle(), window_image_count);
+
+        // Frames are predicted at 60Hz until the refresh rate is known
+        gb_session.frame_timer.SetNominalRefreshRate(gb_session.display.GetRefreshRate());
+
+        // Initialize weaver params
+        DX12WeaverInitialize params{};
+        params.command_queue = gb_session.command_queue.Get();
+        params.device = gb_session.d3d12_device.Get();
+        params.game_bridge = XRGameBridge::g_game_bridge_instance;
+        params.input_resource = gb_session.intermediate_resource.GetBuffers()[0].Get();
+        params.render_target = gb_session.window_swapchain.GetImages()[0].Get();
+        params.window = gb_session.display.GetWindowHandle();
+
+        // Create weaver
+        gb_session.d3d12weaver = new DirectX12Weaver(params);
+        gb_session.d3d12weaver->InitializeWeaver(gb_session.sr_context);
+    }
+}
 
-    try {
-        XRGameBridge::GB_System& system = XRGameBridge::g_systems.at(createInfo->systemId);
-        if (!system.features_enumerated) {
-            return XR_ERROR_GRAPHICS_REQUIREMENTS_CALL_MISSING;
-        }
 
-        if (system.instance != instance) {
-            return XR_ERROR_SYSTEM_INVALID;
-        }
+XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) {
+    SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_SYSTEM_AWARE);
+
+    auto system_lookup = XRGameBridge::FindSystem(createInfo->systemId);
+    if (!system_lookup) {
+        return system_lookup.error();
     }
-    catch (std::out_of_range& e) {
+    if (system_lookup->instance != instance) {
         return XR_ERROR_SYSTEM_INVALID;
     }
-    catch (std::exception& e) {
-        return XR_ERROR_RUNTIME_FAILURE;
+
+    // XR_MND_headless, no graphics binding means no graphics requirements either
+    XRGameBridge::GB_Instance* gb_instance = reinterpret_cast<XRGameBridge::GB_Instance*>(XRGameBridge::g_gbinstance);
+    const bool headless = createInfo->next == nullptr;
+    if (headless && !gb_instance->headless) {
+        return XR_ERROR_GRAPHICS_DEVICE_INVALID;
+    }
+    if (!headless && !system_lookup->features_enumerated) {
+        return XR_ERROR_GRAPHICS_REQUIREMENTS_CALL_MISSING;
     }
 
-    // Create entry if it doesn't exist
-    // Note: This means it overwrite all except for the id member it if it does exist
-    XrSession handle = reinterpret_cast<XrSession>(session_creation_count);
-    XRGameBridge::GB_Session& new_session = XRGameBridge::g_sessions[handle];
+    XrSession handle = XRGameBridge::g_sessions.Create();
+    auto session_lookup = XRGameBridge::g_sessions.Find(handle);
+    if (!session_lookup) {
+        return XR_ERROR_LIMIT_REACHED;
+    }
+    XRGameBridge::GB_Session& new_session = *session_lookup;
 
     // Initialize session with state idle
     new_session.id = handle;
@@ -47,6 +121,15 @@ XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createI
     new_session.system = createInfo->systemId;
     new_session.session_state = XR_SESSION_STATE_IDLE;
     new_session.session_epoch = std::chrono::high_resolution_clock::now();
+    new_session.clock.SetEpoch(new_session.session_epoch);
+    new_session.sr_context = gb_instance->sr_context;
+
+    if (headless) {
+        new_session.headless = true;
+        new_session.compositor_backend = std::make_unique<XRGameBridge::GB_NullCompositor>();
+        *session = handle;
+        return XR_SUCCESS;
+    }
 
     // DirectX 12
     if (XRGameBridge::g_runtime_settings.support_d3d12) {
@@ -55,17 +138,20 @@ XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createI
         new_session.command_queue = d3d12_bindings->queue;
     }
 
-    *session = handle;
-    session_creation_count++;
-
     // TODO Not sure where to put the compositor, it has to be initialized by the session, but you render to a system
     // Maybe a system should own a compositor, but it is created and destroyed by the client?
-    new_session.compositor.Initialize(new_session.d3d12_device, new_session.command_queue, 2);
-
-    // Create sr context, blocks till there is a connection
-    XRGameBridge::GB_Instance* gb_instance = reinterpret_cast<XRGameBridge::GB_Instance*>(XRGameBridge::g_gbinstance);
-    new_session.sr_context = gb_instance->sr_context;
+    new_session.compositor.Initialize(new_session.d3d12_device, new_session.command_queue);
+    if (!new_session.frame_ring.Initialize(new_session.d3d12_device, XRGameBridge::g_runtime_settings.frames_in_flight, new_session.compositor.GetPipelineState())) {
+        XRGameBridge::g_sessions.Destroy(handle);
+        return XR_ERROR_RUNTIME_FAILURE;
+    }
+    if (!new_session.resource_pool.Initialize(new_session.d3d12_device, new_session.command_queue)) {
+        XRGameBridge::g_sessions.Destroy(handle);
+        return XR_ERROR_RUNTIME_FAILURE;
+    }
+    new_session.compositor_backend = std::make_unique<XRGameBridge::GB_D3D12Compositor>(new_session);
 
+    *session = handle;
     return XR_SUCCESS;
 }
 
@@ -83,8 +169,16 @@ XrResult xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo)
     // TODO check if view configuration type is supported
     // TODO, move SESSION_READY logic to here, check here whether all components are initialized for the session to be put on READY.
 
-    XRGameBridge::GB_Session& gb_session = XRGameBridge::g_sessions[session];
-    XRGameBridge::GB_System gb_system = XRGameBridge::g_systems[gb_session.system];
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
+    }
+    XRGameBridge::GB_Session& gb_session = *session_lookup;
+    auto system_lookup = XRGameBridge::FindSystem(gb_session.system);
+    if (!system_lookup) {
+        return system_lookup.error();
+    }
+    XRGameBridge::GB_System& gb_system = *system_lookup;
 
     if (gb_session.session_state == XR_SESSION_STATE_IDLE) {
         LOG(ERROR) << "Session not ready";
@@ -96,44 +190,77 @@ XrResult xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo)
     }
 
     gb_session.view_configuration = beginInfo->primaryViewConfigurationType;
+    gb_session.view_solver.SetScreenSize(gb_system.physical_size);
+    gb_session.eye_predictor.SetParameters(XRGameBridge::g_runtime_settings.prediction);
+    gb_session.frame_pacer.Reset();
 
     XRGameBridge::ChangeSessionState(gb_session, XR_SESSION_STATE_FOCUSED);
 
-    // Create debug window
-    auto native_resolution = XRGameBridge::GetNativeSystemResolution(gb_system);
-    gb_session.display.CreateApplicationWindow(XRGameBridge::g_runtime_settings.hInst, native_resolution.x, native_resolution.y, true, true);
-
-    // Create swapchain info
-    XrSwapchainCreateInfo swapchain_info;
-    swapchain_info.width = native_resolution.x;
-    swapchain_info.height = native_resolution.y;
-    swapchain_info.format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    swapchain_info.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
-
-    // Create intermediate resources for weaving render target
-    gb_session.intermediate_resource.CreateResources(gb_session.d3d12_device, native_resolution.x, native_resolution.y, DXGI_FORMAT_R8G8B8A8_UNORM, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RENDER_TARGET);
-
-    // Create swapchain for debug window
-    gb_session.window_swapchain.CreateSwapChain(gb_session.d3d12_device, gb_session.command_queue ,&swapchain_info, gb_session.display.GetWindowHandle());
-
-    // Initialize weaver params
-    DX12WeaverInitialize params{};
-    params.command_queue = gb_session.command_queue.Get();
-    params.device = gb_session.d3d12_device.Get();
-    params.game_bridge = XRGameBridge::g_game_bridge_instance;
-    params.input_resource = gb_session.intermediate_resource.GetBuffers()[0].Get();
-    params.render_target = gb_session.window_swapchain.GetImages()[0].Get();
-    params.window = gb_session.display.GetWindowHandle();
-
-    // Create weaver
-    gb_session.d3d12weaver = new DirectX12Weaver(params);
-    gb_session.d3d12weaver->InitializeWeaver(gb_session.sr_context);
+    // Headless sessions have nothing to show
+    if (!gb_session.headless) {
+        CreateWindowResources(gb_session, gb_system);
+    }
+
+    if (!XRGameBridge::g_runtime_settings.trace_record_path.empty()) {
+        gb_session.trace_writer = std::make_unique<XRGameBridge::GB_TraceWriter>();
+        if (gb_session.trace_writer->Open(XRGameBridge::g_runtime_settings.trace_record_path)) {
+            gb_session.pose_history.SetTraceWriter(gb_session.trace_writer.get());
+            LOG(INFO) << "Recording trace to " << XRGameBridge::g_runtime_settings.trace_record_path;
+        }
+        else {
+            LOG(ERROR) << "Failed to create trace " << XRGameBridge::g_runtime_settings.trace_record_path;
+            gb_session.trace_writer.reset();
+        }
+    }
+
+    // Start eye tracking, the SR sense must exist before the context is initialized
+    if (!XRGameBridge::g_runtime_settings.trace_replay_path.empty()) {
+        gb_session.pose_source = std::make_unique<XRGameBridge::GB_ReplayPoseSource>(XRGameBridge::g_runtime_settings.trace_replay_path, gb_session.clock);
+    }
+    else if (XRGameBridge::g_runtime_settings.synthetic_poses) {
+        gb_session.pose_source = std::make_unique<XRGameBridge::GB_SyntheticPoseSource>(gb_session.clock);
+    }
+    else {
+        gb_session.pose_source = std::make_unique<XRGameBridge::GB_SRPoseSource>(*gb_session.sr_context, gb_session.clock);
+    }
+    if (!gb_session.pose_source->Start(gb_session.pose_history)) {
+        LOG(WARNING) << "Eye tracking unavailable, views are located at the default eye positions";
+    }
+
     gb_session.sr_context->initialize();
 
     return XR_SUCCESS;
 }
 
 XrResult xrEndSession(XrSession session) {
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
+    }
+
+    XRGameBridge::GB_Session& gb_session = *session_lookup;
+
+    // Don't leave the application blocked in xrWaitFrame
+    gb_session.frame_pacer.Release();
+
+    if (gb_session.pose_source) {
+        gb_session.pose_source->Stop();
+    }
+    // The tracker is stopped, Close waits for frame functions that are still writing on other threads
+    if (gb_session.trace_writer) {
+        gb_session.pose_history.SetTraceWriter(nullptr);
+        gb_session.trace_writer->Close();
+        LOG(INFO) << "Trace closed, dropped records: " << gb_session.trace_writer->GetDroppedRecords();
+    }
+
+    // Memory of swapchains destroyed by now goes back, the rest stays for the next session
+    if (!gb_session.headless) {
+        const XRGameBridge::GB_HeapAllocatorStats pool_stats = gb_session.resource_pool.GetImageStats();
+        LOG(INFO) << "Swapchain image pool: " << pool_stats.heaps_created << " heaps created, " << pool_stats.reused_allocations << " of " << pool_stats.allocations << " images reused, "
+            << pool_stats.heap_bytes / (1024 * 1024) << " MB held, internal fragmentation " << pool_stats.GetInternalFragmentation() << ", external " << pool_stats.GetExternalFragmentation();
+        gb_session.resource_pool.Trim();
+    }
+
     LOG(INFO) << "Called " << __func__;
     return XR_ERROR_RUNTIME_FAILURE;
 }
@@ -146,56 +273,57 @@ XrResult xrRequestExitSession(XrSession session) {
 // TODO Use frame display time as frame ids
 XrResult xrWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState) {
     // TODO simple implementation so the application can continue. Should when I understand this part better
-    XRGameBridge::GB_Session& gb_session = XRGameBridge::g_sessions[session];
-    bool should_wait = true;
-
-    // Blocking wait, blocks until BeginFrame was called
-    while (should_wait) {
-        if (gb_session.wait_frame_state_mutex.try_lock()) {
-            if (gb_session.wait_frame_state == XRGameBridge::NewFrameAllowed) {
-                gb_session.wait_frame_state = XRGameBridge::NewFrameBusy;
-                break;
-            }
-            gb_session.wait_frame_state_mutex.unlock();
-        }
-        std::this_thread::sleep_for(ch::nanoseconds(10));
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
     }
+    XRGameBridge::GB_Session& gb_session = *session_lookup;
 
-    // Todo Scoped lock inside the if statement may be easier
-    gb_session.wait_frame_state_mutex.unlock();
+    // Blocks until xrBeginFrame was called for the previous frame
+    if (gb_session.frame_pacer.WaitFrame() != XRGameBridge::GB_FramePacer::WaitResult::Success) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
 
-    // Time point since session epoch + 16 milliseconds
-    // Super simple version of this for now I guess
+    // Throttle the application on the oldest frame the GPU is still working on
+    if (!gb_session.headless) {
+        gb_session.frame_ring.WaitForFreeFrame();
+    }
 
     /* As far as I understand:
      * predictedDisplayTime: The future time point the next image will be displayed at
      * predictedDisplayPeriod: The amount of time the next image will be visible (presented) on the screen 
      */
+    XRGameBridge::GB_FramePrediction prediction = gb_session.frame_timer.PredictFrame();
+    gb_session.frame_timer.StartFrame();
 
-    // 1/60th in nanoseconds
-    uint32_t nanoseconds = 1.0 / 60.0 * 1000 * 1000 * 1000;
-    auto refresh_rate = ch::nanoseconds(nanoseconds);
-    // Image should be displayed for the <refresh rate> amount of time
-    auto display_period = ch::nanoseconds(refresh_rate);
-    // Time since the epoch the application is running now, add the refresh rate to predict the time the next image will be displayed.
-    auto display_time = ch::high_resolution_clock::now() - gb_session.session_epoch + refresh_rate;
-
-    frameState->predictedDisplayPeriod = display_period.count();
-    frameState->predictedDisplayTime = display_time.count();
+    frameState->predictedDisplayPeriod = prediction.display_period;
+    frameState->predictedDisplayTime = prediction.display_time;
     frameState->shouldRender = true;
 
+    if (gb_session.trace_writer) {
+        const XRGameBridge::GB_TraceFrameTiming timing{ gb_session.frame_pacer.GetFramesBegun(), prediction.display_time, prediction.display_period, 0, 0 };
+        gb_session.trace_writer->WriteFrame(XRGameBridge::TRACE_RECORD_WAIT_FRAME, gb_session.clock.Now(), timing);
+    }
+
     return XR_SUCCESS;
 }
 
 XrResult xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo) {
-    XRGameBridge::GB_Session& gb_session = XRGameBridge::g_sessions[session];
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
+    }
+    XRGameBridge::GB_Session& gb_session = *session_lookup;
 
-    std::lock_guard guard(gb_session.wait_frame_state_mutex);
-    if (gb_session.wait_frame_state != XRGameBridge::NewFrameBusy) {
+    // Also wakes up the next xrWaitFrame
+    if (!gb_session.frame_pacer.BeginFrame()) {
         return XR_ERROR_CALL_ORDER_INVALID;
     }
 
-    gb_session.wait_frame_state = XRGameBridge::FrameState::NewFrameAllowed;
+    if (gb_session.trace_writer) {
+        const XRGameBridge::GB_TraceFrameTiming timing{ gb_session.frame_pacer.GetFramesBegun(), 0, 0, 0, 0 };
+        gb_session.trace_writer->WriteFrame(XRGameBridge::TRACE_RECORD_BEGIN_FRAME, gb_session.clock.Now(), timing);
+    }
 
     return XR_SUCCESS;
 }
@@ -203,97 +331,161 @@ XrResult xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo)
 XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
     // TODO If no layers are provided then the display must be cleared.
     // Present the frame for session
-    XRGameBridge::GB_Session& gb_session = XRGameBridge::g_sessions[session];
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
+    }
+    XRGameBridge::GB_Session& gb_session = *session_lookup;
+    auto system_lookup = XRGameBridge::FindSystem(gb_session.system);
+    if (!system_lookup) {
+        return system_lookup.error();
+    }
 
-    // TODO Don't want to keep swapchains in the swapchain anymore, either move them to the compositor, or the system.
-    auto& gb_graphics_device = gb_session.window_swapchain;
-    int32_t index = gb_graphics_device.AcquireNextImage();
-    auto& gb_compositor = gb_session.compositor;
-    auto& cmd_list = gb_compositor.GetCommandList(index);
-    auto& cmd_allocator = gb_compositor.GetCommandAllocator(index);
+    // Validate the handles in the layers up front, the compositor skips anything it can't find
+    for (uint32_t layer_num = 0; layer_num < frameEndInfo->layerCount; layer_num++) {
+        const XrCompositionLayerBaseHeader* base_layer = frameEndInfo->layers[layer_num];
+        if (base_layer == nullptr) {
+            return XR_ERROR_LAYER_INVALID;
+        }
+        if (base_layer->type != XR_TYPE_COMPOSITION_LAYER_PROJECTION && base_layer->type != XR_TYPE_COMPOSITION_LAYER_QUAD) {
+            continue;
+        }
 
-    // Prepare command list // TODO set pipeline state when resetting command list later
-    cmd_allocator->Reset();
-    cmd_list->Reset(cmd_allocator.Get(), gb_compositor.GetPipelineState().Get());
+        // Layers can be placed in any reference or action space of this session
+        auto node_lookup = XRGameBridge::GB_SpaceGraph::GetNode(base_layer->space);
+        if (!node_lookup) {
+            return node_lookup.error();
+        }
+        if (node_lookup->session != session) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
 
-    // TODO transition proxy images to unordered access/shader source (If I'm right...)
-    gb_compositor.TransitionImage(cmd_list.Get(), gb_graphics_device.GetImages()[index].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        if (base_layer->type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
+            auto layer = reinterpret_cast<const XrCompositionLayerQuad*>(base_layer);
+            auto swapchain_lookup = XRGameBridge::FindSwapchainBackend(layer->subImage.swapchain);
+            if (!swapchain_lookup) {
+                return swapchain_lookup.error();
+            }
+            continue;
+        }
 
-    // Set intermediate resource as render target
-    CD3DX12_CPU_DESCRIPTOR_HANDLE intermediate_rtv_handle(gb_session.intermediate_resource.GetRtvHeap()->GetCPUDescriptorHandleForHeapStart(), index, gb_graphics_device.GetRtvDescriptorSize());
-    cmd_list->OMSetRenderTargets(1, &intermediate_rtv_handle, true, nullptr);
-    cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        auto layer = reinterpret_cast<const XrCompositionLayerProjection*>(base_layer);
+        for (uint32_t view_num = 0; view_num < layer->viewCount; view_num++) {
+            auto swapchain_lookup = XRGameBridge::FindSwapchainBackend(layer->views[view_num].subImage.swapchain);
+            if (!swapchain_lookup) {
+                return swapchain_lookup.error();
+            }
+        }
+    }
 
-    // Compose and draw to the render target
-    gb_compositor.ComposeImage(frameEndInfo, cmd_list.Get());
+    if (!gb_session.frame_pacer.EndFrame()) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
 
-    // Transition intermediate resource to unordered access fo the weaver
-    // Todo Figure out whether I need 2 buffers as input or the weaver, not entirely sure about it....
-    gb_compositor.TransitionImage(cmd_list.Get(), gb_session.intermediate_resource.GetBuffers()[index].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    // The application is done with the frame, everything from here on is compositor latency
+    gb_session.frame_timer.EndFrame();
+    const int64_t compositor_start = gb_session.clock.Now();
 
-    // Set swapchain as render target
-    CD3DX12_CPU_DESCRIPTOR_HANDLE back_buffer_rtv_handle(gb_graphics_device.GetRtvHeap()->GetCPUDescriptorHandleForHeapStart(), index, gb_graphics_device.GetRtvDescriptorSize());
-    float clear_color[4] = {0.5f, 0.0f, 0.5f, 1.0f};
-    //cmd_list->ClearRenderTargetView(back_buffer_rtv_handle, clear_color, 0, nullptr);
-    cmd_list->OMSetRenderTargets(1, &back_buffer_rtv_handle, true, nullptr);
+    if (gb_session.trace_writer) {
+        RecordEndFrame(gb_session, frameEndInfo, compositor_start);
+    }
 
-    // Set viewport for rendering to the final rtv
-    auto native_resolution = XRGameBridge::GetNativeSystemResolution(XRGameBridge::g_systems[gb_session.system]);
-    D3D12_VIEWPORT view_port{ 0, 0, static_cast<float>(native_resolution.x) , static_cast<float>(native_resolution.y), 0.0f, 1.0f };
-    D3D12_RECT scissor_rect{ 0, 0, static_cast<long>(native_resolution.x) , static_cast<long>(native_resolution.y) };
-    cmd_list->RSSetViewports(1, &view_port);
-    cmd_list->RSSetScissorRects(1, &scissor_rect);
+    const XrResult result = gb_session.compositor_backend->ComposeFrame(frameEndInfo);
+    gb_session.frame_timer.AddCompositorLatency(gb_session.clock.Now() - compositor_start);
 
-    gb_session.d3d12weaver->SetInputFrameBuffer(gb_session.intermediate_resource.GetBuffers()[index].Get(), DXGI_FORMAT_R8G8B8A8_UNORM);
+    return result;
+}
+
+void XRGameBridge::ChangeSessionState(GB_Session& session, XrSessionState state) {
+    session.session_state = state;
+    PushSessionStateChanged(g_event_queue, session.id, state, session.clock.Now());
+}
+
+namespace XRGameBridge {
+    GB_D3D12Compositor::GB_D3D12Compositor(GB_Session& session) : session(session) {
+    }
 
-    // Do weaving
-    gb_session.d3d12weaver->Weave(cmd_list.Get(), native_resolution.x, native_resolution.y, 0, 0);
+    XrResult GB_D3D12Compositor::ComposeFrame(const XrFrameEndInfo* frameEndInfo) {
+        auto system_lookup = FindSystem(session.system);
+        if (!system_lookup) {
+            return system_lookup.error();
+        }
 
-    // DEBUG
-    //gb_compositor.ComposeImage(frameEndInfo, cmd_list.Get());
+        // TODO Don't want to keep swapchains in the swapchain anymore, either move them to the compositor, or the system.
+        auto& gb_graphics_device = session.window_swapchain;
+        int32_t index = gb_graphics_device.AcquireNextImage();
+        auto& gb_compositor = session.compositor;
 
-    // Transition swapchain to present
-    gb_compositor.TransitionImage(cmd_list.Get(), gb_graphics_device.GetImages()[index].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-    gb_compositor.TransitionImage(cmd_list.Get(), gb_session.intermediate_resource.GetBuffers()[index].Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        // Prepare command list // TODO set pipeline state when resetting command list later
+        XRGameBridge::GB_FrameContext& frame = session.frame_ring.BeginFrame(gb_compositor.GetPipelineState());
+        frame.display_time = frameEndInfo->displayTime;
+        auto& cmd_list = frame.command_list;
 
-    // Todo: maybe use split barriers at the end here instead of regular ones. Then also initialize the resources in the correct state.
+        // TODO transition proxy images to unordered access/shader source (If I'm right...)
+        gb_compositor.TransitionImage(cmd_list.Get(), gb_graphics_device.GetImages()[index].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
 
-    // Close command list
-    cmd_list->Close();
+        // Set intermediate resource as render target
+        CD3DX12_CPU_DESCRIPTOR_HANDLE intermediate_rtv_handle(session.intermediate_resource.GetRtvHeap()->GetCPUDescriptorHandleForHeapStart(), index, gb_graphics_device.GetRtvDescriptorSize());
+        cmd_list->OMSetRenderTargets(1, &intermediate_rtv_handle, true, nullptr);
+        cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-    // Execute command lists
-    gb_compositor.ExecuteCommandLists(cmd_list.Get(), frameEndInfo);
+        // Compose and draw to the render target
+        gb_compositor.ComposeImage(frameEndInfo, cmd_list.Get());
 
-    // Present to window
-    gb_graphics_device.PresentFrame();
+        // Transition intermediate resource to unordered access fo the weaver
+        // Todo Figure out whether I need 2 buffers as input or the weaver, not entirely sure about it....
+        gb_compositor.TransitionImage(cmd_list.Get(), session.intermediate_resource.GetBuffers()[index].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
-    // Update window
-    gb_session.display.UpdateWindow();
+        // Set swapchain as render target
+        CD3DX12_CPU_DESCRIPTOR_HANDLE back_buffer_rtv_handle(gb_graphics_device.GetRtvHeap()->GetCPUDescriptorHandleForHeapStart(), index, gb_graphics_device.GetRtvDescriptorSize());
+        float clear_color[4] = {0.5f, 0.0f, 0.5f, 1.0f};
+        //cmd_list->ClearRenderTargetView(back_buffer_rtv_handle, clear_color, 0, nullptr);
+        cmd_list->OMSetRenderTargets(1, &back_buffer_rtv_handle, true, nullptr);
 
-    return XR_SUCCESS;
-}
+        // Set viewport for rendering to the final rtv
+        auto native_resolution = XRGameBridge::GetNativeSystemResolution(*system_lookup);
+        D3D12_VIEWPORT view_port{ 0, 0, static_cast<float>(native_resolution.x) , static_cast<float>(native_resolution.y), 0.0f, 1.0f };
+        D3D12_RECT scissor_rect{ 0, 0, static_cast<long>(native_resolution.x) , static_cast<long>(native_resolution.y) };
+        cmd_list->RSSetViewports(1, &view_port);
+        cmd_list->RSSetScissorRects(1, &scissor_rect);
 
-void XRGameBridge::ChangeSessionState(GB_Session& session, XrSessionState state) {
-    session.session_state = state;
-    EventManager& event_manager = g_game_bridge_instance->GetEventManager();
-
-    event_manager.PrepareForEventStreamSubmission();
-    if (state == XR_SESSION_STATE_READY) {
-        XrEventDataSessionStateChanged state_change;
-        state_change.type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
-        state_change.session = session.id;
-        state_change.state = XR_SESSION_STATE_READY;
-        state_change.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - session.session_epoch).count();
-        g_openxr_event_stream_writer->SubmitEvent(XR_SESSION_STATE_READY, sizeof(XrEventDataSessionStateChanged), &state_change);
-        event_manager.PrepareForEventStreamProcessing();// TODO FOR DEBUG PURPOSES SHOULD BE REMOVED ASAP
-    }
-    else if (state == XR_SESSION_STATE_FOCUSED) {
-        XrEventDataSessionStateChanged state_change;
-        state_change.type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
-        state_change.session = session.id;
-        state_change.state = XR_SESSION_STATE_FOCUSED;
-        state_change.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - session.session_epoch).count();
-        g_openxr_event_stream_writer->SubmitEvent(XR_SESSION_STATE_FOCUSED, sizeof(XrEventDataSessionStateChanged), &state_change);
-        event_manager.PrepareForEventStreamProcessing();// TODO FOR DEBUG PURPOSES SHOULD BE REMOVED ASAP
+        session.d3d12weaver->SetInputFrameBuffer(session.intermediate_resource.GetBuffers()[index].Get(), DXGI_FORMAT_R8G8B8A8_UNORM);
+
+        // Do weaving
+        session.d3d12weaver->Weave(cmd_list.Get(), native_resolution.x, native_resolution.y, 0, 0);
+
+        // DEBUG
+        //gb_compositor.ComposeImage(frameEndInfo, cmd_list.Get());
+
+        // Transition swapchain to present
+        gb_compositor.TransitionImage(cmd_list.Get(), gb_graphics_device.GetImages()[index].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+        gb_compositor.TransitionImage(cmd_list.Get(), session.intermediate_resource.GetBuffers()[index].Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        // Todo: maybe use split barriers at the end here instead of regular ones. Then also initialize the resources in the correct state.
+
+        // Close command list
+        cmd_list->Close();
+
+        // Execute command lists
+        gb_compositor.ExecuteCommandLists(cmd_list.Get(), session.frame_ring.GetTimeline().GetNextValue());
+        session.frame_ring.EndFrame(session.command_queue, frame);
+
+        // Present to window
+        gb_graphics_device.PresentFrame();
+
+        const int64_t present_time = session.clock.Now();
+
+        // Without frame statistics the return of a vsynced present is the closest thing to a vblank we have
+        int64_t vblank_age = 0;
+        gb_graphics_device.GetLastVblankAge(vblank_age);
+        session.frame_timer.AddVblank(present_time - vblank_age);
+        if (session.trace_writer) {
+            session.trace_writer->WriteVblank(present_time - vblank_age);
+        }
+
+        // Update window
+        session.display.UpdateWindow();
+
+        return XR_SUCCESS;
     }
 }
@@ -2,12 +2,21 @@
 
 #include <vector>
 #include <chrono>
-#include <mutex>
-
+#include <memory>
+
+#include "frame_pacer.h"
+#include "frame_ring.h"
+#include "frame_timer.h"
+#include "eye_predictor.h"
+#include "pose_history.h"
+#include "space_graph.h"
+#include "trace.h"
+#include "view_solver.h"
 #include "openxr_includes.h"
 #include "window.h"
 #include "swapchain.h"
 #include "compositor.h"
+#include "graphics_backend.h"
 
 #include "srhelpers.h"
 #include "weaver_directx_12.h"
@@ -35,6 +44,18 @@ namespace XRGameBridge {
         Ended
     };
 
+    struct GB_Session;
+
+    // Composes into the intermediate image, weaves it to the window and presents
+    class GB_D3D12Compositor : public GB_CompositorBackend {
+        GB_Session& session;
+
+    public:
+        explicit GB_D3D12Compositor(GB_Session& session);
+
+        XrResult ComposeFrame(const XrFrameEndInfo* frame_end_info) override;
+    };
+
     struct GB_Session {
         XrSession id;
         XrInstance instance;
@@ -46,13 +67,31 @@ namespace XRGameBridge {
 
         //std
         std::chrono::high_resolution_clock::time_point session_epoch;
-        FrameState wait_frame_state;
-        std::mutex wait_frame_state_mutex;
+        GB_FramePacer frame_pacer;
+        GB_SessionClock clock;
+        GB_FrameTimer frame_timer{ clock };
+
+        // Tracking
+        GB_PoseHistory pose_history;
+        std::unique_ptr<GB_PoseSource> pose_source;
+        GB_EyePredictor eye_predictor{ pose_history };
+        GB_SpaceGraph space_graph{ eye_predictor };
+        GB_ViewSolver view_solver{ eye_predictor, space_graph };
+        // Records eye samples and frame timing when tracing is enabled
+        std::unique_ptr<GB_TraceWriter> trace_writer;
+
+        // Created without a graphics binding, swapchains are null swapchains and nothing is drawn or shown
+        bool headless = false;
+        // Where xrEndFrame hands the layers, GB_D3D12Compositor or GB_NullCompositor for headless sessions
+        std::unique_ptr<GB_CompositorBackend> compositor_backend;
 
         // DirectX 12
         ComPtr<ID3D12Device> d3d12_device;
         ComPtr<ID3D12CommandQueue> command_queue;
         GB_Compositor compositor;
+        GB_FrameRing frame_ring;
+        // Memory and descriptors of the application's swapchains
+        GB_ResourcePool resource_pool;
         GB_ProxySwapchain intermediate_resource;
 
         // Windows
@@ -64,41 +103,5 @@ namespace XRGameBridge {
         DirectX12Weaver* d3d12weaver;
     };
 
-    class GB_FrameTimer {
-        uint32_t frame_index = 0;
-        FrameState state = Waiting;
-
-        std::chrono::high_resolution_clock::time_point last_frame_start;
-        std::chrono::high_resolution_clock::duration last_frame_time;
-        std::chrono::high_resolution_clock::duration next_frame_time;
-
-        GB_FrameTimer() = delete;
-        GB_FrameTimer(GB_FrameTimer& other) = delete;
-        GB_FrameTimer(GB_FrameTimer&& other) = delete;
-
-        explicit GB_FrameTimer(uint32_t frame_index) : frame_index(frame_index) {
-        }
-
-        void StartNewFrame(uint32_t frame_id) {
-        }
-
-        void EndFrame(uint32_t frame_id) {
-        }
-
-        uint64_t GetNextRenderTimeNanoseconds() {
-            //auto display_time = ch::high_resolution_clock::now() - last_frame_start;
-            //next_frame_time = ch::high_resolution_clock::now() + ch::milliseconds(33);
-            //last_frame_start = ch::high_resolution_clock::now();
-            //return ch::time_point_cast<ch::nanoseconds>(ch::high_resolution_clock::now() + ch::milliseconds(3));
-        }
-
-        uint64_t GetFrameTime() {
-            //last_frame_time = ch::high_resolution_clock::now() - last_frame;
-            //return ch::duration_cast<ch::nanoseconds>(last_frame_time).count();
-        }
-    };
-
-    inline std::vector<GB_FrameTimer> g_frames;
-
     void ChangeSessionState(GB_Session& session, XrSessionState state);
 }
@@ -1 +1,77 @@
 #include "settings.h"
+
+#include <cstdlib>
+
+namespace XRGameBridge {
+    void LoadEnvironmentSettings() {
+        const char* frames_in_flight = std::getenv("XR_GAME_BRIDGE_FRAMES_IN_FLIGHT");
+        if (frames_in_flight != nullptr) {
+            const int value = std::atoi(frames_in_flight);
+            if (value >= 1 && value <= 3) {
+                g_runtime_settings.frames_in_flight = static_cast<uint32_t>(value);
+            }
+            else {
+                LOG(WARNING) << "XR_GAME_BRIDGE_FRAMES_IN_FLIGHT must be 1, 2 or 3, got " << frames_in_flight;
+            }
+        }
+
+        const char* swapchain_images = std::getenv("XR_GAME_BRIDGE_SWAPCHAIN_IMAGES");
+        if (swapchain_images != nullptr) {
+            const int value = std::atoi(swapchain_images);
+            if (value >= 2 && value <= 4) {
+                g_runtime_settings.swapchain_images = static_cast<uint32_t>(value);
+            }
+            else {
+                LOG(WARNING) << "XR_GAME_BRIDGE_SWAPCHAIN_IMAGES must be 2, 3 or 4, got " << swapchain_images;
+            }
+        }
+
+        const char* synthetic_poses = std::getenv("XR_GAME_BRIDGE_SYNTHETIC_POSES");
+        if (synthetic_poses != nullptr) {
+            g_runtime_settings.synthetic_poses = std::atoi(synthetic_poses) != 0;
+        }
+
+        const char* prediction_filter = std::getenv("XR_GAME_BRIDGE_PREDICTION_FILTER");
+        if (prediction_filter != nullptr) {
+            const std::string filter = prediction_filter;
+            if (filter == "none") {
+                g_runtime_settings.prediction.filter = PREDICTION_FILTER_NONE;
+            }
+            else if (filter == "one_euro") {
+                g_runtime_settings.prediction.filter = PREDICTION_FILTER_ONE_EURO;
+            }
+            else if (filter == "kalman") {
+                g_runtime_settings.prediction.filter = PREDICTION_FILTER_KALMAN;
+            }
+            else {
+                LOG(WARNING) << "XR_GAME_BRIDGE_PREDICTION_FILTER must be none, one_euro or kalman, got " << prediction_filter;
+            }
+        }
+
+        const char* tracker_latency = std::getenv("XR_GAME_BRIDGE_TRACKER_LATENCY_MS");
+        if (tracker_latency != nullptr) {
+            const double milliseconds = std::atof(tracker_latency);
+            if (milliseconds >= 0.0 && milliseconds <= 200.0) {
+                g_runtime_settings.prediction.tracker_latency = static_cast<XrDuration>(milliseconds * 1'000'000.0);
+            }
+            else {
+                LOG(WARNING) << "XR_GAME_BRIDGE_TRACKER_LATENCY_MS must be between 0 and 200, got " << tracker_latency;
+            }
+        }
+
+        const char* trace_record_path = std::getenv("XR_GAME_BRIDGE_TRACE_RECORD");
+        if (trace_record_path != nullptr) {
+            g_runtime_settings.trace_record_path = trace_record_path;
+        }
+
+        const char* trace_replay_path = std::getenv("XR_GAME_BRIDGE_TRACE_REPLAY");
+        if (trace_replay_path != nullptr) {
+            g_runtime_settings.trace_replay_path = trace_replay_path;
+        }
+
+        const char* api_capture_path = std::getenv("XR_GAME_BRIDGE_API_CAPTURE");
+        if (api_capture_path != nullptr) {
+            g_runtime_settings.api_capture_path = api_capture_path;
+        }
+    }
+}
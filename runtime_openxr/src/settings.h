@@ -6,6 +6,8 @@
 #include <filesystem>
 #include  <array>
 
+#include "eye_predictor.h"
+
 namespace fs = std::filesystem;
 
 namespace XRGameBridge {
@@ -14,8 +16,28 @@ namespace XRGameBridge {
         bool support_d3d11 = false;
         bool support_vk = false;
         bool support_gl = false;
+        // Number of frames the GPU may work on at once, 1 to 3. Higher trades latency for throughput.
+        uint32_t frames_in_flight = 2;
+        // Images of every swapchain the application creates, 2 to 4. Triple buffering keeps the application from stalling
+        // in xrWaitSwapchainImage when weaving runs late.
+        uint32_t swapchain_images = 3;
+        // Drive the eyes along a synthetic path instead of the eye tracker
+        bool synthetic_poses = false;
+        // Eye prediction filter and its tuning, sessions pick these up when they begin
+        GB_PredictionParameters prediction;
+        // Record a trace of every session to this file
+        std::string trace_record_path;
+        // Play the eye samples of this trace instead of using the eye tracker
+        std::string trace_replay_path;
+        // Capture every OpenXR call the application makes to this file
+        std::string api_capture_path;
         HINSTANCE hInst;
     } inline g_runtime_settings;
+
+    // Reads deployment overrides from the environment, XR_GAME_BRIDGE_FRAMES_IN_FLIGHT, XR_GAME_BRIDGE_SWAPCHAIN_IMAGES, XR_GAME_BRIDGE_SYNTHETIC_POSES,
+    // XR_GAME_BRIDGE_PREDICTION_FILTER (none, one_euro or kalman), XR_GAME_BRIDGE_TRACKER_LATENCY_MS,
+    // XR_GAME_BRIDGE_TRACE_RECORD, XR_GAME_BRIDGE_TRACE_REPLAY and XR_GAME_BRIDGE_API_CAPTURE
+    void LoadEnvironmentSettings();
 }
 
 constexpr std::array sr_dlls = {
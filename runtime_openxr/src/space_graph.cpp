@@ -0,0 +1,154 @@
+#include "space_graph.h"
+
+#include <cstring>
+
+#include "pose_math.h"
+#include "spaces.h"
+
+namespace XRGameBridge {
+    GB_SpaceGraph::GB_SpaceGraph(const GB_EyePredictor& eye_predictor) : eye_predictor(eye_predictor) {
+    }
+
+    GB_Expected<GB_SpaceNode> GB_SpaceGraph::GetNode(XrSpace space) {
+        switch (GetHandleType(space)) {
+        case HANDLE_TYPE_REFERENCE_SPACE: {
+            auto reference_space = g_reference_spaces.Find(space);
+            if (!reference_space) {
+                return GB_Expected<GB_SpaceNode>::Error(reference_space.error());
+            }
+
+            const GB_SpaceNodeType type = reference_space->space_type == XR_REFERENCE_SPACE_TYPE_VIEW ? SPACE_NODE_VIEW : SPACE_NODE_LOCAL;
+            return GB_SpaceNode{ reference_space->session, type, reference_space->pose_in_reference_space };
+        }
+        case HANDLE_TYPE_ACTION_SPACE: {
+            auto action_space = g_action_spaces.Find(space);
+            if (!action_space) {
+                return GB_Expected<GB_SpaceNode>::Error(action_space.error());
+            }
+            return GB_SpaceNode{ action_space->session, SPACE_NODE_ACTION, action_space->pose_in_action_space };
+        }
+        default:
+            return GB_Expected<GB_SpaceNode>::Error(XR_ERROR_HANDLE_INVALID);
+        }
+    }
+
+    GB_SpaceLocation GB_SpaceGraph::LocateNode(const GB_SpaceNode& node, XrTime time) const {
+        constexpr XrSpaceLocationFlags valid = XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
+        constexpr XrSpaceLocationFlags tracked = XR_SPACE_LOCATION_POSITION_TRACKED_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
+
+        switch (node.type) {
+        case SPACE_NODE_LOCAL:
+            // The origin is the center of the screen
+            return { node.offset, valid };
+        case SPACE_NODE_VIEW: {
+            // Default eye positions until the tracker delivers samples
+            GB_PoseSample eyes;
+            const bool sampled = eye_predictor.Predict(time, eyes);
+            const XrPosef head{ eyes.head_orientation, GetEyeCenter(eyes) };
+            return { PoseMultiply(head, node.offset), sampled ? valid | tracked : valid };
+        }
+        default:
+            return { PoseIdentity(), 0 };
+        }
+    }
+
+    bool GB_SpaceGraph::ReadCache(const CacheEntry& entry, CacheData& data) {
+        const uint64_t version = entry.version.load(std::memory_order_acquire);
+        if ((version & 1) != 0) {
+            return false;
+        }
+
+        std::array<uint64_t, cache_words> words;
+        for (uint32_t i = 0; i < cache_words; i++) {
+            words[i] = entry.words[i].load(std::memory_order_relaxed);
+        }
+
+        // The data loads may not move past the second version check
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.version.load(std::memory_order_relaxed) != version) {
+            return false;
+        }
+
+        memcpy(&data, words.data(), sizeof(CacheData));
+        return true;
+    }
+
+    void GB_SpaceGraph::WriteCache(CacheEntry& entry, const CacheData& data) {
+        // Claim the entry by making the version odd, another thread already filling it wins
+        uint64_t version = entry.version.load(std::memory_order_relaxed);
+        if ((version & 1) != 0 || !entry.version.compare_exchange_strong(version, version + 1, std::memory_order_relaxed)) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::array<uint64_t, cache_words> words{};
+        memcpy(words.data(), &data, sizeof(CacheData));
+        for (uint32_t i = 0; i < cache_words; i++) {
+            entry.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        entry.version.store(version + 2, std::memory_order_release);
+    }
+
+    GB_Expected<GB_SpaceLocation> GB_SpaceGraph::LocateInDisplay(XrSpace space, XrTime time) const {
+        auto node = GetNode(space);
+        if (!node) {
+            return GB_Expected<GB_SpaceLocation>::Error(node.error());
+        }
+        return LocateNode(*node, time);
+    }
+
+    GB_Expected<GB_SpaceLocation> GB_SpaceGraph::Locate(XrSpace space, XrSpace base_space, XrTime time) const {
+        auto node = GetNode(space);
+        if (!node) {
+            return GB_Expected<GB_SpaceLocation>::Error(node.error());
+        }
+        auto base_node = GetNode(base_space);
+        if (!base_node) {
+            return GB_Expected<GB_SpaceLocation>::Error(base_node.error());
+        }
+        if (base_node->session != node->session) {
+            return GB_Expected<GB_SpaceLocation>::Error(XR_ERROR_VALIDATION_FAILURE);
+        }
+
+        // Nothing to compose when either side can't be located
+        if (node->type == SPACE_NODE_ACTION || base_node->type == SPACE_NODE_ACTION) {
+            return GB_SpaceLocation{ PoseIdentity(), 0 };
+        }
+
+        // Pairs without the view space are fixed relative to each other, time doesn't matter for them
+        const bool tracked_pair = node->type == SPACE_NODE_VIEW || base_node->type == SPACE_NODE_VIEW;
+        const int64_t bucket = tracked_pair ? time / time_bucket : 0;
+        // Read before sampling, a sample that arrives while composing leaves the entry stale instead of wrongly fresh
+        const uint64_t generation = eye_predictor.GetGeneration();
+
+        const uint64_t key = reinterpret_cast<uint64_t>(space) * 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uint64_t>(base_space) * 0xC2B2AE3D27D4EB4Full ^ static_cast<uint64_t>(bucket);
+        CacheEntry& entry = cache[(key >> 32) % cache_size];
+
+        CacheData cached;
+        if (ReadCache(entry, cached) && cached.space == space && cached.base_space == base_space && cached.bucket == bucket && (!tracked_pair || cached.generation == generation)) {
+            cache_hits.fetch_add(1, std::memory_order_relaxed);
+            return cached.location;
+        }
+        cache_misses.fetch_add(1, std::memory_order_relaxed);
+
+        const GB_SpaceLocation location = LocateNode(*node, time);
+        const GB_SpaceLocation base_location = LocateNode(*base_node, time);
+
+        GB_SpaceLocation result;
+        result.pose = PoseMultiply(PoseInverse(base_location.pose), location.pose);
+        result.flags = location.flags & base_location.flags;
+        // Tracking of either side carries over to the relation between them
+        result.flags |= (location.flags | base_location.flags) & (XR_SPACE_LOCATION_POSITION_TRACKED_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT);
+
+        WriteCache(entry, { space, base_space, bucket, generation, result });
+        return result;
+    }
+
+    uint64_t GB_SpaceGraph::GetCacheHits() const {
+        return cache_hits.load(std::memory_order_relaxed);
+    }
+
+    uint64_t GB_SpaceGraph::GetCacheMisses() const {
+        return cache_misses.load(std::memory_order_relaxed);
+    }
+}
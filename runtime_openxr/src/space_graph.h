@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include <openxr/openxr.h>
+
+#include "expected.h"
+#include "eye_predictor.h"
+
+namespace XRGameBridge {
+    enum GB_SpaceNodeType {
+        SPACE_NODE_LOCAL,
+        SPACE_NODE_VIEW,
+        SPACE_NODE_ACTION,
+    };
+
+    // A space in the graph, the origin of its type plus the offset pose the application created it with
+    struct GB_SpaceNode {
+        XrSession session;
+        GB_SpaceNodeType type;
+        XrPosef offset;
+    };
+
+    struct GB_SpaceLocation {
+        XrPosef pose;
+        XrSpaceLocationFlags flags;
+    };
+
+    // Locates spaces relative to each other.
+    // Every reference space hangs off the display space the eye tracker reports in, local space is fixed in it and view space follows the eyes.
+    // Action spaces have nothing tracking them and are never located.
+    //
+    // Composed transforms are cached per (space, base space, time bucket). Entries that involve the view space are dropped as soon as the eye prediction
+    // changes, so the many locate calls of a single frame compose every pair only once.
+    // Every cache entry is a seqlock like the slots of GB_PoseHistory, so locating never takes a lock. A read that races a write counts as a miss,
+    // and a write that finds another thread writing the same entry is dropped.
+    class GB_SpaceGraph {
+    public:
+        // Locate times in the same bucket share a cached result
+        static constexpr XrDuration time_bucket = 100'000;
+        static constexpr uint32_t cache_size = 64;
+
+    private:
+        // Trivially copyable so it can be copied in and out of the entry words, an entry of all zeroes holds no space
+        struct CacheData {
+            XrSpace space;
+            XrSpace base_space;
+            int64_t bucket;
+            // Eye predictor generation the entry was composed at, only checked for tracked pairs
+            uint64_t generation;
+            GB_SpaceLocation location;
+        };
+
+        static constexpr uint32_t cache_words = (sizeof(CacheData) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        struct CacheEntry {
+            // Odd while a writer fills the entry
+            std::atomic<uint64_t> version = 0;
+            std::array<std::atomic<uint64_t>, cache_words> words{};
+        };
+
+        const GB_EyePredictor& eye_predictor;
+
+        mutable std::array<CacheEntry, cache_size> cache;
+        mutable std::atomic<uint64_t> cache_hits = 0;
+        mutable std::atomic<uint64_t> cache_misses = 0;
+
+        // Pose of the node in display space
+        GB_SpaceLocation LocateNode(const GB_SpaceNode& node, XrTime time) const;
+
+        // Returns false if the entry was being written
+        static bool ReadCache(const CacheEntry& entry, CacheData& data);
+        static void WriteCache(CacheEntry& entry, const CacheData& data);
+
+    public:
+        explicit GB_SpaceGraph(const GB_EyePredictor& eye_predictor);
+
+        // Looks the space up in the reference and action space tables, the handle type says which
+        static GB_Expected<GB_SpaceNode> GetNode(XrSpace space);
+
+        // Pose of the space in display space, not cached
+        GB_Expected<GB_SpaceLocation> LocateInDisplay(XrSpace space, XrTime time) const;
+        // Pose of the space in the base space, both have to belong to the same session
+        GB_Expected<GB_SpaceLocation> Locate(XrSpace space, XrSpace base_space, XrTime time) const;
+
+        uint64_t GetCacheHits() const;
+        uint64_t GetCacheMisses() const;
+    };
+}
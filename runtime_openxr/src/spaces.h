@@ -0,0 +1,27 @@
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include "handle_table.h"
+
+namespace XRGameBridge {
+    // Spaces are basically transformation matrices.
+    // They transform a point/orientation with respect to an XrSpace of the applications choosing
+    struct GB_ReferenceSpace {
+        XrSession session;
+        XrSpace handle;
+        XrReferenceSpaceType space_type;
+        XrPosef pose_in_reference_space;
+    };
+
+    struct GB_ActionSpace {
+        XrSession session;
+        XrSpace handle;
+        XrAction action;
+        XrPath sub_action_path;
+        XrPosef pose_in_action_space;
+    };
+
+    inline GB_HandleTable<XrSpace, GB_ReferenceSpace> g_reference_spaces{ HANDLE_TYPE_REFERENCE_SPACE };
+    inline GB_HandleTable<XrSpace, GB_ActionSpace> g_action_spaces{ HANDLE_TYPE_ACTION_SPACE };
+}
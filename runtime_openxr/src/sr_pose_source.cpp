@@ -0,0 +1,55 @@
+#include "sr_pose_source.h"
+
+#include <cmath>
+
+namespace XRGameBridge {
+    GB_SRPoseSource::GB_SRPoseSource(SR::SRContext& context, const GB_Clock& clock) : context(context), clock(clock) {
+    }
+
+    GB_SRPoseSource::~GB_SRPoseSource() {
+        Stop();
+    }
+
+    bool GB_SRPoseSource::Start(GB_PoseHistory& history) {
+        if (this->history != nullptr) {
+            return false;
+        }
+
+        eye_tracker = SR::EyeTracker::create(context);
+        if (eye_tracker == nullptr) {
+            LOG(ERROR) << "Failed to create SR eye tracker";
+            return false;
+        }
+
+        this->history = &history;
+        stream.set(eye_tracker->openEyePairStream(this));
+        return true;
+    }
+
+    void GB_SRPoseSource::Stop() {
+        if (history == nullptr) {
+            return;
+        }
+        stream.stop();
+        history = nullptr;
+    }
+
+    void GB_SRPoseSource::accept(const SR_eyePair& eye_pair) {
+        if (history == nullptr) {
+            return;
+        }
+
+        // The tracker uses its own timebase, samples are stamped on arrival so they line up with predicted display times.
+        // SR reports millimeters in the same display space the history uses.
+        GB_PoseSample sample;
+        sample.time = clock.Now();
+        sample.left_eye = { static_cast<float>(eye_pair.left.x) * 0.001f, static_cast<float>(eye_pair.left.y) * 0.001f, static_cast<float>(eye_pair.left.z) * 0.001f };
+        sample.right_eye = { static_cast<float>(eye_pair.right.x) * 0.001f, static_cast<float>(eye_pair.right.y) * 0.001f, static_cast<float>(eye_pair.right.z) * 0.001f };
+
+        // The tracker has no head orientation, the turn around the vertical axis follows from the line between the eyes
+        const float yaw = std::atan2(sample.left_eye.z - sample.right_eye.z, sample.right_eye.x - sample.left_eye.x);
+        sample.head_orientation = { 0.0f, std::sin(yaw / 2.0f), 0.0f, std::cos(yaw / 2.0f) };
+
+        history->AddSample(sample);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "openxr_includes.h"
+#include "pose_history.h"
+
+#include <sr/sense/core/inputstream.h>
+#include <sr/sense/eyetracker/eyetracker.h>
+
+namespace XRGameBridge {
+    // Feeds the pose history from the SR eye tracker.
+    // Has to be started before the SR context is initialized, the tracker registers itself as a sense of the context.
+    class GB_SRPoseSource : public GB_PoseSource, public SR::EyePairListener {
+        SR::SRContext& context;
+        const GB_Clock& clock;
+
+        SR::EyeTracker* eye_tracker = nullptr;
+        SR::InputStream<SR::EyePairStream> stream;
+        GB_PoseHistory* history = nullptr;
+
+    public:
+        GB_SRPoseSource(SR::SRContext& context, const GB_Clock& clock);
+        ~GB_SRPoseSource() override;
+
+        bool Start(GB_PoseHistory& history) override;
+        void Stop() override;
+
+        // Called on the tracker thread for every new eye pair
+        void accept(const SR_eyePair& eye_pair) override;
+    };
+}
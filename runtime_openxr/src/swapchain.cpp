@@ -1,5 +1,7 @@
 #include "swapchain.h"
 
+#include <algorithm>
+#include <bit>
 #include <stdexcept>
 #include <exception>
 #include <vector>
@@ -9,26 +11,25 @@
 #include "easylogging++.h"
 #include "openxr_functions.h"
 #include "instance.h"
+#include "null_backend.h"
 #include "settings.h"
 #include "system.h"
 
 XrResult xrEnumerateSwapchainFormats(XrSession session, uint32_t formatCapacityInput, uint32_t* formatCountOutput, int64_t* formats) {
-    XRGameBridge::GraphicsBackend backend;
-
-    try {
-        XRGameBridge::GB_Session& gb_session = XRGameBridge::g_sessions.at(session);
-        XRGameBridge::GB_System& gb_system = XRGameBridge::g_systems.at(gb_session.system);
-        backend = gb_system.active_graphics_backend;
-    }
-    catch (std::out_of_range& e) {
-        return XR_ERROR_SYSTEM_INVALID;
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
     }
-    catch (std::exception& e) {
-        return XR_ERROR_RUNTIME_FAILURE;
+
+    auto system_lookup = XRGameBridge::FindSystem(session_lookup->system);
+    if (!system_lookup) {
+        return system_lookup.error();
     }
+    XRGameBridge::GraphicsBackend backend = system_lookup->active_graphics_backend;
 
     std::vector<int64_t> supported_swapchain_formats;
-    if (backend == XRGameBridge::GraphicsBackend::D3D12) {
+    // Null swapchains stand in for D3D12 ones, a capture of a D3D12 application asks for the same formats
+    if (backend == XRGameBridge::GraphicsBackend::D3D12 || session_lookup->headless) {
         supported_swapchain_formats.push_back(DXGI_FORMAT_R8G8B8A8_UNORM);
         supported_swapchain_formats.push_back(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
     }
@@ -57,40 +58,72 @@ XrResult xrEnumerateSwapchainFormats(XrSession session, uint32_t formatCapacityI
 XrResult xrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain) {
     //TODO Get compositor from the session and create descriptor on it for the new swapchain
 
-    static size_t swapchain_creation_count = 1;
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
+    }
+    XRGameBridge::GB_Session& gb_session = *session_lookup;
 
-    // Create handle
-    XrSwapchain handle = reinterpret_cast<XrSwapchain>(swapchain_creation_count);
+    if (gb_session.headless) {
+        XrResult result = XRGameBridge::GB_NullSwapchain::ValidateCreateInfo(*createInfo);
+        if (result != XR_SUCCESS) {
+            return result;
+        }
+        XrSwapchain handle = XRGameBridge::g_null_swapchains.Create(*createInfo, XRGameBridge::g_runtime_settings.swapchain_images);
+        if (handle == XR_NULL_HANDLE) {
+            return XR_ERROR_LIMIT_REACHED;
+        }
+        *swapchain = handle;
+        gb_session.swap_chain = handle;
+        XRGameBridge::ChangeSessionState(gb_session, XR_SESSION_STATE_READY);
+        return XR_SUCCESS;
+    }
+
+    XrResult result = XRGameBridge::ValidateSwapchainCreateInfo(gb_session.d3d12_device, createInfo);
+    if (result != XR_SUCCESS) {
+        return result;
+    }
 
-    // Create entry in the listx
-    XRGameBridge::GB_ProxySwapchain gb_proxy(handle);
+    // Create entry in the table
+    XrSwapchain handle = XRGameBridge::g_proxy_swapchains.Create();
+    auto swapchain_lookup = XRGameBridge::g_proxy_swapchains.Find(handle);
+    if (!swapchain_lookup) {
+        return XR_ERROR_LIMIT_REACHED;
+    }
+    XRGameBridge::GB_ProxySwapchain& gb_proxy = *swapchain_lookup;
+    gb_proxy.SetHandle(handle);
 
     // Create swap chain
-    XRGameBridge::GB_Session& gb_session = XRGameBridge::g_sessions[session];
-
-    if (gb_proxy.CreateResources(gb_session.d3d12_device, createInfo) == false) {
+    if (gb_proxy.CreateResources(gb_session.d3d12_device, createInfo, XRGameBridge::g_runtime_settings.swapchain_images, &gb_session.resource_pool, &gb_session.frame_ring.GetTimeline()) == false) {
+        gb_proxy.DestroyResources();
+        XRGameBridge::g_proxy_swapchains.Destroy(handle);
         return XR_ERROR_RUNTIME_FAILURE;
     }
 
     // Couple swap chain to the session
     *swapchain = handle;
     gb_session.swap_chain = handle;
-    swapchain_creation_count++;
 
     // TODO Is this the right place set the session state to ready?
     // Maybe the session is ready when all systems for the session are there, this would not include swapchains
     // Whether there is something to render to is responsibility of the application.
     XRGameBridge::ChangeSessionState(gb_session, XR_SESSION_STATE_READY);
 
-    XRGameBridge::g_proxy_swapchains[handle] = gb_proxy;
     return XR_SUCCESS;
 }
 
 XrResult xrDestroySwapchain(XrSwapchain swapchain) {
-    auto& gb_proxy = XRGameBridge::g_proxy_swapchains[swapchain];
-    gb_proxy.DestroyResources();
+    if (XRGameBridge::GetHandleType(swapchain) == XRGameBridge::HANDLE_TYPE_NULL_SWAPCHAIN) {
+        return XRGameBridge::g_null_swapchains.Destroy(swapchain) ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
+    }
+
+    auto gb_proxy = XRGameBridge::g_proxy_swapchains.Find(swapchain);
+    if (!gb_proxy) {
+        return gb_proxy.error();
+    }
+    gb_proxy->DestroyResources();
 
-    XRGameBridge::g_proxy_swapchains.erase(swapchain);
+    XRGameBridge::g_proxy_swapchains.Destroy(swapchain);
 
     return XR_SUCCESS;
 }
@@ -98,7 +131,24 @@ XrResult xrDestroySwapchain(XrSwapchain swapchain) {
 XrResult xrEnumerateSwapchainImages(XrSwapchain swapchain, uint32_t imageCapacityInput, uint32_t* imageCountOutput, XrSwapchainImageBaseHeader* images) {
     //TODO Create actual swap chains over here
 
-    auto& gb_render_target = XRGameBridge::g_proxy_swapchains[swapchain];
+    if (XRGameBridge::GetHandleType(swapchain) == XRGameBridge::HANDLE_TYPE_NULL_SWAPCHAIN) {
+        auto null_lookup = XRGameBridge::g_null_swapchains.Find(swapchain);
+        if (!null_lookup) {
+            return null_lookup.error();
+        }
+        // Null images are plain memory that isn't handed out, only the count is returned and the structs are left as they are
+        *imageCountOutput = null_lookup->GetBufferCount();
+        if (imageCapacityInput != 0 && imageCapacityInput < *imageCountOutput) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+        return XR_SUCCESS;
+    }
+
+    auto swapchain_lookup = XRGameBridge::g_proxy_swapchains.Find(swapchain);
+    if (!swapchain_lookup) {
+        return swapchain_lookup.error();
+    }
+    auto& gb_render_target = *swapchain_lookup;
     uint32_t count = gb_render_target.GetBufferCount();
 
     *imageCountOutput = count;
@@ -117,16 +167,12 @@ XrResult xrEnumerateSwapchainImages(XrSwapchain swapchain, uint32_t imageCapacit
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
-        std::vector<XrSwapchainImageD3D12KHR> xr_images;
-        auto directx_images = gb_render_target.GetBuffers();
+        // Fill array, the application owns the structure types and next chains
+        auto d3d12_images = reinterpret_cast<XrSwapchainImageD3D12KHR*>(images);
+        const auto& directx_images = gb_render_target.GetBuffers();
         for (uint32_t i = 0; i < count; i++) {
-            XrSwapchainImageD3D12KHR image{};
-            image.texture = directx_images[i].Get();
-            xr_images.push_back(image);
+            d3d12_images[i].texture = directx_images[i].Get();
         }
-
-        // Fill array
-        memcpy_s(images, imageCapacityInput * sizeof(XrSwapchainImageD3D12KHR), xr_images.data(), xr_images.size() * sizeof(XrSwapchainImageD3D12KHR));
         return XR_SUCCESS;
     }
 
@@ -140,97 +186,150 @@ XrResult xrEnumerateBoundSourcesForAction(XrSession session, const XrBoundSource
 }
 
 XrResult xrAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo* acquireInfo, uint32_t* index) {
-    //TODO May only be called again AFTER xrReleaseSwapchainImage has been called. See specification.
-    // return XR_ERROR_CALL_ORDER_INVALID
+    // Images can be acquired up to the image count before releasing them, waits and releases follow the acquire order
 
-    auto& gb_proxy = XRGameBridge::g_proxy_swapchains[swapchain];
-    XrResult res = gb_proxy.AcquireNextImage(*index);
+    auto backend = XRGameBridge::FindSwapchainBackend(swapchain);
+    if (!backend) {
+        return backend.error();
+    }
+
+    XrResult res = backend->AcquireNextImage(*index);
     return res;
 }
 
 XrResult xrWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* waitInfo) {
     //TODO see specification for other waiting requirements
 
-    uint64_t wait_duration = INFINITE;
-    if (waitInfo->timeout != XR_INFINITE_DURATION) {
-        wait_duration = waitInfo->timeout;
+    auto backend = XRGameBridge::FindSwapchainBackend(swapchain);
+    if (!backend) {
+        return backend.error();
     }
 
-    auto& gb_proxy = XRGameBridge::g_proxy_swapchains[swapchain];
-
-    return gb_proxy.WaitForImage(wait_duration);
+    return backend->WaitForImage(waitInfo->timeout);
 }
 
 XrResult xrReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo* releaseInfo) {
     // Basically tells the runtime that the application is done with an image
 
-    auto& gb_proxy = XRGameBridge::g_proxy_swapchains[swapchain];
-    return gb_proxy.ReleaseImage();
+    auto backend = XRGameBridge::FindSwapchainBackend(swapchain);
+    if (!backend) {
+        return backend.error();
+    }
+
+    return backend->ReleaseImage();
 }
 
 namespace XRGameBridge {
-    GB_ProxySwapchain::GB_ProxySwapchain(XrSwapchain handle) : handle(handle) {
+    GB_Expected<GB_SwapchainBackend&> FindSwapchainBackend(XrSwapchain swapchain) {
+        if (GetHandleType(swapchain) == HANDLE_TYPE_NULL_SWAPCHAIN) {
+            auto null_lookup = g_null_swapchains.Find(swapchain);
+            if (!null_lookup) {
+                return GB_Expected<GB_SwapchainBackend&>::Error(null_lookup.error());
+            }
+            return *null_lookup;
+        }
+
+        auto proxy_lookup = g_proxy_swapchains.Find(swapchain);
+        if (!proxy_lookup) {
+            return GB_Expected<GB_SwapchainBackend&>::Error(proxy_lookup.error());
+        }
+        return *proxy_lookup;
     }
 
-    bool GB_ProxySwapchain::CreateResources(const ComPtr<ID3D12Device>& device, const XrSwapchainCreateInfo* createInfo)
+    void GB_ProxySwapchain::SetHandle(XrSwapchain swapchain_handle) {
+        handle = swapchain_handle;
+    }
+
+    bool GB_ProxySwapchain::CreateResources(const ComPtr<ID3D12Device>& device, const XrSwapchainCreateInfo* createInfo, uint32_t count, GB_ResourcePool* resource_pool, const GB_Timeline* session_timeline)
     {
         D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE;
         D3D12_RESOURCE_STATES states = D3D12_RESOURCE_STATE_COMMON;
         GetResourceStateFlags(createInfo->usageFlags, flags, states);
-        return CreateResources(device, createInfo->width, createInfo->height, static_cast<DXGI_FORMAT>(createInfo->format), flags, states);
-    }
 
-    bool GB_ProxySwapchain::CreateResources(const ComPtr<ID3D12Device>& device, uint32_t width, uint32_t height, DXGI_FORMAT format, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES states){
+        // Cube faces are array slices to D3D12, a cube view is only a way to look at six of them
+        const auto desc = CD3DX12_RESOURCE_DESC::Tex2D(
+            static_cast<DXGI_FORMAT>(createInfo->format),
+            createInfo->width,
+            createInfo->height,
+            static_cast<UINT16>(createInfo->arraySize * createInfo->faceCount),
+            static_cast<UINT16>(createInfo->mipCount),
+            createInfo->sampleCount,
+            0,
+            flags);
+        return CreateResources(device, desc, states, count, resource_pool, session_timeline);
+    }
+
+    bool GB_ProxySwapchain::CreateResources(const ComPtr<ID3D12Device>& device, const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES states, uint32_t count, GB_ResourcePool* resource_pool, const GB_Timeline* session_timeline){
+        image_count = std::clamp(count, g_min_swapchain_images, g_max_swapchain_images);
+        image_desc = desc;
+        pool = resource_pool;
+        timeline = session_timeline;
+
         // Reinitialize the values in the array
-        current_image_state.fill(IMAGE_STATE_RELEASED);
-        fence_values.fill(0);
-
-        for (uint32_t i = 0; i < g_back_buffer_count; i++) {
-            // Describe and create a Texture2D.
-            D3D12_RESOURCE_DESC textureDesc = {};
-            textureDesc.MipLevels = 1;
-            textureDesc.Format = format;
-            textureDesc.Width = width;
-            textureDesc.Height = height;
-            textureDesc.Flags = flags;
-            textureDesc.DepthOrArraySize = 1;
-            textureDesc.SampleDesc.Count = 1;
-            textureDesc.SampleDesc.Quality = 0;
-            textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-
-            //D3D12_DEPTH_STENCIL_VALUE depth_stencil_value;
-            //depth_stencil_value.Depth = 100.f;
-            //depth_stencil_value.Stencil = 0;
-
-            float clear_color[4]{ 0.5f, 0.5f, 0.0f, 1.0f };
-
-            D3D12_CLEAR_VALUE clear_value{
-                static_cast<DXGI_FORMAT>(format),
-                0.5f
-            };
-
-            // Set resource_usage to save the state the application expects the buffer to be in
-            resource_usage = states;
-
-            auto resource = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-            ThrowIfFailed(device->CreateCommittedResource(
-                &resource,
-                D3D12_HEAP_FLAG_NONE,
-                &textureDesc,
-                states,
-                &clear_value,
-                IID_PPV_ARGS(&back_buffers[i])));
+        image_ring.Reset(image_count);
+        for (auto& value : timeline_values) {
+            value.store(0, std::memory_order_relaxed);
+        }
 
+        //D3D12_DEPTH_STENCIL_VALUE depth_stencil_value;
+        //depth_stencil_value.Depth = 100.f;
+        //depth_stencil_value.Stencil = 0;
+
+        float clear_color[4]{ 0.5f, 0.5f, 0.0f, 1.0f };
+
+        D3D12_CLEAR_VALUE clear_value{
+            desc.Format,
+            0.5f
+        };
+
+        // Set resource_usage to save the state the application expects the buffer to be in
+        resource_usage = states;
+
+        // Placed in the session's heaps when possible, committed otherwise
+        if (pool == nullptr || !pool->CreateImages(desc, states, &clear_value, image_count, back_buffers.data(), image_allocations.data())) {
+            for (uint32_t i = 0; i < image_count; i++) {
+                auto resource = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+                ThrowIfFailed(device->CreateCommittedResource(
+                    &resource,
+                    D3D12_HEAP_FLAG_NONE,
+                    &desc,
+                    states,
+                    &clear_value,
+                    IID_PPV_ARGS(&back_buffers[i])));
+            }
+        }
+
+        for (uint32_t i = 0; i < image_count; i++) {
             // Set name for debugging
             std::wstring name = std::format(L"Proxy Swapchain {} Resource {}", reinterpret_cast<size_t>(handle), i);
             back_buffers[i]->SetName(name.c_str());
         }
 
-        // Create descriptor heaps.
-        {
+        // Multisampled color images can't be sampled by the compositor, it reads a resolved copy of the same image index.
+        // The copies stay in the pixel shader resource state, only the slice being resolved leaves it.
+        if (IsMultisampled() && (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET) != 0) {
+            const auto resolve_desc = CD3DX12_RESOURCE_DESC::Tex2D(desc.Format, desc.Width, desc.Height, desc.DepthOrArraySize, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+            if (pool == nullptr || !pool->CreateImages(resolve_desc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, &clear_value, image_count, resolve_images.data(), resolve_allocations.data())) {
+                for (uint32_t i = 0; i < image_count; i++) {
+                    auto resource = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+                    if (FAILED(device->CreateCommittedResource(&resource, D3D12_HEAP_FLAG_NONE, &resolve_desc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, &clear_value, IID_PPV_ARGS(&resolve_images[i])))) {
+                        LOG(ERROR) << "Failed to create d3d12 resolve image";
+                        return false;
+                    }
+                }
+            }
+
+            for (uint32_t i = 0; i < image_count; i++) {
+                std::wstring name = std::format(L"Proxy Swapchain {} Resolve {}", reinterpret_cast<size_t>(handle), i);
+                resolve_images[i]->SetName(name.c_str());
+            }
+        }
+
+        // Create descriptor heaps, or take a range of the pool's.
+        if (pool == nullptr || !pool->AllocateDescriptors(image_count, rtv_allocation, rtv_heap, srv_allocation, srv_heap)) {
             // Describe and create a render target view (RTV) descriptor heap.
             D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
-            rtvHeapDesc.NumDescriptors = g_back_buffer_count;
+            rtvHeapDesc.NumDescriptors = image_count;
             rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
             rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
             if (FAILED(device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&rtv_heap)))) {
@@ -241,7 +340,7 @@ namespace XRGameBridge {
             // TODO we create an srv heap here but not srv's themselves later on
             // Describe and create a shader resource view (SRV) heap for the texture.
             D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-            srvHeapDesc.NumDescriptors = g_back_buffer_count;
+            srvHeapDesc.NumDescriptors = image_count;
             srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
             srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
             if (FAILED(device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&srv_heap)))) {
@@ -255,58 +354,74 @@ namespace XRGameBridge {
 
         // Create descriptors
         {
-            CD3DX12_CPU_DESCRIPTOR_HANDLE rtv_handle(rtv_heap->GetCPUDescriptorHandleForHeapStart());
-            CD3DX12_CPU_DESCRIPTOR_HANDLE srv_handle(srv_heap->GetCPUDescriptorHandleForHeapStart());
+            CD3DX12_CPU_DESCRIPTOR_HANDLE rtv_handle(rtv_heap->GetCPUDescriptorHandleForHeapStart(), GetRtvIndex(0), rtv_descriptor_size);
+            CD3DX12_CPU_DESCRIPTOR_HANDLE srv_handle(srv_heap->GetCPUDescriptorHandleForHeapStart(), GetSrvIndex(0), cbc_srv_uav_descriptor_size);
+
+            // Every swapchain is read as an array, the compositor picks the slice of a view with a root constant
+            D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc{};
+            srv_desc.Format = desc.Format;
+            srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+            if (IsMultisampled() && resolve_images[0] == nullptr) {
+                // Multisampled depth has no resolved copy, nothing composites it anyway
+                srv_desc.ViewDimension = D3D12_SRV_DIMENSION::D3D12_SRV_DIMENSION_TEXTURE2DMSARRAY;
+                srv_desc.Texture2DMSArray.FirstArraySlice = 0;
+                srv_desc.Texture2DMSArray.ArraySize = desc.DepthOrArraySize;
+            }
+            else {
+                D3D12_TEX2D_ARRAY_SRV tex2d_array{};
+                tex2d_array.MostDetailedMip = 0;
+                tex2d_array.MipLevels = IsMultisampled() ? 1 : desc.MipLevels;
+                tex2d_array.FirstArraySlice = 0;
+                tex2d_array.ArraySize = desc.DepthOrArraySize;
+                tex2d_array.PlaneSlice = 0;
+                srv_desc.ViewDimension = D3D12_SRV_DIMENSION::D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+                srv_desc.Texture2DArray = tex2d_array;
+            }
 
-            for (int32_t i = 0; i < g_back_buffer_count; i++) {
+            for (uint32_t i = 0; i < image_count; i++) {
                 //std::wstringstream ss; ss << "Swap Container Resource: " << i;
                 //back_buffers[i]->SetName(ss.str().c_str());
 
-                // Create a RTV for each frame.
+                // Create a RTV for each frame, the default view covers the first mip of every slice
                 device->CreateRenderTargetView(back_buffers[i].Get(), nullptr, rtv_handle);
                 rtv_handle.Offset(1, rtv_descriptor_size);
 
-                D3D12_TEX2D_SRV tex2d{};
-                tex2d.MipLevels = 1;
-                tex2d.MostDetailedMip = 0;
-                tex2d.PlaneSlice = 0;
-                D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc {};
-                srv_desc.Format = format;
-                srv_desc.ViewDimension = D3D12_SRV_DIMENSION::D3D12_SRV_DIMENSION_TEXTURE2D;
-                srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-                srv_desc.Texture2D = tex2d;
                 // Create SRV for each frame
-                device->CreateShaderResourceView(back_buffers[i].Get(), &srv_desc, srv_handle);
+                ID3D12Resource* sampled_image = resolve_images[i] != nullptr ? resolve_images[i].Get() : back_buffers[i].Get();
+                device->CreateShaderResourceView(sampled_image, &srv_desc, srv_handle);
                 srv_handle.Offset(1, cbc_srv_uav_descriptor_size);
             }
         }
 
-        // Create fence
-        device->CreateFence(fence_values[current_frame_index], D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence));
-        // Create an event handle to use for frame synchronization.
-        fence_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-        if (fence_event == nullptr) {
-            HRESULT_FROM_WIN32(GetLastError());
-            return false;
-        }
-
         return true;
     }
 
     void GB_ProxySwapchain::DestroyResources() {
-        for (int32_t i = 0; i < g_back_buffer_count; i++) {
+        for (uint32_t i = 0; i < image_count; i++) {
             back_buffers[i].Reset();
+            resolve_images[i].Reset();
         }
 
         rtv_heap.Reset();
         srv_heap.Reset();
+
+        // The pool reuses the memory once the GPU is done with it
+        if (pool != nullptr) {
+            pool->Free(image_allocations.data(), image_count, rtv_allocation, srv_allocation);
+            pool->Free(resolve_allocations.data(), image_count, {}, {});
+            pool = nullptr;
+        }
+        image_allocations.fill({});
+        resolve_allocations.fill({});
+        rtv_allocation = {};
+        srv_allocation = {};
     }
 
-    uint32_t GB_ProxySwapchain::GetBufferCount() {
-        return g_back_buffer_count;
+    uint32_t GB_ProxySwapchain::GetBufferCount() const {
+        return image_count;
     }
 
-    std::array<ComPtr<ID3D12Resource>, g_back_buffer_count> GB_ProxySwapchain::GetBuffers() {
+    const std::array<ComPtr<ID3D12Resource>, g_max_swapchain_images>& GB_ProxySwapchain::GetBuffers() const {
         return back_buffers;
     }
 
@@ -318,73 +433,64 @@ namespace XRGameBridge {
         return srv_heap;
     }
 
-    XrResult GB_ProxySwapchain::AcquireNextImage(uint32_t& index) {
-        uint32_t next_index = (current_frame_index + 1) % g_back_buffer_count;
+    uint32_t GB_ProxySwapchain::GetRtvIndex(uint32_t image) const {
+        return static_cast<uint32_t>(rtv_allocation.offset) + image;
+    }
 
-        if (current_image_state[next_index] != IMAGE_STATE_RELEASED) {
-            return XR_ERROR_CALL_ORDER_INVALID;
-        }
+    uint32_t GB_ProxySwapchain::GetSrvIndex(uint32_t image) const {
+        return static_cast<uint32_t>(srv_allocation.offset) + image;
+    }
 
-        // set current frame values to the values of the next frame
-        current_frame_index = next_index;
-        index = current_frame_index;
-        current_image_state[next_index] = IMAGE_STATE_ACQUIRED;
-        return XR_SUCCESS;
+    uint32_t GB_ProxySwapchain::GetArraySize() const {
+        return image_desc.DepthOrArraySize;
+    }
+
+    bool GB_ProxySwapchain::IsMultisampled() const {
+        return image_desc.SampleDesc.Count > 1;
+    }
+
+    XrResult GB_ProxySwapchain::AcquireNextImage(uint32_t& index) {
+        return image_ring.Acquire(index);
     }
 
     // Wait for the gpu to be done with the image so we can use it for drawing
-    // Must only be called after GetCurrentBackBufferIndex to be sure that the image index is not in use anymore
     XrResult GB_ProxySwapchain::WaitForImage(const XrDuration& timeout) {
-        if (current_image_state[current_frame_index] != IMAGE_STATE_ACQUIRED) {
-            return XR_ERROR_CALL_ORDER_INVALID;
-        }
-
-        // Should always be called AFTER GetCurrentBackBufferIndex. So GetCompletedValue van be compared to the new frame fence value.
-        uint64_t completed_value = fence->GetCompletedValue();
-        if (completed_value < fence_values[current_frame_index]) {
-            // Fire event on completion
-            fence->SetEventOnCompletion(fence_values[current_frame_index], fence_event);
-            // Wait for the fence to be signaled and fire the event
-            HRESULT res = WaitForSingleObjectEx(fence_event, ch::duration_cast<ch::milliseconds>(ch::nanoseconds(timeout)).count(), FALSE);
-            if (res == WAIT_TIMEOUT) {
-                return XR_TIMEOUT_EXPIRED;
-            }
+        uint32_t index = 0;
+        XrResult result = image_ring.BeginWait(index);
+        if (result != XR_SUCCESS) {
+            return result;
+        }
+
+        // Done once the last frame that read the image completed on the session timeline
+        const uint64_t value = timeline_values[index].load(std::memory_order_acquire);
+        if (timeline != nullptr && !timeline->Wait(value, timeout)) {
+            // The image stays acquired, the application may wait on it again
+            image_ring.EndWait(index, false);
+            return XR_TIMEOUT_EXPIRED;
         }
 
         // TODO wait for fence -> transition image -> set event on the same fence -> wait again on the same fence
         // This is so we can guarantee that the image is free and in the correct state to be used by the application
         //TransitionBackBufferImage(COMMAND_RESOURCE_INDEX_TRANSITION, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
 
-        // Remark: fence value will be incremented until the swapchain is destroyed. 
-        fence_values[current_frame_index]++;
-
-        // Set the image state to render target because we have waited for the image to be freed so it can be used by the application again.
-        current_image_state[current_frame_index] = IMAGE_STATE_RENDER_TARGET;
-        awaited_frame_index = current_frame_index;
-
+        // The image can be used by the application again
+        image_ring.EndWait(index, true);
         return XR_SUCCESS;
     }
 
     XrResult GB_ProxySwapchain::ReleaseImage() {
-        // TODO Should release the oldest image in the swap chain according to the spec, this already happens implicitly when acquiring images from the swap chain.
-        // When Acquiring, an image is released that has already been presented, that index is then used to render a new image to.
-
-        // Image state must be IMAGE_STATE_RENDER_TARGET before calling this. Image must have waited without timeout.
-        if (current_image_state[awaited_frame_index] != IMAGE_STATE_RENDER_TARGET) {
-            return XR_ERROR_CALL_ORDER_INVALID;
-        }
-
-        // TODO moved this call to compositor for now
-        // Schedule a Signal command in the queue. for the currently rendered frame
-        //command_queue->Signal(fence.Get(), fence_values[current_frame_index]);
-
+        // After this the image can be weaved. It can also be reacquired by another application thread right away,
+        // the wait on the timeline keeps the application from rendering to it before weaving is done.
+        uint32_t index = 0;
+        return image_ring.Release(index);
+    }
 
-        /// TODO (ONLY FOR SETTING TO IMAGE_STATE_WEAVING) test if this works with multi threaded rendering applications. It could be that after release, another thread will immediately call AcquireSwapchainImage, which will now return CALL_ORDER_INVALID since the weaving still has to happen on the first thread.
-        // Set the image state to IMAGE_STATE_RELEASED. After this the image can be weaved. The image can also be reacquired by the application though.
-        // TODO Set up the fences in a way that WaitForImage should also wait for the presentation to be done
-        current_image_state[awaited_frame_index] = IMAGE_STATE_RELEASED;
+    uint32_t GB_ProxySwapchain::GetReleasedIndex() const {
+        return image_ring.GetReleasedIndex();
+    }
 
-        return XR_SUCCESS;
+    void GB_ProxySwapchain::SetImageTimelineValue(uint32_t index, uint64_t value) {
+        timeline_values[index].store(value, std::memory_order_release);
     }
 
     void GB_GraphicsDevice::CreateDXGIFactory(IDXGIFactory4** factory) {
@@ -438,17 +544,18 @@ namespace XRGameBridge {
         *ppAdapter = adapter.Detach();
     }
 
-    bool GB_GraphicsDevice::CreateSwapChain(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue, const XrSwapchainCreateInfo* createInfo, HWND hwnd) {
+    bool GB_GraphicsDevice::CreateSwapChain(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue, const XrSwapchainCreateInfo* createInfo, HWND hwnd, uint32_t count) {
         // TODO On failure all objects here should be destroyed
         Microsoft::WRL::ComPtr<IDXGIFactory4> factory;
         CreateDXGIFactory(&factory);
+        image_count = std::clamp(count, g_min_swapchain_images, g_max_swapchain_images);
 
         DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
         swapChainDesc.Width = createInfo->width;
         swapChainDesc.Height = createInfo->height;
         swapChainDesc.Format = static_cast<DXGI_FORMAT>(createInfo->format);
         swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT | DXGI_USAGE_BACK_BUFFER;
-        swapChainDesc.BufferCount = g_back_buffer_count;
+        swapChainDesc.BufferCount = image_count;
         swapChainDesc.SampleDesc.Count = 1;
         swapChainDesc.SampleDesc.Quality = 0;
         swapChainDesc.Scaling = DXGI_SCALING_NONE;
@@ -478,7 +585,7 @@ namespace XRGameBridge {
         {
             // Describe and create a render target view (RTV) descriptor heap.
             D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
-            rtvHeapDesc.NumDescriptors = g_back_buffer_count;
+            rtvHeapDesc.NumDescriptors = image_count;
             rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
             rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
             if (FAILED(device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_rtvHeap)))) {
@@ -489,7 +596,7 @@ namespace XRGameBridge {
             // TODO we create an srv heap here but not srv's themselves later on
             // Describe and create a shader resource view (SRV) heap for the texture.
             D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-            srvHeapDesc.NumDescriptors = g_back_buffer_count;
+            srvHeapDesc.NumDescriptors = image_count;
             srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
             srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
             if (FAILED(device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&m_srvHeap)))) {
@@ -505,7 +612,7 @@ namespace XRGameBridge {
             CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
 
             // Create a RTV for each frame.
-            for (int32_t i = 0; i < g_back_buffer_count; i++) {
+            for (uint32_t i = 0; i < image_count; i++) {
                 if (FAILED(swap_chain->GetBuffer(i, IID_PPV_ARGS(&back_buffers[i])))) {
                     LOG(ERROR) << "Failed to create rtv";
                     return false;
@@ -524,7 +631,11 @@ namespace XRGameBridge {
         return true;
     }
 
-    std::array<ComPtr<ID3D12Resource>, g_back_buffer_count> GB_GraphicsDevice::GetImages() {
+    uint32_t GB_GraphicsDevice::GetImageCount() const {
+        return image_count;
+    }
+
+    const std::array<ComPtr<ID3D12Resource>, g_max_swapchain_images>& GB_GraphicsDevice::GetImages() const {
         return back_buffers;
     }
 
@@ -555,6 +666,22 @@ namespace XRGameBridge {
         // barrier to render target
     }
 
+    bool GB_GraphicsDevice::GetLastVblankAge(int64_t& age) {
+        // Fails until the first frame reached the screen and while the statistics are disjoint, for example after a mode change
+        DXGI_FRAME_STATISTICS statistics;
+        if (FAILED(swap_chain->GetFrameStatistics(&statistics))) {
+            return false;
+        }
+
+        LARGE_INTEGER now;
+        LARGE_INTEGER frequency;
+        QueryPerformanceCounter(&now);
+        QueryPerformanceFrequency(&frequency);
+
+        age = (now.QuadPart - statistics.SyncQPCTime.QuadPart) * 1'000'000'000 / frequency.QuadPart;
+        return true;
+    }
+
     void GetResourceStateFlags(XrSwapchainUsageFlags usage_flags, D3D12_RESOURCE_FLAGS& flags, D3D12_RESOURCE_STATES& states)
     {
         if (XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT & usage_flags) {
@@ -584,4 +711,38 @@ namespace XRGameBridge {
             states |= D3D12_RESOURCE_STATES::D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
         }
     }
+
+    XrResult ValidateSwapchainCreateInfo(const ComPtr<ID3D12Device>& device, const XrSwapchainCreateInfo* createInfo) {
+        if (createInfo->width == 0 || createInfo->height == 0 || createInfo->arraySize == 0 || createInfo->mipCount == 0 || createInfo->sampleCount == 0) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (createInfo->faceCount != 1 && createInfo->faceCount != 6) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        if (createInfo->arraySize > D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION / createInfo->faceCount) {
+            return XR_ERROR_FEATURE_UNSUPPORTED;
+        }
+        // The full chain of a 1x1 image is the longest one
+        const uint32_t max_mips = std::bit_width(std::max(createInfo->width, createInfo->height));
+        if (createInfo->mipCount > max_mips) {
+            return XR_ERROR_FEATURE_UNSUPPORTED;
+        }
+
+        if (createInfo->sampleCount > 1) {
+            // D3D12 has no multisampled mip chains or unordered access to multisampled images
+            if (createInfo->mipCount > 1 || (createInfo->usageFlags & XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT) != 0) {
+                return XR_ERROR_FEATURE_UNSUPPORTED;
+            }
+
+            D3D12_FEATURE_DATA_MULTISAMPLE_QUALITY_LEVELS quality_levels{};
+            quality_levels.Format = static_cast<DXGI_FORMAT>(createInfo->format);
+            quality_levels.SampleCount = createInfo->sampleCount;
+            if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_MULTISAMPLE_QUALITY_LEVELS, &quality_levels, sizeof(quality_levels))) || quality_levels.NumQualityLevels == 0) {
+                LOG(WARNING) << "Sample count " << createInfo->sampleCount << " isn't supported for format " << createInfo->format;
+                return XR_ERROR_FEATURE_UNSUPPORTED;
+            }
+        }
+
+        return XR_SUCCESS;
+    }
 }
@@ -2,8 +2,14 @@
 
 #include <unordered_map>
 #include <array>
+#include <atomic>
 
+#include "graphics_backend.h"
+#include "handle_table.h"
+#include "image_ring.h"
 #include "openxr_includes.h"
+#include "resource_pool.h"
+#include "timeline.h"
 
 XrResult xrEnumerateSwapchainFormats(XrSession session, uint32_t formatCapacityInput, uint32_t* formatCountOutput, int64_t* formats);
 XrResult xrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain);
@@ -18,77 +24,93 @@ namespace XRGameBridge {
     // Forward declaration for GB_ProxySwapchain friend
     class GB_Compositor;
 
-    enum ImageState {
-        IMAGE_STATE_WAITING,
-        IMAGE_STATE_RELEASED,
-
-        IMAGE_STATE_ACQUIRED,
-        IMAGE_STATE_RENDER_TARGET,
-        IMAGE_STATE_WEAVING,
-        IMAGE_STATE_DONE_WEAVING
-    };
-
-    // Back buffer count
-    //TODO make this const inside the class and mutable through the constructor
-    constexpr unsigned short g_back_buffer_count = 2;
+    // Images per swapchain, chosen when the swapchain is created. Storage for the maximum is inline so nothing is allocated per image.
+    // More images let the application render ahead while weaving runs late, fewer keep the memory down.
+    constexpr uint32_t g_min_swapchain_images = 2;
+    constexpr uint32_t g_max_swapchain_images = 4;
 
     // TODO Use resources instead of creating multiple swap chains? Is that better?
     // UEVR create a lot of swap chains so let's just use images....
-    class GB_ProxySwapchain {
+    class GB_ProxySwapchain : public GB_SwapchainBackend {
         friend GB_Compositor;
-        XrSwapchain handle;
+        XrSwapchain handle = XR_NULL_HANDLE;
 
         //ComPtr<ID3D12CommandQueue> command_queue;
-        std::array<ComPtr<ID3D12Resource>, g_back_buffer_count> back_buffers;
+        uint32_t image_count = 0;
+        std::array<ComPtr<ID3D12Resource>, g_max_swapchain_images> back_buffers;
+        // Every image has the same description, array slices are the array size times the face count
+        D3D12_RESOURCE_DESC image_desc = {};
+        // Single sampled copies of multisampled images, the compositor resolves the slices it reads into them and samples those
+        std::array<ComPtr<ID3D12Resource>, g_max_swapchain_images> resolve_images;
         ComPtr<ID3D12DescriptorHeap> rtv_heap;
         ComPtr<ID3D12DescriptorHeap> srv_heap;
 
+        // Where the images and descriptors came from, allocations are invalid for what was created outside the pool
+        GB_ResourcePool* pool = nullptr;
+        std::array<GB_HeapAllocation, g_max_swapchain_images> image_allocations;
+        std::array<GB_HeapAllocation, g_max_swapchain_images> resolve_allocations;
+        GB_HeapAllocation rtv_allocation;
+        GB_HeapAllocation srv_allocation;
+
         uint32_t rtv_descriptor_size = 0;
         uint32_t cbc_srv_uav_descriptor_size = 0;
 
         D3D12_RESOURCE_STATES resource_usage = D3D12_RESOURCE_STATE_COMMON;
-        uint32_t current_frame_index = 0;
-        uint32_t awaited_frame_index = 0;
-        std::array<ImageState, g_back_buffer_count> current_image_state;
-        uint64_t previous_fence_value = 0;
+        GB_ImageRing image_ring;
 
-        // TODO We are using fences for every image instead of every frame, test if we can use fences per frame only instead
-        HANDLE fence_event;
-        ComPtr<ID3D12Fence> fence;
-        std::array<uint64_t, g_back_buffer_count> fence_values;
+        // Session timeline, nullptr for swapchains only the runtime renders to
+        const GB_Timeline* timeline = nullptr;
+        // Timeline value of the last frame that read an image, 0 if none did. Written by the compositor and read by the wait.
+        std::array<std::atomic<uint64_t>, g_max_swapchain_images> timeline_values;
 
     public:
         GB_ProxySwapchain() = default;
-        GB_ProxySwapchain(XrSwapchain handle);
+
+        // The handle is only known after the table slot has been created
+        void SetHandle(XrSwapchain swapchain_handle);
 
         // Todo Not sure how to get the initial resource usage if there are multiple specified, for example D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE and D3D12_RESOURCE_STATE_UNORDERED_ACCESS. Can't set them both initially so there exist the initial_usage parameter for now
-        bool CreateResources(const ComPtr<ID3D12Device>& device, const XrSwapchainCreateInfo* createInfo);
-        bool CreateResources(const ComPtr<ID3D12Device>& device, uint32_t width, uint32_t height, DXGI_FORMAT format, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES states);
+        // count is clamped to [g_min_swapchain_images, g_max_swapchain_images]. Without a pool every swapchain gets its own memory and descriptor heaps.
+        // Without a timeline images are ready as soon as they are acquired.
+        bool CreateResources(const ComPtr<ID3D12Device>& device, const XrSwapchainCreateInfo* createInfo, uint32_t count, GB_ResourcePool* resource_pool, const GB_Timeline* session_timeline);
+        // desc describes every image, arrays, mip chains and multisampled images included
+        bool CreateResources(const ComPtr<ID3D12Device>& device, const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES states, uint32_t count, GB_ResourcePool* resource_pool = nullptr, const GB_Timeline* session_timeline = nullptr);
         void DestroyResources();
 
-        uint32_t GetBufferCount();
-        std::array<ComPtr<ID3D12Resource>, g_back_buffer_count> GetBuffers();
+        uint32_t GetBufferCount() const override;
+        // Only the first GetBufferCount entries are used
+        const std::array<ComPtr<ID3D12Resource>, g_max_swapchain_images>& GetBuffers() const;
         ComPtr<ID3D12DescriptorHeap>& GetRtvHeap();
         ComPtr<ID3D12DescriptorHeap>& GetSrvHeap();
+        // Position of the image's descriptors in the heaps, pooled heaps are shared with other swapchains
+        uint32_t GetRtvIndex(uint32_t image) const;
+        uint32_t GetSrvIndex(uint32_t image) const;
+        uint32_t GetArraySize() const;
+        bool IsMultisampled() const;
 
         // Returns the oldest image index
-        XrResult AcquireNextImage(uint32_t& index);
+        XrResult AcquireNextImage(uint32_t& index) override;
 
         // Waits for an image that has been weaved
-        XrResult WaitForImage(const XrDuration& timeout);
+        XrResult WaitForImage(const XrDuration& timeout) override;
 
         // Make the image available for weaving
-        XrResult ReleaseImage();
+        XrResult ReleaseImage() override;
+
+        // Image the compositor reads, UINT32_MAX until the application released one
+        uint32_t GetReleasedIndex() const;
+        // The image can be rendered to again once the timeline completed the value
+        void SetImageTimelineValue(uint32_t index, uint64_t value);
     };
 
     // TODO swapchain is only necessary if we render to the XR Game Bridge window, otherwise we render to the back buffer of UEVR window
-    // TODO Remark, this swapchain does not have synchronization objects, this is because we already wait for fences on proxy swapchains, which implicitly waits for this swapchains resources.
-    // TODO Make a render loop for presentation to the window/UEVR that uses it's own fences. Then proxy swapchains don't need their own fences anymore.
+    // TODO Remark, this swapchain does not have synchronization objects, this is because proxy swapchains wait on the session timeline, which implicitly waits for this swapchains resources.
     class GB_GraphicsDevice {
         ComPtr<IDXGISwapChain3> swap_chain;
         ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
         ComPtr<ID3D12DescriptorHeap> m_srvHeap;
-        std::array<ComPtr<ID3D12Resource>, g_back_buffer_count> back_buffers;
+        uint32_t image_count = 0;
+        std::array<ComPtr<ID3D12Resource>, g_max_swapchain_images> back_buffers;
 
         D3D12_RESOURCE_STATES resource_usage = D3D12_RESOURCE_STATE_COMMON;
         uint32_t rtv_descriptor_size = 0;
@@ -98,20 +120,30 @@ namespace XRGameBridge {
         static void CreateDXGIFactory(IDXGIFactory4** factory);
         static void GetGraphicsAdapter(IDXGIFactory1* pFactory, IDXGIAdapter1** ppAdapter, bool requestHighPerformanceAdapter);
 
-        // Creates device
-        bool CreateSwapChain(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue, const XrSwapchainCreateInfo* createInfo, HWND hwnd);
+        // Creates device, count is clamped like for proxy swapchains
+        bool CreateSwapChain(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12CommandQueue>& queue, const XrSwapchainCreateInfo* createInfo, HWND hwnd, uint32_t count);
 
-        std::array<ComPtr<ID3D12Resource>, g_back_buffer_count> GetImages();
+        uint32_t GetImageCount() const;
+        // Only the first GetImageCount entries are used
+        const std::array<ComPtr<ID3D12Resource>, g_max_swapchain_images>& GetImages() const;
         ComPtr<ID3D12DescriptorHeap>& GetRtvHeap();
         ComPtr<ID3D12DescriptorHeap>& GetSrvHeap();
         uint32_t GetRtvDescriptorSize();
 
         uint32_t AcquireNextImage();
         void PresentFrame();
+
+        // How long ago the last vblank happened in nanoseconds, false when the frame statistics are not available
+        bool GetLastVblankAge(int64_t& age);
     };
 
+    // The proxy or null swapchain behind the handle, picked by the handle type
+    GB_Expected<GB_SwapchainBackend&> FindSwapchainBackend(XrSwapchain swapchain);
+
     void GetResourceStateFlags(XrSwapchainUsageFlags usage_flags, D3D12_RESOURCE_FLAGS& flags, D3D12_RESOURCE_STATES& states);
+    // XR_SUCCESS when the device can create images like this, sample counts are checked against the format
+    XrResult ValidateSwapchainCreateInfo(const ComPtr<ID3D12Device>& device, const XrSwapchainCreateInfo* createInfo);
 
-    inline std::unordered_map<XrSwapchain, GB_ProxySwapchain> g_proxy_swapchains;
+    inline GB_HandleTable<XrSwapchain, GB_ProxySwapchain> g_proxy_swapchains{ HANDLE_TYPE_SWAPCHAIN };
     //inline std::unordered_map<XrSwapchain, GB_GraphicsDevice> g_graphics_devices;
 }
@@ -4,8 +4,10 @@
 #include <complex>
 
 #include "easylogging++.h"
+#include "logging.h"
 #include "openxr_includes.h"
 #include "instance.h"
+#include "locate.h"
 #include "session.h"
 
 XrResult xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId) {
@@ -37,9 +39,11 @@ XrResult xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSyst
 }
 
 XrResult xrGetSystemProperties(XrInstance instance, XrSystemId systemId, XrSystemProperties* properties) {
-
-    XRGameBridge::GB_System& gb_system = XRGameBridge::g_systems[systemId];
-    *properties = XRGameBridge::GetSystemProperties(gb_system);
+    auto system_lookup = XRGameBridge::FindSystem(systemId);
+    if (!system_lookup) {
+        return system_lookup.error();
+    }
+    *properties = XRGameBridge::GetSystemProperties(*system_lookup);
 
     return XR_SUCCESS;
 }
@@ -110,7 +114,11 @@ XrResult xrGetViewConfigurationProperties(XrInstance instance, XrSystemId system
 XrResult xrEnumerateViewConfigurationViews(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrViewConfigurationView* views) {
     XrResult res = XR_ERROR_RUNTIME_FAILURE;
 
-    XRGameBridge::GB_System gb_system = XRGameBridge::g_systems[systemId];
+    auto system_lookup = XRGameBridge::FindSystem(systemId);
+    if (!system_lookup) {
+        return system_lookup.error();
+    }
+    const XRGameBridge::GB_System& gb_system = *system_lookup;
     XRGameBridge::GBVector2i form_factor_resolution = GetSystemResolution(gb_system, gb_system.form_factor);
     XRGameBridge::GBVector2i native_resolution = GetNativeSystemResolution(gb_system);
 
@@ -123,8 +131,9 @@ XrResult xrEnumerateViewConfigurationViews(XrInstance instance, XrSystemId syste
         view.maxImageRectWidth = native_resolution.x;
         view.recommendedImageRectHeight = form_factor_resolution.y;
         view.maxImageRectHeight = native_resolution.y;
-        view.recommendedSwapchainSampleCount = 2; //TODO idk what this means
-        view.maxSwapchainSampleCount = 2;
+        // Weaving filters the image already, multisampling is left to the application. Every D3D12 device supports 4x for the offered formats.
+        view.recommendedSwapchainSampleCount = 1;
+        view.maxSwapchainSampleCount = 4;
 
         // TODO Create 2 views here to get 2 swap chains and so a view per eye
         supported_views.push_back(view);
@@ -157,66 +166,15 @@ XrResult xrEnumerateViewConfigurationViews(XrInstance instance, XrSystemId syste
     return res;
 }
 
-constexpr auto M_PI = 3.14159265358979323846;
 XrResult xrLocateViews(XrSession session, const XrViewLocateInfo* viewLocateInfo, XrViewState* viewState, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrView* views) {
-    // TODO Dummy implementation for locate views, only returning views with a hardcoded offset hoping these are the eye locations
-
-    float fov = M_PI / 3.5f;
-
-    XrView view1, view2;
-    view1.type = XR_TYPE_VIEW;
-    view1.next = nullptr;
-    view1.pose = { {.0f, 0.0f, 0.0f, 1.0f}, {-0.060f, 0, 0} }; // Orientation, Position
-    view1.fov = { -fov, fov, fov, -fov }; // FOV angle left, right, up, down
-
-    view2.type = XR_TYPE_VIEW;
-    view2.next = nullptr;
-    view2.pose = { {0.0f, 0.0f, 0.0f, 1.0f}, {0.060f, 0, 0} }; // Orientation, Position
-    view2.fov = { -fov, fov, fov, -fov }; // FOV angle left, right, up, down
-
-    std::vector<XrView> sr_views;
-
-    //TODO Don't understand this, for some reason it wants a single view for stereo output.
-    // Should change this later
-    if (viewLocateInfo->viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO) {
-        sr_views = { view1 };
-    }
-    else if (viewLocateInfo->viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
-        sr_views = { view1, view2 };
-    }
-
-    *viewCountOutput = sr_views.size();
-
-    // Request for the extension array or the extension array itself
-    if (viewCapacityInput == 0) {
-        return XR_SUCCESS;
-    }
-    // Passed array not large enough
-    if (viewCapacityInput < sr_views.size()) {
-        return XR_ERROR_SIZE_INSUFFICIENT;
-    }
-
-    viewLocateInfo->displayTime;
-
-    XRGameBridge::GB_ReferenceSpace& gb_ref_space = XRGameBridge::g_reference_spaces[viewLocateInfo->space];
-    if (gb_ref_space.space_type == XR_REFERENCE_SPACE_TYPE_VIEW) // Camera space
-    {
-        gb_ref_space.pose_in_reference_space.position;
-    }
-    if (gb_ref_space.space_type == XR_REFERENCE_SPACE_TYPE_LOCAL) { // World space
-        //view1.pose.position += gb_ref_space.pose_in_reference_space.position;
-        //LOG(INFO) << "World space not implemented: " << __func__;
-    }
-
-    viewState->viewStateFlags = XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_VALID_BIT;
-
-    memcpy_s(views, viewCapacityInput * sizeof(XrView), sr_views.data(), sr_views.size() * sizeof(XrView));
-
-    return XR_SUCCESS;
+    return XRGameBridge::LocateViews(XRGameBridge::g_sessions, session, viewLocateInfo, viewState, viewCapacityInput, viewCountOutput, views);
 }
 
 XrResult xrEnumerateReferenceSpaces(XrSession session, uint32_t spaceCapacityInput, uint32_t* spaceCountOutput, XrReferenceSpaceType* spaces) {
-    XRGameBridge::GB_Session* gb_session = reinterpret_cast<XRGameBridge::GB_Session*>(session);
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
+    }
 
     std::array reference_space_types{
         XR_REFERENCE_SPACE_TYPE_VIEW,
@@ -240,26 +198,28 @@ XrResult xrEnumerateReferenceSpaces(XrSession session, uint32_t spaceCapacityInp
 
 #include "openxr_functions.h"
 XrResult xrCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateInfo* createInfo, XrSpace* space) {
-    static uint64_t reference_space_count = 1;
-    XrSpace handle = reinterpret_cast<XrSpace>(reference_space_count);
-    XRGameBridge::GB_ReferenceSpace new_space;
-    new_space.session = session;
-    new_space.handle = handle;
-    new_space.pose_in_reference_space = createInfo->poseInReferenceSpace;
-    new_space.space_type = createInfo->referenceSpaceType;
-
+    // The types xrEnumerateReferenceSpaces lists, a display on a desk has no floor to put a stage on
     if (createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_VIEW &&
-        createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_LOCAL &&
-        createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_STAGE) {
+        createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_LOCAL) {
         return XR_ERROR_REFERENCE_SPACE_UNSUPPORTED;
     }
 
-    const auto inserted = XRGameBridge::g_reference_spaces.insert({ handle, new_space });
-    if (!inserted.second) {
-        return XR_ERROR_RUNTIME_FAILURE;
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
+    }
+
+    XrSpace handle = XRGameBridge::g_reference_spaces.Create();
+    auto space_lookup = XRGameBridge::g_reference_spaces.Find(handle);
+    if (!space_lookup) {
+        return XR_ERROR_LIMIT_REACHED;
     }
+    XRGameBridge::GB_ReferenceSpace& new_space = *space_lookup;
+    new_space.session = session;
+    new_space.handle = handle;
+    new_space.pose_in_reference_space = createInfo->poseInReferenceSpace;
+    new_space.space_type = createInfo->referenceSpaceType;
 
-    reference_space_count++;
     *space = handle;
 
     return XR_SUCCESS;
@@ -270,81 +230,41 @@ XrResult xrGetReferenceSpaceBoundsRect(XrSession session, XrReferenceSpaceType r
 }
 
 XrResult xrCreateActionSpace(XrSession session, const XrActionSpaceCreateInfo* createInfo, XrSpace* space) {
-    XRGameBridge::GB_ActionSpace new_space{};
+    auto session_lookup = XRGameBridge::g_sessions.Find(session);
+    if (!session_lookup) {
+        return session_lookup.error();
+    }
+
+    XrSpace handle = XRGameBridge::g_action_spaces.Create();
+    auto space_lookup = XRGameBridge::g_action_spaces.Find(handle);
+    if (!space_lookup) {
+        return XR_ERROR_LIMIT_REACHED;
+    }
+    XRGameBridge::GB_ActionSpace& new_space = *space_lookup;
     new_space.session = session;
+    new_space.handle = handle;
     new_space.action = createInfo->action;
     new_space.sub_action_path = createInfo->subactionPath;
     new_space.pose_in_action_space = createInfo->poseInActionSpace;
 
-    // Add action handle to sub action handle for a space handle hash
-    XrSpace handle = reinterpret_cast<XrSpace>(reinterpret_cast<uint64_t>(new_space.action) + createInfo->subactionPath);
     *space = handle;
-    XRGameBridge::g_action_spaces.insert({ handle, new_space });
     return XR_SUCCESS;
 }
 
 XrResult xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
-    // TODO Return to this with a better understanding of spaces. Are there only single View and Local spaces, or do more of them exist?
-    // TODO Should we have both action and reference spaces in a single array for quicker lookup?
-
-
-    // TODO check location flags
-    location->locationFlags;
-
-    // TODO Application may ask for a velocity of the tracked object
-    if (location->next != nullptr) {
-        XrSpaceVelocity* velocity = static_cast<XrSpaceVelocity*>(location->next);
-        velocity->velocityFlags;
-    }
-
-    // For Reference spaces
-    XRGameBridge::GB_ReferenceSpace& gb_space = XRGameBridge::g_reference_spaces[space];
-    XRGameBridge::GB_ReferenceSpace& gb_base_space = XRGameBridge::g_reference_spaces[baseSpace];
-    if (gb_space.session != nullptr) {
-        // TODO, Transform to base space? just returning it for now, in the test the local space is 0 anyways
-        // Telling the application the view position is valid but never being tracked
-        location->pose = gb_space.pose_in_reference_space;
-        location->locationFlags = XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
-
-        return XR_SUCCESS;
-    }
-
-    // For Action spaces
-
-    // Retreiving action spaces is not supported
-    XRGameBridge::GB_ActionSpace& gb_a_space = XRGameBridge::g_action_spaces[space];
-    XRGameBridge::GB_ActionSpace& gb_a_base_space = XRGameBridge::g_action_spaces[baseSpace];
-    if (gb_a_space.session == nullptr) {
-        LOG(INFO) << "Space does not exist";
-    }
-
-    std::string& path = XRGameBridge::g_xrpath_storage[gb_a_space.sub_action_path];
-
-    // TODO Actions are never located now, might be what we want anyways
-    // Application is told the actions are never being tracked this way
-    location->pose = XrPosef{ 0.f };
-    location->locationFlags = 0;
-    return XR_SUCCESS;
+    return XRGameBridge::LocateSpace(XRGameBridge::g_sessions, space, baseSpace, time, location);
 }
 
 XrResult xrDestroySpace(XrSpace space) {
-    // Todo If the space is not a reference space, unorderedmap::[] creates an entry for it. This may not be desired but won't do any harm.
-    // Check for reference space
-     XRGameBridge::GB_ReferenceSpace& gb_reference_space = XRGameBridge::g_reference_spaces[space];
-    if(gb_reference_space.session != nullptr)
-    {
-        XRGameBridge::g_reference_spaces.erase(space);
-        return XR_SUCCESS;
+    // The handle type tells which table owns the space
+    switch (XRGameBridge::GetHandleType(space)) {
+    case XRGameBridge::HANDLE_TYPE_REFERENCE_SPACE:
+        return XRGameBridge::g_reference_spaces.Destroy(space) ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
+    case XRGameBridge::HANDLE_TYPE_ACTION_SPACE:
+        return XRGameBridge::g_action_spaces.Destroy(space) ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
+    default:
+        return XR_ERROR_HANDLE_INVALID;
     }
-
-    // Check for action space
-    XRGameBridge::GB_ActionSpace& gb_action_space = XRGameBridge::g_action_spaces[space];
-    if (gb_action_space.session != nullptr) {
-        XRGameBridge::g_action_spaces.erase(space);
-        return XR_SUCCESS;
-    }
-
-    return XR_ERROR_HANDLE_INVALID;
 }
 
 //XRGameBridge::GBVector2i XRGameBridge::GetDummyScreenResolution() {
@@ -392,6 +312,8 @@ XrSystemId XRGameBridge::CreateXrGameBridgeSystem(XrInstance instance)
     system.sr_screen = SR::Screen::create(*gb_instance->sr_context);
     system.lens_hint = SR::SwitchableLensHint::create(*gb_instance->sr_context);
     system.physical_resolution = GBVector2i{ static_cast<uint64_t>(system.sr_screen->getPhysicalResolutionWidth()), static_cast<uint64_t>(system.sr_screen->getPhysicalResolutionHeight()) };
+    // SR reports the size in centimeters
+    system.physical_size = XrExtent2Df{ system.sr_screen->getPhysicalSizeWidth() * 0.01f, system.sr_screen->getPhysicalSizeHeight() * 0.01f };
 
     g_systems.insert({ system.id, system });
 
@@ -3,6 +3,7 @@
 
 #include "openxr_includes.h"
 #include "platform_manager.h"
+#include "spaces.h"
 
 // System
 XrResult xrGeSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId);
@@ -56,28 +57,13 @@ namespace  XRGameBridge {
         bool features_enumerated = false;
         GraphicsBackend active_graphics_backend;
         GBVector2i physical_resolution;
+        // Meters, zero when the screen doesn't report it
+        XrExtent2Df physical_size;
 
         SR::Screen* sr_screen;
         SR::SwitchableLensHint* lens_hint;
     };
 
-    // Spaces are basically transformation matrices.
-    // They transform a point/orientation with respect to an XrSpace of the applications choosing
-    struct GB_ReferenceSpace {
-        XrSession session;
-        XrSpace handle;
-        XrReferenceSpaceType space_type;
-        XrPosef pose_in_reference_space;
-    };
-
-    struct GB_ActionSpace {
-        XrSession session;
-        XrSpace handle;
-        XrAction action;
-        XrPath sub_action_path;
-        XrPosef pose_in_action_space;
-    };
-
     //GBVector2i GetDummyScreenResolution();
 
     //XrSystemProperties GetDummySystemProperties();
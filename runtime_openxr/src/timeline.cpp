@@ -0,0 +1,55 @@
+#include "timeline.h"
+
+namespace XRGameBridge {
+    bool GB_Timeline::Initialize(const ComPtr<ID3D12Device>& device) {
+        if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)))) {
+            LOG(ERROR) << "Failed to create timeline fence";
+            return false;
+        }
+        fence->SetName(L"Session Timeline Fence");
+        signaled_value.store(0, std::memory_order_release);
+        return true;
+    }
+
+    uint64_t GB_Timeline::GetNextValue() const {
+        return signaled_value.load(std::memory_order_acquire) + 1;
+    }
+
+    uint64_t GB_Timeline::GetSignaledValue() const {
+        return signaled_value.load(std::memory_order_acquire);
+    }
+
+    uint64_t GB_Timeline::GetCompletedValue() const {
+        return fence->GetCompletedValue();
+    }
+
+    uint64_t GB_Timeline::Signal(const ComPtr<ID3D12CommandQueue>& queue) {
+        const uint64_t value = signaled_value.load(std::memory_order_relaxed) + 1;
+        queue->Signal(fence.Get(), value);
+        signaled_value.store(value, std::memory_order_release);
+        return value;
+    }
+
+    void GB_Timeline::WakeOnCompletion(uint64_t value, GB_WaitBackend& backend) const {
+        // Without an event the call would block until the value is reached
+        if (HANDLE event = backend.GetNativeEvent()) {
+            fence->SetEventOnCompletion(value, event);
+        }
+    }
+
+    bool GB_Timeline::Wait(uint64_t value, XrDuration timeout) const {
+        return GetFenceWaiter().Wait(*this, value, timeout);
+    }
+
+    bool GB_Timeline::WaitBlocking(uint64_t value) const {
+        if (fence->GetCompletedValue() >= value) {
+            return true;
+        }
+        // Without an event the call returns once the value is reached
+        if (FAILED(fence->SetEventOnCompletion(value, nullptr))) {
+            LOG(ERROR) << "Failed to wait for timeline value " << value;
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "fence_waiter.h"
+#include "openxr_includes.h"
+
+namespace XRGameBridge {
+    // Session wide timeline fence. Every frame submission signals the next value once, the GPU work of a frame, including reading
+    // the swapchain images of its layers, is done when the timeline completed the frame's value.
+    // Swapchain images remember the value of the last frame that read them, so waiting on an image is a compare against the timeline.
+    class GB_Timeline : public GB_WaitTimeline {
+        ComPtr<ID3D12Fence> fence;
+        // Last value signaled on the queue
+        std::atomic<uint64_t> signaled_value = 0;
+
+    public:
+        bool Initialize(const ComPtr<ID3D12Device>& device);
+
+        // Value of the submission being recorded, the next Signal uses it
+        uint64_t GetNextValue() const;
+        uint64_t GetSignaledValue() const;
+        uint64_t GetCompletedValue() const override;
+        void WakeOnCompletion(uint64_t value, GB_WaitBackend& backend) const override;
+
+        // Signals the next value after everything submitted to the queue so far and returns it, one thread at a time
+        uint64_t Signal(const ComPtr<ID3D12CommandQueue>& queue);
+
+        // Blocks until the timeline completed the value, false when the timeout in nanoseconds expired first. Goes through the fence waiter, safe to call from several threads.
+        bool Wait(uint64_t value, XrDuration timeout = XR_INFINITE_DURATION) const;
+        // Blocks the calling thread on the fence itself, for when the fence waiter was stopped. False if the device was removed.
+        bool WaitBlocking(uint64_t value) const;
+    };
+}
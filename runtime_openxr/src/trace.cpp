@@ -0,0 +1,419 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace XRGameBridge {
+    namespace {
+        constexpr uint64_t record_alignment = 8;
+
+        uint64_t AlignRecordSize(uint64_t size) {
+            return (size + record_alignment - 1) & ~(record_alignment - 1);
+        }
+    }
+
+    GB_MappedFile::~GB_MappedFile() {
+        Close();
+    }
+
+#ifdef _WIN32
+    bool GB_MappedFile::Create(const std::string& path, uint64_t size) {
+        Close();
+
+        HANDLE new_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (new_file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        HANDLE new_mapping = CreateFileMappingA(new_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+        if (new_mapping == nullptr) {
+            CloseHandle(new_file);
+            return false;
+        }
+        void* view = MapViewOfFile(new_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (view == nullptr) {
+            CloseHandle(new_mapping);
+            CloseHandle(new_file);
+            return false;
+        }
+
+        file = new_file;
+        mapping = new_mapping;
+        data = static_cast<uint8_t*>(view);
+        this->size = size;
+        return true;
+    }
+
+    bool GB_MappedFile::Open(const std::string& path) {
+        Close();
+
+        HANDLE new_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (new_file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(new_file, &file_size) || file_size.QuadPart == 0) {
+            CloseHandle(new_file);
+            return false;
+        }
+        HANDLE new_mapping = CreateFileMappingA(new_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (new_mapping == nullptr) {
+            CloseHandle(new_file);
+            return false;
+        }
+        void* view = MapViewOfFile(new_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr) {
+            CloseHandle(new_mapping);
+            CloseHandle(new_file);
+            return false;
+        }
+
+        file = new_file;
+        mapping = new_mapping;
+        data = static_cast<uint8_t*>(view);
+        size = static_cast<uint64_t>(file_size.QuadPart);
+        return true;
+    }
+
+    void GB_MappedFile::Close(uint64_t truncate_size) {
+        if (data != nullptr) {
+            UnmapViewOfFile(data);
+            CloseHandle(mapping);
+            if (truncate_size != 0) {
+                LARGE_INTEGER end;
+                end.QuadPart = static_cast<LONGLONG>(truncate_size);
+                SetFilePointerEx(file, end, nullptr, FILE_BEGIN);
+                SetEndOfFile(file);
+            }
+            CloseHandle(file);
+        }
+        data = nullptr;
+        mapping = nullptr;
+        file = nullptr;
+        size = 0;
+    }
+#else
+    bool GB_MappedFile::Create(const std::string& path, uint64_t size) {
+        Close();
+
+        const int new_file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (new_file < 0) {
+            return false;
+        }
+        if (ftruncate(new_file, static_cast<off_t>(size)) != 0) {
+            close(new_file);
+            return false;
+        }
+        void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, new_file, 0);
+        if (view == MAP_FAILED) {
+            close(new_file);
+            return false;
+        }
+
+        file = new_file;
+        data = static_cast<uint8_t*>(view);
+        this->size = size;
+        return true;
+    }
+
+    bool GB_MappedFile::Open(const std::string& path) {
+        Close();
+
+        const int new_file = open(path.c_str(), O_RDONLY);
+        if (new_file < 0) {
+            return false;
+        }
+        struct stat file_stat;
+        if (fstat(new_file, &file_stat) != 0 || file_stat.st_size == 0) {
+            close(new_file);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, new_file, 0);
+        if (view == MAP_FAILED) {
+            close(new_file);
+            return false;
+        }
+
+        file = new_file;
+        data = static_cast<uint8_t*>(view);
+        size = static_cast<uint64_t>(file_stat.st_size);
+        return true;
+    }
+
+    void GB_MappedFile::Close(uint64_t truncate_size) {
+        if (data != nullptr) {
+            munmap(data, size);
+            if (truncate_size != 0) {
+                ftruncate(file, static_cast<off_t>(truncate_size));
+            }
+            close(file);
+        }
+        data = nullptr;
+        file = -1;
+        size = 0;
+    }
+#endif
+
+    uint8_t* GB_MappedFile::GetData() const {
+        return data;
+    }
+
+    uint64_t GB_MappedFile::GetSize() const {
+        return size;
+    }
+
+    GB_TraceWriter::~GB_TraceWriter() {
+        Close();
+    }
+
+    bool GB_TraceWriter::Open(const std::string& path, uint64_t capacity) {
+        Close();
+        if (capacity < sizeof(GB_TraceFileHeader) || !file.Create(path, capacity)) {
+            return false;
+        }
+
+        const GB_TraceFileHeader header{ g_trace_magic, g_trace_version, 0 };
+        memcpy(file.GetData(), &header, sizeof(header));
+        write_offset.store(sizeof(header), std::memory_order_relaxed);
+        dropped_records.store(0, std::memory_order_relaxed);
+        open.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void GB_TraceWriter::Close() {
+        if (!open.exchange(false)) {
+            return;
+        }
+        // Writers that saw the trace open are still copying into the mapping. Both sides use sequentially consistent operations,
+        // so either a writer sees open cleared or Close sees it counted.
+        while (active_writers.load() != 0) {
+            std::this_thread::yield();
+        }
+        // Cut off the unused capacity, a failed reservation may have moved the offset past the end
+        file.Close(std::min(write_offset.load(std::memory_order_acquire), file.GetSize()));
+    }
+
+    bool GB_TraceWriter::Write(GB_TraceRecordType type, XrTime time, const void* payload, uint32_t payload_size, const void* extra, uint32_t extra_size) {
+        active_writers.fetch_add(1);
+        struct WriterGuard {
+            std::atomic<uint32_t>& active_writers;
+            ~WriterGuard() {
+                active_writers.fetch_sub(1, std::memory_order_release);
+            }
+        } guard{ active_writers };
+
+        if (!open.load()) {
+            return false;
+        }
+
+        const uint64_t record_size = sizeof(GB_TraceRecordHeader) + payload_size + extra_size;
+        const uint64_t reserved_size = AlignRecordSize(record_size);
+        const uint64_t offset = write_offset.fetch_add(reserved_size, std::memory_order_relaxed);
+        if (offset + reserved_size > file.GetSize()) {
+            dropped_records.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint8_t* record = file.GetData() + offset;
+        GB_TraceRecordHeader header{ 0, type, 0, time };
+        memcpy(record, &header, sizeof(header));
+        if (payload_size > 0) {
+            memcpy(record + sizeof(header), payload, payload_size);
+        }
+        if (extra_size > 0) {
+            memcpy(record + sizeof(header) + payload_size, extra, extra_size);
+        }
+
+        // Publish the record, a reader that sees the size sees the rest of it
+        std::atomic_ref<uint32_t> size(reinterpret_cast<GB_TraceRecordHeader*>(record)->size);
+        size.store(static_cast<uint32_t>(record_size), std::memory_order_release);
+        return true;
+    }
+
+    bool GB_TraceWriter::WriteEyeSample(const GB_PoseSample& sample) {
+        return Write(TRACE_RECORD_EYE_SAMPLE, sample.time, &sample, sizeof(sample));
+    }
+
+    bool GB_TraceWriter::WriteFrame(GB_TraceRecordType type, XrTime time, const GB_TraceFrameTiming& timing, const GB_TraceLayer* layers) {
+        const uint32_t layers_size = layers != nullptr ? timing.layer_count * static_cast<uint32_t>(sizeof(GB_TraceLayer)) : 0;
+        return Write(type, time, &timing, sizeof(timing), layers, layers_size);
+    }
+
+    bool GB_TraceWriter::WriteVblank(XrTime time) {
+        return Write(TRACE_RECORD_VBLANK, time, nullptr, 0);
+    }
+
+    uint64_t GB_TraceWriter::GetDroppedRecords() const {
+        return dropped_records.load(std::memory_order_relaxed);
+    }
+
+    bool GB_TraceReader::Open(const std::string& path) {
+        if (!file.Open(path)) {
+            return false;
+        }
+
+        GB_TraceFileHeader header;
+        if (file.GetSize() < sizeof(header)) {
+            file.Close();
+            return false;
+        }
+        memcpy(&header, file.GetData(), sizeof(header));
+        if (header.magic != g_trace_magic || header.version != g_trace_version) {
+            file.Close();
+            return false;
+        }
+
+        Rewind();
+        return true;
+    }
+
+    void GB_TraceReader::Close() {
+        file.Close();
+    }
+
+    bool GB_TraceReader::Next(GB_TraceRecord& record) {
+        if (read_offset + sizeof(GB_TraceRecordHeader) > file.GetSize()) {
+            return false;
+        }
+
+        GB_TraceRecordHeader header;
+        memcpy(&header, file.GetData() + read_offset, sizeof(header));
+        // The end of the trace, or a record that was never finished
+        if (header.size < sizeof(header) || read_offset + header.size > file.GetSize()) {
+            return false;
+        }
+
+        record.type = header.type;
+        record.time = header.time;
+        record.payload = file.GetData() + read_offset + sizeof(header);
+        record.payload_size = header.size - static_cast<uint32_t>(sizeof(header));
+        read_offset += AlignRecordSize(header.size);
+        return true;
+    }
+
+    void GB_TraceReader::Rewind() {
+        read_offset = sizeof(GB_TraceFileHeader);
+    }
+
+    GB_TraceReplay::GB_TraceReplay(GB_TraceReader& reader) : reader(reader) {
+    }
+
+    const GB_ReplayClock& GB_TraceReplay::GetClock() const {
+        return clock;
+    }
+
+    void GB_TraceReplay::Play(const GB_TraceRecord& record, GB_PoseHistory* history, GB_FrameTimer* frame_timer) {
+        clock.Set(std::max(clock.Now(), record.time));
+
+        if (record.type == TRACE_RECORD_EYE_SAMPLE && history != nullptr) {
+            GB_PoseSample sample;
+            if (GB_TraceReader::GetPayload(record, sample)) {
+                history->AddSample(sample);
+            }
+        }
+        else if (record.type == TRACE_RECORD_VBLANK && frame_timer != nullptr) {
+            frame_timer->AddVblank(record.time);
+        }
+    }
+
+    bool GB_TraceReplay::AdvanceTo(XrTime time, GB_PoseHistory* history, GB_FrameTimer* frame_timer) {
+        while (true) {
+            if (!has_pending) {
+                has_pending = reader.Next(pending);
+                if (!has_pending) {
+                    clock.Set(std::max(clock.Now(), time));
+                    return false;
+                }
+            }
+            if (pending.time > time) {
+                clock.Set(std::max(clock.Now(), time));
+                return true;
+            }
+            Play(pending, history, frame_timer);
+            has_pending = false;
+        }
+    }
+
+    bool GB_TraceReplay::AdvanceToNext(GB_TraceRecordType type, GB_TraceRecord& record, GB_PoseHistory* history, GB_FrameTimer* frame_timer) {
+        while (true) {
+            if (!has_pending) {
+                has_pending = reader.Next(pending);
+                if (!has_pending) {
+                    return false;
+                }
+            }
+            Play(pending, history, frame_timer);
+            has_pending = false;
+            if (pending.type == type) {
+                record = pending;
+                return true;
+            }
+        }
+    }
+
+    GB_ReplayPoseSource::GB_ReplayPoseSource(std::string path, const GB_Clock& clock) : path(std::move(path)), clock(clock) {
+    }
+
+    GB_ReplayPoseSource::~GB_ReplayPoseSource() {
+        Stop();
+    }
+
+    bool GB_ReplayPoseSource::Start(GB_PoseHistory& history) {
+        if (running.exchange(true)) {
+            return false;
+        }
+        if (!reader.Open(path)) {
+            running.store(false);
+            return false;
+        }
+
+        thread = std::thread([this, &history] {
+            // The recording starts now, the gaps between samples are kept
+            const int64_t start = clock.Now();
+            int64_t first_sample_time = 0;
+            bool first = true;
+
+            GB_TraceRecord record;
+            while (running.load(std::memory_order_relaxed) && reader.Next(record)) {
+                GB_PoseSample sample;
+                if (record.type != TRACE_RECORD_EYE_SAMPLE || !GB_TraceReader::GetPayload(record, sample)) {
+                    continue;
+                }
+                if (first) {
+                    first_sample_time = sample.time;
+                    first = false;
+                }
+
+                const int64_t due = start + (sample.time - first_sample_time);
+                // Sleep in short steps so Stop doesn't wait for a long gap in the recording
+                for (int64_t now = clock.Now(); now < due && running.load(std::memory_order_relaxed); now = clock.Now()) {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<int64_t>(due - now, 5'000'000)));
+                }
+
+                sample.time = due;
+                history.AddSample(sample);
+            }
+        });
+        return true;
+    }
+
+    void GB_ReplayPoseSource::Stop() {
+        running.store(false);
+        if (thread.joinable()) {
+            thread.join();
+        }
+        reader.Close();
+    }
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include <openxr/openxr.h>
+
+#include "frame_timer.h"
+#include "pose_history.h"
+
+namespace XRGameBridge {
+    // Binary trace of eye samples and frame timing, to reproduce tracking and pacing without the SR hardware.
+    //
+    // Layout: a GB_TraceFileHeader followed by records that each start 8 byte aligned with a GB_TraceRecordHeader.
+    // The file is memory mapped with a fixed capacity and only ever appended to, writers reserve space with an atomic add
+    // and publish a record by writing its size last. A record size of 0 ends the trace.
+    // Records of one type come from one thread and are in time order, records of different types may interleave slightly out of order.
+    // All fields are little endian, the layout is the same on every platform the runtime builds for.
+    constexpr uint32_t g_trace_magic = 0x52544247; // "GBTR"
+    constexpr uint32_t g_trace_version = 1;
+
+    enum GB_TraceRecordType : uint16_t {
+        TRACE_RECORD_NONE = 0,
+        // GB_PoseSample
+        TRACE_RECORD_EYE_SAMPLE,
+        // GB_TraceFrameTiming
+        TRACE_RECORD_WAIT_FRAME,
+        TRACE_RECORD_BEGIN_FRAME,
+        // GB_TraceFrameTiming followed by layer_count GB_TraceLayer
+        TRACE_RECORD_END_FRAME,
+        // No payload, the record time is the vblank
+        TRACE_RECORD_VBLANK,
+        // API capture, see api_capture.h
+        TRACE_RECORD_API_FUNCTION,
+        TRACE_RECORD_API_CALL,
+    };
+
+    struct GB_TraceFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t reserved;
+    };
+
+    struct GB_TraceRecordHeader {
+        // Including this header, 0 while the record is being written
+        uint32_t size;
+        GB_TraceRecordType type;
+        uint16_t reserved;
+        XrTime time;
+    };
+
+    struct GB_TraceFrameTiming {
+        uint64_t frame_index;
+        XrTime display_time;
+        XrDuration display_period;
+        uint32_t layer_count;
+        uint32_t reserved;
+    };
+
+    // What the application submitted in a composition layer, only the first view's sub image is kept
+    struct GB_TraceLayer {
+        uint32_t type;
+        uint32_t flags;
+        uint32_t view_count;
+        uint32_t array_index;
+        int32_t width;
+        int32_t height;
+    };
+
+    static_assert(std::is_trivially_copyable_v<GB_PoseSample>, "Pose samples are written to traces as is");
+
+    struct GB_TraceRecord {
+        GB_TraceRecordType type = TRACE_RECORD_NONE;
+        XrTime time = 0;
+        const uint8_t* payload = nullptr;
+        uint32_t payload_size = 0;
+    };
+
+    // File mapped into memory, read only or read write with a fixed size
+    class GB_MappedFile {
+        uint8_t* data = nullptr;
+        uint64_t size = 0;
+#ifdef _WIN32
+        void* file = nullptr;
+        void* mapping = nullptr;
+#else
+        int file = -1;
+#endif
+
+    public:
+        ~GB_MappedFile();
+
+        // Creates or overwrites the file with size zeroed bytes
+        bool Create(const std::string& path, uint64_t size);
+        bool Open(const std::string& path);
+        // Shrinks the file to truncate_size when it isn't 0
+        void Close(uint64_t truncate_size = 0);
+
+        uint8_t* GetData() const;
+        uint64_t GetSize() const;
+    };
+
+    // Appends records to a trace, any thread may write at any time, also while another thread closes it.
+    // Writers announce themselves before touching the mapping, Close stops new writes and waits for the announced ones before unmapping.
+    class GB_TraceWriter {
+        GB_MappedFile file;
+        std::atomic<uint64_t> write_offset = 0;
+        std::atomic<uint64_t> dropped_records = 0;
+        std::atomic<bool> open = false;
+        std::atomic<uint32_t> active_writers = 0;
+
+    public:
+        static constexpr uint64_t default_capacity = 64ull * 1024 * 1024;
+
+        ~GB_TraceWriter();
+
+        bool Open(const std::string& path, uint64_t capacity = default_capacity);
+        // Waits for writes in progress, writes that start after it return false
+        void Close();
+
+        // Records that don't fit anymore are dropped and counted
+        bool Write(GB_TraceRecordType type, XrTime time, const void* payload, uint32_t payload_size, const void* extra = nullptr, uint32_t extra_size = 0);
+
+        bool WriteEyeSample(const GB_PoseSample& sample);
+        bool WriteFrame(GB_TraceRecordType type, XrTime time, const GB_TraceFrameTiming& timing, const GB_TraceLayer* layers = nullptr);
+        bool WriteVblank(XrTime time);
+
+        uint64_t GetDroppedRecords() const;
+    };
+
+    class GB_TraceReader {
+        GB_MappedFile file;
+        uint64_t read_offset = 0;
+
+    public:
+        bool Open(const std::string& path);
+        void Close();
+
+        // False at the end of the trace
+        bool Next(GB_TraceRecord& record);
+        void Rewind();
+
+        template <typename T>
+        static bool GetPayload(const GB_TraceRecord& record, T& value, uint32_t offset = 0) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (record.payload_size < offset + sizeof(T)) {
+                return false;
+            }
+            memcpy(&value, record.payload + offset, sizeof(T));
+            return true;
+        }
+    };
+
+    // Clock that only moves when the replay moves it
+    class GB_ReplayClock : public GB_Clock {
+        std::atomic<int64_t> now = 0;
+
+    public:
+        int64_t Now() const override {
+            return now.load(std::memory_order_acquire);
+        }
+
+        void Set(int64_t time) {
+            now.store(time, std::memory_order_release);
+        }
+    };
+
+    // Steps through a trace in time order. Eye samples go into a pose history, vblanks into a frame timer and the clock follows the records.
+    // Nothing happens between steps, so benchmarks and regression runs on a trace give the same result every time.
+    class GB_TraceReplay {
+        GB_TraceReader& reader;
+        GB_ReplayClock clock;
+        GB_TraceRecord pending;
+        bool has_pending = false;
+
+        void Play(const GB_TraceRecord& record, GB_PoseHistory* history, GB_FrameTimer* frame_timer);
+
+    public:
+        explicit GB_TraceReplay(GB_TraceReader& reader);
+
+        const GB_ReplayClock& GetClock() const;
+
+        // Plays every record up to and including time, false once the trace is exhausted
+        bool AdvanceTo(XrTime time, GB_PoseHistory* history, GB_FrameTimer* frame_timer);
+        // Plays up to and including the next record of the type and returns it, to step a headless run frame by frame
+        bool AdvanceToNext(GB_TraceRecordType type, GB_TraceRecord& record, GB_PoseHistory* history, GB_FrameTimer* frame_timer);
+    };
+
+    // Plays the eye samples of a trace into a running session in real time, in place of the eye tracker
+    class GB_ReplayPoseSource : public GB_PoseSource {
+        std::string path;
+        const GB_Clock& clock;
+        GB_TraceReader reader;
+
+        std::thread thread;
+        std::atomic<bool> running = false;
+
+    public:
+        GB_ReplayPoseSource(std::string path, const GB_Clock& clock);
+        ~GB_ReplayPoseSource() override;
+
+        bool Start(GB_PoseHistory& history) override;
+        void Stop() override;
+    };
+}
@@ -0,0 +1,81 @@
+#include "view_solver.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "pose_math.h"
+
+namespace XRGameBridge {
+    GB_ViewSolver::GB_ViewSolver(const GB_EyePredictor& eye_predictor, const GB_SpaceGraph& space_graph) : eye_predictor(eye_predictor), space_graph(space_graph) {
+    }
+
+    void GB_ViewSolver::SetScreenSize(const XrExtent2Df& size) {
+        std::scoped_lock lock(cache_mutex);
+        screen_size = size;
+        cache = {};
+    }
+
+    void GB_ViewSolver::SolveFrustums(const XrExtent2Df& screen_size, const XrVector3f* eyes, XrFovf* fovs, uint32_t count) {
+        if (screen_size.width <= 0.0f || screen_size.height <= 0.0f) {
+            std::fill_n(fovs, count, XrFovf{ -fallback_half_fov, fallback_half_fov, fallback_half_fov, -fallback_half_fov });
+            return;
+        }
+
+        const float half_width = screen_size.width / 2.0f;
+        const float half_height = screen_size.height / 2.0f;
+        for (uint32_t i = 0; i < count; i++) {
+            const XrVector3f& eye = eyes[i];
+            const float distance = std::max(eye.z, min_eye_distance);
+
+            // Angles from the eye to the screen edges, measured from the screen normal through the eye
+            fovs[i].angleLeft = std::atan((-half_width - eye.x) / distance);
+            fovs[i].angleRight = std::atan((half_width - eye.x) / distance);
+            fovs[i].angleUp = std::atan((half_height - eye.y) / distance);
+            fovs[i].angleDown = std::atan((-half_height - eye.y) / distance);
+        }
+    }
+
+    GB_Expected<GB_ViewSolution> GB_ViewSolver::Solve(XrSpace base_space, XrTime display_time) const {
+        // Read before sampling, a sample that arrives in the meantime leaves the entry stale instead of wrongly fresh
+        const uint64_t generation = eye_predictor.GetGeneration();
+
+        XrExtent2Df size;
+        {
+            std::scoped_lock lock(cache_mutex);
+            for (const CacheEntry& entry : cache) {
+                if (entry.base_space == base_space && entry.display_time == display_time && entry.generation == generation) {
+                    return entry.solution;
+                }
+            }
+            size = screen_size;
+        }
+
+        auto base_lookup = space_graph.LocateInDisplay(base_space, display_time);
+        if (!base_lookup) {
+            return GB_Expected<GB_ViewSolution>::Error(base_lookup.error());
+        }
+
+        // Where the eyes will be when the frame is shown, the default eye positions until the tracker delivers samples
+        GB_PoseSample eyes;
+        const bool tracked = eye_predictor.Predict(display_time, eyes);
+
+        GB_ViewSolution solution;
+        solution.base_flags = base_lookup->flags;
+        solution.tracked = tracked;
+
+        const std::array<XrVector3f, 2> eye_positions{ eyes.left_eye, eyes.right_eye };
+        SolveFrustums(size, eye_positions.data(), solution.fovs.data(), static_cast<uint32_t>(eye_positions.size()));
+
+        // The views face the screen, not the direction the head is turned
+        const XrQuaternionf facing_screen{ 0.0f, 0.0f, 0.0f, 1.0f };
+        solution.poses = { XrPosef{ facing_screen, eyes.left_eye }, XrPosef{ facing_screen, eyes.right_eye } };
+        PoseMultiplyBatch(PoseInverse(base_lookup->pose), solution.poses.data(), solution.poses.data(), static_cast<uint32_t>(solution.poses.size()));
+
+        {
+            std::scoped_lock lock(cache_mutex);
+            cache[next_entry] = { base_space, display_time, generation, solution };
+            next_entry = (next_entry + 1) % cache_size;
+        }
+        return solution;
+    }
+}
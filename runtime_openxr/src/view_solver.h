@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+
+#include <openxr/openxr.h>
+
+#include "expected.h"
+#include "eye_predictor.h"
+#include "space_graph.h"
+
+namespace XRGameBridge {
+    // Located eyes for one xrLocateViews call, left eye first
+    struct GB_ViewSolution {
+        std::array<XrPosef, 2> poses;
+        std::array<XrFovf, 2> fovs;
+        // Flags of the base space in display space, views can't be located when it isn't valid
+        XrSpaceLocationFlags base_flags;
+        bool tracked;
+    };
+
+    // Solves the views of a window-style display, the screen is a window into the scene.
+    // Every eye looks straight at the screen plane through an asymmetric frustum that passes through the edges of the physical screen,
+    // so the image stays fixed to the screen as the eyes move.
+    // Solutions are cached per (base space, display time, eye prediction), repeated calls within a frame only copy the cached solution.
+    class GB_ViewSolver {
+    public:
+        static constexpr uint32_t cache_size = 4;
+        // Eyes closer to the screen than this are clamped, the frustum degenerates at the screen plane
+        static constexpr float min_eye_distance = 0.05f;
+        // Used while the screen size is unknown
+        static constexpr float fallback_half_fov = 3.14159265358979323846f / 3.5f;
+
+    private:
+        struct CacheEntry {
+            XrSpace base_space = XR_NULL_HANDLE;
+            XrTime display_time = 0;
+            uint64_t generation = 0;
+            GB_ViewSolution solution{};
+        };
+
+        const GB_EyePredictor& eye_predictor;
+        const GB_SpaceGraph& space_graph;
+
+        mutable std::mutex cache_mutex;
+        // Meters, the screen is centered on the display space origin in the z = 0 plane
+        XrExtent2Df screen_size{};
+        mutable std::array<CacheEntry, cache_size> cache;
+        mutable uint32_t next_entry = 0;
+
+    public:
+        GB_ViewSolver(const GB_EyePredictor& eye_predictor, const GB_SpaceGraph& space_graph);
+
+        void SetScreenSize(const XrExtent2Df& size);
+
+        // Off-axis frustums from eyes in display space to the screen rectangle, writes count fovs
+        static void SolveFrustums(const XrExtent2Df& screen_size, const XrVector3f* eyes, XrFovf* fovs, uint32_t count);
+
+        GB_Expected<GB_ViewSolution> Solve(XrSpace base_space, XrTime display_time) const;
+    };
+}
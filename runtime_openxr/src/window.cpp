@@ -113,6 +113,27 @@ namespace XRGameBridge {
         return h_wnd;
     }
 
+    double GB_Display::GetRefreshRate() {
+        HMONITOR monitor = MonitorFromWindow(h_wnd, MONITOR_DEFAULTTONEAREST);
+        MONITORINFOEXA monitor_info{};
+        monitor_info.cbSize = sizeof(monitor_info);
+        if (!GetMonitorInfoA(monitor, &monitor_info)) {
+            return 0.0;
+        }
+
+        DEVMODEA display_mode{};
+        display_mode.dmSize = sizeof(display_mode);
+        if (!EnumDisplaySettingsA(monitor_info.szDevice, ENUM_CURRENT_SETTINGS, &display_mode)) {
+            return 0.0;
+        }
+
+        // 0 and 1 mean the hardware default
+        if (display_mode.dmDisplayFrequency <= 1) {
+            return 0.0;
+        }
+        return static_cast<double>(display_mode.dmDisplayFrequency);
+    }
+
     void GB_Display::UpdateWindow() {
         // Main message loop:
         MSG msg;
@@ -16,6 +16,8 @@ namespace XRGameBridge {
         static LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
         bool CreateApplicationWindow(HINSTANCE hInstance, uint32_t width, uint32_t height, int nCmdShow, bool fullscreen = true);
         HWND GetWindowHandle();
+        // Refresh rate of the monitor the window is on, 0 if unknown
+        double GetRefreshRate();
         void UpdateWindow();
     };
 }
@@ -0,0 +1,13 @@
+echo off
+
+rem Stall time in xrWaitSwapchainImage against the swapchain image count, one CSV row per image count.
+rem Usage: image_count_sweep.bat <path to SyntheticClient.exe> [client options, for example --uevr]
+SET client=%1
+SET csv=image_count_sweep.csv
+
+for %%I in (2 3 4) do (
+	%client% --images=%%I --label=images_%%I --csv=%csv% %2 %3 %4 %5 %6 %7 %8 %9
+)
+echo Results in %csv%
+
+pause
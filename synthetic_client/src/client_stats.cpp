@@ -0,0 +1,98 @@
+#include "client_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "trace.h"
+
+namespace XRGameBridge {
+    GB_DurationStats Summarize(std::vector<int64_t>& samples) {
+        GB_DurationStats stats;
+        if (samples.empty()) {
+            return stats;
+        }
+        std::sort(samples.begin(), samples.end());
+
+        double sum = 0.0;
+        for (int64_t sample : samples) {
+            sum += static_cast<double>(sample);
+        }
+        stats.count = samples.size();
+        stats.mean = sum / static_cast<double>(samples.size());
+
+        double squares = 0.0;
+        for (int64_t sample : samples) {
+            const double deviation = static_cast<double>(sample) - stats.mean;
+            squares += deviation * deviation;
+        }
+        stats.stddev = std::sqrt(squares / static_cast<double>(samples.size()));
+
+        stats.median = samples[samples.size() / 2];
+        stats.p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+        stats.max = samples.back();
+        return stats;
+    }
+
+    bool ReadDisplayTimes(const std::string& trace_path, GB_DisplayTimeStats& stats) {
+        GB_TraceReader reader;
+        if (!reader.Open(trace_path)) {
+            return false;
+        }
+
+        struct EndedFrame {
+            XrTime end_time;
+            XrTime display_time;
+            XrDuration display_period;
+        };
+        std::vector<EndedFrame> frames;
+        std::vector<XrTime> vblanks;
+        XrDuration display_period = 0;
+
+        // End frame records don't carry the period, the wait frame before them does
+        GB_TraceRecord record;
+        while (reader.Next(record)) {
+            GB_TraceFrameTiming timing;
+            if (record.type == TRACE_RECORD_WAIT_FRAME && GB_TraceReader::GetPayload(record, timing)) {
+                display_period = timing.display_period;
+            }
+            else if (record.type == TRACE_RECORD_END_FRAME && GB_TraceReader::GetPayload(record, timing)) {
+                frames.push_back({ record.time, timing.display_time, display_period });
+            }
+            else if (record.type == TRACE_RECORD_VBLANK) {
+                vblanks.push_back(record.time);
+            }
+        }
+        reader.Close();
+
+        // Records of different types may interleave slightly out of order
+        std::sort(vblanks.begin(), vblanks.end());
+
+        for (const EndedFrame& frame : frames) {
+            auto vblank = std::upper_bound(vblanks.begin(), vblanks.end(), frame.end_time);
+            if (vblank == vblanks.end()) {
+                stats.unmatched_frames++;
+                continue;
+            }
+            const int64_t error = *vblank - frame.display_time;
+            stats.errors.push_back(error);
+            if (frame.display_period > 0 && error >= frame.display_period / 2) {
+                stats.late_frames++;
+            }
+        }
+        return true;
+    }
+
+    void PrintStatsHeader(std::ostream& out) {
+        char line[160];
+        snprintf(line, sizeof(line), "%-32s %10s %10s %10s %10s %10s %10s\n", "us", "count", "mean", "stddev", "median", "p99", "max");
+        out << line;
+    }
+
+    void PrintStats(std::ostream& out, const std::string& name, const GB_DurationStats& stats) {
+        char line[160];
+        snprintf(line, sizeof(line), "%-32s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", name.c_str(), static_cast<unsigned long long>(stats.count),
+            stats.mean / 1e3, stats.stddev / 1e3, stats.median / 1e3, stats.p99 / 1e3, stats.max / 1e3);
+        out << line;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace XRGameBridge {
+    // Distribution of a set of nanosecond samples
+    struct GB_DurationStats {
+        uint64_t count = 0;
+        double mean = 0.0;
+        double stddev = 0.0;
+        int64_t median = 0;
+        int64_t p99 = 0;
+        int64_t max = 0;
+    };
+
+    // Sorts the samples
+    GB_DurationStats Summarize(std::vector<int64_t>& samples);
+
+    // Predicted display time of every frame the runtime recorded against the vblank it was actually shown at
+    struct GB_DisplayTimeStats {
+        // Actual minus predicted, positive when the frame was shown later than predicted
+        std::vector<int64_t> errors;
+        // Frames shown at least half a refresh later than predicted
+        uint64_t late_frames = 0;
+        // Frames ended after the last recorded vblank
+        uint64_t unmatched_frames = 0;
+    };
+
+    // Reads the trace the runtime recorded during the session (XR_GAME_BRIDGE_TRACE_RECORD).
+    // A frame counts as shown at the first vblank after xrEndFrame started composing it, the runtime records a vblank with every present.
+    bool ReadDisplayTimes(const std::string& trace_path, GB_DisplayTimeStats& stats);
+
+    // One line of the report, times in microseconds
+    void PrintStats(std::ostream& out, const std::string& name, const GB_DurationStats& stats);
+    void PrintStatsHeader(std::ostream& out);
+}
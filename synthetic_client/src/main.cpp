@@ -0,0 +1,150 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <easylogging++.h>
+
+#include "logging.h"
+#include "synthetic_client.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+    struct Options {
+        std::string csv_path;
+        std::string label;
+        std::string replay_path;
+    };
+
+    // The replay runs inside the runtime, it has to call the entry points directly to time them
+    int ReplayCapture(const std::string& runtime_path, const std::string& capture_path) {
+        HMODULE runtime = LoadLibraryA(runtime_path.c_str());
+        if (runtime == nullptr) {
+            std::cerr << "Can't load " << runtime_path << '\n';
+            return 1;
+        }
+
+        using PFN_ReplayApiCapture = int (*)(const char*);
+        auto replay = reinterpret_cast<PFN_ReplayApiCapture>(GetProcAddress(runtime, "GB_ReplayApiCapture"));
+        const int result = replay != nullptr ? replay(capture_path.c_str()) : 1;
+        if (replay == nullptr) {
+            std::cerr << runtime_path << " doesn't export GB_ReplayApiCapture\n";
+        }
+        FreeLibrary(runtime);
+        return result;
+    }
+
+    bool ParseOptions(int argc, char** argv, XRGameBridge::GB_ClientConfig& config, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            const std::string_view argument(argv[i]);
+            auto value = [&](std::string_view name, std::string& out) {
+                if (argument.substr(0, name.size()) != name) {
+                    return false;
+                }
+                out = argument.substr(name.size());
+                return true;
+            };
+
+            std::string number;
+            if (argument == "--uevr") {
+                config.ApplyUevrPreset();
+                continue;
+            }
+            if (argument == "--headless") {
+                config.headless = true;
+                continue;
+            }
+            if (value("--runtime=", config.runtime_path) || value("--trace=", config.trace_path) || value("--csv=", options.csv_path) || value("--label=", options.label) || value("--replay=", options.replay_path)) {
+                continue;
+            }
+            if (value("--frames=", number)) {
+                config.frames = std::atoi(number.c_str());
+                continue;
+            }
+            if (value("--swapchains=", number)) {
+                config.swapchain_count = std::atoi(number.c_str());
+                continue;
+            }
+            if (value("--images=", number)) {
+                config.swapchain_images = std::atoi(number.c_str());
+                continue;
+            }
+            if (value("--quads=", number)) {
+                config.quad_layers = std::atoi(number.c_str());
+                continue;
+            }
+            if (value("--size=", number)) {
+                config.width = std::atoi(number.c_str());
+                const size_t separator = number.find('x');
+                config.height = separator != std::string::npos ? std::atoi(number.c_str() + separator + 1) : config.height;
+                continue;
+            }
+            if (value("--locate_views=", number)) {
+                config.locate_views = std::atoi(number.c_str());
+                continue;
+            }
+            if (value("--locate_spaces=", number)) {
+                config.locate_spaces = std::atoi(number.c_str());
+                continue;
+            }
+            if (value("--render_ms=", number)) {
+                config.render_ms = std::atof(number.c_str());
+                continue;
+            }
+            if (value("--render_jitter_ms=", number)) {
+                config.render_jitter_ms = std::atof(number.c_str());
+                continue;
+            }
+            if (value("--seed=", number)) {
+                config.seed = std::atoi(number.c_str());
+                continue;
+            }
+
+            std::cerr << "Usage: " << argv[0] << " [--runtime=<dll>] [--trace=<file>] [--frames=<n>] [--headless] [--uevr] [--swapchains=<n>] [--images=<2-4>] [--quads=<n>]\n"
+                << "    [--size=<w>x<h>] [--locate_views=<n>] [--locate_spaces=<n>] [--render_ms=<ms>] [--render_jitter_ms=<ms>] [--seed=<n>]\n"
+                << "    [--csv=<file> [--label=<name>]]\n"
+                << "       " << argv[0] << " [--runtime=<dll>] --replay=<api capture>\n"
+                << "Options after --uevr override the preset\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToStandardOutput, "false");
+
+    XRGameBridge::GB_ClientConfig config;
+    config.runtime_path = GB_CLIENT_RUNTIME_PATH;
+    Options options;
+    if (!ParseOptions(argc, argv, config, options)) {
+        return 1;
+    }
+    if (!options.replay_path.empty()) {
+        return ReplayCapture(config.runtime_path, options.replay_path);
+    }
+
+    int result = 0;
+    {
+        XRGameBridge::GB_SyntheticClient client(config);
+        if (!client.Initialize()) {
+            std::cerr << "Session setup failed, see the log\n";
+            result = 1;
+        }
+        else {
+            if (!client.Run()) {
+                std::cerr << "Frame loop stopped early, see the log\n";
+                result = 1;
+            }
+            client.Report(std::cout);
+            if (!options.csv_path.empty() && !client.WriteCsv(options.csv_path, options.label)) {
+                std::cerr << "Can't write " << options.csv_path << '\n';
+                result = 1;
+            }
+        }
+    }
+
+    XRGameBridge::FlushLog();
+    return result;
+}
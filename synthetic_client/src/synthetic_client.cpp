@@ -0,0 +1,488 @@
+#include "synthetic_client.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include <dxgi1_6.h>
+
+#include "easylogging++.h"
+
+namespace XRGameBridge {
+    namespace {
+        int64_t Now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+        }
+
+        // Settings the user passed in the environment win
+        void SetDefaultEnvironment(const char* name, const std::string& value) {
+            if (std::getenv(name) == nullptr) {
+                _putenv_s(name, value.c_str());
+            }
+        }
+
+        const char* GetCallName(GB_ClientCall call) {
+            switch (call) {
+            case CLIENT_CALL_WAIT_FRAME: return "xrWaitFrame";
+            case CLIENT_CALL_BEGIN_FRAME: return "xrBeginFrame";
+            case CLIENT_CALL_LOCATE_VIEWS: return "xrLocateViews";
+            case CLIENT_CALL_LOCATE_SPACE: return "xrLocateSpace";
+            case CLIENT_CALL_ACQUIRE_IMAGE: return "xrAcquireSwapchainImage";
+            case CLIENT_CALL_WAIT_IMAGE: return "xrWaitSwapchainImage";
+            case CLIENT_CALL_RELEASE_IMAGE: return "xrReleaseSwapchainImage";
+            case CLIENT_CALL_END_FRAME: return "xrEndFrame";
+            default: return "unknown";
+            }
+        }
+
+        constexpr XrPosef identity_pose{ { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } };
+    }
+
+    void GB_ClientConfig::ApplyUevrPreset() {
+        // Eye swapchains, overlay swapchains for the game UI and the framework and a few spare ones the mod recreates on resolution changes
+        swapchain_count = 6;
+        quad_layers = 2;
+        // Locate calls from the game thread, the render thread and the framework, the controllers and the HMD are located separately
+        locate_views = 4;
+        locate_spaces = 16;
+        render_ms = 6.0;
+        render_jitter_ms = 2.0;
+    }
+
+    GB_SyntheticClient::GB_SyntheticClient(GB_ClientConfig config) : config(std::move(config)), random(this->config.seed) {
+        this->config.swapchain_count = std::max(this->config.swapchain_count, 2u);
+        views.fill({ XR_TYPE_VIEW });
+        projection_views.fill({ XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW });
+        projection = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
+    }
+
+    GB_SyntheticClient::~GB_SyntheticClient() {
+        Destroy();
+    }
+
+    bool GB_SyntheticClient::Initialize() {
+        // No eye tracker needed, and the runtime records the frame timing the report reads back
+        SetDefaultEnvironment("XR_GAME_BRIDGE_SYNTHETIC_POSES", "1");
+        SetDefaultEnvironment("XR_GAME_BRIDGE_TRACE_RECORD", config.trace_path);
+        config.trace_path = std::getenv("XR_GAME_BRIDGE_TRACE_RECORD");
+        if (config.swapchain_images != 0) {
+            _putenv_s("XR_GAME_BRIDGE_SWAPCHAIN_IMAGES", std::to_string(config.swapchain_images).c_str());
+        }
+
+        if (!xr.LoadRuntime(config.runtime_path)) {
+            return false;
+        }
+        if (!CreateInstance() || (!config.headless && !CreateDevice()) || !CreateSession() || !CreateSwapchains()) {
+            return false;
+        }
+        PrepareLayers();
+
+        // The runtime makes the session ready once it has a swapchain
+        if (!WaitForSessionState(XR_SESSION_STATE_READY)) {
+            LOG(ERROR) << "Session didn't become ready";
+            return false;
+        }
+        XrSessionBeginInfo begin_info{ XR_TYPE_SESSION_BEGIN_INFO };
+        begin_info.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        if (XR_FAILED(xr.xrBeginSession(session, &begin_info))) {
+            LOG(ERROR) << "xrBeginSession failed";
+            return false;
+        }
+        PollEvents();
+        return true;
+    }
+
+    bool GB_SyntheticClient::CreateInstance() {
+        const char* extensions[] = { config.headless ? XR_MND_HEADLESS_EXTENSION_NAME : XR_KHR_D3D12_ENABLE_EXTENSION_NAME };
+
+        XrInstanceCreateInfo create_info{ XR_TYPE_INSTANCE_CREATE_INFO };
+        strcpy_s(create_info.applicationInfo.applicationName, "SyntheticClient");
+        strcpy_s(create_info.applicationInfo.engineName, "XRGameBridge");
+        create_info.applicationInfo.applicationVersion = 1;
+        create_info.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+        create_info.enabledExtensionCount = 1;
+        create_info.enabledExtensionNames = extensions;
+
+        if (XR_FAILED(xr.xrCreateInstance(&create_info, &instance))) {
+            LOG(ERROR) << "xrCreateInstance failed";
+            return false;
+        }
+        if (!xr.LoadInstanceFunctions(instance, !config.headless)) {
+            return false;
+        }
+
+        XrSystemGetInfo system_info{ XR_TYPE_SYSTEM_GET_INFO };
+        system_info.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+        if (XR_FAILED(xr.xrGetSystem(instance, &system_info, &system))) {
+            LOG(ERROR) << "xrGetSystem failed";
+            return false;
+        }
+        return true;
+    }
+
+    bool GB_SyntheticClient::CreateDevice() {
+        XrGraphicsRequirementsD3D12KHR requirements{ XR_TYPE_GRAPHICS_REQUIREMENTS_D3D12_KHR };
+        if (XR_FAILED(xr.xrGetD3D12GraphicsRequirementsKHR(instance, system, &requirements))) {
+            LOG(ERROR) << "xrGetD3D12GraphicsRequirementsKHR failed";
+            return false;
+        }
+
+        // The device has to be created on the adapter the runtime composes on
+        Microsoft::WRL::ComPtr<IDXGIFactory4> factory;
+        if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&factory)))) {
+            return false;
+        }
+        Microsoft::WRL::ComPtr<IDXGIAdapter1> adapter;
+        for (UINT index = 0; factory->EnumAdapters1(index, &adapter) != DXGI_ERROR_NOT_FOUND; index++) {
+            DXGI_ADAPTER_DESC1 desc;
+            adapter->GetDesc1(&desc);
+            if (memcmp(&desc.AdapterLuid, &requirements.adapterLuid, sizeof(LUID)) == 0) {
+                break;
+            }
+            adapter.Reset();
+        }
+        if (adapter == nullptr) {
+            LOG(ERROR) << "Adapter of the runtime not found";
+            return false;
+        }
+
+        if (FAILED(D3D12CreateDevice(adapter.Get(), requirements.minFeatureLevel, IID_PPV_ARGS(&device)))) {
+            LOG(ERROR) << "D3D12CreateDevice failed";
+            return false;
+        }
+        D3D12_COMMAND_QUEUE_DESC queue_desc{};
+        queue_desc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+        if (FAILED(device->CreateCommandQueue(&queue_desc, IID_PPV_ARGS(&queue)))) {
+            LOG(ERROR) << "CreateCommandQueue failed";
+            return false;
+        }
+        return true;
+    }
+
+    bool GB_SyntheticClient::CreateSession() {
+        XrGraphicsBindingD3D12KHR binding{ XR_TYPE_GRAPHICS_BINDING_D3D12_KHR };
+        binding.device = device.Get();
+        binding.queue = queue.Get();
+
+        XrSessionCreateInfo create_info{ XR_TYPE_SESSION_CREATE_INFO };
+        create_info.next = config.headless ? nullptr : &binding;
+        create_info.systemId = system;
+        if (XR_FAILED(xr.xrCreateSession(instance, &create_info, &session))) {
+            LOG(ERROR) << "xrCreateSession failed";
+            return false;
+        }
+
+        XrReferenceSpaceCreateInfo space_info{ XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+        space_info.poseInReferenceSpace = identity_pose;
+        space_info.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+        if (XR_FAILED(xr.xrCreateReferenceSpace(session, &space_info, &local_space))) {
+            LOG(ERROR) << "Creating the local space failed";
+            return false;
+        }
+        space_info.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
+        if (XR_FAILED(xr.xrCreateReferenceSpace(session, &space_info, &view_space))) {
+            LOG(ERROR) << "Creating the view space failed";
+            return false;
+        }
+        return true;
+    }
+
+    bool GB_SyntheticClient::CreateSwapchains() {
+        uint32_t format_count = 0;
+        xr.xrEnumerateSwapchainFormats(session, 0, &format_count, nullptr);
+        std::vector<int64_t> formats(format_count);
+        if (format_count == 0 || XR_FAILED(xr.xrEnumerateSwapchainFormats(session, format_count, &format_count, formats.data()))) {
+            LOG(ERROR) << "No swapchain formats";
+            return false;
+        }
+
+        XrSwapchainCreateInfo create_info{ XR_TYPE_SWAPCHAIN_CREATE_INFO };
+        create_info.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+        create_info.format = formats[0];
+        create_info.sampleCount = 1;
+        create_info.width = config.width;
+        create_info.height = config.height;
+        create_info.faceCount = 1;
+        create_info.arraySize = 1;
+        create_info.mipCount = 1;
+
+        for (uint32_t i = 0; i < config.swapchain_count; i++) {
+            XrSwapchain swapchain = XR_NULL_HANDLE;
+            if (XR_FAILED(xr.xrCreateSwapchain(session, &create_info, &swapchain))) {
+                LOG(ERROR) << "xrCreateSwapchain failed for swapchain " << i;
+                return false;
+            }
+            swapchains.push_back(swapchain);
+
+            // Applications look up the images before rendering, even if this one never renders to them
+            uint32_t image_count = 0;
+            xr.xrEnumerateSwapchainImages(swapchain, 0, &image_count, nullptr);
+            std::vector<XrSwapchainImageD3D12KHR> images(image_count, { XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR });
+            xr.xrEnumerateSwapchainImages(swapchain, image_count, &image_count, reinterpret_cast<XrSwapchainImageBaseHeader*>(images.data()));
+            this->image_count = image_count;
+        }
+        return true;
+    }
+
+    void GB_SyntheticClient::PrepareLayers() {
+        const XrRect2Di rect{ { 0, 0 }, { static_cast<int32_t>(config.width), static_cast<int32_t>(config.height) } };
+        for (uint32_t eye = 0; eye < projection_views.size(); eye++) {
+            projection_views[eye].subImage = { swapchains[eye], rect, 0 };
+        }
+        projection.space = local_space;
+        projection.viewCount = static_cast<uint32_t>(projection_views.size());
+        projection.views = projection_views.data();
+        layers.push_back(reinterpret_cast<const XrCompositionLayerBaseHeader*>(&projection));
+
+        // Overlays stacked in front of the viewer, on the swapchains after the eyes or on the eyes' if there are no others
+        const uint32_t overlay_swapchains = static_cast<uint32_t>(swapchains.size()) - 2;
+        quads.resize(config.quad_layers, { XR_TYPE_COMPOSITION_LAYER_QUAD });
+        for (uint32_t i = 0; i < quads.size(); i++) {
+            XrCompositionLayerQuad& quad = quads[i];
+            const uint32_t swapchain = overlay_swapchains > 0 ? 2 + i % overlay_swapchains : i % 2;
+            quad.layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+            quad.space = local_space;
+            quad.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+            quad.subImage = { swapchains[swapchain], rect, 0 };
+            quad.pose = identity_pose;
+            quad.pose.position.z = -1.0f - 0.1f * static_cast<float>(i);
+            quad.size = { 1.0f, static_cast<float>(config.height) / static_cast<float>(config.width) };
+            layers.push_back(reinterpret_cast<const XrCompositionLayerBaseHeader*>(&quad));
+        }
+    }
+
+    void GB_SyntheticClient::PollEvents() {
+        XrEventDataBuffer event{ XR_TYPE_EVENT_DATA_BUFFER };
+        while (xr.xrPollEvent(instance, &event) == XR_SUCCESS) {
+            if (event.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
+                session_state = reinterpret_cast<const XrEventDataSessionStateChanged*>(&event)->state;
+            }
+            else if (event.type == XR_TYPE_EVENT_DATA_EVENTS_LOST) {
+                LOG(WARNING) << "Runtime lost events";
+            }
+            event = { XR_TYPE_EVENT_DATA_BUFFER };
+        }
+    }
+
+    bool GB_SyntheticClient::WaitForSessionState(XrSessionState state) {
+        // State changes are queued by the calls that cause them, a second is plenty
+        const int64_t deadline = Now() + 1'000'000'000;
+        while (session_state != state && Now() < deadline) {
+            PollEvents();
+            if (session_state != state) {
+                Sleep(1);
+            }
+        }
+        return session_state == state;
+    }
+
+    template <typename Call>
+    XrResult GB_SyntheticClient::Measure(GB_ClientCall call, int64_t& frame_time, Call&& function) {
+        const int64_t start = Now();
+        const XrResult result = function();
+        const int64_t duration = Now() - start;
+
+        results.calls[call].push_back(duration);
+        frame_time += duration;
+        if (XR_FAILED(result) && results.failures[call]++ == 0) {
+            LOG(WARNING) << GetCallName(call) << " failed with " << result;
+        }
+        return result;
+    }
+
+    void GB_SyntheticClient::SimulateRender() {
+        std::uniform_real_distribution<double> jitter(-config.render_jitter_ms, config.render_jitter_ms);
+        const double render_ms = std::max(0.0, config.render_ms + jitter(random));
+
+        // Spin, a sleep would give the core away and hide scheduling effects in the runtime
+        const int64_t end = Now() + static_cast<int64_t>(render_ms * 1e6);
+        while (Now() < end) {
+        }
+    }
+
+    bool GB_SyntheticClient::RunFrame(XrTime& previous_display_time, int64_t& previous_wait_return) {
+        int64_t wait_time = 0;
+        int64_t frame_time = 0;
+
+        XrFrameWaitInfo wait_info{ XR_TYPE_FRAME_WAIT_INFO };
+        XrFrameState frame_state{ XR_TYPE_FRAME_STATE };
+        if (XR_FAILED(Measure(CLIENT_CALL_WAIT_FRAME, wait_time, [&] { return xr.xrWaitFrame(session, &wait_info, &frame_state); }))) {
+            return false;
+        }
+
+        // Pacing as the application sees it
+        const int64_t wait_return = Now();
+        const XrDuration period = frame_state.predictedDisplayPeriod;
+        if (previous_wait_return != 0) {
+            const int64_t interval = wait_return - previous_wait_return;
+            results.wait_frame_interval.push_back(interval);
+            results.wait_frame_jitter.push_back(std::abs(interval - period));
+        }
+        if (previous_display_time != 0 && std::abs(frame_state.predictedDisplayTime - previous_display_time - period) > period / 2) {
+            results.skipped_predictions++;
+        }
+        previous_wait_return = wait_return;
+        previous_display_time = frame_state.predictedDisplayTime;
+
+        XrFrameBeginInfo begin_info{ XR_TYPE_FRAME_BEGIN_INFO };
+        Measure(CLIENT_CALL_BEGIN_FRAME, frame_time, [&] { return xr.xrBeginFrame(session, &begin_info); });
+
+        XrViewLocateInfo locate_info{ XR_TYPE_VIEW_LOCATE_INFO };
+        locate_info.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        locate_info.displayTime = frame_state.predictedDisplayTime;
+        locate_info.space = local_space;
+        XrViewState view_state{ XR_TYPE_VIEW_STATE };
+        uint32_t view_count = 0;
+        for (uint32_t i = 0; i < config.locate_views; i++) {
+            Measure(CLIENT_CALL_LOCATE_VIEWS, frame_time, [&] {
+                return xr.xrLocateViews(session, &locate_info, &view_state, static_cast<uint32_t>(views.size()), &view_count, views.data());
+            });
+        }
+
+        XrSpaceLocation location{ XR_TYPE_SPACE_LOCATION };
+        for (uint32_t i = 0; i < config.locate_spaces; i++) {
+            Measure(CLIENT_CALL_LOCATE_SPACE, frame_time, [&] { return xr.xrLocateSpace(view_space, local_space, frame_state.predictedDisplayTime, &location); });
+        }
+
+        XrSwapchainImageAcquireInfo acquire_info{ XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO };
+        XrSwapchainImageWaitInfo image_wait_info{ XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO };
+        image_wait_info.timeout = XR_INFINITE_DURATION;
+        int64_t image_wait_time = 0;
+        for (XrSwapchain swapchain : swapchains) {
+            uint32_t index = 0;
+            Measure(CLIENT_CALL_ACQUIRE_IMAGE, frame_time, [&] { return xr.xrAcquireSwapchainImage(swapchain, &acquire_info, &index); });
+            Measure(CLIENT_CALL_WAIT_IMAGE, image_wait_time, [&] { return xr.xrWaitSwapchainImage(swapchain, &image_wait_info); });
+        }
+        frame_time += image_wait_time;
+        results.frame_image_wait_time.push_back(image_wait_time);
+
+        SimulateRender();
+
+        XrSwapchainImageReleaseInfo release_info{ XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO };
+        for (XrSwapchain swapchain : swapchains) {
+            Measure(CLIENT_CALL_RELEASE_IMAGE, frame_time, [&] { return xr.xrReleaseSwapchainImage(swapchain, &release_info); });
+        }
+
+        for (uint32_t eye = 0; eye < projection_views.size(); eye++) {
+            projection_views[eye].pose = views[eye].pose;
+            projection_views[eye].fov = views[eye].fov;
+        }
+        XrFrameEndInfo end_info{ XR_TYPE_FRAME_END_INFO };
+        end_info.displayTime = frame_state.predictedDisplayTime;
+        end_info.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+        end_info.layerCount = frame_state.shouldRender ? static_cast<uint32_t>(layers.size()) : 0;
+        end_info.layers = layers.data();
+        Measure(CLIENT_CALL_END_FRAME, frame_time, [&] { return xr.xrEndFrame(session, &end_info); });
+
+        results.frame_runtime_time.push_back(frame_time);
+        results.frames++;
+        return true;
+    }
+
+    bool GB_SyntheticClient::Run() {
+        // Nothing allocates in the frame loop
+        const uint32_t frames = config.frames;
+        const uint32_t swapchain_count = static_cast<uint32_t>(swapchains.size());
+        const std::array<uint32_t, CLIENT_CALL_COUNT> calls_per_frame{ 1, 1, config.locate_views, config.locate_spaces, swapchain_count, swapchain_count, swapchain_count, 1 };
+        for (uint32_t call = 0; call < CLIENT_CALL_COUNT; call++) {
+            results.calls[call].reserve(static_cast<size_t>(frames) * calls_per_frame[call]);
+        }
+        results.frame_runtime_time.reserve(frames);
+        results.frame_image_wait_time.reserve(frames);
+        results.wait_frame_interval.reserve(frames);
+        results.wait_frame_jitter.reserve(frames);
+
+        XrTime previous_display_time = 0;
+        int64_t previous_wait_return = 0;
+        for (uint32_t frame = 0; frame < frames; frame++) {
+            PollEvents();
+            if (session_state == XR_SESSION_STATE_EXITING || session_state == XR_SESSION_STATE_LOSS_PENDING) {
+                LOG(WARNING) << "Session ended by the runtime after " << frame << " frames";
+                break;
+            }
+            if (!RunFrame(previous_display_time, previous_wait_return)) {
+                LOG(ERROR) << "xrWaitFrame failed after " << frame << " frames";
+                break;
+            }
+        }
+
+        // Closes the trace, the runtime doesn't implement the state changes after it yet so the result isn't checked
+        xr.xrEndSession(session);
+        return results.frames == frames;
+    }
+
+    void GB_SyntheticClient::Destroy() {
+        for (XrSwapchain swapchain : swapchains) {
+            xr.xrDestroySwapchain(swapchain);
+        }
+        swapchains.clear();
+        if (view_space != XR_NULL_HANDLE) {
+            xr.xrDestroySpace(view_space);
+            view_space = XR_NULL_HANDLE;
+        }
+        if (local_space != XR_NULL_HANDLE) {
+            xr.xrDestroySpace(local_space);
+            local_space = XR_NULL_HANDLE;
+        }
+        if (session != XR_NULL_HANDLE) {
+            xr.xrDestroySession(session);
+            session = XR_NULL_HANDLE;
+        }
+        if (instance != XR_NULL_HANDLE) {
+            xr.xrDestroyInstance(instance);
+            instance = XR_NULL_HANDLE;
+        }
+    }
+
+    void GB_SyntheticClient::Report(std::ostream& out) {
+        out << (config.headless ? "headless, " : "") << "frames " << results.frames << ", swapchains " << swapchains.size() << " of " << image_count << " images, layers " << layers.size() << ", locate views " << config.locate_views
+            << ", locate spaces " << config.locate_spaces << ", render " << config.render_ms << " +- " << config.render_jitter_ms << " ms\n\n";
+
+        PrintStatsHeader(out);
+        for (uint32_t call = 0; call < CLIENT_CALL_COUNT; call++) {
+            PrintStats(out, GetCallName(static_cast<GB_ClientCall>(call)), Summarize(results.calls[call]));
+        }
+        out << '\n';
+        PrintStats(out, "runtime per frame", Summarize(results.frame_runtime_time));
+        PrintStats(out, "image wait per frame", Summarize(results.frame_image_wait_time));
+        PrintStats(out, "xrWaitFrame interval", Summarize(results.wait_frame_interval));
+        PrintStats(out, "xrWaitFrame jitter", Summarize(results.wait_frame_jitter));
+
+        GB_DisplayTimeStats display;
+        if (ReadDisplayTimes(config.trace_path, display)) {
+            PrintStats(out, "actual - predicted display", Summarize(display.errors));
+            out << "\nlate frames " << display.late_frames << ", frames without a vblank after them " << display.unmatched_frames << '\n';
+        }
+        else {
+            out << "\nCan't read " << config.trace_path << ", no display times\n";
+        }
+        out << "predicted display time off by a refresh " << results.skipped_predictions << '\n';
+
+        for (uint32_t call = 0; call < CLIENT_CALL_COUNT; call++) {
+            if (results.failures[call] > 0) {
+                out << GetCallName(static_cast<GB_ClientCall>(call)) << " failed " << results.failures[call] << " times\n";
+            }
+        }
+    }
+
+    bool GB_SyntheticClient::WriteCsv(const std::string& path, const std::string& label) {
+        const bool exists = std::ifstream(path).good();
+        std::ofstream file(path, std::ios::app);
+        if (!file) {
+            return false;
+        }
+        if (!exists) {
+            file << "label,images,swapchains,render_ms,frames,image_wait_median_ns,image_wait_p99_ns,runtime_median_ns,runtime_p99_ns,wait_frame_jitter_p99_ns\n";
+        }
+
+        const GB_DurationStats image_wait = Summarize(results.frame_image_wait_time);
+        const GB_DurationStats runtime = Summarize(results.frame_runtime_time);
+        const GB_DurationStats jitter = Summarize(results.wait_frame_jitter);
+        file << label << ',' << image_count << ',' << swapchains.size() << ',' << config.render_ms << ',' << results.frames << ','
+            << image_wait.median << ',' << image_wait.p99 << ',' << runtime.median << ',' << runtime.p99 << ',' << jitter.p99 << '\n';
+        return true;
+    }
+}
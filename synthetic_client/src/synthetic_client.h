@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <wrl/client.h>
+
+#include "client_stats.h"
+#include "xr_dispatch.h"
+
+namespace XRGameBridge {
+    struct GB_ClientConfig {
+        std::string runtime_path;
+        // Where the runtime records its frame timing, read back for the display time report
+        std::string trace_path = "synthetic_client.gbtrace";
+
+        uint32_t frames = 900;
+        // XR_MND_headless: no D3D12 device and no graphics binding, the runtime runs the session on its null swapchains and compositor
+        bool headless = false;
+        // The first two are the eyes of the projection layer, quad layers cycle through the others
+        uint32_t swapchain_count = 2;
+        uint32_t quad_layers = 0;
+        uint32_t width = 1280;
+        uint32_t height = 720;
+        // Images per swapchain the runtime creates (XR_GAME_BRIDGE_SWAPCHAIN_IMAGES), 0 keeps the runtime's setting
+        uint32_t swapchain_images = 0;
+
+        // Calls per frame, engines locate the views and their tracked objects from several places in a frame
+        uint32_t locate_views = 1;
+        uint32_t locate_spaces = 0;
+
+        // CPU time spent between acquiring and releasing the images, uniformly distributed within the jitter
+        double render_ms = 4.0;
+        double render_jitter_ms = 1.0;
+        uint32_t seed = 1;
+
+        // A UEVR modded game: per eye and overlay swapchains and locate calls from the game thread, the render thread and the framework
+        void ApplyUevrPreset();
+    };
+
+    enum GB_ClientCall : uint32_t {
+        CLIENT_CALL_WAIT_FRAME,
+        CLIENT_CALL_BEGIN_FRAME,
+        CLIENT_CALL_LOCATE_VIEWS,
+        CLIENT_CALL_LOCATE_SPACE,
+        CLIENT_CALL_ACQUIRE_IMAGE,
+        CLIENT_CALL_WAIT_IMAGE,
+        CLIENT_CALL_RELEASE_IMAGE,
+        CLIENT_CALL_END_FRAME,
+        CLIENT_CALL_COUNT,
+    };
+
+    struct GB_ClientResults {
+        std::array<std::vector<int64_t>, CLIENT_CALL_COUNT> calls;
+        // Time spent inside the runtime per frame, without xrWaitFrame which blocks on purpose
+        std::vector<int64_t> frame_runtime_time;
+        // Time per frame the application stalled in xrWaitSwapchainImage, waiting for the compositor to give images back
+        std::vector<int64_t> frame_image_wait_time;
+        // Time between two xrWaitFrame returns and its distance from the predicted display period
+        std::vector<int64_t> wait_frame_interval;
+        std::vector<int64_t> wait_frame_jitter;
+        // Frames whose predicted display time didn't move one period past the previous frame's
+        uint64_t skipped_predictions = 0;
+        std::array<uint64_t, CLIENT_CALL_COUNT> failures{};
+        uint64_t frames = 0;
+    };
+
+    // OpenXR application without a window that runs a whole session against the runtime: instance, system, session, spaces, swapchains
+    // and a frame loop with a simulated render cost. Rendering is simulated on the CPU, the images are never touched.
+    class GB_SyntheticClient {
+        GB_ClientConfig config;
+        GB_XrDispatch xr;
+        GB_ClientResults results;
+        std::mt19937 random;
+
+        Microsoft::WRL::ComPtr<ID3D12Device> device;
+        Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue;
+
+        XrInstance instance = XR_NULL_HANDLE;
+        XrSystemId system = XR_NULL_SYSTEM_ID;
+        XrSession session = XR_NULL_HANDLE;
+        XrSpace local_space = XR_NULL_HANDLE;
+        XrSpace view_space = XR_NULL_HANDLE;
+        std::vector<XrSwapchain> swapchains;
+        uint32_t image_count = 0;
+        XrSessionState session_state = XR_SESSION_STATE_UNKNOWN;
+
+        // Submitted every frame, the projection views follow the located views
+        std::array<XrView, 2> views;
+        std::array<XrCompositionLayerProjectionView, 2> projection_views;
+        XrCompositionLayerProjection projection;
+        std::vector<XrCompositionLayerQuad> quads;
+        std::vector<const XrCompositionLayerBaseHeader*> layers;
+
+        bool CreateInstance();
+        // Skipped in headless runs
+        bool CreateDevice();
+        bool CreateSession();
+        bool CreateSwapchains();
+        void PrepareLayers();
+        bool WaitForSessionState(XrSessionState state);
+        void PollEvents();
+
+        bool RunFrame(XrTime& previous_display_time, int64_t& previous_wait_return);
+        void SimulateRender();
+        void Destroy();
+
+        // Times a runtime call and adds it to the frame, failures are counted and logged once per call type
+        template <typename Call>
+        XrResult Measure(GB_ClientCall call, int64_t& frame_time, Call&& function);
+
+    public:
+        explicit GB_SyntheticClient(GB_ClientConfig config);
+        ~GB_SyntheticClient();
+
+        // Sets up the environment of the runtime, XR_GAME_BRIDGE_* is read when the DLL is loaded
+        bool Initialize();
+        bool Run();
+
+        void Report(std::ostream& out);
+        // Appends the run to a CSV file, one row per run so image counts and builds can be compared
+        bool WriteCsv(const std::string& path, const std::string& label);
+    };
+}
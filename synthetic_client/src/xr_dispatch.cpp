@@ -0,0 +1,80 @@
+#include "xr_dispatch.h"
+
+#include "easylogging++.h"
+
+namespace XRGameBridge {
+    namespace {
+        template <typename Function>
+        bool Resolve(PFN_xrGetInstanceProcAddr get_instance_proc_addr, XrInstance instance, const char* name, Function& function) {
+            if (XR_FAILED(get_instance_proc_addr(instance, name, reinterpret_cast<PFN_xrVoidFunction*>(&function))) || function == nullptr) {
+                LOG(ERROR) << "Runtime doesn't provide " << name;
+                return false;
+            }
+            return true;
+        }
+    }
+
+    GB_XrDispatch::~GB_XrDispatch() {
+        if (runtime != nullptr) {
+            FreeLibrary(runtime);
+        }
+    }
+
+    bool GB_XrDispatch::LoadRuntime(const std::string& path) {
+        runtime = LoadLibraryA(path.c_str());
+        if (runtime == nullptr) {
+            LOG(ERROR) << "Can't load " << path;
+            return false;
+        }
+        auto negotiate = reinterpret_cast<PFN_xrNegotiateLoaderRuntimeInterface>(GetProcAddress(runtime, "xrNegotiateLoaderRuntimeInterface"));
+        if (negotiate == nullptr) {
+            LOG(ERROR) << path << " isn't an OpenXR runtime";
+            return false;
+        }
+
+        XrNegotiateLoaderInfo loader_info{ XR_LOADER_INTERFACE_STRUCT_LOADER_INFO, XR_LOADER_INFO_STRUCT_VERSION, sizeof(XrNegotiateLoaderInfo) };
+        loader_info.minInterfaceVersion = 1;
+        loader_info.maxInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+        loader_info.minApiVersion = XR_MAKE_VERSION(1, 0, 0);
+        loader_info.maxApiVersion = XR_CURRENT_API_VERSION;
+
+        XrNegotiateRuntimeRequest runtime_request{ XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST, XR_RUNTIME_INFO_STRUCT_VERSION, sizeof(XrNegotiateRuntimeRequest) };
+        if (XR_FAILED(negotiate(&loader_info, &runtime_request))) {
+            LOG(ERROR) << "Loader interface negotiation failed";
+            return false;
+        }
+        xrGetInstanceProcAddr = runtime_request.getInstanceProcAddr;
+
+        return Resolve(xrGetInstanceProcAddr, XR_NULL_HANDLE, "xrCreateInstance", xrCreateInstance) &&
+            Resolve(xrGetInstanceProcAddr, XR_NULL_HANDLE, "xrEnumerateInstanceExtensionProperties", xrEnumerateInstanceExtensionProperties);
+    }
+
+    bool GB_XrDispatch::LoadInstanceFunctions(XrInstance instance, bool graphics) {
+        bool resolved = true;
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrDestroyInstance", xrDestroyInstance);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrGetSystem", xrGetSystem);
+        if (graphics) {
+            resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrGetD3D12GraphicsRequirementsKHR", xrGetD3D12GraphicsRequirementsKHR);
+        }
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrPollEvent", xrPollEvent);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrCreateSession", xrCreateSession);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrDestroySession", xrDestroySession);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrBeginSession", xrBeginSession);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrEndSession", xrEndSession);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrCreateReferenceSpace", xrCreateReferenceSpace);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrDestroySpace", xrDestroySpace);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrLocateSpace", xrLocateSpace);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrLocateViews", xrLocateViews);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrEnumerateSwapchainFormats", xrEnumerateSwapchainFormats);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrCreateSwapchain", xrCreateSwapchain);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrDestroySwapchain", xrDestroySwapchain);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrEnumerateSwapchainImages", xrEnumerateSwapchainImages);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrAcquireSwapchainImage", xrAcquireSwapchainImage);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrWaitSwapchainImage", xrWaitSwapchainImage);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrReleaseSwapchainImage", xrReleaseSwapchainImage);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrWaitFrame", xrWaitFrame);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrBeginFrame", xrBeginFrame);
+        resolved &= Resolve(xrGetInstanceProcAddr, instance, "xrEndFrame", xrEndFrame);
+        return resolved;
+    }
+}
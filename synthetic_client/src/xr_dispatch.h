@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+
+#include <windows.h>
+#include <d3d12.h>
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_loader_negotiation.h>
+#include <openxr/openxr_platform.h>
+
+namespace XRGameBridge {
+    // Functions of the runtime DLL, resolved the way the loader does it so the client runs without the loader or the registry
+    struct GB_XrDispatch {
+        HMODULE runtime = nullptr;
+        PFN_xrGetInstanceProcAddr xrGetInstanceProcAddr = nullptr;
+
+        // Resolved without an instance
+        PFN_xrCreateInstance xrCreateInstance = nullptr;
+        PFN_xrEnumerateInstanceExtensionProperties xrEnumerateInstanceExtensionProperties = nullptr;
+
+        PFN_xrDestroyInstance xrDestroyInstance = nullptr;
+        PFN_xrGetSystem xrGetSystem = nullptr;
+        PFN_xrGetD3D12GraphicsRequirementsKHR xrGetD3D12GraphicsRequirementsKHR = nullptr;
+        PFN_xrPollEvent xrPollEvent = nullptr;
+        PFN_xrCreateSession xrCreateSession = nullptr;
+        PFN_xrDestroySession xrDestroySession = nullptr;
+        PFN_xrBeginSession xrBeginSession = nullptr;
+        PFN_xrEndSession xrEndSession = nullptr;
+        PFN_xrCreateReferenceSpace xrCreateReferenceSpace = nullptr;
+        PFN_xrDestroySpace xrDestroySpace = nullptr;
+        PFN_xrLocateSpace xrLocateSpace = nullptr;
+        PFN_xrLocateViews xrLocateViews = nullptr;
+        PFN_xrEnumerateSwapchainFormats xrEnumerateSwapchainFormats = nullptr;
+        PFN_xrCreateSwapchain xrCreateSwapchain = nullptr;
+        PFN_xrDestroySwapchain xrDestroySwapchain = nullptr;
+        PFN_xrEnumerateSwapchainImages xrEnumerateSwapchainImages = nullptr;
+        PFN_xrAcquireSwapchainImage xrAcquireSwapchainImage = nullptr;
+        PFN_xrWaitSwapchainImage xrWaitSwapchainImage = nullptr;
+        PFN_xrReleaseSwapchainImage xrReleaseSwapchainImage = nullptr;
+        PFN_xrWaitFrame xrWaitFrame = nullptr;
+        PFN_xrBeginFrame xrBeginFrame = nullptr;
+        PFN_xrEndFrame xrEndFrame = nullptr;
+
+        ~GB_XrDispatch();
+
+        // Loads the DLL and negotiates the loader interface with it
+        bool LoadRuntime(const std::string& path);
+        // Without graphics the functions of XR_KHR_D3D12_enable are left out, the instance doesn't have the extension
+        bool LoadInstanceFunctions(XrInstance instance, bool graphics);
+    };
+}